@@ -0,0 +1,94 @@
+#ifndef BENCHMARKUTILS_H
+#define BENCHMARKUTILS_H
+#include <Utils/Headers.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+/**
+ * Small helpers shared by the benchmark and regression executables.
+ * Results are stored as JSON with one flat object per line, so they can be read back with simple field lookups
+ * instead of a full JSON parser.
+ */
+namespace BenchmarkUtils {
+    /// Monotonic clock used for all timings.
+    using Clock = std::chrono::steady_clock;
+
+    /// Gets the seconds elapsed since start.
+    inline double seconds_since(const Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    /**
+     * Finds a numeric field in a single-line JSON object.
+     * @param line Line holding one flat JSON object.
+     * @param key Field name.
+     * @param value Set to the field's value when found.
+     * @return Whether the field was found.
+     */
+    inline bool json_number(const std::string &line, const std::string &key, double &value) {
+        const auto position = line.find("\"" + key + "\":");
+        if (position == std::string::npos)
+            return false;
+
+        std::istringstream stream(line.substr(position + key.size() + 3));
+        return static_cast<bool>(stream >> value);
+    }
+
+    /**
+     * Finds a string field in a single-line JSON object. Strings with escaped quotes are not supported.
+     * @param line Line holding one flat JSON object.
+     * @param key Field name.
+     * @return Field's value, empty if not found.
+     */
+    inline std::string json_string(const std::string &line, const std::string &key) {
+        const auto position = line.find("\"" + key + "\":");
+        if (position == std::string::npos)
+            return "";
+
+        const auto start = line.find('"', position + key.size() + 3);
+        const auto end = line.find('"', start + 1);
+        if (start == std::string::npos || end == std::string::npos)
+            return "";
+
+        return line.substr(start + 1, end - start - 1);
+    }
+
+    /// Reads every line of a file, throws if it cannot be opened.
+    inline std::vector<std::string> read_lines(const std::string &filename) {
+        std::ifstream file(filename);
+        if (!file.is_open())
+            throw std::runtime_error("cannot open " + filename);
+
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line))
+            lines.push_back(line);
+        return lines;
+    }
+
+    /**
+     * Silences std::cout for its lifetime (the renderer reports progress on it).
+     */
+    class QuietStdout {
+        /// Sink buffer, declared first so it exists before std::cout is redirected to it.
+        std::ostringstream sink;
+
+        /// Buffer std::cout wrote to before.
+        std::streambuf *previous;
+
+    public:
+        QuietStdout() : previous(std::cout.rdbuf(sink.rdbuf())) {
+        }
+
+        ~QuietStdout() {
+            std::cout.rdbuf(previous);
+        }
+
+        QuietStdout(const QuietStdout &) = delete;
+
+        QuietStdout &operator=(const QuietStdout &) = delete;
+    };
+}
+
+#endif //BENCHMARKUTILS_H
@@ -0,0 +1,269 @@
+// Microbenchmark suite for the intersection, sampling and output kernels.
+// Each kernel is warmed up, then timed over repeated batches on a pinned thread, and reported in ns/op with its
+// spread. Results can be saved as JSON and compared against a saved baseline.
+
+#include "BenchmarkUtils.h"
+#include <Geometry/PackedSphereList.h>
+#include <Geometry/SphereList.h>
+#include <Renderer/Renderer.h>
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace BenchmarkUtils;
+
+namespace {
+    /// Statistics of one benchmark, in nanoseconds per operation.
+    struct Result {
+        std::string name;
+        double mean;
+        double stddev;
+        double min;
+        int64_t operations;
+    };
+
+    /// Suite options.
+    struct Options {
+        std::string filter;
+        std::string output;
+        std::string baseline;
+        double warmup_seconds = 0.05;
+        double batch_seconds = 0.01;
+        int batches = 15;
+        double threshold = 0.10;
+        int cpu = 0;
+    };
+
+    /// Keeps the compiler from discarding a value computed by a benchmark.
+    template<typename T>
+    void do_not_optimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const T *sink;
+        sink = &value;
+#endif
+    }
+
+    /// Pins the calling thread to a CPU so timings do not include migrations.
+    void pin_thread(const int cpu) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+            std::cerr << "WARNING: could not pin to CPU " << cpu << ", timings may be noisier" << std::endl;
+#else
+        std::cerr << "WARNING: thread pinning is only supported on Linux" << std::endl;
+#endif
+    }
+
+    /**
+     * Times body, which performs one operation per call.
+     * Calls are grouped into batches long enough to hide timer overhead, after a warm-up period.
+     */
+    Result run(const std::string &name, const Options &options, const std::function<void()> &body) {
+        // Warm up caches, branch predictors and clocks, and size the batches
+        int64_t calls = 0;
+        const auto warmup_start = Clock::now();
+        while (seconds_since(warmup_start) < options.warmup_seconds) {
+            body();
+            calls++;
+        }
+        const double seconds_per_call = options.warmup_seconds / static_cast<double>(std::max<int64_t>(calls, 1));
+        const auto batch_size = std::max<int64_t>(1, static_cast<int64_t>(options.batch_seconds / seconds_per_call));
+
+        // Timed batches
+        std::vector<double> samples;
+        for (int batch = 0; batch < options.batches; batch++) {
+            const auto start = Clock::now();
+            for (int64_t i = 0; i < batch_size; i++)
+                body();
+            samples.push_back(seconds_since(start) * 1e9 / static_cast<double>(batch_size));
+        }
+
+        double mean = 0;
+        for (const auto sample: samples)
+            mean += sample / static_cast<double>(samples.size());
+
+        double variance = 0;
+        for (const auto sample: samples)
+            variance += (sample - mean) * (sample - mean) / static_cast<double>(samples.size());
+
+        return {name, mean, std::sqrt(variance), *std::min_element(samples.begin(), samples.end()),
+                batch_size * options.batches};
+    }
+
+    void print_usage() {
+        std::cerr << "Usage: BlunderBenchmarks [--filter <substring>] [--output <results.json>]\n"
+                "                         [--baseline <results.json>] [--threshold <fraction>]\n"
+                "                         [--batches <n>] [--cpu <index>]" << std::endl;
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    Options options;
+
+    // Parse options
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--filter" && hasValue)
+            options.filter = argv[++i];
+        else if (arg == "--output" && hasValue)
+            options.output = argv[++i];
+        else if (arg == "--baseline" && hasValue)
+            options.baseline = argv[++i];
+        else if (arg == "--threshold" && hasValue)
+            options.threshold = std::stod(argv[++i]);
+        else if (arg == "--batches" && hasValue)
+            options.batches = std::max(2, std::stoi(argv[++i]));
+        else if (arg == "--cpu" && hasValue)
+            options.cpu = std::stoi(argv[++i]);
+        else {
+            print_usage();
+            return 2;
+        }
+    }
+
+    pin_thread(options.cpu);
+
+    // Shared fixtures
+    const Sphere sphere(vec3(0, 0, 0), 1, Color(0.5, 0.5, 0.5));
+    const Ray hit_ray(vec3(0, -5, 0), vec3(0, 1, 0));
+    const Ray miss_ray(vec3(0, -5, 0), vec3(0, -1, 0));
+    HitRecord record{};
+
+    auto camera = make_shared<Camera>(vec3(0, -10, 5), vec3(0));
+    auto small_target = make_shared<RenderTarget>(64, 64);
+    const auto rt_camera_values = Renderer::initializeRTCamera(camera, small_target);
+
+    HitRecord scatter_record{};
+    sphere.RecordHit(hit_ray, 4, scatter_record);
+    Ray scattered = hit_ray;
+
+    // Benchmarks, in the order they are reported
+    std::vector<std::pair<std::string, std::function<void()> > > benchmarks;
+
+    benchmarks.emplace_back("Sphere::Hit/hit", [&] {
+        do_not_optimize(sphere.Hit(hit_ray, 0.001f, 1000000, record));
+    });
+    benchmarks.emplace_back("Sphere::Hit/miss", [&] {
+        do_not_optimize(sphere.Hit(miss_ray, 0.001f, 1000000, record));
+    });
+
+    // Sphere lists of increasing size, spheres spread in a line along the ray so most candidates are tested
+    std::vector<shared_ptr<SphereList> > lists;
+    for (const int size: {1, 16, 256, 4096}) {
+        auto list = make_shared<SphereList>();
+        for (int i = 0; i < size; i++) {
+            const float offset = static_cast<float>(i) * 3.0f;
+            list->Add(make_shared<Sphere>(vec3(random_float(-1, 1), offset, random_float(-1, 1)), 1.0f,
+                                          Color(0.5, 0.5, 0.5)));
+        }
+        lists.push_back(list);
+        benchmarks.emplace_back("SphereList::Hit/" + std::to_string(size), [&, list] {
+            do_not_optimize(list->Hit(hit_ray, 0.001f, 1000000, record));
+        });
+    }
+
+    // The same lists packed as the renderer traces them
+    for (const auto &list: lists) {
+        auto packed = make_shared<PackedSphereList>(*list);
+        benchmarks.emplace_back("PackedSphereList::Hit/" + std::to_string(list->size()), [&, packed] {
+            do_not_optimize(packed->Hit(hit_ray, 0.001f, 1000000, record));
+        });
+    }
+
+    benchmarks.emplace_back("random_float", [] {
+        do_not_optimize(random_float());
+    });
+    benchmarks.emplace_back("random_unit_vector", [] {
+        do_not_optimize(random_unit_vector());
+    });
+    float batch_x[256], batch_y[256], batch_z[256];
+    benchmarks.emplace_back("random_unit_vectors/256", [&] {
+        random_unit_vectors(256, batch_x, batch_y, batch_z);
+        do_not_optimize(batch_x[255]);
+    });
+    benchmarks.emplace_back("sampleSquare", [] {
+        do_not_optimize(sampleSquare());
+    });
+    benchmarks.emplace_back("Renderer::getRayAtPixel", [&] {
+        do_not_optimize(Renderer::getRayAtPixel(31, 17, rt_camera_values));
+    });
+    benchmarks.emplace_back("Renderer::scatter", [&] {
+        do_not_optimize(Renderer::scatter(scatter_record, scattered));
+    });
+    benchmarks.emplace_back("RenderTarget::writeToFile/64x64", [&] {
+        small_target->writeToFile("benchmark_output.ppm");
+    });
+
+    // Run
+    std::vector<Result> results;
+    std::printf("%-36s %12s %12s %12s %14s\n", "benchmark", "mean ns/op", "stddev", "min", "operations");
+    for (const auto &[name, body]: benchmarks) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+            continue;
+
+        const auto result = run(name, options, body);
+        std::printf("%-36s %12.2f %12.2f %12.2f %14lld\n", result.name.c_str(), result.mean, result.stddev,
+                    result.min, static_cast<long long>(result.operations));
+        results.push_back(result);
+    }
+    std::remove("benchmark_output.ppm");
+
+    // Save, one flat JSON object per line
+    if (!options.output.empty()) {
+        std::ofstream file(options.output);
+        file << "{\"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            file << "{\"name\": \"" << results[i].name << "\", \"mean\": " << results[i].mean
+                    << ", \"stddev\": " << results[i].stddev << ", \"min\": " << results[i].min << "}"
+                    << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        file << "]}\n";
+        std::cout << "Wrote " << options.output << std::endl;
+    }
+
+    // Compare against a baseline
+    if (!options.baseline.empty()) {
+        std::map<std::string, double> baseline;
+        try {
+            for (const auto &line: read_lines(options.baseline)) {
+                double mean;
+                const auto name = json_string(line, "name");
+                if (!name.empty() && json_number(line, "mean", mean))
+                    baseline[name] = mean;
+            }
+        } catch (std::exception &e) {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+            return 2;
+        }
+
+        int regressions = 0;
+        std::printf("\n%-36s %12s %12s %10s\n", "benchmark", "baseline", "current", "change");
+        for (const auto &result: results) {
+            if (baseline.count(result.name) == 0)
+                continue;
+
+            const double before = baseline[result.name];
+            const double change = (result.mean - before) / before;
+            const bool regressed = change > options.threshold;
+            regressions += regressed;
+            std::printf("%-36s %12.2f %12.2f %+9.1f%%%s\n", result.name.c_str(), before, result.mean,
+                        100.0 * change, regressed ? "  REGRESSION" : "");
+        }
+
+        if (regressions > 0)
+            return 1;
+    }
+
+    return 0;
+}
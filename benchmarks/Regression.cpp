@@ -0,0 +1,264 @@
+// Image-quality-aware performance regression harness.
+// Renders every reference scene over a ladder of sample counts, compares each image against a stored high-sample
+// reference (RMSE, PSNR, FLIP-style error) and records time-to-quality curves. Given a baseline, it fails when the
+// current build needs more time for the same error, or reaches a larger error in the same time.
+
+#include "BenchmarkUtils.h"
+#include <Renderer/ImageMetrics.h>
+#include <Renderer/Renderer.h>
+#include <Utils/Importer.h>
+#include <algorithm>
+#include <filesystem>
+#include <map>
+
+#ifndef BLUNDER_SOURCE_DIR
+#define BLUNDER_SOURCE_DIR "."
+#endif
+
+using namespace BenchmarkUtils;
+namespace fs = std::filesystem;
+
+namespace {
+    /// One point of a time-to-quality curve.
+    struct QualityPoint {
+        int samples;
+        double seconds;
+        double rmse;
+        double psnr;
+        double flip;
+    };
+
+    /// Harness options.
+    struct Options {
+        std::string scenes = std::string(BLUNDER_SOURCE_DIR) + "/benchmarks/scenes";
+        std::string references = std::string(BLUNDER_SOURCE_DIR) + "/benchmarks/references";
+        std::string output = "regression_results.json";
+        std::string baseline;
+        std::string metric = "rmse";
+        bool update_references = false;
+        int reference_samples = 1024;
+        int max_samples = 64;
+        int repeats = 3;
+        double tolerance = 0.10;
+    };
+
+    void print_usage() {
+        std::cerr << "Usage: BlunderRegression [--scenes <dir>] [--references <dir>] [--update-references]\n"
+                "                         [--reference-samples <n>] [--max-samples <n>] [--repeats <n>]\n"
+                "                         [--output <results.json>] [--baseline <results.json>]\n"
+                "                         [--metric rmse|flip] [--tolerance <fraction>]" << std::endl;
+    }
+
+    /// Renders a scene at a sample count into a fresh render target, returns the render time in seconds.
+    double render(const Scene &scene, const int samples, shared_ptr<RenderTarget> &image) {
+        image = make_shared<RenderTarget>(scene.screen_width, scene.screen_height);
+        const Renderer renderer(samples, scene.bounces);
+
+        QuietStdout quiet;
+        const auto start = Clock::now();
+        renderer.render(scene.spheres, scene.camera, image);
+        return seconds_since(start);
+    }
+
+    /// Gets the gated error of a point.
+    double error_of(const QualityPoint &point, const std::string &metric) {
+        return metric == "flip" ? point.flip : point.rmse;
+    }
+
+    /**
+     * Interpolates y at x along a curve in log-log space.
+     * Returns false when x lies outside the curve, where no fair comparison can be made.
+     */
+    bool interpolate(std::vector<std::pair<double, double> > curve, const double x, double &y) {
+        std::sort(curve.begin(), curve.end());
+        for (size_t i = 0; i + 1 < curve.size(); i++) {
+            const auto [x0, y0] = curve[i];
+            const auto [x1, y1] = curve[i + 1];
+            if (x < x0 || x > x1 || x0 <= 0 || x1 <= 0 || y0 <= 0 || y1 <= 0)
+                continue;
+
+            const double t = x1 > x0 ? (std::log(x) - std::log(x0)) / (std::log(x1) - std::log(x0)) : 0;
+            y = std::exp(std::log(y0) + t * (std::log(y1) - std::log(y0)));
+            return true;
+        }
+        return false;
+    }
+
+    /// Compares a scene's curve against its baseline curve, prints and counts failures.
+    int compare(const std::string &scene, const std::vector<QualityPoint> &current,
+                const std::vector<QualityPoint> &baseline, const Options &options) {
+        // Baseline curves as time -> error and error -> time
+        std::vector<std::pair<double, double> > error_at_time, time_at_error;
+        for (const auto &point: baseline) {
+            error_at_time.emplace_back(point.seconds, error_of(point, options.metric));
+            time_at_error.emplace_back(error_of(point, options.metric), point.seconds);
+        }
+
+        int failures = 0;
+        for (const auto &point: current) {
+            const double error = error_of(point, options.metric);
+            double baseline_time, baseline_error;
+
+            if (interpolate(time_at_error, error, baseline_time) &&
+                point.seconds > baseline_time * (1.0 + options.tolerance)) {
+                std::cout << "FAIL " << scene << " @" << point.samples << " spp: slower at equal error ("
+                        << point.seconds << "s vs " << baseline_time << "s for " << options.metric << " " << error
+                        << ")" << std::endl;
+                failures++;
+            }
+
+            if (interpolate(error_at_time, point.seconds, baseline_error) &&
+                error > baseline_error * (1.0 + options.tolerance)) {
+                std::cout << "FAIL " << scene << " @" << point.samples << " spp: worse at equal time ("
+                        << options.metric << " " << error << " vs " << baseline_error << " at " << point.seconds
+                        << "s)" << std::endl;
+                failures++;
+            }
+        }
+
+        return failures;
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    Options options;
+
+    // Parse options
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--scenes" && hasValue)
+            options.scenes = argv[++i];
+        else if (arg == "--references" && hasValue)
+            options.references = argv[++i];
+        else if (arg == "--update-references")
+            options.update_references = true;
+        else if (arg == "--reference-samples" && hasValue)
+            options.reference_samples = std::stoi(argv[++i]);
+        else if (arg == "--max-samples" && hasValue)
+            options.max_samples = std::stoi(argv[++i]);
+        else if (arg == "--repeats" && hasValue)
+            options.repeats = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--output" && hasValue)
+            options.output = argv[++i];
+        else if (arg == "--baseline" && hasValue)
+            options.baseline = argv[++i];
+        else if (arg == "--metric" && hasValue)
+            options.metric = argv[++i];
+        else if (arg == "--tolerance" && hasValue)
+            options.tolerance = std::stod(argv[++i]);
+        else {
+            print_usage();
+            return 2;
+        }
+    }
+
+    if (options.metric != "rmse" && options.metric != "flip") {
+        print_usage();
+        return 2;
+    }
+
+    try {
+        // Reference scenes, in a stable order
+        std::vector<fs::path> scene_files;
+        for (const auto &entry: fs::directory_iterator(options.scenes))
+            if (entry.path().extension() == ".blunder")
+                scene_files.push_back(entry.path());
+        std::sort(scene_files.begin(), scene_files.end());
+
+        if (scene_files.empty())
+            throw std::runtime_error("no .blunder scenes in " + options.scenes);
+
+        fs::create_directories(options.references);
+        std::map<std::string, std::vector<QualityPoint> > results;
+
+        for (const auto &scene_file: scene_files) {
+            const std::string name = scene_file.stem().string();
+            const Scene scene = Importer::LoadScene(scene_file.string());
+            const std::string reference_file = (fs::path(options.references) / (name + ".pfm")).string();
+
+            // Reference image, rendered once at a high sample count
+            if (options.update_references || !fs::exists(reference_file)) {
+                if (!options.update_references)
+                    throw std::runtime_error("missing reference " + reference_file + ", run with --update-references");
+
+                std::cout << "Rendering reference " << name << " at " << options.reference_samples << " spp..."
+                        << std::endl;
+                shared_ptr<RenderTarget> image;
+                render(scene, options.reference_samples, image);
+                image->writeToPFM(reference_file);
+            }
+            const auto reference = RenderTarget::readFromPFM(reference_file);
+
+            // Time-to-quality ladder
+            std::cout << name << "\n  spp     seconds        rmse    psnr(dB)        flip" << std::endl;
+            for (int samples = 1; samples <= options.max_samples; samples *= 2) {
+                QualityPoint point{samples, infinity, 0, 0, 0};
+
+                for (int repeat = 0; repeat < options.repeats; repeat++) {
+                    shared_ptr<RenderTarget> image;
+                    point.seconds = std::min(point.seconds, render(scene, samples, image));
+                    point.rmse += ImageMetrics::rmse(*image, *reference) / options.repeats;
+                    point.psnr += ImageMetrics::psnr(*image, *reference) / options.repeats;
+                    point.flip += ImageMetrics::flip(*image, *reference) / options.repeats;
+                }
+
+                std::printf("%5d %11.5f %11.6f %11.3f %11.6f\n", point.samples, point.seconds, point.rmse,
+                            point.psnr, point.flip);
+                results[name].push_back(point);
+            }
+        }
+
+        // Results, one flat JSON object per line
+        {
+            std::ofstream file(options.output);
+            file << "{\"metric\": \"" << options.metric << "\", \"points\": [\n";
+            bool first = true;
+            for (const auto &[scene, points]: results) {
+                for (const auto &point: points) {
+                    file << (first ? "" : ",\n") << "{\"scene\": \"" << scene << "\", \"samples\": " << point.samples
+                            << ", \"seconds\": " << point.seconds << ", \"rmse\": " << point.rmse
+                            << ", \"psnr\": " << point.psnr << ", \"flip\": " << point.flip << "}";
+                    first = false;
+                }
+            }
+            file << "\n]}\n";
+            std::cout << "Wrote " << options.output << std::endl;
+        }
+
+        // Efficiency gate against a baseline
+        if (!options.baseline.empty()) {
+            std::map<std::string, std::vector<QualityPoint> > baseline;
+            for (const auto &line: read_lines(options.baseline)) {
+                const std::string scene = json_string(line, "scene");
+                double samples, seconds, rmse, psnr, flip;
+                if (scene.empty() || !json_number(line, "samples", samples) || !json_number(line, "seconds", seconds)
+                    || !json_number(line, "rmse", rmse) || !json_number(line, "psnr", psnr)
+                    || !json_number(line, "flip", flip))
+                    continue;
+                baseline[scene].push_back({static_cast<int>(samples), seconds, rmse, psnr, flip});
+            }
+
+            int failures = 0;
+            for (const auto &[scene, points]: results) {
+                if (baseline.count(scene) == 0) {
+                    std::cout << "SKIP " << scene << ": not in baseline" << std::endl;
+                    continue;
+                }
+                failures += compare(scene, points, baseline[scene], options);
+            }
+
+            if (failures > 0) {
+                std::cout << failures << " efficiency regression(s) against " << options.baseline << std::endl;
+                return 1;
+            }
+            std::cout << "No efficiency regressions against " << options.baseline << std::endl;
+        }
+    } catch (std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 2;
+    }
+
+    return 0;
+}
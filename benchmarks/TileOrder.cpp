@@ -0,0 +1,210 @@
+// Tile traversal order benchmark.
+// Renders one scene with every tile order and tile size, against full-width one-row tiles as a baseline, and reports
+// throughput along with cache miss counts from the kernel's hardware performance counters.
+
+#include "BenchmarkUtils.h"
+#include <Renderer/Renderer.h>
+#include <Utils/Importer.h>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifndef BLUNDER_SOURCE_DIR
+#define BLUNDER_SOURCE_DIR "."
+#endif
+
+using namespace BenchmarkUtils;
+
+namespace {
+    /// Benchmark options.
+    struct Options {
+        std::string scene = std::string(BLUNDER_SOURCE_DIR) + "/benchmarks/scenes/ground_clutter.blunder";
+        int width = 1280;
+        int height = 720;
+        int samples = 4;
+        int repeats = 3;
+        std::vector<std::string> tile_sizes{"auto", "16x16", "32x32", "64x64"};
+    };
+
+    /// Cache events that can be counted.
+    enum class CacheEvent {
+        /// Last level cache references, mostly L2 misses on current CPUs (exact L2 events are model specific).
+        References,
+
+        /// Last level cache misses.
+        Misses
+    };
+
+    /**
+     * Hardware cache counter covering the calling thread and every thread it starts afterwards.
+     * Unavailable counters (no PMU, virtual machines, perf_event_paranoid) read as -1.
+     */
+    class CacheCounter {
+        int fd = -1;
+
+    public:
+        explicit CacheCounter(const CacheEvent event) {
+#ifdef __linux__
+            perf_event_attr attributes{};
+            attributes.size = sizeof(attributes);
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.config = event == CacheEvent::References
+                                    ? PERF_COUNT_HW_CACHE_REFERENCES
+                                    : PERF_COUNT_HW_CACHE_MISSES;
+            attributes.disabled = 1;
+            attributes.inherit = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#else
+            static_cast<void>(event);
+#endif
+        }
+
+        ~CacheCounter() {
+#ifdef __linux__
+            if (fd >= 0)
+                close(fd);
+#endif
+        }
+
+        CacheCounter(const CacheCounter &) = delete;
+
+        CacheCounter &operator=(const CacheCounter &) = delete;
+
+        void start() const {
+#ifdef __linux__
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        [[nodiscard]] int64_t stop() const {
+#ifdef __linux__
+            uint64_t value = 0;
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                if (read(fd, &value, sizeof(value)) == sizeof(value))
+                    return static_cast<int64_t>(value);
+            }
+#endif
+            return -1;
+        }
+    };
+
+    void print_usage() {
+        std::cerr << "Usage: BlunderTileBenchmark [--scene <scene.blunder>] [--size <width>x<height>] [--samples <n>]\n"
+                "                            [--repeats <n>] [--tile-sizes auto,16x16,...]" << std::endl;
+    }
+
+    /// Formats a counter for the table, "n/a" when it could not be read.
+    std::string counter_text(const int64_t value) {
+        return value < 0 ? "n/a" : std::to_string(value);
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    Options options;
+
+    // Parse options
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (arg == "--scene" && hasValue)
+                options.scene = argv[++i];
+            else if (arg == "--size" && hasValue) {
+                RT_TILING size{};
+                Tiling::parseTileSize(argv[++i], size);
+                options.width = size.tile_width;
+                options.height = size.tile_height;
+            } else if (arg == "--samples" && hasValue)
+                options.samples = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--repeats" && hasValue)
+                options.repeats = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--tile-sizes" && hasValue) {
+                options.tile_sizes.clear();
+                std::stringstream list(argv[++i]);
+                std::string size;
+                while (std::getline(list, size, ','))
+                    options.tile_sizes.push_back(size);
+            } else {
+                print_usage();
+                return 2;
+            }
+        }
+    } catch (std::exception &) {
+        print_usage();
+        return 2;
+    }
+
+    try {
+        const Scene scene = Importer::LoadScene(options.scene);
+
+        // Configurations: one-row tiles first, then every order at every tile size
+        std::vector<std::pair<std::string, RT_TILING> > configurations;
+        configurations.emplace_back("rows", RT_TILING{options.width, 1, TileOrder::RowMajor});
+        for (const auto &size: options.tile_sizes) {
+            for (const auto &[name, order]: {
+                     std::pair{"rowmajor", TileOrder::RowMajor}, std::pair{"morton", TileOrder::Morton},
+                     std::pair{"hilbert", TileOrder::Hilbert}
+                 }) {
+                RT_TILING tiling{};
+                tiling.order = order;
+                Tiling::parseTileSize(size, tiling);
+                configurations.emplace_back(std::string(name) + " " + size, tiling);
+            }
+        }
+
+        const CacheCounter llc_references(CacheEvent::References);
+        const CacheCounter llc_misses(CacheEvent::Misses);
+
+        std::cout << options.width << "x" << options.height << " at " << options.samples << " spp, "
+                << std::max(1u, std::thread::hardware_concurrency()) << " threads, best of " << options.repeats
+                << std::endl;
+        std::printf("%-20s %10s %12s %16s %16s\n", "order", "seconds", "Msamples/s", "LLC refs", "LLC misses");
+
+        for (const auto &[name, tiling]: configurations) {
+            Renderer renderer(options.samples, scene.bounces);
+            renderer.set_tiling(tiling);
+
+            double best = infinity;
+            int64_t best_references = -1, best_misses = -1;
+            for (int repeat = 0; repeat < options.repeats; repeat++) {
+                auto image = make_shared<RenderTarget>(options.width, options.height);
+                QuietStdout quiet;
+
+                llc_references.start();
+                llc_misses.start();
+                const auto start = Clock::now();
+                renderer.render(scene.spheres, scene.camera, image);
+                const double seconds = seconds_since(start);
+                const int64_t references = llc_references.stop();
+                const int64_t misses = llc_misses.stop();
+
+                if (seconds < best) {
+                    best = seconds;
+                    best_references = references;
+                    best_misses = misses;
+                }
+            }
+
+            const double samples = static_cast<double>(options.width) * options.height * options.samples;
+            std::printf("%-20s %10.4f %12.3f %16s %16s\n", name.c_str(), best, samples / best / 1e6,
+                        counter_text(best_references).c_str(), counter_text(best_misses).c_str());
+        }
+    } catch (std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 2;
+    }
+
+    return 0;
+}
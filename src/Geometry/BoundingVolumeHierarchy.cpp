@@ -0,0 +1,102 @@
+#include "BoundingVolumeHierarchy.h"
+#include <algorithm>
+#include <numeric>
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(const std::vector<vec3> &minimums, const std::vector<vec3> &maximums,
+                                                 std::vector<uint32_t> &order, const shared_ptr<Arena> &arena)
+    : nodes(ArenaAllocator<RT_BVH_NODE>(arena)) {
+    // Ensure every item has both corners
+    if (minimums.size() != maximums.size())
+        throw BoundingVolumeHierarchyException(
+            "BoundingVolumeHierarchy::BoundingVolumeHierarchy(): minimums and maximums must be the same size");
+
+    // Ensure the items can be indexed
+    if (minimums.size() > std::numeric_limits<uint32_t>::max())
+        throw BoundingVolumeHierarchyException(
+            "BoundingVolumeHierarchy::BoundingVolumeHierarchy(): too many items");
+
+    order.resize(minimums.size());
+    std::iota(order.begin(), order.end(), 0u);
+    if (order.empty())
+        return;
+
+    // Reserved exactly, so the nodes are allocated once
+    nodes.reserve(NodeCount(order.size()));
+    nodes.push_back({});
+    split(0, 0, static_cast<uint32_t>(order.size()), minimums, maximums, order);
+}
+
+size_t BoundingVolumeHierarchy::NodeCount(const size_t items) {
+    if (items == 0)
+        return 0;
+    if (items <= LEAF_SIZE)
+        return 1;
+    return 1 + NodeCount(items / 2) + NodeCount(items - items / 2);
+}
+
+void BoundingVolumeHierarchy::split(const uint32_t node, const uint32_t first, const uint32_t count,
+                                    const std::vector<vec3> &minimums, const std::vector<vec3> &maximums,
+                                    std::vector<uint32_t> &order) {
+    // Boxes around the items and around their centers
+    vec3 minimum(infinity), maximum(-infinity), low(infinity), high(-infinity);
+    for (uint32_t i = first; i < first + count; i++) {
+        minimum = min(minimum, minimums[order[i]]);
+        maximum = max(maximum, maximums[order[i]]);
+        const vec3 center = 0.5f * (minimums[order[i]] + maximums[order[i]]);
+        low = min(low, center);
+        high = max(high, center);
+    }
+    nodes[node].minimum = minimum;
+    nodes[node].maximum = maximum;
+
+    if (count <= LEAF_SIZE) {
+        nodes[node].first = first;
+        nodes[node].count = count;
+        return;
+    }
+
+    // Half of the items on each side of the median center along the widest axis
+    const vec3 extent = high - low;
+    const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+    const uint32_t half = count / 2;
+    std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+                     [&](const uint32_t a, const uint32_t b) {
+                         return minimums[a][axis] + maximums[a][axis] < minimums[b][axis] + maximums[b][axis];
+                     });
+
+    // Children sit next to each other, so the node only keeps the first
+    const auto child = static_cast<uint32_t>(nodes.size());
+    nodes[node].first = child;
+    nodes[node].count = 0;
+    nodes.push_back({});
+    nodes.push_back({});
+    split(child, first, half, minimums, maximums, order);
+    split(child + 1, first + half, count - half, minimums, maximums, order);
+}
+
+void BoundingVolumeHierarchy::Refit(const std::vector<vec3> &minimums, const std::vector<vec3> &maximums) {
+    // Ensure there is a box for every item the leaves refer to
+    size_t items = 0;
+    for (const auto &node: nodes)
+        if (node.count > 0)
+            items = std::max(items, static_cast<size_t>(node.first) + node.count);
+    if (minimums.size() != maximums.size() || minimums.size() != items)
+        throw BoundingVolumeHierarchyException(
+            "BoundingVolumeHierarchy::Refit(): minimums and maximums must have one box per item");
+
+    // Children always come after their parent, so going backwards finishes both children before their parent
+    for (size_t n = nodes.size(); n-- > 0;) {
+        RT_BVH_NODE &node = nodes[n];
+        if (node.count > 0) {
+            node.minimum = vec3(infinity);
+            node.maximum = vec3(-infinity);
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                node.minimum = min(node.minimum, minimums[i]);
+                node.maximum = max(node.maximum, maximums[i]);
+            }
+        } else {
+            node.minimum = min(nodes[node.first].minimum, nodes[node.first + 1].minimum);
+            node.maximum = max(nodes[node.first].maximum, nodes[node.first + 1].maximum);
+        }
+    }
+}
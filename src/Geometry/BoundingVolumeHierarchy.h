@@ -0,0 +1,197 @@
+#ifndef BOUNDINGVOLUMEHIERARCHY_H
+#define BOUNDINGVOLUMEHIERARCHY_H
+#include <Utils/Headers.h>
+#include <Utils/Arena.h>
+#include <vector>
+
+/**
+ * Node of a bounding volume hierarchy, 32 bytes.
+ */
+struct RT_BVH_NODE {
+    /// Lowest corner of the box around everything below the node.
+    vec3 minimum;
+
+    /// First child of an inner node, the second one right after it. First item of a leaf.
+    uint32_t first;
+
+    /// Highest corner of the box around everything below the node.
+    vec3 maximum;
+
+    /// Number of items of a leaf, 0 for an inner node.
+    uint32_t count;
+};
+
+/**
+ * Work done by traversals, counted when a caller asks for it.
+ */
+struct RT_BVH_COUNTS {
+    /// Nodes visited, inner nodes and leaves.
+    uint32_t nodes = 0;
+
+    /// Primitives intersected in the leaves reached.
+    uint32_t tests = 0;
+};
+
+/**
+ * Binary tree of axis-aligned boxes over a set of items, so a ray only visits the items whose boxes it crosses.
+ * Items are split at the median of their centers along the widest axis until a leaf holds at most LEAF_SIZE of them.
+ * Leaves refer to consecutive items of the order the hierarchy was built with, so the owner stores its items in that
+ * order. Traversal is read-only and safe from any number of threads.
+ */
+class BoundingVolumeHierarchy final {
+    /// Nodes, the root first.
+    ArenaVector<RT_BVH_NODE> nodes{};
+
+    /// Splits the items order[first, first + count) below node.
+    void split(uint32_t node, uint32_t first, uint32_t count, const std::vector<vec3> &minimums,
+               const std::vector<vec3> &maximums, std::vector<uint32_t> &order);
+
+public:
+    /// Most items a leaf holds.
+    static constexpr uint32_t LEAF_SIZE = 4;
+
+    /// Deepest tree traversal supports, far deeper than the median split makes for 2^32 items.
+    static constexpr int MAX_DEPTH = 64;
+
+    // Constructors
+    /**
+     * Creates an empty hierarchy, which no ray crosses.
+     */
+    BoundingVolumeHierarchy() = default;
+
+    /**
+     * Builds a hierarchy over the boxes of some items.
+     * @param minimums Lowest corner of every item's box.
+     * @param maximums Highest corner of every item's box.
+     * @param order Set to the item indices in leaf order, the order the owner should store the items in.
+     * @param arena Arena holding the nodes, the heap when nullptr.
+     *
+     * @note Test Cases:\n
+     * BoundingVolumeHierarchy(minimums, maximums, order) -> root box around every box, order a permutation\n
+     * BoundingVolumeHierarchy({}, {}, order) -> empty, order empty\n
+     * BoundingVolumeHierarchy(2 minimums, 1 maximum, order) -> ERROR: will throw a BoundingVolumeHierarchyException\n
+     */
+    BoundingVolumeHierarchy(const std::vector<vec3> &minimums, const std::vector<vec3> &maximums,
+                            std::vector<uint32_t> &order, const shared_ptr<Arena> &arena = nullptr);
+
+    /**
+     * Counts the nodes of a hierarchy over some items, the median split makes it depend on nothing else.
+     * @param items Number of items.
+     * @return Number of nodes the hierarchy has.
+     *
+     * @note Test Cases:\n
+     * NodeCount(0) -> 0\n
+     * NodeCount(n) -> BoundingVolumeHierarchy(n boxes, ...).size()\n
+     */
+    static size_t NodeCount(size_t items);
+
+    // Methods
+    /**
+     * Recomputes every box around items that moved or changed size, keeping the tree as built. Much cheaper than a
+     * rebuild, though rays visit more nodes the further items move from where the tree grouped them.
+     * @param minimums Lowest corner of every item's box, in leaf order.
+     * @param maximums Highest corner of every item's box, in leaf order.
+     *
+     * @note Test Cases:\n
+     * bvh.Refit(moved minimums, moved maximums) -> root box around every moved box, same size()\n
+     * bvh.Refit(fewer minimums than items, ...) -> ERROR: will throw a BoundingVolumeHierarchyException\n
+     */
+    void Refit(const std::vector<vec3> &minimums, const std::vector<vec3> &maximums);
+
+    /**
+     * Visits the leaves a ray crosses between tStart and tEnd, nearest child first.
+     * @param origin Origin of the ray.
+     * @param inverse_direction Reciprocal of each component of the ray's direction.
+     * @param tStart Minimum t value to visit.
+     * @param tEnd Maximum t value to visit, lowered by leaf as it finds closer hits.
+     * @param leaf Called as leaf(first, count, tEnd) with a leaf's range of items, returns whether it hit anything.
+     * @param any Stop at the first leaf that hits anything, for occlusion queries.
+     * @param counts Nodes visited are added to it when it is not nullptr, leaf counts its own tests.
+     * @return Whether any leaf hit anything.
+     *
+     * @note Test Cases:\n
+     * bvh.Traverse(ray through one box, ...) -> leaf called for the leaf holding it\n
+     * bvh.Traverse(ray missing every box, ...) -> false, leaf never called\n
+     */
+    template<class Leaf>
+    bool Traverse(const vec3 &origin, const vec3 &inverse_direction, const float tStart, float tEnd, Leaf &&leaf,
+                  const bool any = false, RT_BVH_COUNTS *counts = nullptr) const {
+        float entry;
+        if (nodes.empty() || !Enter(nodes[0], origin, inverse_direction, tStart, tEnd, entry))
+            return false;
+
+        bool hit = false;
+        uint32_t stack[MAX_DEPTH];
+        int top = 0;
+        uint32_t node = 0;
+        for (;;) {
+            const RT_BVH_NODE &current = nodes[node];
+            if (counts != nullptr)
+                counts->nodes++;
+            if (current.count > 0) {
+                if (leaf(current.first, current.count, tEnd)) {
+                    hit = true;
+                    if (any)
+                        return true;
+                }
+            } else {
+                // Nearer child first, the other one waits on the stack
+                float first_entry, second_entry;
+                const bool first = Enter(nodes[current.first], origin, inverse_direction, tStart, tEnd, first_entry);
+                const bool second = Enter(nodes[current.first + 1], origin, inverse_direction, tStart, tEnd,
+                                          second_entry);
+                if (first && second) {
+                    const bool swapped = second_entry < first_entry;
+                    stack[top++] = current.first + (swapped ? 0 : 1);
+                    node = current.first + (swapped ? 1 : 0);
+                    continue;
+                }
+                if (first || second) {
+                    node = current.first + (first ? 0 : 1);
+                    continue;
+                }
+            }
+
+            // Boxes popped after a closer hit was found may no longer be worth entering
+            do {
+                if (top == 0)
+                    return hit;
+                node = stack[--top];
+            } while (!Enter(nodes[node], origin, inverse_direction, tStart, tEnd, entry));
+        }
+    }
+
+    /**
+     * Gets whether a ray crosses a node's box between tStart and tEnd.
+     * @param node Node whose box is tested.
+     * @param origin Origin of the ray.
+     * @param inverse_direction Reciprocal of each component of the ray's direction.
+     * @param tStart Minimum t value.
+     * @param tEnd Maximum t value.
+     * @param entry Set to the t value the ray enters the box at, or tStart when it starts inside.
+     * @return Whether the ray crosses the box.
+     */
+    static bool Enter(const RT_BVH_NODE &node, const vec3 &origin, const vec3 &inverse_direction, const float tStart,
+                      const float tEnd, float &entry) {
+        const vec3 t0 = (node.minimum - origin) * inverse_direction;
+        const vec3 t1 = (node.maximum - origin) * inverse_direction;
+        const vec3 lower = min(t0, t1);
+        const vec3 upper = max(t0, t1);
+        entry = std::max(std::max(lower.x, lower.y), std::max(lower.z, tStart));
+        const float exit = std::min(std::min(upper.x, upper.y), std::min(upper.z, tEnd));
+        return entry <= exit;
+    }
+
+    // Getters
+    /// Gets the number of nodes.
+    [[nodiscard]] size_t size() const {
+        return nodes.size();
+    }
+
+    /// Gets a node, the root at index 0.
+    [[nodiscard]] const RT_BVH_NODE &get_node(const size_t index) const {
+        return nodes[index];
+    }
+};
+
+#endif //BOUNDINGVOLUMEHIERARCHY_H
@@ -0,0 +1,158 @@
+#include "InstancedSphereList.h"
+
+uint32_t InstancedSphereList::AddGroup(const shared_ptr<const SphereGroup> &group) {
+    // Ensure the group is initialized
+    if (group == nullptr)
+        throw InstancedSphereListException("InstancedSphereList::AddGroup(): group cannot be nullptr");
+
+    // Ensure there is something to instance, an empty group has no box
+    if (group->size() == 0)
+        throw InstancedSphereListException("InstancedSphereList::AddGroup(): group must hold a sphere");
+
+    groups.push_back(group);
+    return static_cast<uint32_t>(groups.size() - 1);
+}
+
+void InstancedSphereList::AddInstance(const uint32_t group, const mat3 &linear, const vec3 &translation) {
+    // Ensure the group exists
+    if (group >= groups.size())
+        throw InstancedSphereListException("InstancedSphereList::AddInstance(): group index out of range");
+
+    // Ensure the transform is finite
+    if (!is_finite(linear[0]) || !is_finite(linear[1]) || !is_finite(linear[2]) || !is_finite(translation))
+        throw InstancedSphereListException("InstancedSphereList::AddInstance(): transform must be finite");
+
+    // Ensure rays can be moved into the group's space
+    const float scale = length(linear[0]) * length(linear[1]) * length(linear[2]);
+    if (!(std::fabs(determinant(linear)) > 1e-6f * scale))
+        throw InstancedSphereListException("InstancedSphereList::AddInstance(): linear must be invertible");
+
+    const mat3 to_group = inverse(linear);
+    instances.push_back({to_group, -(to_group * translation), group});
+    dirty = true;
+}
+
+void InstancedSphereList::Build() {
+    // Box of each instance: the group's box carried into the scene, its half extent through |linear|
+    std::vector<vec3> minimums(instances.size()), maximums(instances.size());
+    for (size_t i = 0; i < instances.size(); i++) {
+        const RT_INSTANCE &instance = instances[i];
+        const SphereGroup &group = *groups[instance.group];
+        const mat3 linear = inverse(instance.to_group);
+        const mat3 magnitude(abs(linear[0]), abs(linear[1]), abs(linear[2]));
+        const vec3 center = linear * (0.5f * (group.get_minimum() + group.get_maximum()) - instance.offset);
+        const vec3 half = magnitude * (0.5f * (group.get_maximum() - group.get_minimum()));
+        minimums[i] = center - half;
+        maximums[i] = center + half;
+    }
+
+    std::vector<uint32_t> order;
+    hierarchy = BoundingVolumeHierarchy(minimums, maximums, order);
+    std::vector<RT_INSTANCE> ordered;
+    ordered.reserve(instances.size());
+    for (const auto index: order)
+        ordered.push_back(instances[index]);
+    instances = std::move(ordered);
+    dirty = false;
+}
+
+void InstancedSphereList::validateTrace(const float tStart, const float tEnd, const std::string &method) const {
+    // Ensure the hierarchy covers every instance
+    if (dirty)
+        throw InstancedSphereListException("InstancedSphereList::" + method + "(): call Build() after adding instances");
+
+    // Ensure tStart and tEnd are finite
+    if (!is_finite(tStart) || !is_finite(tEnd))
+        throw InstancedSphereListException("InstancedSphereList::" + method + "(): tStart and tEnd should be finite");
+
+    // Ensure tStart is lesser than tEnd
+    if (tStart >= tEnd)
+        throw InstancedSphereListException("InstancedSphereList::" + method + "(): tStart should be lesser than tEnd");
+
+    // Ensure tStart, tEnd greater than zero
+    if (tStart < 0)
+        throw InstancedSphereListException(
+            "InstancedSphereList::" + method + "(): tStart (and possible tEnd) should not be negative");
+}
+
+bool InstancedSphereList::Hit(const Ray &ray, const float tStart, const float tEnd, HitRecord &hitRecord,
+                              RT_BVH_COUNTS *counts) const {
+    return Hit(ray.get_position(), ray.get_direction(), tStart, tEnd, hitRecord, counts);
+}
+
+bool InstancedSphereList::Hit(const vec3 &origin, const vec3 &direction, const float tStart, const float tEnd,
+                              HitRecord &hitRecord, RT_BVH_COUNTS *counts) const {
+    validateTrace(tStart, tEnd, "Hit");
+
+    // The ray keeps its t in every group's space, only its origin and direction are transformed
+    float t = tEnd;
+    vec3 normal;
+    uint32_t instance_hit = 0, sphere_hit = 0;
+
+    const bool hit = hierarchy.Traverse(origin, 1.0f / direction, tStart, tEnd,
+                                        [&](const uint32_t first, const uint32_t count, float &closest_so_far) {
+                                            bool found = false;
+                                            for (uint32_t i = first; i < first + count; i++) {
+                                                const RT_INSTANCE &instance = instances[i];
+                                                const vec3 group_origin = instance.to_group * origin + instance.offset;
+                                                const vec3 group_direction = instance.to_group * direction;
+                                                float group_t;
+                                                vec3 group_normal;
+                                                uint32_t sphere;
+                                                if (groups[instance.group]->Intersect(
+                                                    group_origin, group_direction, tStart, closest_so_far, group_t,
+                                                    group_normal, sphere, counts)) {
+                                                    closest_so_far = t = group_t;
+                                                    normal = group_normal;
+                                                    instance_hit = i;
+                                                    sphere_hit = sphere;
+                                                    found = true;
+                                                }
+                                            }
+                                            return found;
+                                        }, false, counts);
+    if (!hit)
+        return false;
+
+    // Normals go back through the inverse transpose of the instance's linear part, which is to_group transposed
+    const RT_INSTANCE &instance = instances[instance_hit];
+    hitRecord.set_t(t);
+    hitRecord.set_point(origin + t * direction);
+    hitRecord.set_normal(normalize(transpose(instance.to_group) * normal));
+    hitRecord.set_color(groups[instance.group]->get_spheres().get_color(sphere_hit));
+    return true;
+}
+
+bool InstancedSphereList::Occluded(const Ray &ray, const float tStart, const float tEnd) const {
+    validateTrace(tStart, tEnd, "Occluded");
+
+    const vec3 origin = ray.get_position();
+    const vec3 direction = ray.get_direction();
+    return hierarchy.Traverse(origin, 1.0f / direction, tStart, tEnd,
+                              [&](const uint32_t first, const uint32_t count, float &) {
+                                  for (uint32_t i = first; i < first + count; i++) {
+                                      const RT_INSTANCE &instance = instances[i];
+                                      if (groups[instance.group]->Blocks(instance.to_group * origin + instance.offset,
+                                                                         instance.to_group * direction, tStart, tEnd))
+                                          return true;
+                                  }
+                                  return false;
+                              }, true);
+}
+
+uint64_t InstancedSphereList::get_sphere_count() const {
+    uint64_t count = 0;
+    for (const auto &instance: instances)
+        count += groups[instance.group]->size();
+    return count;
+}
+
+size_t InstancedSphereList::get_memory_bytes() const {
+    // Groups are counted once, however many instances place them
+    size_t bytes = sizeof(*this) + instances.capacity() * sizeof(RT_INSTANCE) + hierarchy.size() * sizeof(RT_BVH_NODE);
+    for (const auto &group: groups)
+        bytes += sizeof(SphereGroup) + group->size() * (sizeof(vec4) + sizeof(uint16_t)) +
+                group->get_hierarchy().size() * sizeof(RT_BVH_NODE) +
+                group->get_spheres().get_palette().size() * sizeof(Color);
+    return bytes;
+}
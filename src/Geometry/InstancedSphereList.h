@@ -0,0 +1,162 @@
+#ifndef INSTANCEDSPHERELIST_H
+#define INSTANCEDSPHERELIST_H
+#include <Utils/Headers.h>
+#include <Geometry/SphereGroup.h>
+
+/**
+ * Copy of a SphereGroup placed in the scene, stored as the transform from the scene into the group's own space.
+ * 52 bytes, whatever the size of the group.
+ */
+struct RT_INSTANCE {
+    /// Linear part of the transform into the group's space, the inverse of the instance's.
+    mat3 to_group;
+
+    /// Translation of the transform into the group's space.
+    vec3 offset;
+
+    /// Group placed, an index into the list's groups.
+    uint32_t group;
+};
+
+/**
+ * Two-level scene of many affine-transformed copies (instances) of a few sphere groups.
+ * Each group keeps one copy of its spheres under its own bounding volume hierarchy, and a top-level hierarchy over the
+ * instances' boxes finds the instances a ray crosses. The ray is then moved into each one's group space and traced
+ * through the group. Memory grows with the spheres of the groups plus about 70 bytes per instance, so millions of
+ * instances of thousand-sphere groups stand for billions of spheres. Scaling an instance unevenly makes its spheres
+ * ellipsoids.
+ * Add the groups and instances, then Build() the top level before tracing. Tracing is read-only, and safe from any
+ * number of threads.
+ */
+class InstancedSphereList final {
+    /// Groups the instances place.
+    std::vector<shared_ptr<const SphereGroup> > groups{};
+
+    /// Every instance, in the top-level hierarchy's leaf order once built.
+    std::vector<RT_INSTANCE> instances{};
+
+    /// Hierarchy over the instances' boxes.
+    BoundingVolumeHierarchy hierarchy{};
+
+    /// Whether instances were added since the last Build().
+    bool dirty = false;
+
+    /// Ensures the list can be traced, naming the calling method in the error.
+    void validateTrace(float tStart, float tEnd, const std::string &method) const;
+
+public:
+    // Constructors
+    /**
+     * Creates an empty list.
+     */
+    InstancedSphereList() = default;
+
+    // Methods
+    /**
+     * Adds a group for instances to place.
+     * @param group Group to add, shared with anything else using it.
+     * @return Index of the group, for AddInstance().
+     *
+     * @note Test Cases:\n
+     * list.AddGroup(group) -> 0, then 1 for the next group\n
+     * list.AddGroup(nullptr) -> ERROR: will throw an InstancedSphereListException (group cannot be nullptr)\n
+     * list.AddGroup(empty group) -> ERROR: will throw an InstancedSphereListException (group must hold a sphere)\n
+     */
+    uint32_t AddGroup(const shared_ptr<const SphereGroup> &group);
+
+    /**
+     * Places a copy of a group, mapping each point p of the group to linear * p + translation.
+     * @param group Index returned by AddGroup().
+     * @param linear Rotation, scale and shear of the copy, invertible.
+     * @param translation Position of the group's origin in the scene.
+     *
+     * @note Test Cases:\n
+     * list.AddInstance(0, mat3(1), vec3(5, 0, 0)) -> size() grows by one, the group is hit 5 units along x\n
+     * list.AddInstance(1, mat3(1), vec3(0)) with one group -> ERROR: will throw an InstancedSphereListException (group out of range)\n
+     * list.AddInstance(0, mat3(0), vec3(0)) -> ERROR: will throw an InstancedSphereListException (linear must be invertible)\n
+     */
+    void AddInstance(uint32_t group, const mat3 &linear, const vec3 &translation);
+
+    /**
+     * Builds the top-level hierarchy over every instance, reordering them. Call it after adding instances, before
+     * tracing. Not thread-safe, nothing may trace meanwhile.
+     *
+     * @note Test Cases:\n
+     * list.Build() -> is_built(), Hit() finds every instance\n
+     */
+    void Build();
+
+    /**
+     * Finds the closest intersection of a ray with the spheres of every instance, like SphereList::Hit().
+     * The normal is the group's normal carried into the scene, normalized.
+     * @param ray Ray that could possibly be intersecting the spheres.
+     * @param tStart Minimum t value to begin checking.
+     * @param tEnd Maximum t value to finish checking.
+     * @param hitRecord Hit information if the ray intersects a sphere.
+     * @param counts Nodes visited, in the instance hierarchy and in the groups entered, and spheres tested are added to
+     * it when it is not nullptr.
+     * @return True if the ray intersects a sphere and logs the closest intersection in hitRecord, false otherwise.
+     *
+     * @note Test Cases:\n
+     * list.Hit(ray, 0.001, 1000, record) -> same hit as a SphereList holding every copy\n
+     * list.Hit(ray, 0.001, 1000, record) after AddInstance() without Build() -> ERROR: will throw an InstancedSphereListException\n
+     */
+    bool Hit(const Ray &ray, float tStart, float tEnd, HitRecord &hitRecord, RT_BVH_COUNTS *counts = nullptr) const;
+
+    /**
+     * Finds the closest intersection of a ray given by its vectors, like Hit(), without making a Ray of them.
+     * @param origin Origin of the ray, finite.
+     * @param direction Direction of the ray, finite and non-zero.
+     * @param tStart Minimum t value to begin checking.
+     * @param tEnd Maximum t value to finish checking.
+     * @param hitRecord Hit information if the ray intersects a sphere.
+     * @param counts Added to like Hit() when it is not nullptr.
+     * @return True if the ray intersects a sphere and logs the closest intersection in hitRecord, false otherwise.
+     *
+     * @note Test Cases:\n
+     * list.Hit(origin, direction, 0.001, 1000, record) -> same hit as list.Hit(Ray(origin, direction), 0.001, 1000, record)\n
+     */
+    bool Hit(const vec3 &origin, const vec3 &direction, float tStart, float tEnd, HitRecord &hitRecord,
+             RT_BVH_COUNTS *counts = nullptr) const;
+
+    /**
+     * Determines whether any instance blocks the ray between tStart and tEnd, like SphereList::Occluded().
+     * @param ray Ray to test for occlusion.
+     * @param tStart Minimum t value to begin checking.
+     * @param tEnd Maximum t value to finish checking.
+     * @return True if any sphere intersects the ray inside [tStart, tEnd]. False if the ray is unobstructed.
+     *
+     * @note Test Cases:\n
+     * Same as SphereList::Occluded(), with InstancedSphereListException instead of SphereListException.\n
+     */
+    [[nodiscard]] bool Occluded(const Ray &ray, float tStart, float tEnd) const;
+
+    // Getters
+    /// Gets the number of instances.
+    [[nodiscard]] size_t size() const {
+        return instances.size();
+    }
+
+    /// Gets the number of groups.
+    [[nodiscard]] size_t get_group_count() const {
+        return groups.size();
+    }
+
+    /// Gets an instance, in the top-level hierarchy's leaf order once built.
+    [[nodiscard]] const RT_INSTANCE &get_instance(const size_t index) const {
+        return instances[index];
+    }
+
+    /// Gets the number of spheres the instances stand for, every copy counted.
+    [[nodiscard]] uint64_t get_sphere_count() const;
+
+    /// Gets the bytes held by the groups, instances and hierarchies, about the list's whole memory.
+    [[nodiscard]] size_t get_memory_bytes() const;
+
+    /// Gets whether the top-level hierarchy covers every instance.
+    [[nodiscard]] bool is_built() const {
+        return !dirty;
+    }
+};
+
+#endif //INSTANCEDSPHERELIST_H
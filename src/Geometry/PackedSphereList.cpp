@@ -0,0 +1,189 @@
+#include "PackedSphereList.h"
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+namespace {
+    /// Same arithmetic as Sphere::Intersect(), with |direction|^2 computed once per ray.
+    inline bool Intersect(const vec4 &sphere, const vec3 &origin, const vec3 &direction, const float a,
+                          const float tStart, const float tEnd, float &t) {
+        const vec3 oc = origin - vec3(sphere.x, sphere.y, sphere.z);
+        const auto h = dot(direction, oc);
+        const auto c = length2(oc) - sphere.w * sphere.w;
+
+        const auto discriminant = h * h - a * c;
+        if (discriminant < 0)
+            return false;
+
+        const auto sqrtd = std::sqrt(discriminant);
+
+        auto root = (-h - sqrtd) / a;
+        if (root < tStart || root > tEnd) {
+            root = (-h + sqrtd) / a;
+            if (root < tStart || root > tEnd)
+                return false;
+        }
+
+        t = root;
+        return true;
+    }
+
+    /// Ensures a [tStart, tEnd] interval is usable, naming the calling method in the error.
+    void ValidateInterval(const float tStart, const float tEnd, const std::string &method) {
+        // Ensure tStart is finite
+        if (!is_finite(tStart))
+            throw PackedSphereListException("PackedSphereList::" + method + "(): tStart should be finite");
+
+        // Ensure tEnd is finite
+        if (!is_finite(tEnd))
+            throw PackedSphereListException("PackedSphereList::" + method + "(): tEnd should be finite");
+
+        // Ensure tStart is lesser than tEnd
+        if (tStart >= tEnd)
+            throw PackedSphereListException("PackedSphereList::" + method + "(): tStart should be lesser than tEnd");
+
+        // Ensure tStart, tEnd greater than zero
+        if (tStart < 0)
+            throw PackedSphereListException(
+                "PackedSphereList::" + method + "(): tStart (and possible tEnd) should not be negative");
+    }
+}
+
+PackedSphereList::PackedSphereList(const SphereList &spheres) {
+    const auto &list = spheres.get_spheres();
+    this->spheres.reserve(list.size());
+    color_indices.reserve(list.size());
+
+    // Colors are looked up by value, neighbouring spheres often share one so the last match is tried first
+    auto colors = std::vector<Color>();
+    std::map<std::tuple<float, float, float>, uint16_t> lookup;
+    vec3 last_color{-1};
+    uint16_t last_index = 0;
+
+    for (const auto &sphere: list) {
+        // Ensure every sphere is initialized
+        if (sphere == nullptr)
+            throw PackedSphereListException(
+                "PackedSphereList::PackedSphereList(): sphere is nullptr, did you forget to initialize a sphere?");
+
+        const vec3 position = sphere->get_position();
+        this->spheres.emplace_back(position, sphere->get_radius());
+
+        const vec3 color = sphere->get_color().get_color();
+        if (color != last_color) {
+            const auto key = std::make_tuple(color.x, color.y, color.z);
+            auto found = lookup.find(key);
+            if (found == lookup.end()) {
+                // Ensure the index still fits in 16 bits
+                if (colors.size() == MAX_COLORS)
+                    throw PackedSphereListException(
+                        "PackedSphereList::PackedSphereList(): more than 65536 distinct sphere colors");
+
+                found = lookup.emplace(key, static_cast<uint16_t>(colors.size())).first;
+                colors.push_back(sphere->get_color());
+            }
+            last_color = color;
+            last_index = found->second;
+        }
+        color_indices.push_back(last_index);
+    }
+
+    palette = make_shared<const std::vector<Color> >(std::move(colors));
+}
+
+PackedSphereList PackedSphereList::Select(const std::vector<uint32_t> &indices,
+                                          const shared_ptr<Arena> &arena) const {
+    PackedSphereList selected;
+    selected.spheres = ArenaVector<vec4>(ArenaAllocator<vec4>(arena));
+    selected.color_indices = ArenaVector<uint16_t>(ArenaAllocator<uint16_t>(arena));
+    selected.palette = palette;
+    selected.spheres.reserve(indices.size());
+    selected.color_indices.reserve(indices.size());
+
+    for (const auto index: indices) {
+        // Ensure index is in range
+        if (index >= spheres.size())
+            throw PackedSphereListException("PackedSphereList::Select(): index out of range");
+
+        selected.spheres.push_back(spheres[index]);
+        selected.color_indices.push_back(color_indices[index]);
+    }
+
+    return selected;
+}
+
+void PackedSphereList::Update(const size_t index, const Sphere &sphere) {
+    // Ensure index is in range
+    if (index >= spheres.size())
+        throw PackedSphereListException("PackedSphereList::Update(): index out of range");
+
+    spheres[index] = vec4(sphere.get_position(), sphere.get_radius());
+
+    const vec3 color = sphere.get_color().get_color();
+    if ((*palette)[color_indices[index]].get_color() == color)
+        return;
+
+    const auto found = std::find_if(palette->begin(), palette->end(), [&](const Color &entry) {
+        return entry.get_color() == color;
+    });
+    if (found != palette->end()) {
+        color_indices[index] = static_cast<uint16_t>(found - palette->begin());
+        return;
+    }
+
+    // Ensure the index still fits in 16 bits
+    if (palette->size() == MAX_COLORS)
+        throw PackedSphereListException("PackedSphereList::Update(): more than 65536 distinct sphere colors");
+
+    auto colors = make_shared<std::vector<Color> >(*palette);
+    colors->push_back(sphere.get_color());
+    color_indices[index] = static_cast<uint16_t>(colors->size() - 1);
+    palette = std::move(colors);
+}
+
+bool PackedSphereList::Hit(const Ray &ray, const float tStart, const float tEnd, HitRecord &hitRecord) const {
+    ValidateInterval(tStart, tEnd, "Hit");
+
+    // Only the closest t and its sphere are tracked, the hit is recorded once for the winner like SphereList::Hit()
+    const vec3 origin = ray.get_position();
+    const vec3 direction = ray.get_direction();
+    const float a = length2(direction);
+
+    size_t closest = spheres.size();
+    auto closestSoFar = tEnd;
+    float t;
+
+    for (size_t i = 0; i < spheres.size(); i++) {
+        if (Intersect(spheres[i], origin, direction, a, tStart, closestSoFar, t)) {
+            closestSoFar = t;
+            closest = i;
+        }
+    }
+
+    if (closest == spheres.size())
+        return false;
+
+    // Same as Sphere::RecordHit()
+    const vec4 &sphere = spheres[closest];
+    hitRecord.set_t(closestSoFar);
+    hitRecord.set_point(ray.at(closestSoFar));
+    hitRecord.set_normal((hitRecord.get_point() - vec3(sphere.x, sphere.y, sphere.z)) / sphere.w);
+    hitRecord.set_color((*palette)[color_indices[closest]]);
+
+    return true;
+}
+
+bool PackedSphereList::Occluded(const Ray &ray, const float tStart, const float tEnd) const {
+    ValidateInterval(tStart, tEnd, "Occluded");
+
+    const vec3 origin = ray.get_position();
+    const vec3 direction = ray.get_direction();
+    const float a = length2(direction);
+    float t;
+
+    for (const auto &sphere: spheres)
+        if (Intersect(sphere, origin, direction, a, tStart, tEnd, t))
+            return true;
+
+    return false;
+}
@@ -0,0 +1,119 @@
+#ifndef PACKEDSPHERELIST_H
+#define PACKEDSPHERELIST_H
+#include <Utils/Headers.h>
+#include <Geometry/SphereList.h>
+#include <Utils/Arena.h>
+#include <vector>
+
+/**
+ * Compact copy of a SphereList, used by the renderer while tracing.
+ * Each sphere's center and radius share one vec4 (16 bytes), stored contiguously so traversal streams through them,
+ * and its color is a 16-bit index into a palette shared with every list selected from it. Scenes use few colors, so
+ * this holds a sphere in 18 bytes instead of a heap allocated Sphere behind a shared_ptr.
+ */
+class PackedSphereList final {
+    /// Center (x, y, z) and radius (w) of every sphere.
+    ArenaVector<vec4> spheres{};
+
+    /// Palette index of every sphere's color.
+    ArenaVector<uint16_t> color_indices{};
+
+    /// Distinct colors of the spheres.
+    shared_ptr<const std::vector<Color> > palette = make_shared<const std::vector<Color> >();
+
+public:
+    /// Largest number of distinct colors a list can hold.
+    static constexpr size_t MAX_COLORS = 65536;
+
+    // Constructors
+    /**
+     * Creates an empty PackedSphereList.
+     */
+    PackedSphereList() = default;
+
+    /**
+     * Packs the spheres of a SphereList, in the same order, collecting their distinct colors into the palette.
+     * @param spheres Spheres to be packed.
+     *
+     * @note Test Cases:\n
+     * PackedSphereList(list) -> same size as list, Hit() finds the same hits as list.Hit()\n
+     * PackedSphereList(list with a nullptr sphere) -> ERROR: will throw a PackedSphereListException\n
+     * PackedSphereList(list with more than 65536 colors) -> ERROR: will throw a PackedSphereListException\n
+     */
+    explicit PackedSphereList(const SphereList &spheres);
+
+    // Methods
+    /**
+     * Makes a list of some of the spheres, sharing this list's palette.
+     * @param indices Indices of the spheres to keep, in the order they should be kept.
+     * @param arena Arena holding the selected spheres, the heap when nullptr.
+     * @return List holding the selected spheres.
+     *
+     * @note Test Cases:\n
+     * list.Select({2, 0}) -> size 2, sphere 0 is list's sphere 2\n
+     * list.Select({2, 0}, arena) -> same spheres, arena.get_used() grows by their size\n
+     * list.Select({list.size()}) -> ERROR: will throw a PackedSphereListException (index out of range)\n
+     */
+    [[nodiscard]] PackedSphereList Select(const std::vector<uint32_t> &indices,
+                                          const shared_ptr<Arena> &arena = nullptr) const;
+
+    /**
+     * Replaces a sphere with the values of another, for spheres moved, resized or recolored in place. A color missing
+     * from the palette is added to a copy of it, so lists sharing the palette are unaffected.
+     * @param index Index of the sphere to replace.
+     * @param sphere Sphere whose position, radius and color are copied.
+     *
+     * @note Test Cases:\n
+     * list.Update(0, sphere) -> list.get_sphere(0) and list.get_color(0) are sphere's\n
+     * list.Update(list.size(), sphere) -> ERROR: will throw a PackedSphereListException (index out of range)\n
+     */
+    void Update(size_t index, const Sphere &sphere);
+
+    /**
+     * Finds the closest intersection of a ray with the spheres, like SphereList::Hit().
+     * @param ray Ray that could possibly be intersecting the spheres.
+     * @param tStart Minimum t value to begin checking.
+     * @param tEnd Maximum t value to finish checking.
+     * @param hitRecord Hit information if the ray intersects a sphere.
+     * @return True if the ray intersects a sphere and logs the closest intersection in hitRecord, false otherwise.
+     *
+     * @note Test Cases:\n
+     * Same as SphereList::Hit(), with PackedSphereListException instead of SphereListException.\n
+     */
+    bool Hit(const Ray &ray, float tStart, float tEnd, HitRecord &hitRecord) const;
+
+    /**
+     * Determines whether any sphere blocks the ray between tStart and tEnd, like SphereList::Occluded().
+     * @param ray Ray to test for occlusion.
+     * @param tStart Minimum t value to begin checking.
+     * @param tEnd Maximum t value to finish checking.
+     * @return True if any sphere intersects the ray inside [tStart, tEnd]. False if the ray is unobstructed.
+     *
+     * @note Test Cases:\n
+     * Same as SphereList::Occluded(), with PackedSphereListException instead of SphereListException.\n
+     */
+    [[nodiscard]] bool Occluded(const Ray &ray, float tStart, float tEnd) const;
+
+    // Getters
+    /// Gets the number of spheres in the list.
+    [[nodiscard]] size_t size() const {
+        return spheres.size();
+    }
+
+    /// Gets the center (x, y, z) and radius (w) of a sphere.
+    [[nodiscard]] vec4 get_sphere(const size_t index) const {
+        return spheres[index];
+    }
+
+    /// Gets the color of a sphere.
+    [[nodiscard]] Color get_color(const size_t index) const {
+        return (*palette)[color_indices[index]];
+    }
+
+    /// Gets the distinct colors of the spheres.
+    [[nodiscard]] const std::vector<Color> &get_palette() const {
+        return *palette;
+    }
+};
+
+#endif //PACKEDSPHERELIST_H
@@ -23,17 +23,30 @@ bool Sphere::Hit(const Ray &ray, const float tStart, const float tEnd, HitRecord
     if (tStart < 0)
         throw SphereException("Sphere::Hit(): tStart (and possibly tEnd) should not be negative");
 
+    // Find the nearest intersection
+    float root;
+    if (!Intersect(ray, tStart, tEnd, root))
+        return false;
+
+    // HitRecord logging
+    RecordHit(ray, root, hitRecord);
+
+    // Return true
+    return true;
+}
+
+bool Sphere::Intersect(const Ray &ray, const float tStart, const float tEnd, float &t) const {
     // BEGIN CALCULATION CODE
-    vec3 oc = ray.get_position() - get_position();
-    auto a = length2(ray.get_direction());
-    auto h = dot(ray.get_direction(), oc);
-    auto c = length2(oc) - get_radius() * get_radius();
+    const vec3 oc = ray.get_position() - position;
+    const auto a = length2(ray.get_direction());
+    const auto h = dot(ray.get_direction(), oc);
+    const auto c = length2(oc) - radius * radius;
 
-    auto discriminant = h * h - a * c;
+    const auto discriminant = h * h - a * c;
     if (discriminant < 0)
         return false;
 
-    auto sqrtd = std::sqrt(discriminant);
+    const auto sqrtd = std::sqrt(discriminant);
 
     auto root = (-h - sqrtd) / a;
     if (root < tStart || root > tEnd) {
@@ -43,15 +56,16 @@ bool Sphere::Hit(const Ray &ray, const float tStart, const float tEnd, HitRecord
     }
     // END CALCULATION CODE
 
-    // HitRecord logging
-    hitRecord.set_t(root);
-    hitRecord.set_point(ray.at(root));
-    const dvec3 outward_normal = (hitRecord.get_point() - get_position()) / get_radius();
+    t = root;
+    return true;
+}
+
+void Sphere::RecordHit(const Ray &ray, const float t, HitRecord &hitRecord) const {
+    hitRecord.set_t(t);
+    hitRecord.set_point(ray.at(t));
+    const vec3 outward_normal = (hitRecord.get_point() - get_position()) / get_radius();
     hitRecord.set_normal(outward_normal);
     hitRecord.set_color(get_color());
-
-    // Return true
-    return true;
 }
 
 void Sphere::set_position(const vec3 &position) {
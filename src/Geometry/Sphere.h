@@ -52,6 +52,40 @@ public:
      */
     bool Hit(const Ray &ray, float tStart, float tEnd, HitRecord &hitRecord) const;
 
+    /**
+     * Finds the nearest ray parameter t in [tStart, tEnd] where the ray intersects the sphere.
+     * Only t is computed, the point, normal and color are left for RecordHit() so list traversal stays cheap.
+     * Unlike Hit(), tStart and tEnd are not validated here, callers are expected to have done so already.
+     * @param ray Ray that could possibly be intersecting the sphere.
+     * @param tStart Minimum t value to begin checking.
+     * @param tEnd Maximum t value to finish checking.
+     * @param t Ray parameter of the nearest intersection, only written on a hit.
+     * @return True if ray intersects the sphere inside [tStart, tEnd]. False if there is no intersection.
+     *
+     * @note Test Cases:\n
+     * auto s1 = Sphere(vec3(0, 0, 0), 1, Color(1, 1, 1))\n
+     * auto ray = Ray(vec3(0, -2, 0), vec3(0, 1, 0))\n
+     * float t\n
+     * s1.Intersect(ray, 0, 10000, t) -> true, t should be 1\n
+     * s1.Intersect(ray, 0, 0.5, t) -> false\n
+     */
+    bool Intersect(const Ray &ray, float tStart, float tEnd, float &t) const;
+
+    /**
+     * Logs the intersection at ray parameter t into hitRecord (t, point, normal, and color).
+     * This is the deferred half of Hit(), run once for the closest intersection found.
+     * @param ray Ray intersecting the sphere.
+     * @param t Ray parameter of the intersection, usually found by Intersect().
+     * @param hitRecord Hit information to be filled in.
+     *
+     * @note Test Cases:\n
+     * auto s1 = Sphere(vec3(0, 0, 0), 1, Color(1, 1, 1))\n
+     * auto ray = Ray(vec3(0, -2, 0), vec3(0, 1, 0))\n
+     * s1.RecordHit(ray, 1, hitRecord) -> point should be (0, -1, 0), normal should be (0, -1, 0), color (1, 1, 1)\n
+     * s1.RecordHit(ray, -1, hitRecord) -> ERROR: will throw a HitRecordException (t is negative)\n
+     */
+    void RecordHit(const Ray &ray, float t, HitRecord &hitRecord) const;
+
     // Getters
     /// Gets the position of the center of the sphere.
     [[nodiscard]] vec3 get_position() const { return position; }
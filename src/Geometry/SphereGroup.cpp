@@ -0,0 +1,157 @@
+#include "SphereGroup.h"
+
+namespace {
+    /// Same arithmetic as Sphere::Intersect(), with |direction|^2 computed once per ray.
+    inline bool IntersectSphere(const vec4 &sphere, const vec3 &origin, const vec3 &direction, const float a,
+                                const float tStart, const float tEnd, float &t) {
+        const vec3 oc = origin - vec3(sphere.x, sphere.y, sphere.z);
+        const auto h = dot(direction, oc);
+        const auto c = length2(oc) - sphere.w * sphere.w;
+
+        const auto discriminant = h * h - a * c;
+        if (discriminant < 0)
+            return false;
+
+        const auto sqrtd = std::sqrt(discriminant);
+
+        auto root = (-h - sqrtd) / a;
+        if (root < tStart || root > tEnd) {
+            root = (-h + sqrtd) / a;
+            if (root < tStart || root > tEnd)
+                return false;
+        }
+
+        t = root;
+        return true;
+    }
+
+    /// Ensures a [tStart, tEnd] interval is usable, naming the calling method in the error.
+    void ValidateInterval(const float tStart, const float tEnd, const std::string &method) {
+        // Ensure tStart and tEnd are finite
+        if (!is_finite(tStart) || !is_finite(tEnd))
+            throw SphereGroupException("SphereGroup::" + method + "(): tStart and tEnd should be finite");
+
+        // Ensure tStart is lesser than tEnd
+        if (tStart >= tEnd)
+            throw SphereGroupException("SphereGroup::" + method + "(): tStart should be lesser than tEnd");
+
+        // Ensure tStart, tEnd greater than zero
+        if (tStart < 0)
+            throw SphereGroupException("SphereGroup::" + method + "(): tStart (and possible tEnd) should not be negative");
+    }
+}
+
+SphereGroup::SphereGroup(const SphereList &spheres, const shared_ptr<Arena> &arena) {
+    // Packed first, then stored in the order of the hierarchy's leaves
+    const PackedSphereList packed(spheres);
+    std::vector<vec3> minimums(packed.size()), maximums(packed.size());
+    for (size_t i = 0; i < packed.size(); i++) {
+        const vec4 sphere = packed.get_sphere(i);
+        minimums[i] = vec3(sphere.x, sphere.y, sphere.z) - vec3(sphere.w);
+        maximums[i] = vec3(sphere.x, sphere.y, sphere.z) + vec3(sphere.w);
+    }
+
+    hierarchy = BoundingVolumeHierarchy(minimums, maximums, sources, arena);
+    this->spheres = packed.Select(sources, arena);
+}
+
+size_t SphereGroup::ArenaSize(const size_t spheres) {
+    // Three allocations, each padded at most to the alignment of a node
+    return spheres * (sizeof(vec4) + sizeof(uint16_t)) + BoundingVolumeHierarchy::NodeCount(spheres) *
+           sizeof(RT_BVH_NODE) + 3 * alignof(RT_BVH_NODE);
+}
+
+void SphereGroup::Refit(const SphereList &spheres) {
+    // Ensure the list matches the group, sphere for sphere
+    const auto &list = spheres.get_spheres();
+    if (list.size() != sources.size())
+        throw SphereGroupException("SphereGroup::Refit(): list must hold as many spheres as the group");
+
+    std::vector<vec3> minimums(sources.size()), maximums(sources.size());
+    for (size_t i = 0; i < sources.size(); i++) {
+        const auto &sphere = list[sources[i]];
+
+        // Ensure every sphere is initialized
+        if (sphere == nullptr)
+            throw SphereGroupException(
+                "SphereGroup::Refit(): sphere is nullptr, did you forget to initialize a sphere?");
+
+        this->spheres.Update(i, *sphere);
+        minimums[i] = sphere->get_position() - vec3(sphere->get_radius());
+        maximums[i] = sphere->get_position() + vec3(sphere->get_radius());
+    }
+
+    hierarchy.Refit(minimums, maximums);
+}
+
+bool SphereGroup::Hit(const Ray &ray, const float tStart, const float tEnd, HitRecord &hitRecord,
+                      RT_BVH_COUNTS *counts) const {
+    return Hit(ray.get_position(), ray.get_direction(), tStart, tEnd, hitRecord, counts);
+}
+
+bool SphereGroup::Hit(const vec3 &origin, const vec3 &direction, const float tStart, const float tEnd,
+                      HitRecord &hitRecord, RT_BVH_COUNTS *counts) const {
+    ValidateInterval(tStart, tEnd, "Hit");
+
+    float t;
+    vec3 normal;
+    uint32_t index;
+    if (!Intersect(origin, direction, tStart, tEnd, t, normal, index, counts))
+        return false;
+
+    hitRecord.set_t(t);
+    hitRecord.set_point(origin + t * direction);
+    hitRecord.set_normal(normal);
+    hitRecord.set_color(spheres.get_color(index));
+    return true;
+}
+
+bool SphereGroup::Occluded(const Ray &ray, const float tStart, const float tEnd) const {
+    ValidateInterval(tStart, tEnd, "Occluded");
+    return Blocks(ray.get_position(), ray.get_direction(), tStart, tEnd);
+}
+
+bool SphereGroup::Intersect(const vec3 &origin, const vec3 &direction, const float tStart, const float tEnd, float &t,
+                            vec3 &normal, uint32_t &index, RT_BVH_COUNTS *counts) const {
+    const float a = length2(direction);
+    const vec3 inverse_direction = 1.0f / direction;
+    uint32_t closest = 0;
+
+    const bool hit = hierarchy.Traverse(origin, inverse_direction, tStart, tEnd,
+                                        [&](const uint32_t first, const uint32_t count, float &closest_so_far) {
+                                            if (counts != nullptr)
+                                                counts->tests += count;
+                                            bool found = false;
+                                            for (uint32_t i = first; i < first + count; i++) {
+                                                if (IntersectSphere(spheres.get_sphere(i), origin, direction, a,
+                                                                    tStart, closest_so_far, t)) {
+                                                    closest_so_far = t;
+                                                    closest = i;
+                                                    found = true;
+                                                }
+                                            }
+                                            return found;
+                                        }, false, counts);
+    if (!hit)
+        return false;
+
+    // Same as Sphere::RecordHit(), t holds the closest hit since every later one had to be closer
+    const vec4 sphere = spheres.get_sphere(closest);
+    normal = (origin + t * direction - vec3(sphere.x, sphere.y, sphere.z)) / sphere.w;
+    index = closest;
+    return true;
+}
+
+bool SphereGroup::Blocks(const vec3 &origin, const vec3 &direction, const float tStart, const float tEnd) const {
+    const float a = length2(direction);
+    const vec3 inverse_direction = 1.0f / direction;
+    float t;
+
+    return hierarchy.Traverse(origin, inverse_direction, tStart, tEnd,
+                              [&](const uint32_t first, const uint32_t count, float &) {
+                                  for (uint32_t i = first; i < first + count; i++)
+                                      if (IntersectSphere(spheres.get_sphere(i), origin, direction, a, tStart, tEnd, t))
+                                          return true;
+                                  return false;
+                              }, true);
+}
@@ -0,0 +1,154 @@
+#ifndef SPHEREGROUP_H
+#define SPHEREGROUP_H
+#include <Utils/Headers.h>
+#include <Geometry/BoundingVolumeHierarchy.h>
+#include <Geometry/PackedSphereList.h>
+
+/**
+ * Cluster of spheres with its own bounding volume hierarchy. The renderer traces every SphereList scene through one,
+ * and it is the prototype an InstancedSphereList places copies of.
+ * The spheres are packed like a PackedSphereList and stored in the hierarchy's leaf order, so a ray only tests the
+ * spheres in the leaves it crosses. A group is read-only once made, and safe to trace from any number of threads.
+ */
+class SphereGroup final {
+    /// Spheres, in the hierarchy's leaf order.
+    PackedSphereList spheres{};
+
+    /// Hierarchy over the spheres.
+    BoundingVolumeHierarchy hierarchy{};
+
+    /// Index of every sphere in the list the group was made from, in the hierarchy's leaf order.
+    std::vector<uint32_t> sources{};
+
+public:
+    // Constructors
+    /**
+     * Makes a group from the spheres of a list.
+     * @param spheres Spheres of the group.
+     * @param arena Arena holding the packed spheres and the hierarchy's nodes, the heap when nullptr.
+     *
+     * @note Test Cases:\n
+     * SphereGroup(list) -> same size as list, Hit() finds the same hits as list.Hit()\n
+     * SphereGroup(list, arena) -> same hits as SphereGroup(list), arena.get_used() at most ArenaSize(list.size())\n
+     * SphereGroup(empty list) -> size 0, no ray hits it\n
+     * SphereGroup(list with a nullptr sphere) -> ERROR: will throw a PackedSphereListException\n
+     */
+    explicit SphereGroup(const SphereList &spheres, const shared_ptr<Arena> &arena = nullptr);
+
+    /**
+     * Bytes of arena a group of some spheres allocates, alignment padding included.
+     * @param spheres Number of spheres.
+     * @return Bytes the packed spheres and the hierarchy's nodes take.
+     */
+    static size_t ArenaSize(size_t spheres);
+
+    // Methods
+    /**
+     * Updates the group to spheres of the list it was made from that were moved, resized or recolored in place.
+     * The hierarchy's boxes are recomputed without rebuilding the tree (see BoundingVolumeHierarchy::Refit()).
+     * Not thread-safe, nothing may trace the group meanwhile.
+     * @param spheres List the group was made from, with the same number of spheres.
+     *
+     * @note Test Cases:\n
+     * group.Refit(list) after moving spheres of list -> Hit() finds the same hits as list.Hit()\n
+     * group.Refit(list with another sphere count) -> ERROR: will throw a SphereGroupException\n
+     */
+    void Refit(const SphereList &spheres);
+
+    /**
+     * Finds the closest intersection of a ray with the spheres, like SphereList::Hit(). The ray's direction need not
+     * be normalized, t is measured in multiples of it.
+     * @param ray Ray that could possibly be intersecting the spheres.
+     * @param tStart Minimum t value to begin checking.
+     * @param tEnd Maximum t value to finish checking.
+     * @param hitRecord Hit information if the ray intersects a sphere.
+     * @param counts Nodes visited and spheres tested are added to it when it is not nullptr.
+     * @return True if the ray intersects a sphere and logs the closest intersection in hitRecord, false otherwise.
+     *
+     * @note Test Cases:\n
+     * group.Hit(ray, 0.001, 1000, record) -> same hit as the list the group was made from\n
+     * group.Hit(ray, 0.001, 1000, record, &counts) -> counts.tests below size() for a ray crossing a few leaves\n
+     * group.Hit(ray, 1000, 0.001, record) -> ERROR: will throw a SphereGroupException (tStart should be lesser than tEnd)\n
+     */
+    bool Hit(const Ray &ray, float tStart, float tEnd, HitRecord &hitRecord, RT_BVH_COUNTS *counts = nullptr) const;
+
+    /**
+     * Finds the closest intersection of a ray given by its vectors, like Hit(), without making a Ray of them. Used for
+     * camera rays, which are generated as separate component arrays.
+     * @param origin Origin of the ray, finite.
+     * @param direction Direction of the ray, finite and non-zero.
+     * @param tStart Minimum t value to begin checking.
+     * @param tEnd Maximum t value to finish checking.
+     * @param hitRecord Hit information if the ray intersects a sphere.
+     * @param counts Nodes visited and spheres tested are added to it when it is not nullptr.
+     * @return True if the ray intersects a sphere and logs the closest intersection in hitRecord, false otherwise.
+     *
+     * @note Test Cases:\n
+     * group.Hit(origin, direction, 0.001, 1000, record) -> same hit as group.Hit(Ray(origin, direction), 0.001, 1000, record)\n
+     * group.Hit(origin, direction, 1000, 0.001, record) -> ERROR: will throw a SphereGroupException (tStart should be lesser than tEnd)\n
+     */
+    bool Hit(const vec3 &origin, const vec3 &direction, float tStart, float tEnd, HitRecord &hitRecord,
+             RT_BVH_COUNTS *counts = nullptr) const;
+
+    /**
+     * Determines whether any sphere blocks the ray between tStart and tEnd, like SphereList::Occluded().
+     * @param ray Ray to test for occlusion.
+     * @param tStart Minimum t value to begin checking.
+     * @param tEnd Maximum t value to finish checking.
+     * @return True if any sphere intersects the ray inside [tStart, tEnd]. False if the ray is unobstructed.
+     *
+     * @note Test Cases:\n
+     * Same as SphereList::Occluded(), with SphereGroupException instead of SphereListException.\n
+     */
+    [[nodiscard]] bool Occluded(const Ray &ray, float tStart, float tEnd) const;
+
+    /**
+     * Finds the closest hit like Hit(), without checking the interval. Used by InstancedSphereList for every
+     * instance a ray crosses.
+     * @param origin Origin of the ray.
+     * @param direction Direction of the ray.
+     * @param tStart Minimum t value, finite and non-negative.
+     * @param tEnd Maximum t value, above tStart.
+     * @param t Set to the t value of the closest hit.
+     * @param normal Set to the unit surface normal of the closest hit.
+     * @param index Set to the index of the sphere hit, in get_spheres().
+     * @param counts Nodes visited and spheres tested are added to it when it is not nullptr.
+     * @return Whether the ray hits a sphere.
+     */
+    bool Intersect(const vec3 &origin, const vec3 &direction, float tStart, float tEnd, float &t, vec3 &normal,
+                   uint32_t &index, RT_BVH_COUNTS *counts = nullptr) const;
+
+    /**
+     * Determines whether any sphere blocks the ray like Occluded(), without checking the interval.
+     * @return Whether the ray hits a sphere between tStart and tEnd.
+     */
+    [[nodiscard]] bool Blocks(const vec3 &origin, const vec3 &direction, float tStart, float tEnd) const;
+
+    // Getters
+    /// Gets the number of spheres in the group.
+    [[nodiscard]] size_t size() const {
+        return spheres.size();
+    }
+
+    /// Gets the spheres, in the hierarchy's leaf order.
+    [[nodiscard]] const PackedSphereList &get_spheres() const {
+        return spheres;
+    }
+
+    /// Gets the hierarchy over the spheres.
+    [[nodiscard]] const BoundingVolumeHierarchy &get_hierarchy() const {
+        return hierarchy;
+    }
+
+    /// Gets the lowest corner of the box around the group, which must hold a sphere.
+    [[nodiscard]] vec3 get_minimum() const {
+        return hierarchy.get_node(0).minimum;
+    }
+
+    /// Gets the highest corner of the box around the group, which must hold a sphere.
+    [[nodiscard]] vec3 get_maximum() const {
+        return hierarchy.get_node(0).maximum;
+    }
+};
+
+#endif //SPHEREGROUP_H
@@ -1,4 +1,5 @@
 #include "SphereList.h"
+#include <Geometry/SphereGroup.h>
 
 void SphereList::Add(const shared_ptr<Sphere> &sphere) {
     /*
@@ -11,6 +12,33 @@ void SphereList::Add(const shared_ptr<Sphere> &sphere) {
 
     // Add sphere pointer
     spheres.push_back(sphere);
+    std::atomic_store(&accelerator, shared_ptr<const SphereGroup>());
+}
+
+void SphereList::Refit() {
+    // Nothing to refit until a group is built, and a failed refit leaves it to be rebuilt on next use
+    const auto group = std::atomic_load(&accelerator);
+    if (group == nullptr)
+        return;
+    std::atomic_store(&accelerator, shared_ptr<const SphereGroup>());
+
+    auto refitted = make_shared<SphereGroup>(*group);
+    refitted->Refit(*this);
+    std::atomic_store(&accelerator, shared_ptr<const SphereGroup>(std::move(refitted)));
+}
+
+shared_ptr<const SphereGroup> SphereList::get_accelerator() const {
+    // Threads asking at once may each build one, the last stored is kept and every one of them is correct
+    auto group = std::atomic_load(&accelerator);
+    if (group == nullptr) {
+        // Groups of a huge page or more keep their spheres and nodes together in an arena, backed by huge pages where
+        // the kernel allows, smaller ones stay on the heap
+        const size_t bytes = SphereGroup::ArenaSize(spheres.size());
+        const auto arena = bytes < Arena::HUGE_PAGE_SIZE ? nullptr : make_shared<Arena>(bytes);
+        group = make_shared<const SphereGroup>(*this, arena);
+        std::atomic_store(&accelerator, group);
+    }
+    return group;
 }
 
 bool SphereList::Hit(const Ray &ray, const float tStart, const float tEnd, HitRecord &record) const {
@@ -31,22 +59,63 @@ bool SphereList::Hit(const Ray &ray, const float tStart, const float tEnd, HitRe
         throw SphereListException("SphereList::Hit(): tStart (and possible tEnd) should not be negative");
 
     // Begin intersection code
-    HitRecord tempRecord{};
-    bool hitAny = false;
+    // Only the closest t and the sphere it belongs to are tracked while traversing.
+    // The point, normal and color are reconstructed once for the winner afterward.
+    const Sphere *closestSphere = nullptr;
     auto closestSoFar = tEnd;
+    float t;
 
     for (const auto &sphere: spheres) {
         if (sphere == nullptr)
             throw SphereListException("SphereList::Hit(): sphere is nullptr, did you forget to initialize a sphere?");
 
-        if (sphere->Hit(ray, tStart, closestSoFar, tempRecord)) {
-            hitAny = true;
-            closestSoFar = tempRecord.get_t();
-            record = tempRecord;
+        if (sphere->Intersect(ray, tStart, closestSoFar, t)) {
+            closestSoFar = t;
+            closestSphere = sphere.get();
         }
     }
+
+    if (closestSphere == nullptr)
+        return false;
+
+    closestSphere->RecordHit(ray, closestSoFar, record);
     // End intersection code
 
-    // Return if there are hits on any spheres
-    return hitAny;
+    // Return true, there was a hit on at least one sphere
+    return true;
+}
+
+bool SphereList::Occluded(const Ray &ray, const float tStart, const float tEnd) const {
+    // Ensure tStart is finite
+    if (!is_finite(tStart))
+        throw SphereListException("SphereList::Occluded(): tStart should be finite");
+
+    // Ensure tEnd is finite
+    if (!is_finite(tEnd))
+        throw SphereListException("SphereList::Occluded(): tEnd should be finite");
+
+    // Ensure tStart is lesser than tEnd
+    if (tStart >= tEnd)
+        throw SphereListException("SphereList::Occluded(): tStart should be lesser than tEnd");
+
+    // Ensure tStart, tEnd greater than zero
+    if (tStart < 0)
+        throw SphereListException("SphereList::Occluded(): tStart (and possible tEnd) should not be negative");
+
+    // Begin occlusion code
+    // Any intersection inside the interval is enough, so the first one found ends the traversal.
+    float t;
+
+    for (const auto &sphere: spheres) {
+        if (sphere == nullptr)
+            throw SphereListException(
+                "SphereList::Occluded(): sphere is nullptr, did you forget to initialize a sphere?");
+
+        if (sphere->Intersect(ray, tStart, tEnd, t))
+            return true;
+    }
+    // End occlusion code
+
+    // Nothing blocks the ray
+    return false;
 }
@@ -4,6 +4,8 @@
 #include <Geometry/Sphere.h>
 #include <vector>
 
+class SphereGroup;
+
 /**
  * List for spheres.
  * Use this list to store collections of sphere spheres which can be queried by Hit().
@@ -12,6 +14,9 @@ class SphereList final {
     /// List of pointers to hittable spheres.
     std::vector<shared_ptr<Sphere> > spheres{};
 
+    /// Spheres packed for tracing, made by get_accelerator() and dropped when the spheres change.
+    mutable shared_ptr<const SphereGroup> accelerator{};
+
 public:
     // Constructors
     /**
@@ -26,6 +31,46 @@ public:
      */
     void Add(const shared_ptr<Sphere> &sphere);
 
+    /**
+     * Tells the list that spheres were moved, resized or recolored in place, so get_accelerator() reflects them.
+     * A group already built is refit rather than rebuilt (see SphereGroup::Refit()). The refit is made on a copy, so
+     * renders still tracing the previous group are unaffected.
+     *
+     * @note Test Cases:\n
+     * sphere->set_position(p); list.Refit() -> list.get_accelerator() hits the sphere at p\n
+     */
+    void Refit();
+
+    /**
+     * Gets the spheres packed into a SphereGroup, which the renderer traces. It is built on first use and kept until
+     * the spheres change, so every render of an unchanged list shares one. Safe to call from several threads.
+     * @return Group holding every sphere, read-only.
+     *
+     * @note Test Cases:\n
+     * list.get_accelerator() twice -> the same group\n
+     * list.Add(sphere); list.get_accelerator() -> a new group holding the sphere\n
+     * list with a nullptr sphere -> ERROR: will throw a PackedSphereListException\n
+     */
+    [[nodiscard]] shared_ptr<const SphereGroup> get_accelerator() const;
+
+    /**
+     * Reserves room for a number of spheres, so adding that many does not reallocate.
+     * @param count Number of spheres the list will hold.
+     */
+    void Reserve(size_t count) {
+        spheres.reserve(count);
+    }
+
+    /// Gets the spheres in the list, in the order they were added.
+    [[nodiscard]] const std::vector<shared_ptr<Sphere> > &get_spheres() const {
+        return spheres;
+    }
+
+    /// Gets the number of spheres in the list.
+    [[nodiscard]] size_t size() const {
+        return spheres.size();
+    }
+
     // Methods
     /**
      * Determines whether the incoming ray intersects the sphere or not.
@@ -43,6 +88,24 @@ public:
      * For advanced testing, set the pointer to nullptr and run it again. You should catch a SphereListException.\n
      */
     bool Hit(const Ray &ray, float tStart, float tEnd, HitRecord &hitRecord) const;
+
+    /**
+     * Determines whether anything in the list blocks the ray between tStart and tEnd.
+     * This is a visibility-only query (shadow rays, occlusion probes, sky visibility).
+     * It returns on the first intersection found instead of searching for the closest one, and no HitRecord is built.
+     * @param ray Ray to test for occlusion.
+     * @param tStart Minimum t value to begin checking.
+     * @param tEnd Maximum t value to finish checking.
+     * @return True if any sphere intersects the ray inside [tStart, tEnd]. False if the ray is unobstructed.
+     *
+     * @note Test Cases:\n
+     * Same setup as Hit(): a list with a sphere at the origin and a ray from (0, -2, 0) toward +y.\n
+     * spheres->Occluded(ray, 0, 10000) -> true\n
+     * spheres->Occluded(ray, 0, 0.5) -> false (the sphere is past tEnd)\n
+     * spheres->Occluded(ray, -infinity, infinity) -> ERROR: will throw a SphereListException (tStart and tEnd must be finite)\n
+     * A nullptr sphere in the list -> ERROR: will throw a SphereListException\n
+     */
+    [[nodiscard]] bool Occluded(const Ray &ray, float tStart, float tEnd) const;
 };
 
 
@@ -0,0 +1,99 @@
+#include "CostMap.h"
+#include <Renderer/RenderTarget.h>
+#include <fstream>
+
+CostMap::CostMap(const int width, const int height) : width(width), height(height) {
+    // Ensure the size is positive
+    if (width <= 0 || height <= 0)
+        throw CostMapException("CostMap::CostMap(): size must be positive");
+
+    values.assign(static_cast<size_t>(width) * static_cast<size_t>(height) * CHANNELS, 0.0f);
+}
+
+void CostMap::set_cost(const int x, const int y, const RT_PIXEL_COST &cost) {
+    // Ensure x and y are within bounds
+    if (x < 0 || y < 0 || x >= width || y >= height)
+        throw CostMapException("CostMap::set_cost(): pixel index out of bounds");
+
+    float *pixel = values.data() + (static_cast<size_t>(y) * width + x) * CHANNELS;
+    pixel[static_cast<int>(CostChannel::IntersectionTests)] = static_cast<float>(cost.intersection_tests);
+    pixel[static_cast<int>(CostChannel::TraversalSteps)] = static_cast<float>(cost.traversal_steps);
+    pixel[static_cast<int>(CostChannel::Bounces)] = static_cast<float>(cost.bounces);
+}
+
+void CostMap::set_tile_time(const RT_TILE &tile, const double nanoseconds) {
+    // Ensure the tile is within bounds
+    if (tile.x < 0 || tile.y < 0 || tile.x + tile.width > width || tile.y + tile.height > height)
+        throw CostMapException("CostMap::set_tile_time(): tile does not fit inside the map");
+
+    for (int y = tile.y; y < tile.y + tile.height; y++)
+        for (int x = tile.x; x < tile.x + tile.width; x++)
+            values[(static_cast<size_t>(y) * width + x) * CHANNELS + static_cast<int>(CostChannel::TileTime)] =
+                    static_cast<float>(nanoseconds);
+}
+
+float CostMap::get_value(const int x, const int y, const CostChannel channel) const {
+    // Ensure x and y are within bounds
+    if (x < 0 || y < 0 || x >= width || y >= height)
+        throw CostMapException("CostMap::get_value(): pixel index out of bounds");
+
+    return values[(static_cast<size_t>(y) * width + x) * CHANNELS + static_cast<int>(channel)];
+}
+
+float CostMap::get_max(const CostChannel channel) const {
+    float max = 0;
+    for (size_t i = static_cast<int>(channel); i < values.size(); i += CHANNELS)
+        max = std::max(max, values[i]);
+    return max;
+}
+
+Color CostMap::falseColor(const float t) {
+    // Heat ramp in linear light, evenly spaced stops
+    static const vec3 stops[] = {
+        vec3(0.0f, 0.0f, 0.0f), vec3(0.12f, 0.0f, 0.3f), vec3(0.7f, 0.02f, 0.1f), vec3(1.0f, 0.3f, 0.0f),
+        vec3(1.0f, 0.85f, 0.05f), vec3(1.0f, 1.0f, 1.0f)
+    };
+    constexpr int segments = static_cast<int>(std::size(stops)) - 1;
+
+    const float position = clamp(t, 0.0f, 1.0f) * segments;
+    const int segment = std::min(static_cast<int>(position), segments - 1);
+    const float f = position - static_cast<float>(segment);
+    return Color(stops[segment] + f * (stops[segment + 1] - stops[segment]));
+}
+
+void CostMap::writeFalseColor(const std::string &filename, const CostChannel channel) const {
+    // Ensure the filename is not empty
+    if (filename.empty())
+        throw CostMapException("CostMap::writeFalseColor(): empty filename");
+
+    // Scaled to the largest value, an all-zero channel stays black
+    const float max = get_max(channel);
+    const float scale = max > 0 ? 1.0f / max : 0.0f;
+
+    RenderTarget image(width, height);
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            image.set_radiance(x, y, falseColor(get_value(x, y, channel) * scale).get_color());
+
+    try {
+        image.writeToFile(filename, PostProcess(1, ToneMapping::Clamp, TransferFunction::SRGB));
+    } catch (RenderTargetException &e) {
+        throw CostMapException(std::string("CostMap::writeFalseColor(): ") + e.what());
+    }
+}
+
+void CostMap::writeRaw(const std::string &filename) const {
+    // Ensure the filename is not empty
+    if (filename.empty())
+        throw CostMapException("CostMap::writeRaw(): empty filename");
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open())
+        throw CostMapException("CostMap::writeRaw(): cannot open " + filename);
+
+    file.write(reinterpret_cast<const char *>(values.data()),
+               static_cast<std::streamsize>(values.size() * sizeof(float)));
+
+    if (!file.good())
+        throw CostMapException("CostMap::writeRaw(): system error writing to " + filename);
+}
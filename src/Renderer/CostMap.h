@@ -0,0 +1,148 @@
+#ifndef COSTMAP_H
+#define COSTMAP_H
+#include <Utils/Headers.h>
+#include <Renderer/Tiling.h>
+
+/**
+ * Quantities recorded per pixel by a CostMap.
+ */
+enum class CostChannel {
+    /// Ray-sphere intersection tests, summed over the pixel's samples.
+    IntersectionTests,
+
+    /// Hierarchy nodes visited to find hits (one per traced ray segment for lists without one), summed over the
+    /// pixel's samples.
+    TraversalSteps,
+
+    /// Bounces off spheres, summed over the pixel's samples.
+    Bounces,
+
+    /// Wall-clock nanoseconds spent on the tile the pixel belongs to.
+    TileTime
+};
+
+/**
+ * Work done tracing the samples of one pixel, counted by the renderer.
+ */
+struct RT_PIXEL_COST {
+    /// Ray-sphere intersection tests.
+    uint32_t intersection_tests = 0;
+
+    /// Hierarchy nodes visited, or sphere lists walked for lists without a hierarchy.
+    uint32_t traversal_steps = 0;
+
+    /// Bounces off spheres.
+    uint32_t bounces = 0;
+};
+
+/**
+ * Diagnostic image of where a render spends its time, filled when passed to Renderer::render() or renderAsync().
+ * Every pixel holds one float per CostChannel. Pixels outside the crop window, or of tiles that were not rendered,
+ * stay 0.
+ */
+class CostMap final {
+    /// Width in pixels of the image.
+    int width;
+
+    /// Height in pixels of the image.
+    int height;
+
+    /// Row-major values of every pixel, CHANNELS interleaved floats each.
+    std::vector<float> values;
+
+public:
+    /// Number of channels per pixel.
+    static constexpr int CHANNELS = 4;
+
+    // Constructors
+    /**
+     * Makes an empty cost map.
+     * @param width Width, in pixels, the same as the rendered image.
+     * @param height Height, in pixels, the same as the rendered image.
+     *
+     * @note Test Cases:\n
+     * CostMap(64, 48) -> every value 0\n
+     * CostMap(0, 48) -> ERROR: will throw a CostMapException (size must be positive)\n
+     */
+    CostMap(int width, int height);
+
+    // Methods
+    /**
+     * Records the work done for a pixel's samples, replacing earlier counts.
+     * @param x x pixel coordinate.
+     * @param y y pixel coordinate.
+     * @param cost Counts of the pixel.
+     *
+     * @note Test Cases:\n
+     * map.set_cost(1, 2, {5, 2, 1}) -> get_value(1, 2, CostChannel::IntersectionTests) == 5\n
+     * map.set_cost(-1, 0, cost) -> ERROR: will throw a CostMapException (pixel out of bounds)\n
+     */
+    void set_cost(int x, int y, const RT_PIXEL_COST &cost);
+
+    /**
+     * Records the time a tile took in every one of its pixels.
+     * @param tile Rendered tile.
+     * @param nanoseconds Wall-clock time spent on it.
+     *
+     * @note Test Cases:\n
+     * map.set_tile_time({0, 0, 8, 8}, 1000) -> get_value(7, 7, CostChannel::TileTime) == 1000\n
+     * map.set_tile_time({60, 0, 8, 8}, 1000) on a 64 pixel wide map -> ERROR: will throw a CostMapException\n
+     */
+    void set_tile_time(const RT_TILE &tile, double nanoseconds);
+
+    /**
+     * Gets a recorded value.
+     * @return Value of the channel at pixel (x, y).
+     *
+     * @note Test Cases:\n
+     * map.get_value(64, 0, channel) on a 64 pixel wide map -> ERROR: will throw a CostMapException\n
+     */
+    [[nodiscard]] float get_value(int x, int y, CostChannel channel) const;
+
+    /// Gets the largest value of a channel over the whole map.
+    [[nodiscard]] float get_max(CostChannel channel) const;
+
+    /**
+     * Maps a value in [0, 1] to a heat color: black, purple, red, orange, yellow, then white.
+     * @param t Value, clamped to [0, 1].
+     * @return Linear color.
+     *
+     * @note Test Cases:\n
+     * CostMap::falseColor(0) -> black\n
+     * CostMap::falseColor(1) -> white\n
+     */
+    static Color falseColor(float t);
+
+    /**
+     * Writes one channel as a false-color PPM image, scaled so the largest value is white.
+     * @param filename Output file.
+     * @param channel Channel shown.
+     *
+     * @note Test Cases:\n
+     * map.writeFalseColor("", channel) -> ERROR: will throw a CostMapException (empty filename)\n
+     */
+    void writeFalseColor(const std::string &filename, CostChannel channel) const;
+
+    /**
+     * Writes every channel as a raw buffer: width * height * CHANNELS native-endian 32-bit floats, rows top to
+     * bottom, channels interleaved in CostChannel order. There is no header.
+     * @param filename Output file.
+     *
+     * @note Test Cases:\n
+     * map.writeRaw("cost.raw") -> file of width * height * 16 bytes\n
+     * map.writeRaw("") -> ERROR: will throw a CostMapException (empty filename)\n
+     */
+    void writeRaw(const std::string &filename) const;
+
+    // Getters
+    /// Gets the width in pixels of the map.
+    [[nodiscard]] int get_width() const { return width; }
+
+    /// Gets the height in pixels of the map.
+    [[nodiscard]] int get_height() const { return height; }
+
+    /// Gets the interleaved values of every pixel (width * height * CHANNELS floats).
+    [[nodiscard]] const float *get_data() const { return values.data(); }
+};
+
+#endif //COSTMAP_H
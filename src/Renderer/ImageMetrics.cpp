@@ -0,0 +1,202 @@
+#include "ImageMetrics.h"
+
+namespace {
+    /// Gaussian standard deviation, in pixels, standing in for the achromatic contrast sensitivity.
+    constexpr float LUMINANCE_SIGMA = 1.0f;
+
+    /// Gaussian standard deviation, in pixels, standing in for the (blurrier) chromatic contrast sensitivity.
+    constexpr float CHROMA_SIGMA = 2.0f;
+
+    /// D65 reference white in XYZ.
+    const vec3 WHITE{0.9505f, 1.0f, 1.089f};
+
+    /// Ensures two images can be compared, returns the number of floats in each.
+    size_t checked_size(const RenderTarget &image, const RenderTarget &reference, const std::string &caller) {
+        if (image.get_width() != reference.get_width() || image.get_height() != reference.get_height())
+            throw ImageMetricsException("ImageMetrics::" + caller + "(): image and reference sizes differ");
+
+        return static_cast<size_t>(image.get_width()) * static_cast<size_t>(image.get_height()) * 3;
+    }
+
+    /// Linear sRGB to CIE XYZ.
+    vec3 rgb_to_xyz(const vec3 &rgb) {
+        return {
+            0.4124f * rgb.r + 0.3576f * rgb.g + 0.1805f * rgb.b,
+            0.2126f * rgb.r + 0.7152f * rgb.g + 0.0722f * rgb.b,
+            0.0193f * rgb.r + 0.1192f * rgb.g + 0.9505f * rgb.b
+        };
+    }
+
+    /// CIE XYZ to linear sRGB.
+    vec3 xyz_to_rgb(const vec3 &xyz) {
+        return {
+            3.2406f * xyz.x - 1.5372f * xyz.y - 0.4986f * xyz.z,
+            -0.9689f * xyz.x + 1.8758f * xyz.y + 0.0415f * xyz.z,
+            0.0557f * xyz.x - 0.2040f * xyz.y + 1.0570f * xyz.z
+        };
+    }
+
+    /// CIE XYZ to the YCxCz opponent space.
+    vec3 xyz_to_ycxcz(const vec3 &xyz) {
+        const vec3 n = xyz / WHITE;
+        return {116.0f * n.y - 16.0f, 500.0f * (n.x - n.y), 200.0f * (n.y - n.z)};
+    }
+
+    /// YCxCz opponent space back to CIE XYZ.
+    vec3 ycxcz_to_xyz(const vec3 &ycxcz) {
+        const float y = (ycxcz.x + 16.0f) / 116.0f;
+        return vec3(ycxcz.y / 500.0f + y, y, y - ycxcz.z / 200.0f) * WHITE;
+    }
+
+    /// CIE XYZ to CIE L*a*b*.
+    vec3 xyz_to_lab(const vec3 &xyz) {
+        const auto f = [](const float t) {
+            constexpr float delta = 6.0f / 29.0f;
+            return t > delta * delta * delta ? std::cbrt(t) : t / (3.0f * delta * delta) + 4.0f / 29.0f;
+        };
+        const vec3 n = xyz / WHITE;
+        return {116.0f * f(n.y) - 16.0f, 500.0f * (f(n.x) - f(n.y)), 200.0f * (f(n.y) - f(n.z))};
+    }
+
+    /// HyAB color distance between two L*a*b* colors.
+    float hyab(const vec3 &a, const vec3 &b) {
+        const vec3 d = a - b;
+        return std::fabs(d.x) + std::sqrt(d.y * d.y + d.z * d.z);
+    }
+
+    /// Normalized 1D Gaussian kernel of a standard deviation, covering three deviations on each side.
+    std::vector<float> gaussian_kernel(const float sigma) {
+        const int radius = static_cast<int>(std::ceil(3.0f * sigma));
+        std::vector<float> kernel(2 * radius + 1);
+        float sum = 0;
+        for (int i = -radius; i <= radius; i++) {
+            kernel[i + radius] = std::exp(-static_cast<float>(i * i) / (2.0f * sigma * sigma));
+            sum += kernel[i + radius];
+        }
+        for (auto &weight: kernel)
+            weight /= sum;
+        return kernel;
+    }
+
+    /// Blurs one channel of an interleaved 3-channel image in place with a separable, edge-clamped Gaussian.
+    void blur_channel(std::vector<vec3> &pixels, const int width, const int height, const int channel,
+                      const float sigma) {
+        const auto kernel = gaussian_kernel(sigma);
+        const int radius = static_cast<int>(kernel.size() / 2);
+        std::vector<float> temporary(pixels.size());
+
+        // Horizontal pass
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                float sum = 0;
+                for (int k = -radius; k <= radius; k++) {
+                    const int sx = std::min(std::max(x + k, 0), width - 1);
+                    sum += kernel[k + radius] * pixels[static_cast<size_t>(y) * width + sx][channel];
+                }
+                temporary[static_cast<size_t>(y) * width + x] = sum;
+            }
+        }
+
+        // Vertical pass
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                float sum = 0;
+                for (int k = -radius; k <= radius; k++) {
+                    const int sy = std::min(std::max(y + k, 0), height - 1);
+                    sum += kernel[k + radius] * temporary[static_cast<size_t>(sy) * width + x];
+                }
+                pixels[static_cast<size_t>(y) * width + x][channel] = sum;
+            }
+        }
+    }
+
+    /// Filters an image as the eye would see it and returns it in L*a*b*.
+    std::vector<vec3> perceived_lab(const RenderTarget &image) {
+        const int width = image.get_width();
+        const int height = image.get_height();
+        std::vector<vec3> pixels(static_cast<size_t>(width) * height);
+
+        // Read a row at a time, so any pixel storage works
+        std::vector<float> row(static_cast<size_t>(width) * 3);
+        for (int y = 0; y < height; y++) {
+            image.readRow(0, y, width, row.data());
+            for (int x = 0; x < width; x++) {
+                const vec3 rgb = clamp(vec3(row[3 * x], row[3 * x + 1], row[3 * x + 2]), 0.0f, 1.0f);
+                pixels[static_cast<size_t>(y) * width + x] = xyz_to_ycxcz(rgb_to_xyz(rgb));
+            }
+        }
+
+        blur_channel(pixels, width, height, 0, LUMINANCE_SIGMA);
+        blur_channel(pixels, width, height, 1, CHROMA_SIGMA);
+        blur_channel(pixels, width, height, 2, CHROMA_SIGMA);
+
+        for (auto &pixel: pixels) {
+            const vec3 rgb = clamp(xyz_to_rgb(ycxcz_to_xyz(pixel)), 0.0f, 1.0f);
+            pixel = xyz_to_lab(rgb_to_xyz(rgb));
+        }
+
+        return pixels;
+    }
+}
+
+float ImageMetrics::rmse(const RenderTarget &image, const RenderTarget &reference) {
+    const size_t count = checked_size(image, reference, "rmse");
+    const int width = image.get_width();
+
+    // Read a row at a time, so any pixel storage works
+    std::vector<float> a(static_cast<size_t>(width) * 3), b(a.size());
+    double sum = 0;
+    for (int y = 0; y < image.get_height(); y++) {
+        image.readRow(0, y, width, a.data());
+        reference.readRow(0, y, width, b.data());
+        for (size_t i = 0; i < a.size(); i++) {
+            const double difference = static_cast<double>(a[i]) - static_cast<double>(b[i]);
+            sum += difference * difference;
+        }
+    }
+
+    return static_cast<float>(std::sqrt(sum / static_cast<double>(count)));
+}
+
+float ImageMetrics::psnr(const RenderTarget &image, const RenderTarget &reference) {
+    const float error = rmse(image, reference);
+
+    // Identical images have no noise, report a large finite value instead
+    if (error <= 1e-5f)
+        return 100.0f;
+
+    return std::min(100.0f, -20.0f * std::log10(error));
+}
+
+float ImageMetrics::flip(const RenderTarget &image, const RenderTarget &reference) {
+    checked_size(image, reference, "flip");
+
+    // FLIP's color error exponent and compression parameters
+    constexpr float exponent = 0.7f;
+    constexpr float compression_point = 0.4f;
+    constexpr float compression_target = 0.95f;
+
+    // Largest expected error, between pure green and pure blue
+    const float max_error = std::pow(hyab(xyz_to_lab(rgb_to_xyz(vec3(0, 1, 0))),
+                                          xyz_to_lab(rgb_to_xyz(vec3(0, 0, 1)))), exponent);
+
+    const auto a = perceived_lab(image);
+    const auto b = perceived_lab(reference);
+
+    double sum = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        const float error = std::pow(hyab(a[i], b[i]), exponent);
+
+        // Compress large errors toward 1
+        float normalized;
+        if (error < compression_point * max_error)
+            normalized = compression_target / (compression_point * max_error) * error;
+        else
+            normalized = compression_target + (error - compression_point * max_error)
+                         / (max_error - compression_point * max_error) * (1.0f - compression_target);
+
+        sum += std::min(normalized, 1.0f);
+    }
+
+    return static_cast<float>(sum / static_cast<double>(a.size()));
+}
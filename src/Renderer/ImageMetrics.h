@@ -0,0 +1,56 @@
+#ifndef IMAGEMETRICS_H
+#define IMAGEMETRICS_H
+#include <Utils/Headers.h>
+#include <Renderer/RenderTarget.h>
+
+/**
+ * Error metrics between a rendered image and a reference image of the same size.
+ * Used to judge whether a faster render is still a correct one, which exact pixel comparisons cannot do once
+ * sampling changes.
+ */
+class ImageMetrics {
+public:
+    /**
+     * Root mean squared error over every color component of the linear framebuffers.
+     * @param image Rendered image.
+     * @param reference Reference image, same size as image.
+     * @return RMSE, 0 for identical images.
+     *
+     * @note Test Cases:\n
+     * ImageMetrics::rmse(black, black) -> 0\n
+     * ImageMetrics::rmse(black, white) -> 1\n
+     * ImageMetrics::rmse(100x100 image, 50x50 image) -> ERROR: will throw an ImageMetricsException (sizes differ)\n
+     */
+    static float rmse(const RenderTarget &image, const RenderTarget &reference);
+
+    /**
+     * Peak signal-to-noise ratio, in decibels, for a peak value of 1.
+     * @param image Rendered image.
+     * @param reference Reference image, same size as image.
+     * @return PSNR in dB, capped at 100 dB for identical images.
+     *
+     * @note Test Cases:\n
+     * ImageMetrics::psnr(black, white) -> 0\n
+     * ImageMetrics::psnr(black, black) -> 100\n
+     * ImageMetrics::psnr(100x100 image, 50x50 image) -> ERROR: will throw an ImageMetricsException (sizes differ)\n
+     */
+    static float psnr(const RenderTarget &image, const RenderTarget &reference);
+
+    /**
+     * Perceptual color error in the style of NVIDIA FLIP (its color pipeline, without the feature term).
+     * Both images are clamped to [0, 1], moved to an opponent color space and blurred with per-channel Gaussians that
+     * stand in for the eye's contrast sensitivity. The HyAB distance of the results, in L*a*b*, is then compressed
+     * and normalized to [0, 1] per pixel.
+     * @param image Rendered image.
+     * @param reference Reference image, same size as image.
+     * @return Mean per-pixel error in [0, 1], 0 for identical images.
+     *
+     * @note Test Cases:\n
+     * ImageMetrics::flip(black, black) -> 0\n
+     * ImageMetrics::flip(black, white) -> close to 1\n
+     * ImageMetrics::flip(100x100 image, 50x50 image) -> ERROR: will throw an ImageMetricsException (sizes differ)\n
+     */
+    static float flip(const RenderTarget &image, const RenderTarget &reference);
+};
+
+#endif //IMAGEMETRICS_H
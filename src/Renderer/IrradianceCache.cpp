@@ -0,0 +1,265 @@
+#include "IrradianceCache.h"
+#include <algorithm>
+
+namespace {
+    constexpr float PI = 3.14159265f;
+
+    /// Bits of a packed grid cell coordinate, per axis.
+    constexpr int CELL_BITS = 20;
+
+    /// Offset making cell coordinates around the origin non-negative before packing.
+    constexpr int64_t CELL_BIAS = int64_t{1} << (CELL_BITS - 1);
+
+    /**
+     * Packs a level and cell coordinates into a key. Coordinates wrap past 2^20 cells, which only makes distant cells
+     * share keys.
+     */
+    uint64_t PackCell(const int level, const int64_t x, const int64_t y, const int64_t z) {
+        constexpr uint64_t mask = (uint64_t{1} << CELL_BITS) - 1;
+        return (static_cast<uint64_t>(x + CELL_BIAS) & mask) | (static_cast<uint64_t>(y + CELL_BIAS) & mask) <<
+               CELL_BITS | (static_cast<uint64_t>(z + CELL_BIAS) & mask) << 2 * CELL_BITS |
+               static_cast<uint64_t>(level) << 3 * CELL_BITS;
+    }
+
+    /// Integral of tan(theta) over sin^2(theta) from 0 to x, for the mean slope of a row of cells.
+    float TanIntegral(const float x) {
+        return std::asin(std::sqrt(x)) - std::sqrt(x * (1.0f - x));
+    }
+
+    /// Tangents completing a unit normal into an orthonormal basis, without branching on its direction (Duff et al.)
+    void MakeBasis(const vec3 &normal, vec3 &tangent, vec3 &bitangent) {
+        const float sign = std::copysign(1.0f, normal.z);
+        const float a = -1.0f / (sign + normal.z);
+        const float b = normal.x * normal.y * a;
+        tangent = vec3(1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+        bitangent = vec3(b, sign + normal.y * normal.y * a, -normal.y);
+    }
+}
+
+IrradianceCache::IrradianceCache(const float accuracy, const float min_spacing, const float max_spacing) {
+    // Ensure accuracy is in (0, 1]
+    if (!(accuracy > 0 && accuracy <= 1))
+        throw IrradianceCacheException("IrradianceCache::IrradianceCache(): accuracy must be in (0, 1]");
+
+    // Ensure the spacing is a finite, positive range
+    if (!(min_spacing > 0) || !(max_spacing >= min_spacing) || !is_finite(max_spacing))
+        throw IrradianceCacheException(
+            "IrradianceCache::IrradianceCache(): spacing must satisfy 0 < min_spacing <= max_spacing");
+
+    this->accuracy = accuracy;
+    this->min_spacing = min_spacing;
+    this->max_spacing = max_spacing;
+    cell_size = 2.0f * accuracy * max_spacing;
+    cell_keys.assign(64, EMPTY_CELL);
+    cell_records.resize(64);
+}
+
+size_t IrradianceCache::findSlot(const uint64_t key) const {
+    // Fibonacci hashing spreads neighbouring cells over the table
+    const size_t mask = cell_keys.size() - 1;
+    size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    while (cell_keys[slot] != EMPTY_CELL && cell_keys[slot] != key)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+vec3 IrradianceCache::getSampleDirection(const vec3 &normal, const int theta_strata, const int phi_strata, const int j,
+                                         const int k, const float u, const float v) {
+    // Ensure the cell exists
+    if (theta_strata <= 0 || phi_strata <= 0 || j < 0 || j >= theta_strata || k < 0 || k >= phi_strata)
+        throw IrradianceCacheException("IrradianceCache::getSampleDirection(): stratum out of range");
+
+    // Equal steps of sin^2(theta) have equal cosine weighted area
+    const float sin2_theta = (static_cast<float>(j) + u) / static_cast<float>(theta_strata);
+    const float sin_theta = std::sqrt(sin2_theta);
+    const float cos_theta = std::sqrt(std::max(0.0f, 1.0f - sin2_theta));
+    const float phi = 2.0f * PI * (static_cast<float>(k) + v) / static_cast<float>(phi_strata);
+
+    vec3 tangent, bitangent;
+    MakeBasis(normal, tangent, bitangent);
+    return sin_theta * (std::cos(phi) * tangent + std::sin(phi) * bitangent) + cos_theta * normal;
+}
+
+RT_IRRADIANCE_RECORD IrradianceCache::makeRecord(const vec3 &position, const vec3 &normal, const int theta_strata,
+                                                 const int phi_strata, const std::vector<vec3> &radiance,
+                                                 const std::vector<float> &distance) const {
+    // Ensure there is one sample per cell
+    const size_t cells = static_cast<size_t>(std::max(theta_strata, 0)) * static_cast<size_t>(std::max(phi_strata, 0));
+    if (cells == 0 || radiance.size() != cells || distance.size() != cells)
+        throw IrradianceCacheException("IrradianceCache::makeRecord(): need one sample per hemisphere cell");
+
+    RT_IRRADIANCE_RECORD record{};
+    record.position = position;
+    record.normal = normal;
+
+    vec3 tangent, bitangent;
+    MakeBasis(normal, tangent, bitangent);
+
+    const auto M = static_cast<float>(theta_strata);
+    const auto N = static_cast<float>(phi_strata);
+    const auto at = [phi_strata](const int j, const int k) { return static_cast<size_t>(j * phi_strata + k); };
+
+    // Ward and Heckbert's gradients. Rows are weighted by their mean tan(theta) rather than at their middle, and the
+    // boundaries between columns by their cells' cosine weighted area, which both match finite differences closely.
+    vec3 irradiance{0};
+    float inverse_distances = 0;
+    for (int k = 0; k < phi_strata; k++) {
+        // Azimuth through the middle of the column, and the azimuth of its boundary with column k - 1
+        const float phi = 2.0f * PI * (static_cast<float>(k) + 0.5f) / N;
+        const float phi_boundary = 2.0f * PI * static_cast<float>(k) / N;
+        const vec3 u_k = std::cos(phi) * tangent + std::sin(phi) * bitangent;
+        const vec3 v_k = -std::sin(phi) * tangent + std::cos(phi) * bitangent;
+        const vec3 v_boundary = -std::sin(phi_boundary) * tangent + std::cos(phi_boundary) * bitangent;
+        const int previous_k = (k + phi_strata - 1) % phi_strata;
+
+        vec3 rotational{0};
+        for (int j = 0; j < theta_strata; j++) {
+            const vec3 L = radiance[at(j, k)];
+            const float R = distance[at(j, k)];
+            irradiance += L;
+            inverse_distances += 1.0f / std::max(R, 1e-6f);
+
+            // Mean slope of the row, weighting turns of the normal towards the column
+            const float sin2_lower = static_cast<float>(j) / M;
+            const float sin2_upper = static_cast<float>(j + 1) / M;
+            rotational += M * (TanIntegral(sin2_upper) - TanIntegral(sin2_lower)) * L;
+
+            // Moving along u_k shifts the boundary with row j - 1, seen at sin^2(theta) = sin2_lower
+            if (j > 0) {
+                const float R_min = std::max(std::min(R, distance[at(j - 1, k)]), 1e-6f);
+                const vec3 change = 2.0f * PI / N * std::sqrt(sin2_lower) * (1.0f - sin2_lower) / R_min *
+                                    (L - radiance[at(j - 1, k)]);
+                for (int c = 0; c < 3; c++)
+                    record.translational_gradient[c] += change[c] * u_k;
+            }
+
+            // Moving along v_boundary turns the boundary with column k - 1, whose cells cover 1 / 2M of the
+            // cosine weighted hemisphere per radian
+            const float R_min = std::max(std::min(R, distance[at(j, previous_k)]), 1e-6f);
+            const float sin_middle = std::sqrt((static_cast<float>(j) + 0.5f) / M);
+            const vec3 change = 0.5f / (M * sin_middle * R_min) * (L - radiance[at(j, previous_k)]);
+            for (int c = 0; c < 3; c++)
+                record.translational_gradient[c] += change[c] * v_boundary;
+        }
+
+        for (int c = 0; c < 3; c++)
+            record.rotational_gradient[c] += rotational[c] * v_k;
+    }
+
+    // The sums are of radiance, irradiance over pi is their mean
+    const float scale = 1.0f / static_cast<float>(cells);
+    record.irradiance = irradiance * scale;
+    for (int c = 0; c < 3; c++) {
+        record.rotational_gradient[c] *= scale;
+        record.translational_gradient[c] /= PI;
+    }
+
+    // Harmonic mean distance, clamped. Raising it to min_spacing lowers the gradient to match.
+    const float radius = inverse_distances > 0 ? static_cast<float>(cells) / inverse_distances : infinity;
+    record.radius = std::clamp(radius, min_spacing, max_spacing);
+    if (radius < min_spacing)
+        for (auto &gradient: record.translational_gradient)
+            gradient *= radius / min_spacing;
+
+    return record;
+}
+
+void IrradianceCache::add(const RT_IRRADIANCE_RECORD &record) {
+    const auto index = static_cast<uint32_t>(records.size());
+    const float reach = accuracy * record.radius;
+    records.push_back(record);
+    bounds.emplace_back(record.position, reach * reach);
+
+    // Finest level whose cells span the record's reach, so it is listed in at most 2 x 2 x 2 cells
+    int level = 0;
+    float size = cell_size;
+    while (level < LEVELS - 1 && size * 0.5f >= 2.0f * reach) {
+        size *= 0.5f;
+        level++;
+    }
+    used_levels |= 1u << level;
+
+    const vec3 low = (record.position - vec3(reach)) / size;
+    const vec3 high = (record.position + vec3(reach)) / size;
+    for (auto z = static_cast<int64_t>(std::floor(low.z)); z <= static_cast<int64_t>(std::floor(high.z)); z++)
+        for (auto y = static_cast<int64_t>(std::floor(low.y)); y <= static_cast<int64_t>(std::floor(high.y)); y++)
+            for (auto x = static_cast<int64_t>(std::floor(low.x)); x <= static_cast<int64_t>(std::floor(high.x)); x++) {
+                // Twice as many slots once half are used
+                if (2 * (cell_count + 1) > cell_keys.size()) {
+                    auto keys = std::move(cell_keys);
+                    auto lists = std::move(cell_records);
+                    cell_keys.assign(2 * keys.size(), EMPTY_CELL);
+                    cell_records = std::vector<std::vector<uint32_t> >(2 * keys.size());
+                    for (size_t i = 0; i < keys.size(); i++) {
+                        if (keys[i] == EMPTY_CELL)
+                            continue;
+                        const size_t slot = findSlot(keys[i]);
+                        cell_keys[slot] = keys[i];
+                        cell_records[slot] = std::move(lists[i]);
+                    }
+                }
+
+                const uint64_t key = PackCell(level, x, y, z);
+                const size_t slot = findSlot(key);
+                if (cell_keys[slot] == EMPTY_CELL) {
+                    cell_keys[slot] = key;
+                    cell_count++;
+                }
+                cell_records[slot].push_back(index);
+            }
+}
+
+bool IrradianceCache::lookup(const vec3 &position, const vec3 &normal, vec3 &irradiance) const {
+    vec3 sum{0};
+    float weights = 0;
+    float size = cell_size;
+    for (int level = 0; level < LEVELS; level++, size *= 0.5f) {
+        if ((used_levels >> level & 1u) == 0)
+            continue;
+
+        const size_t slot = findSlot(PackCell(level, static_cast<int64_t>(std::floor(position.x / size)),
+                                              static_cast<int64_t>(std::floor(position.y / size)),
+                                              static_cast<int64_t>(std::floor(position.z / size))));
+        if (cell_keys[slot] == EMPTY_CELL)
+            continue;
+
+        for (const auto index: cell_records[slot]) {
+            // Out of reach, checked from the compact bounds before reading the record
+            const vec4 &bound = bounds[index];
+            const vec3 offset = position - vec3(bound.x, bound.y, bound.z);
+            const float distance2 = length2(offset);
+            if (distance2 >= bound.w)
+                continue;
+
+            // Ward's error estimate, the record is only used below the accuracy
+            const RT_IRRADIANCE_RECORD &record = records[index];
+            const float turn = std::max(0.0f, 1.0f - dot(normal, record.normal));
+            if (turn >= accuracy * accuracy)
+                continue;
+            const float error = std::sqrt(distance2) / record.radius + std::sqrt(turn);
+            if (error >= accuracy)
+                continue;
+
+            // Points in front of the record see surfaces it did not
+            if (dot(offset, normal + record.normal) < -0.1f * record.radius)
+                continue;
+
+            // Extrapolated to the point with the gradients
+            const vec3 rotation = cross(record.normal, normal);
+            vec3 extrapolated = record.irradiance;
+            for (int c = 0; c < 3; c++)
+                extrapolated[c] = std::max(0.0f, extrapolated[c] + dot(rotation, record.rotational_gradient[c]) +
+                                                 dot(offset, record.translational_gradient[c]));
+
+            const float weight = 1.0f / std::max(error, 1e-6f);
+            sum += weight * extrapolated;
+            weights += weight;
+        }
+    }
+
+    if (weights == 0)
+        return false;
+
+    irradiance = sum / weights;
+    return true;
+}
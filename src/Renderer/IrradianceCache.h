@@ -0,0 +1,209 @@
+#ifndef IRRADIANCECACHE_H
+#define IRRADIANCECACHE_H
+#include <Utils/Headers.h>
+#include <vector>
+
+/**
+ * Settings of the irradiance cache a renderer builds before rendering, see IrradianceCache.
+ */
+struct RT_IRRADIANCE_CACHE {
+    /// Whether renders build and use an irradiance cache. Off renders plain path tracing.
+    bool enabled = false;
+
+    /// Largest interpolation error a record is used with (Ward's a). Smaller values place more records.
+    float accuracy = 0.3f;
+
+    /// Strata along the polar angle of a record's hemisphere. There are about pi times as many along the azimuth.
+    int theta_strata = 8;
+
+    /// Smallest record radius, in world units, 0 to derive it from the scene.
+    float min_spacing = 0;
+
+    /// Largest record radius, in world units, 0 to derive it from the scene.
+    float max_spacing = 0;
+};
+
+/**
+ * Cached irradiance at one point of a surface, with its gradients.
+ * Irradiance is stored divided by pi, as the cosine weighted mean of incoming radiance, so that a Lambertian surface
+ * of albedo c reflects c * irradiance.
+ */
+struct RT_IRRADIANCE_RECORD {
+    /// Point the irradiance was gathered at.
+    vec3 position;
+
+    /// Surface normal at position.
+    vec3 normal;
+
+    /// Irradiance over pi, per color channel.
+    vec3 irradiance;
+
+    /// Harmonic mean distance to the surfaces seen from position, clamped to the cache's spacing.
+    float radius;
+
+    /// Change of each channel's irradiance as the normal rotates, Ward and Heckbert's rotational gradient.
+    vec3 rotational_gradient[3];
+
+    /// Change of each channel's irradiance as position moves along the surface, their translational gradient.
+    vec3 translational_gradient[3];
+};
+
+/**
+ * Sparse irradiance records over the scene's surfaces, interpolated between (Ward's irradiance caching).
+ * Every material is Lambertian, so indirect light changes slowly across surfaces and a record gathered with many rays
+ * stands in for every path bouncing nearby. Records are found through hashed grids nested like an octree: each level
+ * halves the cell size of the one above, and a record is listed in the finest level whose cells span its reach, so
+ * a lookup only walks records of about its cell's size. The cache is filled before rendering; lookups are read-only
+ * and safe from any number of threads.
+ */
+class IrradianceCache final {
+    /// Largest interpolation error a record is used with.
+    float accuracy;
+
+    /// Smallest record radius.
+    float min_spacing;
+
+    /// Largest record radius.
+    float max_spacing;
+
+    /// Width of a cell of the coarsest grid level, twice the reach of the largest record.
+    float cell_size;
+
+    /// Bit l is set when level l lists any record.
+    uint32_t used_levels = 0;
+
+    /// Every record, in insertion order.
+    std::vector<RT_IRRADIANCE_RECORD> records{};
+
+    /// Position (x, y, z) and squared reach (w) of every record, checked before the record itself is read.
+    std::vector<vec4> bounds{};
+
+    /// Level and packed coordinates of the grid cell in each slot, or EMPTY_CELL. Open addressing, probed linearly.
+    std::vector<uint64_t> cell_keys{};
+
+    /// Records reaching into the grid cell in each slot.
+    std::vector<std::vector<uint32_t> > cell_records{};
+
+    /// Number of slots holding a cell, kept below half of the slots.
+    size_t cell_count = 0;
+
+    /// Key of free slots, never made by a cell.
+    static constexpr uint64_t EMPTY_CELL = ~uint64_t{0};
+
+    /// Slot holding a cell, or the free slot it would go in.
+    [[nodiscard]] size_t findSlot(uint64_t key) const;
+
+public:
+    /// Number of grid levels. Records reaching less than the finest cell are listed there.
+    static constexpr int LEVELS = 8;
+
+    // Constructors
+    /**
+     * Makes an empty cache.
+     * @param accuracy Largest interpolation error a record is used with, in (0, 1].
+     * @param min_spacing Smallest record radius, positive.
+     * @param max_spacing Largest record radius, at least min_spacing.
+     *
+     * @note Test Cases:\n
+     * IrradianceCache(0.3, 0.1, 2) -> empty cache\n
+     * IrradianceCache(0, 0.1, 2) -> ERROR: will throw an IrradianceCacheException (accuracy out of range)\n
+     * IrradianceCache(0.3, 2, 0.1) -> ERROR: will throw an IrradianceCacheException (invalid spacing)\n
+     */
+    IrradianceCache(float accuracy, float min_spacing, float max_spacing);
+
+    // Methods
+    /**
+     * Gets the direction of one hemisphere sample of a record.
+     * The hemisphere is split into theta_strata x phi_strata cells of equal cosine weighted area, and (u, v) places
+     * the sample inside its cell. Sampling each cell once with random (u, v) gives cosine weighted directions.
+     * @param normal Surface normal, normalized.
+     * @param theta_strata Strata along the polar angle.
+     * @param phi_strata Strata along the azimuth.
+     * @param j Polar stratum, in [0, theta_strata).
+     * @param k Azimuthal stratum, in [0, phi_strata).
+     * @param u Position inside the cell along the polar angle, in [0, 1).
+     * @param v Position inside the cell along the azimuth, in [0, 1).
+     * @return Unit direction on the hemisphere around normal.
+     *
+     * @note Test Cases:\n
+     * IrradianceCache::getSampleDirection(n, 8, 25, j, k, u, v) -> unit length, dot(direction, n) >= 0\n
+     * IrradianceCache::getSampleDirection(n, 8, 25, 0, 0, 0, 0) -> n\n
+     */
+    static vec3 getSampleDirection(const vec3 &normal, int theta_strata, int phi_strata, int j, int k, float u,
+                                   float v);
+
+    /**
+     * Makes a record from the radiance seen through every cell of the hemisphere, with its radius clamped to the
+     * cache's spacing. The translational gradient is scaled down with the radius when the radius is raised to
+     * min_spacing, so records in corners do not extrapolate past what they saw.
+     * @param position Point the hemisphere was sampled from.
+     * @param normal Surface normal at position, normalized.
+     * @param theta_strata Strata along the polar angle.
+     * @param phi_strata Strata along the azimuth.
+     * @param radiance Radiance seen through cell (j, k) at index j * phi_strata + k.
+     * @param distance Distance to the surface seen through each cell, infinity for the sky.
+     * @return Record holding the irradiance and its gradients.
+     *
+     * @note Test Cases:\n
+     * cache.makeRecord(p, n, 8, 25, uniform radiance, distances) -> irradiance is that radiance, zero gradients\n
+     * cache.makeRecord(p, n, 8, 25, radiance, distances with infinity) -> radius is max_spacing when everything is sky\n
+     * cache.makeRecord(p, n, 8, 25, too few samples, distances) -> ERROR: will throw an IrradianceCacheException\n
+     */
+    [[nodiscard]] RT_IRRADIANCE_RECORD makeRecord(const vec3 &position, const vec3 &normal, int theta_strata,
+                                                  int phi_strata, const std::vector<vec3> &radiance,
+                                                  const std::vector<float> &distance) const;
+
+    /**
+     * Adds a record to the cache. Not thread-safe, nothing may look up records while one is added.
+     * @param record Record made by makeRecord().
+     *
+     * @note Test Cases:\n
+     * cache.add(record) -> size() grows by one, lookup() at record.position finds it\n
+     */
+    void add(const RT_IRRADIANCE_RECORD &record);
+
+    /**
+     * Interpolates the irradiance at a point from the records covering it.
+     * A record covers a point when |position - record.position| / record.radius + sqrt(1 - normal . record.normal)
+     * is below the accuracy and the point is not in front of it. Each covering record is extrapolated with its
+     * gradients and weighted by the inverse of that error.
+     * @param position Point on a surface.
+     * @param normal Surface normal at position, normalized.
+     * @param irradiance Interpolated irradiance over pi, set when a record covers the point.
+     * @return Whether any record covers the point.
+     *
+     * @note Test Cases:\n
+     * cache.lookup(record.position, record.normal, e) -> true, e is record.irradiance\n
+     * cache.lookup(point far away, n, e) -> false, e untouched\n
+     * cache.lookup(record.position, -record.normal, e) -> false\n
+     */
+    bool lookup(const vec3 &position, const vec3 &normal, vec3 &irradiance) const;
+
+    // Getters
+    /// Gets the number of records in the cache.
+    [[nodiscard]] size_t size() const {
+        return records.size();
+    }
+
+    /// Gets a record of the cache.
+    [[nodiscard]] const RT_IRRADIANCE_RECORD &get_record(const size_t index) const {
+        return records[index];
+    }
+
+    /// Gets the largest interpolation error a record is used with.
+    [[nodiscard]] float get_accuracy() const {
+        return accuracy;
+    }
+
+    /// Gets the smallest record radius.
+    [[nodiscard]] float get_min_spacing() const {
+        return min_spacing;
+    }
+
+    /// Gets the largest record radius.
+    [[nodiscard]] float get_max_spacing() const {
+        return max_spacing;
+    }
+};
+
+#endif //IRRADIANCECACHE_H
@@ -0,0 +1,289 @@
+#include "PathGuide.h"
+#include <algorithm>
+
+namespace {
+    constexpr float PI = 3.14159265f;
+
+    /// Largest float below 1, keeping points of the square inside it.
+    constexpr float ONE_MINUS_EPSILON = 0x1.fffffep-1f;
+
+    /// Point of the unit square a direction maps to: x follows its z component, y its angle around z.
+    void ToSquare(const vec3 &direction, float &x, float &y) {
+        const float cos_theta = std::clamp(direction.z, -1.0f, 1.0f);
+        const float phi = std::atan2(direction.y, direction.x);
+        x = std::clamp(0.5f * (cos_theta + 1.0f), 0.0f, ONE_MINUS_EPSILON);
+        y = std::clamp(phi / (2.0f * PI) + 0.5f, 0.0f, ONE_MINUS_EPSILON);
+    }
+
+    /// Direction a point of the unit square maps to, covering equal solid angles for equal areas.
+    vec3 FromSquare(const float x, const float y) {
+        const float cos_theta = 2.0f * x - 1.0f;
+        const float sin_theta = std::sqrt(std::max(0.0f, 1.0f - cos_theta * cos_theta));
+        const float phi = 2.0f * PI * (y - 0.5f);
+        return {sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta};
+    }
+
+    /// Quadrant of a node's square holding a point, moving the point into the quadrant's own square.
+    int EnterQuadrant(float &x, float &y) {
+        const int right = x >= 0.5f;
+        const int top = y >= 0.5f;
+        x = 2.0f * x - static_cast<float>(right);
+        y = 2.0f * y - static_cast<float>(top);
+        return right + 2 * top;
+    }
+
+    /// Adds to an atomic float without locking, retrying when another thread added first.
+    void AtomicAdd(std::atomic<float> &target, const float value) {
+        float current = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * Copies a quadtree node into out with the given quadrant energies, then its children: a quadrant holding more
+     * than threshold is split, keeping the old tree's energies below it when it had any and spreading its own evenly
+     * otherwise. Quadrants at or below the threshold become leaves, pruning what the old tree had there.
+     * @return Index of the copy in out.
+     */
+    uint32_t Rebuild(const std::vector<RT_DIRECTION_NODE> &old, const int old_node, const float energy[4],
+                     const int depth, const float threshold, std::vector<RT_DIRECTION_NODE> &out) {
+        const auto index = static_cast<uint32_t>(out.size());
+        out.push_back({});
+        std::copy(energy, energy + 4, out[index].energy);
+
+        for (int c = 0; c < 4; c++) {
+            if (depth >= PathGuide::MAX_DEPTH || energy[c] <= threshold)
+                continue;
+
+            const int old_child = old_node >= 0 && old[old_node].child[c] != 0
+                                      ? static_cast<int>(old[old_node].child[c])
+                                      : -1;
+            float split[4];
+            if (old_child >= 0)
+                std::copy(old[old_child].energy, old[old_child].energy + 4, split);
+            else
+                std::fill(split, split + 4, 0.25f * energy[c]);
+
+            const uint32_t child = Rebuild(old, old_child, split, depth + 1, threshold, out);
+            out[index].child[c] = child;
+        }
+
+        return index;
+    }
+
+    /// Copies a quadtree node and everything below it into out. @return Index of the copy in out.
+    uint32_t CopyTree(const std::vector<RT_DIRECTION_NODE> &old, const uint32_t node,
+                      std::vector<RT_DIRECTION_NODE> &out) {
+        const auto index = static_cast<uint32_t>(out.size());
+        out.push_back(old[node]);
+        for (int c = 0; c < 4; c++) {
+            if (old[node].child[c] != 0) {
+                const uint32_t child = CopyTree(old, old[node].child[c], out);
+                out[index].child[c] = child;
+            }
+        }
+
+        return index;
+    }
+}
+
+PathGuide::PathGuide(const vec3 &minimum, const vec3 &maximum) {
+    // Ensure the box is finite
+    if (!is_finite(minimum.x) || !is_finite(minimum.y) || !is_finite(minimum.z) || !is_finite(maximum.x) ||
+        !is_finite(maximum.y) || !is_finite(maximum.z))
+        throw PathGuideException("PathGuide::PathGuide(): box must be finite");
+
+    // Ensure the corners are ordered
+    if (minimum.x > maximum.x || minimum.y > maximum.y || minimum.z > maximum.z)
+        throw PathGuideException("PathGuide::PathGuide(): minimum cannot exceed maximum");
+
+    // Cube around the box, slightly larger so points on its faces fall inside
+    const vec3 size = maximum - minimum;
+    const float largest = std::max(size.x, std::max(size.y, size.z));
+    extent = largest > 0 ? 1.01f * largest : 1.0f;
+    origin = 0.5f * (minimum + maximum) - vec3(0.5f * extent);
+
+    spatial.push_back({{0, 0}, 0, 0});
+    nodes.assign(NORMAL_BINS, RT_DIRECTION_NODE{});
+    for (uint32_t bin = 0; bin < NORMAL_BINS; bin++)
+        roots.push_back(bin);
+    resetRecording();
+}
+
+void PathGuide::resetRecording() {
+    // Atomics are not copyable, so the arrays are replaced rather than resized
+    recorded = std::vector<std::atomic<float> >(4 * nodes.size());
+    for (auto &energy: recorded)
+        energy.store(0, std::memory_order_relaxed);
+    visits = std::vector<std::atomic<uint32_t> >(roots.size());
+    for (auto &count: visits)
+        count.store(0, std::memory_order_relaxed);
+}
+
+uint32_t PathGuide::findRegion(const vec3 &position, const vec3 &normal) const {
+    // Position inside the cube, scaled to [0, 1) and rescaled to each node's half on the way down
+    const vec3 scaled = (position - origin) / extent;
+    float point[3] = {
+        std::clamp(scaled.x, 0.0f, ONE_MINUS_EPSILON),
+        std::clamp(scaled.y, 0.0f, ONE_MINUS_EPSILON),
+        std::clamp(scaled.z, 0.0f, ONE_MINUS_EPSILON)
+    };
+
+    uint32_t node = 0;
+    while (spatial[node].child[0] != 0) {
+        float &coordinate = point[spatial[node].axis];
+        const int upper = coordinate >= 0.5f;
+        coordinate = 2.0f * coordinate - static_cast<float>(upper);
+        node = spatial[node].child[upper];
+    }
+
+    // Axis the normal points most along, then its sign
+    const vec3 magnitude(std::fabs(normal.x), std::fabs(normal.y), std::fabs(normal.z));
+    const int axis = magnitude.x >= magnitude.y && magnitude.x >= magnitude.z ? 0 : magnitude.y >= magnitude.z ? 1 : 2;
+    return spatial[node].region + static_cast<uint32_t>(2 * axis + (normal[axis] < 0));
+}
+
+vec3 PathGuide::sample(const uint32_t region, float u, const float v, float &density) const {
+    if (!is_trained(region)) {
+        density = 1.0f / (4.0f * PI);
+        return FromSquare(u, v);
+    }
+
+    // Walk down the quadtree picking quadrants by energy, reusing what is left of u inside the chosen quadrant
+    float x = 0, y = 0, size = 1;
+    density = 1.0f / (4.0f * PI);
+    uint32_t node = roots[region];
+    for (;;) {
+        const float *energy = nodes[node].energy;
+        const float target = u * (energy[0] + energy[1] + energy[2] + energy[3]);
+        int c = 0;
+        float below = 0;
+        while (c < 3 && below + energy[c] <= target) {
+            below += energy[c];
+            c++;
+        }
+
+        // Rounding can run past the last quadrant with energy
+        while (energy[c] <= 0 && c > 0) {
+            c--;
+            below -= energy[c];
+        }
+        u = energy[c] > 0 ? std::clamp((target - below) / energy[c], 0.0f, ONE_MINUS_EPSILON) : 0.5f;
+        density *= 4.0f * energy[c] / (energy[0] + energy[1] + energy[2] + energy[3]);
+
+        size *= 0.5f;
+        x += static_cast<float>(c % 2) * size;
+        y += static_cast<float>(c / 2) * size;
+        if (nodes[node].child[c] == 0)
+            break;
+        node = nodes[node].child[c];
+    }
+
+    return FromSquare(x + u * size, y + v * size);
+}
+
+float PathGuide::pdf(const uint32_t region, const vec3 &direction) const {
+    if (!is_trained(region))
+        return 1.0f / (4.0f * PI);
+
+    // Each level picks its quadrant with the quadrant's share of the energy, from a quarter of the area
+    float x, y;
+    ToSquare(direction, x, y);
+    float density = 1;
+    uint32_t node = roots[region];
+    for (;;) {
+        const float *energy = nodes[node].energy;
+        const int c = EnterQuadrant(x, y);
+        if (energy[c] <= 0)
+            return 0;
+        density *= 4.0f * energy[c] / (energy[0] + energy[1] + energy[2] + energy[3]);
+        if (nodes[node].child[c] == 0)
+            break;
+        node = nodes[node].child[c];
+    }
+
+    return density / (4.0f * PI);
+}
+
+void PathGuide::record(const uint32_t region, const vec3 &direction, const float radiance) {
+    visits[region].fetch_add(1, std::memory_order_relaxed);
+    if (!(radiance > 0) || !is_finite(radiance))
+        return;
+
+    float x, y;
+    ToSquare(direction, x, y);
+    uint32_t node = roots[region];
+    for (;;) {
+        const int c = EnterQuadrant(x, y);
+        if (nodes[node].child[c] == 0) {
+            AtomicAdd(recorded[4 * node + c], radiance);
+            return;
+        }
+        node = nodes[node].child[c];
+    }
+}
+
+void PathGuide::refine(const size_t split_visits) {
+    // Leaf quadrants take the recorded energy, inner ones the sum of their children. Children always follow
+    // their parent, so a backwards sweep sees every child before its parent.
+    std::vector<RT_DIRECTION_NODE> measured = nodes;
+    for (size_t n = measured.size(); n-- > 0;) {
+        for (int c = 0; c < 4; c++) {
+            const uint32_t child = measured[n].child[c];
+            measured[n].energy[c] = child == 0
+                                        ? recorded[4 * n + c].load(std::memory_order_relaxed)
+                                        : measured[child].energy[0] + measured[child].energy[1] +
+                                          measured[child].energy[2] + measured[child].energy[3];
+        }
+    }
+
+    // Busy leaves are halved until each half expects at most split_visits bounces. Both halves' regions are rebuilt
+    // from what the leaf's regions measured.
+    std::vector<uint32_t> sources = roots;
+    std::vector<std::pair<uint32_t, double> > pending;
+    for (uint32_t n = 0; n < spatial.size(); n++) {
+        if (spatial[n].child[0] != 0)
+            continue;
+        double count = 0;
+        for (int bin = 0; bin < NORMAL_BINS; bin++)
+            count += visits[spatial[n].region + bin].load(std::memory_order_relaxed);
+        pending.emplace_back(n, count);
+    }
+
+    while (!pending.empty()) {
+        const auto [node, count] = pending.back();
+        pending.pop_back();
+        if (count <= static_cast<double>(split_visits))
+            continue;
+
+        const auto first = static_cast<uint32_t>(spatial.size());
+        const int axis = (spatial[node].axis + 1) % 3;
+        const auto copy = static_cast<uint32_t>(sources.size());
+        for (int bin = 0; bin < NORMAL_BINS; bin++) {
+            const uint32_t source = sources[spatial[node].region + bin];
+            sources.push_back(source);
+        }
+        spatial.push_back({{0, 0}, axis, spatial[node].region});
+        spatial.push_back({{0, 0}, axis, copy});
+        spatial[node].child[0] = first;
+        spatial[node].child[1] = first + 1;
+        pending.emplace_back(first, 0.5 * count);
+        pending.emplace_back(first + 1, 0.5 * count);
+    }
+
+    // Regions no light reached keep what they learned before
+    std::vector<RT_DIRECTION_NODE> rebuilt;
+    rebuilt.reserve(nodes.size());
+    roots.resize(sources.size());
+    for (size_t region = 0; region < sources.size(); region++) {
+        const float *energy = measured[sources[region]].energy;
+        const float total = energy[0] + energy[1] + energy[2] + energy[3];
+        roots[region] = total > 0 && is_finite(total)
+                            ? Rebuild(measured, static_cast<int>(sources[region]), energy, 1,
+                                      SPLIT_FRACTION * total, rebuilt)
+                            : CopyTree(nodes, sources[region], rebuilt);
+    }
+    nodes = std::move(rebuilt);
+
+    resetRecording();
+}
@@ -0,0 +1,187 @@
+#ifndef PATHGUIDE_H
+#define PATHGUIDE_H
+#include <Utils/Headers.h>
+#include <atomic>
+#include <vector>
+
+/**
+ * Settings of the path guide a renderer trains before rendering, see PathGuide.
+ */
+struct RT_PATH_GUIDING {
+    /// Whether renders train and use a path guide. Off renders plain path tracing.
+    bool enabled = false;
+
+    /// Training passes rendered before the image, with 1, 2, 4, ... samples per pixel, averaged into the image.
+    int training_passes = 5;
+
+    /// Probability of sampling a bounce from the learned distribution instead of the cosine lobe, in [0, 1).
+    float guided_fraction = 0.5f;
+};
+
+/**
+ * Node of a directional quadtree, splitting its square of directions into four quadrants.
+ * Quadrant c covers x in [c % 2, c % 2 + 1) / 2 and y in [c / 2, c / 2 + 1) / 2 of the node's square.
+ */
+struct RT_DIRECTION_NODE {
+    /// Radiance arriving through each quadrant.
+    float energy[4];
+
+    /// Node splitting each quadrant further, 0 when the quadrant is a leaf.
+    uint32_t child[4];
+};
+
+/**
+ * Learned distribution of the light arriving at the scene's surfaces, sampled to aim bounces where light comes from
+ * (Müller et al.'s practical path guiding). Space is split by a binary tree, halving a cell along x, y then z
+ * wherever many paths bounce. Each cell holds one region per direction a surface normal mostly points along (+x, -x,
+ * +y, ... -z), so surfaces facing different ways do not learn light from below each other's horizon. Each region
+ * holds a quadtree over the sphere of directions, mapped to a square with equal areas, splitting a quadrant wherever
+ * more than a hundredth of the region's light arrives through it.
+ * Training passes record the light paths found into the guide, then refine() rebuilds both trees from it. Recording
+ * only adds to atomics, so every render thread records at once without locks. Sampling is read-only.
+ */
+class PathGuide final {
+    /// Node of the spatial tree.
+    struct SpatialNode {
+        /// Halves of the node, 0 when it is a leaf.
+        uint32_t child[2];
+
+        /// Axis the node is halved along.
+        int axis;
+
+        /// First of the NORMAL_BINS regions of a leaf.
+        uint32_t region;
+    };
+
+    /// Lowest corner of the cube split by the spatial tree.
+    vec3 origin;
+
+    /// Width of the cube split by the spatial tree.
+    float extent;
+
+    /// Spatial tree, rooted at node 0.
+    std::vector<SpatialNode> spatial{};
+
+    /// Nodes of every region's directional quadtree, each tree stored contiguously, parents before children.
+    std::vector<RT_DIRECTION_NODE> nodes{};
+
+    /// Root node of every region's quadtree.
+    std::vector<uint32_t> roots{};
+
+    /// Radiance recorded through each leaf quadrant of every node since the last refine(), 4 per node.
+    std::vector<std::atomic<float> > recorded{};
+
+    /// Bounces recorded in every region since the last refine().
+    std::vector<std::atomic<uint32_t> > visits{};
+
+    /// Clears the recorded radiance and visits, sized to the current quadtrees.
+    void resetRecording();
+
+public:
+    /// Regions of a spatial cell, one per signed axis a normal mostly points along.
+    static constexpr int NORMAL_BINS = 6;
+
+    /// Deepest level of a directional quadtree.
+    static constexpr int MAX_DEPTH = 12;
+
+    /// Share of a region's light a quadrant needs to be split.
+    static constexpr float SPLIT_FRACTION = 0.01f;
+
+    // Constructors
+    /**
+     * Makes an untrained guide over a box: a single cell, sampling every direction equally.
+     * Points outside the box use the region nearest to them.
+     * @param minimum Lowest corner of the box.
+     * @param maximum Highest corner of the box.
+     *
+     * @note Test Cases:\n
+     * PathGuide(vec3(-1), vec3(1)) -> NORMAL_BINS regions, untrained\n
+     * PathGuide(vec3(1), vec3(-1)) -> ERROR: will throw a PathGuideException (minimum above maximum)\n
+     */
+    PathGuide(const vec3 &minimum, const vec3 &maximum);
+
+    // Methods
+    /**
+     * Finds the region holding a surface point.
+     * @param position Point in the scene.
+     * @param normal Surface normal at position.
+     * @return Index of the region's directional distribution.
+     *
+     * @note Test Cases:\n
+     * guide.findRegion(p, n) -> in [0, get_region_count())\n
+     * guide.findRegion(p, n) != guide.findRegion(p, -n)\n
+     */
+    [[nodiscard]] uint32_t findRegion(const vec3 &position, const vec3 &normal) const;
+
+    /**
+     * Samples a direction from the light a region learned to arrive from.
+     * @param region Region found by findRegion().
+     * @param u Random number in [0, 1).
+     * @param v Random number in [0, 1).
+     * @param density Set to pdf(region, direction), found on the way down without mapping the direction back.
+     * @return Unit direction, uniform over the sphere when the region is untrained.
+     *
+     * @note Test Cases:\n
+     * guide.sample(region, u, v, density) -> unit length, density == pdf(region, direction) > 0\n
+     */
+    [[nodiscard]] vec3 sample(uint32_t region, float u, float v, float &density) const;
+
+    /**
+     * Gets the density sample() draws a direction with.
+     * @param region Region found by findRegion().
+     * @param direction Unit direction.
+     * @return Density per steradian, 1 / 4pi everywhere when the region is untrained.
+     *
+     * @note Test Cases:\n
+     * guide.pdf(region, direction) -> integrates to 1 over the sphere\n
+     */
+    [[nodiscard]] float pdf(uint32_t region, const vec3 &direction) const;
+
+    /**
+     * Records light arriving at a region. Safe to call from any number of threads at once.
+     * @param region Region found by findRegion().
+     * @param direction Unit direction the light arrives from.
+     * @param radiance Radiance arriving, averaged over the color channels, weighted by the cosine to the surface
+     * normal and divided by the density its direction was sampled with: the Monte Carlo estimate of the light the
+     * direction contributes, so the guide learns the product of incident light and the cosine term.
+     *
+     * @note Test Cases:\n
+     * guide.record(region, direction, 1) -> refine() makes directions near direction likelier\n
+     */
+    void record(uint32_t region, const vec3 &direction, float radiance);
+
+    /**
+     * Ends a training pass: rebuilds each region's quadtree from the light recorded in it, then splits cells with
+     * more than split_visits recorded bounces, assuming the bounces are spread evenly across them. Regions that
+     * recorded no light keep their distribution. Not thread-safe, nothing may sample or record meanwhile.
+     * @param split_visits Recorded bounces above which a cell is halved.
+     *
+     * @note Test Cases:\n
+     * guide.refine(1000) after 4000 recorded bounces in the only cell -> 4 cells, the recorded region trained\n
+     */
+    void refine(size_t split_visits);
+
+    // Getters
+    /// Gets whether a region learned a distribution, rather than sampling every direction equally.
+    [[nodiscard]] bool is_trained(const uint32_t region) const {
+        const float *energy = nodes[roots[region]].energy;
+        return energy[0] + energy[1] + energy[2] + energy[3] > 0;
+    }
+
+    /// Gets the number of regions, NORMAL_BINS per cell space is split into.
+    [[nodiscard]] size_t get_region_count() const {
+        return roots.size();
+    }
+
+    /// Gets the root node of a region's directional quadtree.
+    [[nodiscard]] uint32_t get_root(const uint32_t region) const {
+        return roots[region];
+    }
+
+    /// Gets a node of the directional quadtrees, children are indices into the same nodes.
+    [[nodiscard]] const RT_DIRECTION_NODE &get_node(const uint32_t index) const {
+        return nodes[index];
+    }
+};
+
+#endif //PATHGUIDE_H
@@ -0,0 +1,168 @@
+#include "PixelStorage.h"
+#include <cstring>
+
+// F16C kernels are compiled for x86-64 regardless of the build's target and only called when the processor has them
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BLUNDER_F16C_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace {
+    uint32_t FloatBits(const float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float BitsFloat(const uint32_t bits) {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    /// Clamps to [0, max], (v > 0 ? v : 0) also maps NaN to zero.
+    float Saturate(const float value, const float max) {
+        return std::min(value > 0 ? value : 0.0f, max);
+    }
+
+    /**
+     * Half float of a value in [0, HALF_MAX], rounded to nearest even (F. Giesen, float_to_half_fast3_rtne).
+     * Both branches are computed and one is selected, so loops over it vectorize.
+     */
+    uint16_t EncodeHalf(const float value) {
+        const uint32_t bits = FloatBits(value);
+
+        // Subnormal halves: adding 0.5 lines the half's mantissa up with the low bits of the float's, the FPU rounds
+        const uint32_t denorm_magic = ((127 - 15) + (23 - 10) + 1) << 23;
+        const uint32_t subnormal = FloatBits(value + BitsFloat(denorm_magic)) - denorm_magic;
+
+        // Normal halves: rebias the exponent, round to nearest even on the 13 dropped bits
+        const uint32_t mantissa_odd = (bits >> 13) & 1;
+        const uint32_t normal = (bits + (static_cast<uint32_t>(15 - 127) << 23) + 0xfff + mantissa_odd) >> 13;
+
+        return static_cast<uint16_t>(bits < (113u << 23) ? subnormal : normal);
+    }
+
+    /// Float of a half without a sign bit set, exactly (F. Giesen, half_to_float_fast4 without infinities).
+    float DecodeHalf(const uint16_t half) {
+        const uint32_t shifted = static_cast<uint32_t>(half & 0x7fff) << 13;
+        const uint32_t normal = shifted + (static_cast<uint32_t>(127 - 15) << 23);
+
+        // Subnormal halves: give them the smallest normal exponent, then take that exponent's implicit one away
+        const float magic = BitsFloat(113u << 23);
+        const float subnormal = BitsFloat(normal + (1u << 23)) - magic;
+
+        return (shifted & (0x1fu << 23)) == 0 ? subnormal : BitsFloat(normal);
+    }
+
+    /// 2^exponent for exponents in the normal float range.
+    float Power2(const int exponent) {
+        return BitsFloat(static_cast<uint32_t>(exponent + 127) << 23);
+    }
+
+#ifdef BLUNDER_F16C_DISPATCH
+    /// Whether the processor converts half floats in hardware, checked once.
+    bool HasF16C() {
+        static const bool supported = __builtin_cpu_supports("f16c") && __builtin_cpu_supports("avx");
+        return supported;
+    }
+
+    /// Encodes eight values at a time in hardware, max with zero first also maps NaN to zero. Returns how many it did.
+    __attribute__((target("f16c,avx"))) size_t EncodeHalfF16C(const float *in, const size_t count, uint16_t *out) {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 max = _mm256_set1_ps(HALF_MAX);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256 values = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i), zero), max);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT));
+        }
+        return i;
+    }
+
+    /// Decodes eight values at a time in hardware. Returns how many it did.
+    __attribute__((target("f16c,avx"))) size_t DecodeHalfF16C(const uint16_t *in, const size_t count, float *out) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))));
+        return i;
+    }
+#endif
+
+    constexpr int RGB9E5_MANTISSA_BITS = 9;
+    constexpr int RGB9E5_BIAS = 15;
+    constexpr int RGB9E5_MAX_EXPONENT = 31;
+}
+
+size_t pixel_storage_size(const PixelStorage storage) {
+    switch (storage) {
+        case PixelStorage::Half:
+            return 3 * sizeof(uint16_t);
+        case PixelStorage::RGB9E5:
+            return sizeof(uint32_t);
+        default:
+            return 3 * sizeof(float);
+    }
+}
+
+void encode_half(const float *in, const size_t count, uint16_t *out) {
+    size_t i = 0;
+
+#ifdef BLUNDER_F16C_DISPATCH
+    if (HasF16C())
+        i = EncodeHalfF16C(in, count, out);
+#endif
+
+    for (; i < count; i++)
+        out[i] = EncodeHalf(Saturate(in[i], HALF_MAX));
+}
+
+void decode_half(const uint16_t *in, const size_t count, float *out) {
+    size_t i = 0;
+
+#ifdef BLUNDER_F16C_DISPATCH
+    if (HasF16C())
+        i = DecodeHalfF16C(in, count, out);
+#endif
+
+    for (; i < count; i++)
+        out[i] = DecodeHalf(in[i]);
+}
+
+void encode_rgb9e5(const float *rgb, const size_t count, uint32_t *out) {
+    constexpr int mantissa_max = (1 << RGB9E5_MANTISSA_BITS) - 1;
+
+    // EXT_texture_shared_exponent: the brightest channel picks the exponent, the others share it
+    for (size_t i = 0; i < count; i++) {
+        const float r = Saturate(rgb[3 * i], RGB9E5_MAX);
+        const float g = Saturate(rgb[3 * i + 1], RGB9E5_MAX);
+        const float b = Saturate(rgb[3 * i + 2], RGB9E5_MAX);
+        const float brightest = std::max({r, g, b});
+
+        // floor(log2(brightest)) from the float's exponent field, zero and tiny values use the smallest exponent
+        const int log2 = static_cast<int>(FloatBits(brightest) >> 23) - 127;
+        int exponent = std::max(-RGB9E5_BIAS - 1, log2) + 1 + RGB9E5_BIAS;
+
+        // Rounding the brightest channel can carry into the next exponent
+        if (static_cast<int>(std::floor(brightest * Power2(RGB9E5_BIAS + RGB9E5_MANTISSA_BITS - exponent) + 0.5f)) >
+            mantissa_max)
+            exponent++;
+
+        const float scale = Power2(RGB9E5_BIAS + RGB9E5_MANTISSA_BITS - exponent);
+        const auto quantize = [&](const float value) {
+            return std::min(static_cast<uint32_t>(std::floor(value * scale + 0.5f)), static_cast<uint32_t>(mantissa_max));
+        };
+
+        out[i] = quantize(r) | quantize(g) << 9 | quantize(b) << 18 |
+                 static_cast<uint32_t>(std::min(exponent, RGB9E5_MAX_EXPONENT)) << 27;
+    }
+}
+
+void decode_rgb9e5(const uint32_t *in, const size_t count, float *rgb) {
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t packed = in[i];
+        const float scale = Power2(static_cast<int>(packed >> 27) - RGB9E5_BIAS - RGB9E5_MANTISSA_BITS);
+        rgb[3 * i] = static_cast<float>(packed & 0x1ff) * scale;
+        rgb[3 * i + 1] = static_cast<float>(packed >> 9 & 0x1ff) * scale;
+        rgb[3 * i + 2] = static_cast<float>(packed >> 18 & 0x1ff) * scale;
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef PIXELSTORAGE_H
+#define PIXELSTORAGE_H
+#include <Utils/Headers.h>
+
+/**
+ * Ways a render target can store its linear radiance. Smaller formats let very large frames fit in memory, at a
+ * bounded loss of precision. Radiance is non-negative, so neither compact format keeps a sign.
+ */
+enum class PixelStorage {
+    /// Three 32-bit floats per pixel (12 bytes), exact.
+    Float,
+
+    /// Three IEEE half floats per pixel (6 bytes): 11 significant bits, relative error below 2^-11, values saturate at
+    /// HALF_MAX.
+    Half,
+
+    /// Shared-exponent RGB9E5 (4 bytes): a 9-bit mantissa per channel and one 5-bit exponent. The brightest channel
+    /// keeps a relative error below 2^-9, dimmer channels an absolute error below 2^-10 of the brightest, values
+    /// saturate at RGB9E5_MAX.
+    RGB9E5
+};
+
+/// Largest value a half float holds, larger ones are stored as this.
+constexpr float HALF_MAX = 65504.0f;
+
+/// Largest value an RGB9E5 channel holds, larger ones are stored as this.
+constexpr float RGB9E5_MAX = 65408.0f;
+
+/**
+ * Gets the bytes a pixel takes in a storage format.
+ * @param storage Storage format.
+ * @return 12, 6 or 4.
+ *
+ * @note Test Cases:\n
+ * pixel_storage_size(PixelStorage::Half) -> 6\n
+ */
+size_t pixel_storage_size(PixelStorage storage);
+
+/**
+ * Converts floats to half floats, rounding to nearest even. Negative values and NaN become 0, values above HALF_MAX
+ * become HALF_MAX. Uses F16C instructions when the processor has them.
+ * @param in count floats.
+ * @param count Number of values.
+ * @param out count half floats.
+ *
+ * @note Test Cases:\n
+ * encode_half(1.0f) -> 0x3c00, encode_half(65536.0f) -> 0x7bff (HALF_MAX), encode_half(-1.0f) -> 0\n
+ */
+void encode_half(const float *in, size_t count, uint16_t *out);
+
+/**
+ * Converts half floats back to floats, exactly.
+ * @param in count half floats.
+ * @param count Number of values.
+ * @param out count floats.
+ *
+ * @note Test Cases:\n
+ * decode_half(encode_half(v)) -> v for every half float value v\n
+ */
+void decode_half(const uint16_t *in, size_t count, float *out);
+
+/**
+ * Converts interleaved RGB floats to RGB9E5, rounding to nearest. Negative values and NaN become 0, values above
+ * RGB9E5_MAX become RGB9E5_MAX.
+ * @param rgb 3 * count floats.
+ * @param count Number of pixels.
+ * @param out count packed pixels: red in bits 0-8, green 9-17, blue 18-26, exponent 27-31.
+ *
+ * @note Test Cases:\n
+ * encode_rgb9e5({1, 0.5, 0}) -> decodes to exactly {1, 0.5, 0}\n
+ */
+void encode_rgb9e5(const float *rgb, size_t count, uint32_t *out);
+
+/**
+ * Converts RGB9E5 pixels back to interleaved RGB floats.
+ * @param in count packed pixels.
+ * @param count Number of pixels.
+ * @param rgb 3 * count floats.
+ *
+ * @note Test Cases:\n
+ * Covered by encode_rgb9e5().\n
+ */
+void decode_rgb9e5(const uint32_t *in, size_t count, float *rgb);
+
+#endif //PIXELSTORAGE_H
@@ -0,0 +1,235 @@
+#include "PostProcess.h"
+#include <Utils/Profiler.h>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    /// Number of values converted per block, small enough to stay in L1.
+    constexpr size_t BLOCK_SIZE = 256;
+
+    /// Mantissa bits dropped when indexing the quantization table by a float's bit pattern.
+    constexpr int TABLE_SHIFT = 15;
+
+    /// Largest exposed value the curved operators see, where both have long reached white. Infinity would divide
+    /// infinities and turn NaN.
+    constexpr float TONE_MAP_MAX = 1e6f;
+
+    /// Bit pattern of 1.0f, the largest value reaching the quantizer.
+    constexpr uint32_t ONE_BITS = 0x3F800000;
+
+    /**
+     * Exact float -> byte quantizer for one transfer function.
+     * thresholds[k] is the smallest float encoding to byte k, found by bisection against the reference formula.
+     * buckets maps the top bits of a float to the byte at the bottom of its bucket; buckets are narrower than the
+     * gap between thresholds, so at most a single compare fixes up the result.
+     */
+    struct QuantizeTable {
+        /// Smallest float encoding to each byte, thresholds[256] is a +infinity sentinel.
+        float thresholds[257];
+
+        /// Byte at the lower edge of each bucket of floats sharing their top bits.
+        std::vector<unsigned char> buckets;
+    };
+
+    /// Bit pattern of a float.
+    uint32_t float_bits(const float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    /// Float with the given bit pattern.
+    float bits_float(const uint32_t bits) {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    /// Reference gamma 2 encoding, the arithmetic of the original writer.
+    int encode_gamma2(const float value) {
+        return static_cast<int>(255.999 * std::sqrt(value));
+    }
+
+    /// Reference exact sRGB encoding, quantized like gamma 2.
+    int encode_srgb(const float value) {
+        const double linear = value;
+        const double encoded = linear <= 0.0031308 ? 12.92 * linear : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+        return std::min(static_cast<int>(255.999 * encoded), 255);
+    }
+
+    /// Builds the quantizer for a monotonic reference encoding over [0, 1].
+    QuantizeTable build_quantize_table(int (*encode)(float)) {
+        QuantizeTable table{};
+        table.thresholds[0] = 0;
+        table.thresholds[256] = infinity;
+
+        // Non-negative floats order like their bit patterns, so bisect over the bits
+        for (int k = 1; k < 256; k++) {
+            uint32_t low = 0, high = ONE_BITS;
+            while (low < high) {
+                const uint32_t middle = low + (high - low) / 2;
+                if (encode(bits_float(middle)) >= k)
+                    high = middle;
+                else
+                    low = middle + 1;
+            }
+            table.thresholds[k] = bits_float(low);
+        }
+
+        // Byte at the lower edge of every bucket
+        table.buckets.resize((ONE_BITS >> TABLE_SHIFT) + 1);
+        int byte = 0;
+        for (uint32_t index = 0; index < table.buckets.size(); index++) {
+            const float lower = bits_float(index << TABLE_SHIFT);
+            while (lower >= table.thresholds[byte + 1])
+                byte++;
+            table.buckets[index] = static_cast<unsigned char>(byte);
+        }
+
+        return table;
+    }
+
+    /// Gets the (lazily built, shared) quantizer of a transfer function.
+    const QuantizeTable &quantize_table(const TransferFunction transfer_function) {
+        static const QuantizeTable gamma2 = build_quantize_table(encode_gamma2);
+        static const QuantizeTable srgb = build_quantize_table(encode_srgb);
+        return transfer_function == TransferFunction::SRGB ? srgb : gamma2;
+    }
+}
+
+PostProcess::PostProcess(const float exposure, const ToneMapping tone_mapping,
+                         const TransferFunction transfer_function) {
+    set_exposure(exposure);
+    set_tone_mapping(tone_mapping);
+    set_transfer_function(transfer_function);
+}
+
+void PostProcess::apply(const float *linear, const int width, const int height, unsigned char *out) const {
+    // Ensure buffers are not nullptr
+    if (linear == nullptr || out == nullptr)
+        throw PostProcessException("PostProcess::apply(): buffers cannot be nullptr");
+
+    // Ensure width and height are positive
+    if (width <= 0 || height <= 0)
+        throw PostProcessException("PostProcess::apply(): width and height must be positive");
+
+    BLUNDER_PROFILE_ZONE("Post process");
+
+    // Rows are independent, spread them across threads
+    const size_t row_size = static_cast<size_t>(width) * 3;
+    parallel_for(height, [&](const int begin, const int end) {
+        for (int y = begin; y < end; y++)
+            applyRow(linear + row_size * y, row_size, out + row_size * y);
+    }, 16);
+}
+
+void PostProcess::applyRow(const float *linear, const size_t count, unsigned char *out) const {
+    const QuantizeTable &table = quantize_table(transfer_function);
+    float values[BLOCK_SIZE];
+
+    for (size_t start = 0; start < count; start += BLOCK_SIZE) {
+        const size_t n = std::min(BLOCK_SIZE, count - start);
+        const float *in = linear + start;
+
+        // Exposure and tone mapping, one branch-free loop per operator
+        // (v > 0 ? v : 0) also maps NaN to zero
+        switch (tone_mapping) {
+            case ToneMapping::Clamp:
+                for (size_t i = 0; i < n; i++) {
+                    const float v = in[i] * exposure;
+                    values[i] = std::min(v > 0 ? v : 0.0f, 1.0f);
+                }
+                break;
+            case ToneMapping::Reinhard:
+                for (size_t i = 0; i < n; i++) {
+                    float v = in[i] * exposure;
+                    v = v > 0 ? v : 0.0f;
+                    v = v < TONE_MAP_MAX ? v : TONE_MAP_MAX;
+                    values[i] = v / (1.0f + v);
+                }
+                break;
+            case ToneMapping::ACES:
+                for (size_t i = 0; i < n; i++) {
+                    float v = in[i] * exposure;
+                    v = v > 0 ? v : 0.0f;
+                    v = v < TONE_MAP_MAX ? v : TONE_MAP_MAX;
+                    values[i] = (v * (2.51f * v + 0.03f)) / (v * (2.43f * v + 0.59f) + 0.14f);
+                }
+                break;
+        }
+
+        // Transfer function and quantization straight into the output bytes, exact against the reference encodings
+        // (the gamma 2 table reproduces the original writer byte for byte). Values are clamped into [0, 1] first, NaN
+        // to 0, so the bucket index always stays inside the table
+        unsigned char *o = out + start;
+        for (size_t i = 0; i < n; i++) {
+            float v = values[i];
+            v = v > 0 ? v : 0.0f;
+            v = v < 1.0f ? v : 1.0f;
+            int b = table.buckets[float_bits(v) >> TABLE_SHIFT];
+            b += v >= table.thresholds[b + 1];
+            o[i] = static_cast<unsigned char>(b);
+        }
+    }
+}
+
+ToneMapping PostProcess::parseToneMapping(const std::string &name) {
+    if (name == "clamp")
+        return ToneMapping::Clamp;
+    if (name == "reinhard")
+        return ToneMapping::Reinhard;
+    if (name == "aces")
+        return ToneMapping::ACES;
+
+    throw PostProcessException("PostProcess::parseToneMapping(): unknown tone mapping '" + name + "'");
+}
+
+TransferFunction PostProcess::parseTransferFunction(const std::string &name) {
+    if (name == "gamma2")
+        return TransferFunction::Gamma2;
+    if (name == "srgb")
+        return TransferFunction::SRGB;
+
+    throw PostProcessException("PostProcess::parseTransferFunction(): unknown transfer function '" + name + "'");
+}
+
+float PostProcess::parseExposure(const std::string &text) {
+    // Ensure the whole text is a number that fits in a float
+    size_t end = 0;
+    float exposure;
+    try {
+        exposure = std::stof(text, &end);
+    } catch (std::invalid_argument &) {
+        end = 0;
+    } catch (std::out_of_range &) {
+        end = 0;
+    }
+    if (end == 0 || end != text.size())
+        throw PostProcessException("PostProcess::parseExposure(): invalid exposure '" + text + "'");
+
+    return exposure;
+}
+
+void PostProcess::set_exposure(const float exposure) {
+    // Ensure exposure is finite
+    if (!is_finite(exposure))
+        throw PostProcessException("PostProcess::set_exposure(): exposure should be finite");
+
+    // Ensure exposure is positive
+    if (exposure <= 0)
+        throw PostProcessException("PostProcess::set_exposure(): exposure should be greater than zero");
+
+    // Set exposure
+    this->exposure = exposure;
+}
+
+void PostProcess::set_tone_mapping(const ToneMapping tone_mapping) {
+    // Nothing to check, every enumerator is valid
+    this->tone_mapping = tone_mapping;
+}
+
+void PostProcess::set_transfer_function(const TransferFunction transfer_function) {
+    // Nothing to check, every enumerator is valid
+    this->transfer_function = transfer_function;
+}
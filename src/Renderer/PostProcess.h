@@ -0,0 +1,169 @@
+#ifndef POSTPROCESS_H
+#define POSTPROCESS_H
+#include <Utils/Headers.h>
+
+/**
+ * Tone mapping operators used to bring linear radiance into [0, 1].
+ */
+enum class ToneMapping {
+    /// Clamps every component to [0, 1]. Matches the original output for colors already inside [0, 1].
+    Clamp,
+
+    /// Reinhard operator x / (1 + x), applied per component.
+    Reinhard,
+
+    /// Narkowicz's fit of the ACES filmic curve, applied per component.
+    ACES
+};
+
+/**
+ * Transfer functions used to encode tone mapped values for display.
+ */
+enum class TransferFunction {
+    /// Gamma 2 (square root). Matches the original output.
+    Gamma2,
+
+    /// Exact piecewise sRGB curve.
+    SRGB
+};
+
+/**
+ * Post-processing stage turning a linear float framebuffer into 8-bit display values.
+ * Exposure, tone mapping, transfer function and quantization happen in one pass over each row.
+ * The per-row loops run over flat float arrays so they vectorize, and rows are spread across threads.
+ */
+class PostProcess {
+    /// Linear multiplier applied before tone mapping.
+    float exposure{1};
+
+    /// Tone mapping operator.
+    ToneMapping tone_mapping{ToneMapping::Clamp};
+
+    /// Transfer function applied after tone mapping.
+    TransferFunction transfer_function{TransferFunction::Gamma2};
+
+public:
+    // Constructors
+    /**
+     * Creates a post-processing stage that reproduces the original output (exposure 1, clamp, gamma 2).
+     */
+    PostProcess() = default;
+
+    /**
+     * Creates a new post-processing stage.
+     * @param exposure Linear multiplier applied before tone mapping.
+     * @param tone_mapping Tone mapping operator.
+     * @param transfer_function Transfer function applied after tone mapping.
+     *
+     * @note Test Cases:\n
+     * Uses setter test cases.
+     */
+    PostProcess(float exposure, ToneMapping tone_mapping, TransferFunction transfer_function);
+
+    // Methods
+    /**
+     * Converts a linear RGB float framebuffer into 8-bit RGB.
+     * @param linear Row-major, interleaved RGB radiance, width * height * 3 non-negative floats.
+     * @param width Width of the framebuffer, in pixels.
+     * @param height Height of the framebuffer, in pixels.
+     * @param out Output buffer of width * height * 3 bytes.
+     *
+     * @note Test Cases:\n
+     * auto pp = PostProcess()\n
+     * float linear[3] = {0.25, 1, 4}; unsigned char out[3]\n
+     * pp.apply(linear, 1, 1, out) -> out should be {127, 255, 255}\n
+     * pp.apply(nullptr, 1, 1, out) -> ERROR: will throw a PostProcessException (buffers cannot be nullptr)\n
+     * pp.apply(linear, 0, 1, out) -> ERROR: will throw a PostProcessException (width, height must be positive)\n
+     */
+    void apply(const float *linear, int width, int height, unsigned char *out) const;
+
+    /**
+     * Converts count linear float values into 8-bit values. This is the per-row kernel behind apply().
+     * @param linear Linear values (any mix of components).
+     * @param count Number of values.
+     * @param out Output buffer of count bytes.
+     *
+     * @note Test Cases:\n
+     * Covered by apply().
+     */
+    void applyRow(const float *linear, size_t count, unsigned char *out) const;
+
+    /**
+     * Parses a tone mapping operator name.
+     * @param name One of "clamp", "reinhard", "aces".
+     * @return Matching tone mapping operator.
+     *
+     * @note Test Cases:\n
+     * PostProcess::parseToneMapping("aces") -> ToneMapping::ACES\n
+     * PostProcess::parseToneMapping("filmic") -> ERROR: will throw a PostProcessException (unknown tone mapping)\n
+     */
+    static ToneMapping parseToneMapping(const std::string &name);
+
+    /**
+     * Parses a transfer function name.
+     * @param name One of "gamma2", "srgb".
+     * @return Matching transfer function.
+     *
+     * @note Test Cases:\n
+     * PostProcess::parseTransferFunction("srgb") -> TransferFunction::SRGB\n
+     * PostProcess::parseTransferFunction("gamma") -> ERROR: will throw a PostProcessException (unknown transfer function)\n
+     */
+    static TransferFunction parseTransferFunction(const std::string &name);
+
+    /**
+     * Parses an exposure multiplier.
+     * @param text Decimal number, filling the whole text.
+     * @return Exposure, which set_exposure() still checks to be positive and finite.
+     *
+     * @note Test Cases:\n
+     * PostProcess::parseExposure("1.5") -> 1.5\n
+     * PostProcess::parseExposure("bright") -> ERROR: will throw a PostProcessException (invalid exposure)\n
+     * PostProcess::parseExposure("1e99") -> ERROR: will throw a PostProcessException (invalid exposure)\n
+     */
+    static float parseExposure(const std::string &text);
+
+    // Getters
+    /// Gets the exposure multiplier.
+    [[nodiscard]] float get_exposure() const { return exposure; }
+
+    /// Gets the tone mapping operator.
+    [[nodiscard]] ToneMapping get_tone_mapping() const { return tone_mapping; }
+
+    /// Gets the transfer function.
+    [[nodiscard]] TransferFunction get_transfer_function() const { return transfer_function; }
+
+    // Setters
+    /**
+     * Sets the exposure multiplier.
+     * @param exposure Linear multiplier applied before tone mapping.
+     *
+     * @note Test Cases:\n
+     * auto pp = PostProcess()\n
+     * pp.set_exposure(2) -> exposure should be 2\n
+     * pp.set_exposure(0) -> ERROR: will throw a PostProcessException (exposure must be greater than zero)\n
+     * pp.set_exposure(infinity) -> ERROR: will throw a PostProcessException (exposure must be finite)\n
+     */
+    void set_exposure(float exposure);
+
+    /**
+     * Sets the tone mapping operator.
+     * @param tone_mapping Tone mapping operator.
+     *
+     * @note Test Cases:\n
+     * auto pp = PostProcess()\n
+     * pp.set_tone_mapping(ToneMapping::Reinhard) -> tone mapping should be Reinhard\n
+     */
+    void set_tone_mapping(ToneMapping tone_mapping);
+
+    /**
+     * Sets the transfer function.
+     * @param transfer_function Transfer function applied after tone mapping.
+     *
+     * @note Test Cases:\n
+     * auto pp = PostProcess()\n
+     * pp.set_transfer_function(TransferFunction::SRGB) -> transfer function should be SRGB\n
+     */
+    void set_transfer_function(TransferFunction transfer_function);
+};
+
+#endif //POSTPROCESS_H
@@ -1,7 +1,105 @@
 #include "RenderTarget.h"
+#include <Utils/Profiler.h>
+#include <atomic>
+#include <charconv>
+#include <cstring>
 #include <fstream>
 
-RenderTarget::RenderTarget(const int width, const int height) {
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    /// Decimal text of every 8-bit value followed by a space, made once with std::to_chars.
+    struct DecimalTable {
+        char text[256][4]{};
+        unsigned char size[256]{};
+
+        DecimalTable() {
+            for (unsigned value = 0; value < 256; value++) {
+                char *end = std::to_chars(text[value], text[value] + 3, value).ptr;
+                *end++ = ' ';
+                size[value] = static_cast<unsigned char>(end - text[value]);
+            }
+        }
+    };
+
+    const DecimalTable &Decimals() {
+        static const DecimalTable table;
+        return table;
+    }
+
+    /// Rows formatted per write, bounding each thread's buffer.
+    constexpr int PPM_ROWS_PER_WRITE = 64;
+
+    /// Length of a P3 row: the digits of every value, plus a space or newline after each.
+    size_t PPMRowSize(const unsigned char *bytes, const size_t count) {
+        const DecimalTable &decimals = Decimals();
+        size_t size = 0;
+        for (size_t i = 0; i < count; i++)
+            size += decimals.size[bytes[i]];
+        return size;
+    }
+
+    /**
+     * Formats a row as P3 pixel lines, "r g b\n" each, PPMRowSize() characters in total.
+     * Values are copied 4 bytes at a time, so out needs 3 spare bytes past the row.
+     * @return End of the row.
+     */
+    char *FormatPPMRow(const unsigned char *bytes, const size_t count, char *out) {
+        const DecimalTable &decimals = Decimals();
+        for (size_t i = 0; i < count; i += 3) {
+            for (size_t c = 0; c < 3; c++) {
+                std::memcpy(out, decimals.text[bytes[i + c]], 4);
+                out += decimals.size[bytes[i + c]];
+            }
+            out[-1] = '\n';
+        }
+        return out;
+    }
+
+#ifdef __linux__
+    /// Owns a file descriptor, closing it on scope exit unless Close() already did, so exceptions cannot leak it.
+    class FileDescriptor {
+    public:
+        explicit FileDescriptor(const int fd) : fd(fd) {}
+        ~FileDescriptor() { Close(); }
+
+        FileDescriptor(const FileDescriptor &) = delete;
+        FileDescriptor &operator=(const FileDescriptor &) = delete;
+
+        [[nodiscard]] int get() const { return fd; }
+
+        /// Closes the descriptor now. @return Whether it closed cleanly.
+        bool Close() {
+            if (fd < 0)
+                return true;
+            const bool closed = close(fd) == 0;
+            fd = -1;
+            return closed;
+        }
+
+    private:
+        int fd;
+    };
+
+    /// Writes all of data at offset, retrying short writes.
+    bool WriteAt(const int file, const char *data, size_t size, size_t offset) {
+        while (size > 0) {
+            const ssize_t written = pwrite(file, data, size, static_cast<off_t>(offset));
+            if (written <= 0)
+                return false;
+            data += written;
+            size -= static_cast<size_t>(written);
+            offset += static_cast<size_t>(written);
+        }
+        return true;
+    }
+#endif
+}
+
+RenderTarget::RenderTarget(const int width, const int height, const PixelStorage storage) : storage(storage) {
     // Set width and height
     set_width(width);
     set_height(height);
@@ -12,7 +110,29 @@ RenderTarget::RenderTarget(const int width, const int height) {
 
 void RenderTarget::initialize() {
     // Create pixel grid full of black pixels
-    colors = std::vector(get_height(), std::vector(get_width(), Color(0, 0, 0)));
+    allocate();
+}
+
+void RenderTarget::allocate() {
+    // Only the buffer of the storage format holds memory, black is all zero bits in every format
+    const size_t count = static_cast<size_t>(get_width()) * static_cast<size_t>(get_height());
+    pixels.clear();
+    pixels.shrink_to_fit();
+    half_pixels.clear();
+    half_pixels.shrink_to_fit();
+    packed_pixels.clear();
+    packed_pixels.shrink_to_fit();
+
+    switch (storage) {
+        case PixelStorage::Half:
+            half_pixels.assign(3 * count, 0);
+            break;
+        case PixelStorage::RGB9E5:
+            packed_pixels.assign(count, 0);
+            break;
+        default:
+            pixels.assign(3 * count, 0.0f);
+    }
 }
 
 Color RenderTarget::get_pixel(const int x, const int y) const {
@@ -20,8 +140,10 @@ Color RenderTarget::get_pixel(const int x, const int y) const {
     if (x < 0 || y < 0 || x >= get_width() || y >= get_height())
         throw RenderTargetException("RenderTarget::get_pixel(): pixel index out of bounds");
 
-    // Retrieve the color at the index
-    return colors[y][x];
+    // Retrieve the color at the index, HDR values are clamped into Color's range
+    float rgb[3];
+    readRow(x, y, 1, rgb);
+    return Color(clamp(vec3(rgb[0], rgb[1], rgb[2]), 0.0f, 1.0f));
 }
 
 void RenderTarget::set_pixel(const int x, const int y, const Color &pixel) {
@@ -30,55 +152,271 @@ void RenderTarget::set_pixel(const int x, const int y, const Color &pixel) {
         throw RenderTargetException("RenderTarget::set_pixel(): pixel index out of bounds");
 
     // Set the color at the index
-    colors[y][x] = pixel;
+    const auto color = pixel.get_color();
+    const float rgb[3] = {color.r, color.g, color.b};
+    writeRow(x, y, 1, rgb);
+}
+
+vec3 RenderTarget::get_radiance(const int x, const int y) const {
+    // Ensure x and y are within bounds
+    if (x < 0 || y < 0 || x >= get_width() || y >= get_height())
+        throw RenderTargetException("RenderTarget::get_radiance(): pixel index out of bounds");
+
+    // Retrieve the radiance at the index
+    float rgb[3];
+    readRow(x, y, 1, rgb);
+    return {rgb[0], rgb[1], rgb[2]};
+}
+
+void RenderTarget::set_radiance(const int x, const int y, const vec3 &radiance) {
+    // Ensure x and y are within bounds
+    if (x < 0 || y < 0 || x >= get_width() || y >= get_height())
+        throw RenderTargetException("RenderTarget::set_radiance(): pixel index out of bounds");
+
+    // Ensure radiance is finite
+    if (!is_finite(radiance))
+        throw RenderTargetException("RenderTarget::set_radiance(): radiance should be finite");
+
+    // Ensure radiance is non-negative
+    if (radiance.r < 0 || radiance.g < 0 || radiance.b < 0)
+        throw RenderTargetException("RenderTarget::set_radiance(): radiance should not be negative");
+
+    // Set the radiance at the index
+    const float rgb[3] = {radiance.r, radiance.g, radiance.b};
+    writeRow(x, y, 1, rgb);
+}
+
+void RenderTarget::readRow(const int x, const int y, const int count, float *rgb) const {
+    // Ensure the pixels are within bounds
+    if (x < 0 || y < 0 || count < 0 || x + count > get_width() || y >= get_height())
+        throw RenderTargetException("RenderTarget::readRow(): pixel index out of bounds");
+
+    // Convert from the storage format
+    const size_t index = static_cast<size_t>(y) * get_width() + x;
+    switch (storage) {
+        case PixelStorage::Half:
+            decode_half(half_pixels.data() + 3 * index, 3 * static_cast<size_t>(count), rgb);
+            break;
+        case PixelStorage::RGB9E5:
+            decode_rgb9e5(packed_pixels.data() + index, count, rgb);
+            break;
+        default:
+            std::copy_n(pixels.data() + 3 * index, 3 * static_cast<size_t>(count), rgb);
+    }
+}
+
+void RenderTarget::writeRow(const int x, const int y, const int count, const float *rgb) {
+    // Ensure the pixels are within bounds
+    if (x < 0 || y < 0 || count < 0 || x + count > get_width() || y >= get_height())
+        throw RenderTargetException("RenderTarget::writeRow(): pixel index out of bounds");
+
+    // Ensure radiance is finite and non-negative, (v >= 0) is false for NaN
+    for (int i = 0; i < 3 * count; i++) {
+        if (!is_finite(rgb[i]))
+            throw RenderTargetException("RenderTarget::writeRow(): radiance should be finite");
+        if (!(rgb[i] >= 0))
+            throw RenderTargetException("RenderTarget::writeRow(): radiance should not be negative");
+    }
+
+    // Convert into the storage format
+    const size_t index = static_cast<size_t>(y) * get_width() + x;
+    switch (storage) {
+        case PixelStorage::Half:
+            encode_half(rgb, 3 * static_cast<size_t>(count), half_pixels.data() + 3 * index);
+            break;
+        case PixelStorage::RGB9E5:
+            encode_rgb9e5(rgb, count, packed_pixels.data() + index);
+            break;
+        default:
+            std::copy_n(rgb, 3 * static_cast<size_t>(count), pixels.data() + 3 * index);
+    }
 }
 
-void RenderTarget::writeToFile(const std::string &filename) const {
+void RenderTarget::writeToFile(const std::string &filename, const PostProcess &post_process) const {
     // Ensure the filename is not empty
     if (filename.empty())
         throw RenderTargetException("RenderTarget::WriteToFile(): empty filename");
 
+    BLUNDER_PROFILE_ZONE("Write file");
+
     // Attempt to write to file, throw a RenderTargetException if any system errors occur
     try {
-        std::ofstream file(filename);
-
-        // PPM Header
-        file << "P3\n" << get_width() << " " << get_height() << "\n255\n";
-
-        // Generate PPM contents
-        for (int y = 0; y < get_height(); y++) {
-            for (int x = 0; x < get_width(); x++) {
-                // Get pixel
-                const auto pixel = get_pixel(x, y).get_color();
-
-                // Gamma correction
-                auto r = linear_to_gamma(pixel.r);
-                auto g = linear_to_gamma(pixel.g);
-                auto b = linear_to_gamma(pixel.b);
-
-                // Write integer converted color data to file
-                file <<
-                        static_cast<int>(255.999 * r) << " " <<
-                        static_cast<int>(255.999 * g) << " " <<
-                        static_cast<int>(255.999 * b) << "\n";
-            }
+        // Exposure, tone mapping, gamma and quantization in one pass
+        const size_t row_size = static_cast<size_t>(get_width()) * 3;
+        std::vector<unsigned char> bytes(row_size * get_height());
+        if (storage == PixelStorage::Float) {
+            post_process.apply(get_data(), get_width(), get_height(), bytes.data());
+        } else {
+            // Compact storage is decoded a row at a time, never into a full float copy
+            parallel_for(get_height(), [&](const int begin, const int end) {
+                std::vector<float> row(row_size);
+                for (int y = begin; y < end; y++) {
+                    readRow(0, y, get_width(), row.data());
+                    post_process.applyRow(row.data(), row_size, bytes.data() + row_size * y);
+                }
+            }, 16);
         }
 
-        // Close file
-        file.close();
+        // Every row's place in the file, so rows can be formatted in parallel straight to where they belong
+        const std::string header = "P3\n" + std::to_string(get_width()) + " " + std::to_string(get_height()) + "\n255\n";
+        std::vector<size_t> offsets(static_cast<size_t>(get_height()) + 1, 0);
+        parallel_for(get_height(), [&](const int begin, const int end) {
+            for (int y = begin; y < end; y++)
+                offsets[y + 1] = PPMRowSize(bytes.data() + row_size * y, row_size);
+        }, 64);
+        offsets[0] = header.size();
+        for (size_t y = 1; y < offsets.size(); y++)
+            offsets[y] += offsets[y - 1];
+
+#ifdef __linux__
+        // Batches are written straight to their offsets in the file, in any order
+        FileDescriptor file(open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+        if (file.get() < 0)
+            throw RenderTargetException("RenderTarget::WriteToFile(): cannot open " + filename);
+
+        std::atomic<bool> written{WriteAt(file.get(), header.data(), header.size(), 0)};
+        const auto emit = [&](const char *data, const size_t size, const size_t offset) {
+            return WriteAt(file.get(), data, size, offset);
+        };
+#else
+        std::string text(offsets.back(), '\0');
+        std::memcpy(text.data(), header.data(), header.size());
+
+        std::atomic<bool> written{true};
+        const auto emit = [&](const char *data, const size_t size, const size_t offset) {
+            std::memcpy(text.data() + offset, data, size);
+            return true;
+        };
+#endif
+
+        // Threads format batches of consecutive rows into their own buffers, which have room for the formatter's spare
+        // bytes, then emit them at the batch's offset
+        parallel_for(get_height(), [&](const int begin, const int end) {
+            std::vector<char> buffer;
+            for (int first = begin; first < end && written; first += PPM_ROWS_PER_WRITE) {
+                const int last = std::min(end, first + PPM_ROWS_PER_WRITE);
+                const size_t size = offsets[last] - offsets[first];
+                buffer.resize(size + 3);
+                char *out = buffer.data();
+                for (int y = first; y < last; y++)
+                    out = FormatPPMRow(bytes.data() + row_size * y, row_size, out);
+                if (!emit(buffer.data(), size, offsets[first]))
+                    written = false;
+            }
+        }, 16);
+
+#ifdef __linux__
+        if (!file.Close() || !written)
+            throw RenderTargetException("RenderTarget::WriteToFile(): system error writing to " + filename);
+#else
+        std::ofstream file(filename, std::ios::binary);
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!file.good())
+            throw RenderTargetException("RenderTarget::WriteToFile(): system error writing to " + filename);
+#endif
+    } catch (const RenderTargetException &) {
+        throw;
     } catch (const std::exception &e) {
         throw RenderTargetException(
             "RenderTarget::WriteToFile(): system error writing to file: " + std::string(e.what()));
     }
 }
 
+void RenderTarget::writeToPFM(const std::string &filename) const {
+    // Ensure the filename is not empty
+    if (filename.empty())
+        throw RenderTargetException("RenderTarget::writeToPFM(): empty filename");
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open())
+        throw RenderTargetException("RenderTarget::writeToPFM(): cannot open " + filename);
+
+    // Color PFM header, a negative scale marks little-endian floats
+    file << "PF\n" << get_width() << " " << get_height() << "\n-1.0\n";
+
+    // PFM rows run bottom to top
+    const size_t row_size = static_cast<size_t>(get_width()) * 3;
+    std::vector<float> row(row_size);
+    for (int y = get_height() - 1; y >= 0; y--) {
+        readRow(0, y, get_width(), row.data());
+        file.write(reinterpret_cast<const char *>(row.data()), static_cast<std::streamsize>(row_size * sizeof(float)));
+    }
+
+    if (!file.good())
+        throw RenderTargetException("RenderTarget::writeToPFM(): system error writing to " + filename);
+}
+
+shared_ptr<RenderTarget> RenderTarget::readFromPFM(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+        throw RenderTargetException("RenderTarget::readFromPFM(): cannot open " + filename);
+
+    // Header
+    std::string magic;
+    int width = 0, height = 0;
+    float scale = 0;
+    file >> magic >> width >> height >> scale;
+    file.get();
+
+    if (magic != "PF" || !file.good())
+        throw RenderTargetException("RenderTarget::readFromPFM(): " + filename + " is not a color PFM file");
+
+    if (scale >= 0)
+        throw RenderTargetException("RenderTarget::readFromPFM(): big-endian PFM files are not supported");
+
+    auto render_target = make_shared<RenderTarget>(width, height);
+
+    // PFM rows run bottom to top
+    const size_t row_size = static_cast<size_t>(width) * 3;
+    for (int y = height - 1; y >= 0; y--)
+        file.read(reinterpret_cast<char *>(render_target->pixels.data() + row_size * y),
+                  static_cast<std::streamsize>(row_size * sizeof(float)));
+
+    if (!file.good())
+        throw RenderTargetException("RenderTarget::readFromPFM(): " + filename + " is truncated");
+
+    return render_target;
+}
+
+shared_ptr<RenderTarget> RenderTarget::readFromPPM(const std::string &filename) {
+    std::ifstream file(filename);
+    if (!file.is_open())
+        throw RenderTargetException("RenderTarget::readFromPPM(): cannot open " + filename);
+
+    // Header
+    std::string magic;
+    int width = 0, height = 0, max_value = 0;
+    file >> magic >> width >> height >> max_value;
+
+    if (magic != "P3" || !file.good() || max_value != 255)
+        throw RenderTargetException("RenderTarget::readFromPPM(): " + filename + " is not an 8-bit P3 PPM file");
+
+    auto render_target = make_shared<RenderTarget>(width, height);
+
+    // Middle of each gamma 2 quantization bucket, linear
+    float decode[256];
+    for (int value = 0; value < 256; value++) {
+        const float gamma = (static_cast<float>(value) + 0.5f) / 255.999f;
+        decode[value] = gamma * gamma;
+    }
+
+    for (auto &component: render_target->pixels) {
+        int value;
+        if (!(file >> value) || value < 0 || value > 255)
+            throw RenderTargetException("RenderTarget::readFromPPM(): " + filename + " is truncated or invalid");
+        component = decode[value];
+    }
+
+    return render_target;
+}
+
 void RenderTarget::set_width(const int width) {
     // Ensure width is above zero
     if (width <= 0)
         throw RenderTargetException("RenderTarget::set_width(): width must be greater than 0");
 
     // Ensure width is below vector size limit
-    if (width > colors.max_size())
+    if (static_cast<size_t>(width) > pixels.max_size() / 3)
         throw RenderTargetException("RenderTarget::set_width(): width exceeds maximum size");
 
     // Set width
@@ -94,7 +432,7 @@ void RenderTarget::set_height(const int height) {
         throw RenderTargetException("RenderTarget::set_height(): height must be greater than 0");
 
     // Ensure height is below vector size limit
-    if (height > colors[0].max_size())
+    if (static_cast<size_t>(height) * get_width() > pixels.max_size() / 3)
         throw RenderTargetException("RenderTarget::set_height(): height exceeds maximum size");
 
     // Set height
@@ -103,3 +441,29 @@ void RenderTarget::set_height(const int height) {
     // Reinitialize colors
     initialize();
 }
+
+void RenderTarget::set_storage(const PixelStorage storage) {
+    if (storage == this->storage)
+        return;
+
+    // Converted a row at a time, so only the old and new buffers are held at once
+    RenderTarget converted(get_width(), get_height(), storage);
+    std::vector<float> row(static_cast<size_t>(get_width()) * 3);
+    for (int y = 0; y < get_height(); y++) {
+        readRow(0, y, get_width(), row.data());
+        converted.writeRow(0, y, get_width(), row.data());
+    }
+
+    *this = std::move(converted);
+}
+
+PixelStorage RenderTarget::parsePixelStorage(const std::string &name) {
+    if (name == "float")
+        return PixelStorage::Float;
+    if (name == "half")
+        return PixelStorage::Half;
+    if (name == "rgb9e5")
+        return PixelStorage::RGB9E5;
+
+    throw RenderTargetException("RenderTarget::parsePixelStorage(): unknown pixel storage '" + name + "'");
+}
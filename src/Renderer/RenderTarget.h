@@ -1,6 +1,8 @@
 #ifndef RENDERTARGET_H
 #define RENDERTARGET_H
 #include <Utils/Headers.h>
+#include <Renderer/PostProcess.h>
+#include <Renderer/PixelStorage.h>
 
 /**
  * Render target representing an image in memory.
@@ -14,8 +16,20 @@ class RenderTarget {
     /// Height in pixels of the image.
     int height{1};
 
-    /// Two dimensional array of pixels.
-    std::vector<std::vector<Color> > colors;
+    /// How pixels are stored, only the matching buffer below is allocated.
+    PixelStorage storage{PixelStorage::Float};
+
+    /// Row-major, interleaved RGB linear radiance of every pixel. Values may exceed 1 (HDR).
+    std::vector<float> pixels;
+
+    /// Row-major, interleaved RGB half floats of every pixel, for PixelStorage::Half.
+    std::vector<uint16_t> half_pixels;
+
+    /// Row-major RGB9E5 pixels, for PixelStorage::RGB9E5.
+    std::vector<uint32_t> packed_pixels;
+
+    /// Allocates the buffer of storage for the current size, filled with black.
+    void allocate();
 
 public:
     // Constructors
@@ -23,13 +37,15 @@ public:
      * Makes a new render target.
      * @param width Width, in pixels.
      * @param height Height, in pixels.
+     * @param storage How pixels are stored, floats unless memory is short.
      *
      * @note Test Cases:
      * auto rt1 = RenderTarget(100, 100) -> width should be 100, height should be 100
      * auto rt2 = RenderTarget(0, 0) -> ERROR: will throw a RenderTargetException
      * auto rt3 = RenderTarget(-1, -1) -> ERROR: will throw a RenderTargetException
+     * auto rt4 = RenderTarget(100, 100, PixelStorage::Half) -> 600 bytes per row instead of 1200
      */
-    RenderTarget(int width, int height);
+    RenderTarget(int width, int height, PixelStorage storage = PixelStorage::Float);
 
     // Methods
     /**
@@ -43,6 +59,7 @@ public:
 
     /**
      * Gets the color located at (x, y).
+     * Radiance above 1 is clamped, use get_radiance() for the unclamped value.
      * @param x x pixel coordinate.
      * @param y y pixel coordinate.
      * @return Color of pixel (x, y).
@@ -74,9 +91,68 @@ public:
      */
     void set_pixel(int x, int y, const Color &pixel);
 
+    /**
+     * Gets the linear radiance located at (x, y).
+     * @param x x pixel coordinate.
+     * @param y y pixel coordinate.
+     * @return Radiance of pixel (x, y), unclamped.
+     *
+     * @note Test Cases:
+     * auto rt1 = RenderTarget(101, 101)
+     * rt1.set_radiance(0, 0, vec3(4)) -> rt1.get_radiance(0, 0) should be (4, 4, 4), rt1.get_pixel(0, 0) (1, 1, 1)
+     * rt1.get_radiance(101, 101) -> ERROR: will throw a RenderTargetException (pixel out of bounds)
+     */
+    [[nodiscard]] vec3 get_radiance(int x, int y) const;
+
+    /**
+     * Sets the linear radiance located at (x, y). Unlike set_pixel(), values above 1 are kept.
+     * @param x x pixel coordinate.
+     * @param y y pixel coordinate.
+     * @param radiance Non-negative, finite linear radiance.
+     *
+     * @note Test Cases:
+     * auto rt1 = RenderTarget(101, 101)
+     * rt1.set_radiance(0, 0, vec3(4)) -> radiance of the top left pixel should be (4, 4, 4)
+     * rt1.set_radiance(0, 0, vec3(-1)) -> ERROR: will throw a RenderTargetException (radiance must be non-negative)
+     * rt1.set_radiance(0, 0, vec3(infinity)) -> ERROR: will throw a RenderTargetException (radiance must be finite)
+     * rt1.set_radiance(101, 101, vec3(1)) -> ERROR: will throw a RenderTargetException (pixel out of bounds)
+     */
+    void set_radiance(int x, int y, const vec3 &radiance);
+
+    /**
+     * Reads the linear radiance of count pixels of a row, converting it from the storage format.
+     * @param x x pixel coordinate of the first pixel.
+     * @param y y pixel coordinate.
+     * @param count Number of pixels.
+     * @param rgb Output, 3 * count interleaved floats.
+     *
+     * @note Test Cases:
+     * rt1.readRow(0, 0, rt1.get_width(), rgb) -> the first row
+     * rt1.readRow(1, 0, rt1.get_width(), rgb) -> ERROR: will throw a RenderTargetException (pixels out of bounds)
+     */
+    void readRow(int x, int y, int count, float *rgb) const;
+
+    /**
+     * Sets the linear radiance of count pixels of a row, like set_radiance() for each, converting it to the storage
+     * format. This is how the renderer stores traced rows.
+     * @param x x pixel coordinate of the first pixel.
+     * @param y y pixel coordinate.
+     * @param count Number of pixels.
+     * @param rgb 3 * count interleaved, non-negative, finite floats.
+     *
+     * @note Test Cases:
+     * rt1.writeRow(0, 0, 2, {1, 2, 3, 4, 5, 6}) -> rt1.get_radiance(1, 0) should be (4, 5, 6)
+     * rt1.writeRow(0, 0, 1, {-1, 0, 0}) -> ERROR: will throw a RenderTargetException (radiance must be non-negative)
+     * rt1.writeRow(-1, 0, 1, rgb) -> ERROR: will throw a RenderTargetException (pixels out of bounds)
+     */
+    void writeRow(int x, int y, int count, const float *rgb);
+
     /**
      * Writes the render target to an output file.
+     * The framebuffer is converted by post_process, then written as a plain (P3) PPM, one "r g b" line per pixel.
+     * Rows are formatted in parallel, each thread writing batches of rows at their precomputed offsets in the file.
      * @param filename Name of the file to export to.
+     * @param post_process Exposure, tone mapping and transfer function used for the conversion.
      *
      * @note Test Cases:
      * auto rt1 = RenderTarget(100, 100)
@@ -84,7 +160,55 @@ public:
      * rt1.writeToFile("") -> ERROR: will throw a RenderTargetException (filename must be provided)
      * rt1.writeToFile("cool") fails for some other reason -> ERROR: will throw a RenderTargetException (some system error occurred)
      */
-    void writeToFile(const std::string &filename) const;
+    void writeToFile(const std::string &filename, const PostProcess &post_process = PostProcess()) const;
+
+    /**
+     * Writes the linear float framebuffer, unclamped and unprocessed, to a PFM (portable float map) file.
+     * Useful for storing HDR references that later renders are compared against.
+     * @param filename Name of the file to export to.
+     *
+     * @note Test Cases:
+     * auto rt1 = RenderTarget(100, 100)
+     * rt1.writeToPFM("cool.pfm") -> should generate a file cool.pfm
+     * rt1.writeToPFM("") -> ERROR: will throw a RenderTargetException (filename must be provided)
+     */
+    void writeToPFM(const std::string &filename) const;
+
+    /**
+     * Reads a render target back from a color PFM file written by writeToPFM().
+     * @param filename Name of the file to read.
+     * @return Render target holding the file's linear framebuffer.
+     *
+     * @note Test Cases:
+     * RenderTarget::readFromPFM("cool.pfm") -> same size and pixels as the render target that wrote it
+     * RenderTarget::readFromPFM("missing.pfm") -> ERROR: will throw a RenderTargetException (cannot open file)
+     */
+    static shared_ptr<RenderTarget> readFromPFM(const std::string &filename);
+
+    /**
+     * Reads a render target back from a plain (P3) PPM file written by writeToFile().
+     * Each 8-bit value is decoded to the middle of the linear range that the default post process (clamp, gamma 2)
+     * encodes to that value, so writing the result again with the default post process reproduces the file exactly.
+     * @param filename Name of the file to read.
+     * @return Render target holding the decoded linear framebuffer.
+     *
+     * @note Test Cases:
+     * RenderTarget::readFromPPM("cool.ppm") -> same size as the render target that wrote it, writes back identically
+     * RenderTarget::readFromPPM("cool.pfm") -> ERROR: will throw a RenderTargetException (not a P3 PPM file)
+     * RenderTarget::readFromPPM("missing.ppm") -> ERROR: will throw a RenderTargetException (cannot open file)
+     */
+    static shared_ptr<RenderTarget> readFromPPM(const std::string &filename);
+
+    /**
+     * Parses a pixel storage name: "float", "half" or "rgb9e5".
+     * @param name Storage name.
+     * @return Parsed storage.
+     *
+     * @note Test Cases:
+     * RenderTarget::parsePixelStorage("half") -> PixelStorage::Half
+     * RenderTarget::parsePixelStorage("fp8") -> ERROR: will throw a RenderTargetException (unknown storage)
+     */
+    static PixelStorage parsePixelStorage(const std::string &name);
 
     // Getters
     /// Gets the width in pixels of the render target.
@@ -93,6 +217,15 @@ public:
     /// Gets the height in pixels of the render target.
     [[nodiscard]] int get_height() const { return height; }
 
+    /// Gets how pixels are stored.
+    [[nodiscard]] PixelStorage get_storage() const { return storage; }
+
+    /**
+     * Gets the row-major, interleaved RGB linear framebuffer (width * height * 3 floats).
+     * nullptr unless pixels are stored as PixelStorage::Float, read other formats with readRow().
+     */
+    [[nodiscard]] const float *get_data() const { return storage == PixelStorage::Float ? pixels.data() : nullptr; }
+
     // Setters
     /**
      * Sets the width of the render target.
@@ -119,6 +252,16 @@ public:
      * rt1.set_height(-1) -> ERROR: will throw a RenderTargetException (height must be greater than zero)
      */
     void set_height(int height);
+
+    /**
+     * Sets how pixels are stored, converting the current pixels.
+     * @param storage Storage format.
+     *
+     * @note Test Cases:
+     * rt1.set_storage(PixelStorage::RGB9E5) -> same image within RGB9E5 precision, 4 bytes per pixel
+     * rt1.set_storage(PixelStorage::Float) -> after the above, exactly the RGB9E5 values
+     */
+    void set_storage(PixelStorage storage);
 };
 
 #endif //RENDERTARGET_H
@@ -1,4 +1,367 @@
 #include "Renderer.h"
+#include <Utils/Profiler.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+namespace {
+    constexpr float PI = 3.14159265f;
+
+    /**
+     * Per-thread store of random unit vectors for diffuse bounces.
+     * Refilled a block at a time with the branch-free batch sampler, so each bounce costs a fixed, small amount of
+     * work instead of a rejection loop. Renders reset it for every pixel, so blocks start small after a reset and
+     * double up to SIZE, and a pixel with few bounces does not pay for a full block.
+     */
+    struct DirectionPool {
+        static constexpr int SIZE = 256;
+        static constexpr int FIRST_BLOCK = 8;
+        float x[SIZE]{}, y[SIZE]{}, z[SIZE]{};
+        int index = 0;
+        int count = 0;
+        int block = FIRST_BLOCK;
+
+        /// Drops the directions left, so the next ones come from the random stream as it is now.
+        void reset() {
+            index = count = 0;
+            block = FIRST_BLOCK;
+        }
+
+        vec3 next() {
+            if (index == count) {
+                count = block;
+                block = std::min(SIZE, 2 * block);
+                random_unit_vectors(count, x, y, z);
+                index = 0;
+            }
+            const vec3 direction(x[index], y[index], z[index]);
+            index++;
+            return direction;
+        }
+    };
+
+    /// Directions of the calling thread's diffuse bounces.
+    thread_local DirectionPool direction_pool;
+
+    /// Uses of a render's random numbers, mixed into its seed so each draws from streams of its own.
+    enum class RandomUse : uint64_t {
+        Jitter,
+        Path,
+        CacheSites,
+        CacheRecords,
+        GuideBounds,
+        GuideTraining
+    };
+
+    /// Seed of the streams of one use.
+    uint64_t StreamSeed(const uint64_t seed, const RandomUse stream) {
+        return mix_seed(seed, static_cast<uint64_t>(stream));
+    }
+
+    /// Seed of a pixel within a stream, so what is drawn for it does not depend on which thread traces it or when.
+    uint64_t PixelSeed(const uint64_t stream_seed, const int x, const int y) {
+        return mix_seed(stream_seed, static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32 | static_cast<uint32_t>(x));
+    }
+
+    /**
+     * Pyramid with its apex at the camera bounding what primary rays of a tile can see.
+     * The tile, widened by half a pixel for the antialiasing jitter plus half a pixel of margin, gives four side planes.
+     */
+    struct TileFrustum {
+        vec3 origin;
+
+        /// Side plane normals, normalized and pointing into the pyramid.
+        vec3 normals[4];
+
+        TileFrustum(const RT_TILE &tile, const RT_CAMERA_VALUES &rt_camera_values) {
+            // Tile corners in pixel units: jitter reaches half a pixel past the centers, plus half a pixel of margin
+            const float u0 = static_cast<float>(tile.x) - 1.0f;
+            const float u1 = static_cast<float>(tile.x + tile.width);
+            const float v0 = static_cast<float>(tile.y) - 1.0f;
+            const float v1 = static_cast<float>(tile.y + tile.height);
+
+            // Directions from the camera through the corners
+            origin = rt_camera_values.position;
+            const auto corner = [&](const float u, const float v) {
+                return rt_camera_values.pixel_upper_left + u * rt_camera_values.pixel_delta_u
+                       + v * rt_camera_values.pixel_delta_v - origin;
+            };
+            const vec3 corners[4] = {corner(u0, v0), corner(u1, v0), corner(u1, v1), corner(u0, v1)};
+            const vec3 center = corner(0.5f * (u0 + u1), 0.5f * (v0 + v1));
+
+            for (int k = 0; k < 4; k++) {
+                vec3 normal = normalize(cross(corners[k], corners[(k + 1) % 4]));
+                if (dot(normal, center) < 0)
+                    normal = -normal;
+                normals[k] = normal;
+            }
+        }
+
+        /// Whether a sphere is not entirely outside one of the side planes.
+        [[nodiscard]] bool contains(const vec3 &position, const float radius) const {
+            const vec3 offset = position - origin;
+            bool inside = true;
+            for (const auto &normal: normals)
+                inside = inside && dot(normal, offset) >= -radius;
+            return inside;
+        }
+
+        /// Whether a box is not entirely outside one of the side planes, tested at its corner furthest along each.
+        [[nodiscard]] bool overlaps(const vec3 &minimum, const vec3 &maximum) const {
+            bool inside = true;
+            for (const auto &normal: normals) {
+                const vec3 corner(normal.x >= 0 ? maximum.x : minimum.x, normal.y >= 0 ? maximum.y : minimum.y,
+                                  normal.z >= 0 ? maximum.z : minimum.z);
+                inside = inside && dot(normal, corner - origin) >= 0;
+            }
+            return inside;
+        }
+    };
+
+    /// Guide a path samples its bounces from, and whether the path teaches it the light it finds.
+    struct Guiding {
+        PathGuide *guide;
+        float guided_fraction;
+        bool learn;
+    };
+
+    /// Bounce of a learning path, kept until the path ends to record the light that arrived through it.
+    struct GuidedBounce {
+        uint32_t region;
+        vec3 direction;
+
+        /// Density the direction was sampled with.
+        float pdf;
+
+        /// Cosine between the direction and the surface normal.
+        float cosine;
+
+        /// Throughput of the path after the bounce.
+        vec3 attenuation;
+
+        /// Light the path had gathered before the bounce.
+        vec3 color;
+    };
+
+    /**
+     * Scatters a path at a hit, sampling the guide with probability guided_fraction and the cosine lobe otherwise,
+     * and weights the throughput by the mixture's density. Regions the guide has not learned only use the cosine lobe.
+     * @return False when the direction points below the surface, where no light comes from.
+     */
+    bool GuidedScatter(const Guiding &guiding, const HitRecord &record, Ray &ray, vec3 &attenuation,
+                       GuidedBounce &bounce) {
+        const vec3 normal = record.get_normal();
+        bounce.region = guiding.guide->findRegion(record.get_point(), normal);
+        const float fraction = guiding.guide->is_trained(bounce.region) ? guiding.guided_fraction : 0.0f;
+
+        // A guided direction comes with its density, only cosine sampled ones have to look it up
+        float guided_pdf = 0;
+        if (fraction > 0 && random_float() < fraction) {
+            const float u = random_float();
+            const float v = random_float();
+            bounce.direction = guiding.guide->sample(bounce.region, u, v, guided_pdf);
+        } else {
+            Renderer::scatter(record, ray);
+            bounce.direction = normalize(ray.get_direction());
+            if (fraction > 0)
+                guided_pdf = guiding.guide->pdf(bounce.region, bounce.direction);
+        }
+
+        const float cosine = dot(bounce.direction, normal);
+        if (cosine <= 0)
+            return false;
+        bounce.cosine = cosine;
+
+        bounce.pdf = (1.0f - fraction) * cosine / PI + fraction * guided_pdf;
+        ray = Ray(record.get_point(), bounce.direction);
+        attenuation *= record.get_color().get_color() * (cosine / (PI * bounce.pdf));
+        bounce.attenuation = attenuation;
+        return true;
+    }
+
+    /**
+     * Closest hit of a ray, the work done added to cost when it is not nullptr. Lists with a hierarchy count the nodes
+     * it visited and the spheres it tested, plain lists count one walk testing every sphere.
+     */
+    template<class List>
+    bool CountedHit(const List &spheres, const vec3 &origin, const vec3 &direction, HitRecord &record,
+                    RT_PIXEL_COST *cost) {
+        if constexpr (std::is_same_v<List, SphereGroup> || std::is_same_v<List, InstancedSphereList>) {
+            if (cost == nullptr)
+                return spheres.Hit(origin, direction, 0.001, 1000000, record);
+
+            RT_BVH_COUNTS counts;
+            const bool hit = spheres.Hit(origin, direction, 0.001, 1000000, record, &counts);
+            cost->traversal_steps += counts.nodes;
+            cost->intersection_tests += counts.tests;
+            return hit;
+        } else {
+            if (cost != nullptr) {
+                cost->traversal_steps++;
+                cost->intersection_tests += static_cast<uint32_t>(spheres.size());
+            }
+            return spheres.Hit(Ray(origin, direction), 0.001, 1000000, record);
+        }
+    }
+
+    /// Color of the sky seen along a direction, see Renderer::getSkyColor().
+    vec3 SkyRadiance(const vec3 &direction) {
+        const float a = 0.5f * (normalize(direction).z + 1);
+        const auto bottom_color = vec3(0);
+        const auto top_color = vec3(1);
+        return ((1.0f - a) * bottom_color) + (a * top_color);
+    }
+
+    /**
+     * Path traced radiance of a camera ray, given by its vectors so that tracing it to its first hit needs no Ray.
+     * Guided samples weigh their light by the sampling density and may exceed 1, so this is not clamped into a Color.
+     * The work done is added to cost when it is not nullptr. With a cache, the path ends at its second hit when a
+     * record covers it. With guiding, bounces are sampled from the guide, and a learning path records the light
+     * every bounce received into it once the path ends.
+     */
+    template<class List>
+    vec3 TraceRay(const vec3 &origin, const vec3 &direction, const int max_depth, const List &spheres,
+                  RT_PIXEL_COST *cost = nullptr, const IrradianceCache *cache = nullptr,
+                  const Guiding *guiding = nullptr) {
+        HitRecord record{};
+        vec3 color{0};
+        vec3 attenuation{1.0f};
+
+        thread_local std::vector<GuidedBounce> bounces;
+        const bool learning = guiding != nullptr && guiding->learn;
+        if (learning)
+            bounces.clear();
+
+        // Segment being traced, the camera ray until the first bounce
+        vec3 position = origin;
+        vec3 heading = direction;
+        for (int depth = max_depth; depth > 0; depth--) {
+            if (!CountedHit(spheres, position, heading, record, cost)) {
+                color += attenuation * SkyRadiance(heading);
+                break;
+            }
+
+            if (cost != nullptr)
+                cost->bounces++;
+
+            // The surface reflects the irradiance cached near the second hit, standing in for the rest of the path
+            vec3 irradiance;
+            if (cache != nullptr && depth == max_depth - 1 &&
+                cache->lookup(record.get_point(), record.get_normal(), irradiance)) {
+                color += attenuation * record.get_color().get_color() * irradiance;
+                break;
+            }
+
+            // Bounces leave from the hit point, in the direction scattering picks
+            Ray ray(record.get_point(), record.get_normal());
+            if (guiding != nullptr) {
+                GuidedBounce bounce;
+                bounce.color = color;
+                if (!GuidedScatter(*guiding, record, ray, attenuation, bounce))
+                    break;
+                if (learning)
+                    bounces.push_back(bounce);
+            } else {
+                Renderer::scatter(record, ray);
+                attenuation *= record.get_color().get_color();
+            }
+            position = ray.get_position();
+            heading = ray.get_direction();
+        }
+
+        // Light gathered after a bounce, with the throughput up to and through it undone, arrived through it. It is
+        // recorded averaged over channels, times the cosine over the sampling density, as PathGuide::record() expects
+        if (learning) {
+            for (const auto &bounce: bounces) {
+                const vec3 gathered = color - bounce.color;
+                float radiance = 0;
+                int channels = 0;
+                for (int c = 0; c < 3; c++) {
+                    if (bounce.attenuation[c] > 0) {
+                        radiance += gathered[c] / bounce.attenuation[c];
+                        channels++;
+                    }
+                }
+                if (channels > 0)
+                    radiance *= bounce.cosine / (bounce.pdf * static_cast<float>(channels));
+                guiding->guide->record(bounce.region, bounce.direction, radiance);
+            }
+        }
+
+        return color;
+    }
+
+    /// Camera rays sampled along each side of the image to measure how far the camera sees.
+    constexpr int SPACING_RAYS = 16;
+
+    /// Largest record radius derived from the scene, as a fraction of the mean distance to what camera rays hit.
+    constexpr float AUTO_MAX_SPACING = 0.5f;
+
+    /// Smallest record radius derived from the scene, as a fraction of the mean distance to what camera rays hit.
+    constexpr float AUTO_MIN_SPACING = 0.01f;
+
+    /// Pixel spacing of the first pass placing irradiance records, halved every pass down to 2.
+    constexpr int FIRST_RECORD_STRIDE = 16;
+
+    /// Camera paths traced along each side of the image to find the box the path guide covers.
+    constexpr int GUIDE_BOUNDS_PATHS = 16;
+
+    /// Share of the bounces left outside the path guide's box at each end of each axis.
+    constexpr float GUIDE_BOUNDS_OUTLIERS = 0.05f;
+
+    /// Bounces a path guide region records in a one sample per pixel pass before it is halved, growing with the
+    /// square root of the samples of later passes.
+    constexpr float GUIDE_SPLIT_VISITS = 4000.0f;
+
+    /// Most training passes, the last one tracing 2^15 samples per pixel.
+    constexpr int MAX_TRAINING_PASSES = 16;
+
+    /// Surface point a record is wanted at.
+    struct RecordSite {
+        vec3 position;
+        vec3 normal;
+    };
+
+    /**
+     * Irradiance record at a surface point, tracing one path through every cell of the hemisphere around it.
+     * Paths have depth hits left, the first being the hit seen through the cell. radiance and distance are scratch
+     * buffers, reused between records.
+     */
+    RT_IRRADIANCE_RECORD GatherRecord(const IrradianceCache &cache, const RecordSite &site, const int theta_strata,
+                                      const int phi_strata, const int depth, const SphereGroup &scene,
+                                      std::vector<vec3> &radiance, std::vector<float> &distance) {
+        const size_t cells = static_cast<size_t>(theta_strata) * static_cast<size_t>(phi_strata);
+        radiance.resize(cells);
+        distance.resize(cells);
+
+        HitRecord hit{};
+        for (int j = 0; j < theta_strata; j++) {
+            for (int k = 0; k < phi_strata; k++) {
+                const size_t n = static_cast<size_t>(j * phi_strata + k);
+                const Ray ray(site.position, IrradianceCache::getSampleDirection(
+                                  site.normal, theta_strata, phi_strata, j, k, random_float(), random_float()));
+
+                if (scene.Hit(ray, 0.001, 1000000, hit)) {
+                    Ray scattered = ray;
+                    Renderer::scatter(hit, scattered);
+                    distance[n] = hit.get_t();
+                    radiance[n] = hit.get_color().get_color() *
+                                  TraceRay(scattered.get_position(), scattered.get_direction(), depth - 1, scene);
+                } else {
+                    distance[n] = infinity;
+                    radiance[n] = Renderer::getSkyColor(ray).get_color();
+                }
+            }
+        }
+
+        return cache.makeRecord(site.position, site.normal, theta_strata, phi_strata, radiance, distance);
+    }
+}
 
 Renderer::Renderer(const int samples, const int max_depth) {
     set_samples(samples);
@@ -6,44 +369,613 @@ Renderer::Renderer(const int samples, const int max_depth) {
 }
 
 void Renderer::render(const shared_ptr<SphereList> &spheres, const shared_ptr<Camera> &camera,
-                      const shared_ptr<RenderTarget> &render_target) const {
+                      const shared_ptr<RenderTarget> &render_target, const shared_ptr<CostMap> &cost_map,
+                      const shared_ptr<TemporalHistory> &history) const {
+    validateRenderTarget(render_target, "render");
+    const int width = render_target->get_width();
+    const int height = render_target->get_height();
+    const RT_CROP region = validateRender(spheres, camera, width, height, "render");
+    validateCostMap(cost_map, width, height, "render");
+    validateHistory(history, width, height, "render");
+
+    BLUNDER_PROFILE_ZONE("Render");
+
+    // Progress is printed after every tile
+    RT_RENDER_OPTIONS options;
+    options.on_progress = [](const RT_RENDER_PROGRESS &progress) {
+        std::cout << "Rendering in progress: " << 100.0f * static_cast<float>(progress.tiles_done) / static_cast<float>(
+            progress.tiles_total) << "%\n";
+    };
+    options.cost_map = cost_map;
+    options.history = history;
+
+    RenderJob job;
+    renderTiles(*spheres->get_accelerator(), initializeRTCamera(camera, width, height), region,
+                renderTargetWriter(render_target), options, job);
+}
+
+void Renderer::render(const shared_ptr<SphereList> &spheres, const shared_ptr<Camera> &camera,
+                      const RT_FRAMEBUFFER &framebuffer, const shared_ptr<CostMap> &cost_map,
+                      const shared_ptr<TemporalHistory> &history) const {
+    validateFramebuffer(framebuffer, "render");
+    const RT_CROP region = validateRender(spheres, camera, framebuffer.width, framebuffer.height, "render");
+    validateCostMap(cost_map, framebuffer.width, framebuffer.height, "render");
+    validateHistory(history, framebuffer.width, framebuffer.height, "render");
+
+    BLUNDER_PROFILE_ZONE("Render");
+
+    RT_RENDER_OPTIONS options;
+    options.cost_map = cost_map;
+    options.history = history;
+
+    RenderJob job;
+    renderTiles(*spheres->get_accelerator(), initializeRTCamera(camera, framebuffer.width, framebuffer.height), region,
+                framebufferWriter(framebuffer), options, job);
+}
+
+void Renderer::render(const shared_ptr<InstancedSphereList> &instances, const shared_ptr<Camera> &camera,
+                      const shared_ptr<RenderTarget> &render_target, const shared_ptr<CostMap> &cost_map,
+                      const shared_ptr<TemporalHistory> &history) const {
+    // Ensure instances is not nullptr
+    if (instances == nullptr)
+        throw RendererException("Renderer::render(): instances cannot be nullptr");
+
+    // Ensure the top-level hierarchy covers every instance
+    if (!instances->is_built())
+        throw RendererException("Renderer::render(): instances must be built before rendering");
+
+    // Ensure the render only needs what instances support, both pre-passes work on sphere groups
+    if (irradiance_cache.enabled || path_guiding.enabled)
+        throw RendererException(
+            "Renderer::render(): the irradiance cache and path guiding are not supported for instances");
+
+    validateRenderTarget(render_target, "render");
+    const int width = render_target->get_width();
+    const int height = render_target->get_height();
+    const RT_CROP region = validateRegion(camera, width, height, "render");
+    validateCostMap(cost_map, width, height, "render");
+    validateHistory(history, width, height, "render");
+
+    BLUNDER_PROFILE_ZONE("Render");
+
+    RT_RENDER_OPTIONS options;
+    options.cost_map = cost_map;
+    options.history = history;
+
+    RenderJob job;
+    renderTiles(*instances, initializeRTCamera(camera, width, height), region, renderTargetWriter(render_target),
+                options, job);
+}
+
+shared_ptr<RenderJob> Renderer::renderAsync(const shared_ptr<SphereList> &spheres, const shared_ptr<Camera> &camera,
+                                            const shared_ptr<RenderTarget> &render_target,
+                                            const RT_RENDER_OPTIONS &options) const {
+    validateRenderTarget(render_target, "renderAsync");
+    const int width = render_target->get_width();
+    const int height = render_target->get_height();
+    const RT_CROP region = validateRender(spheres, camera, width, height, "renderAsync");
+    validateCostMap(options.cost_map, width, height, "renderAsync");
+    validateHistory(options.history, width, height, "renderAsync");
+
+    return startRender(spheres, initializeRTCamera(camera, width, height), region, renderTargetWriter(render_target),
+                       options);
+}
+
+shared_ptr<RenderJob> Renderer::renderAsync(const shared_ptr<SphereList> &spheres, const shared_ptr<Camera> &camera,
+                                            const RT_FRAMEBUFFER &framebuffer,
+                                            const RT_RENDER_OPTIONS &options) const {
+    validateFramebuffer(framebuffer, "renderAsync");
+    const RT_CROP region = validateRender(spheres, camera, framebuffer.width, framebuffer.height, "renderAsync");
+    validateCostMap(options.cost_map, framebuffer.width, framebuffer.height, "renderAsync");
+    validateHistory(options.history, framebuffer.width, framebuffer.height, "renderAsync");
+
+    return startRender(spheres, initializeRTCamera(camera, framebuffer.width, framebuffer.height), region,
+                       framebufferWriter(framebuffer), options);
+}
+
+shared_ptr<RenderJob> Renderer::startRender(const shared_ptr<SphereList> &spheres,
+                                            const RT_CAMERA_VALUES &rt_camera_values, const RT_CROP &region,
+                                            const RowWriter &write, const RT_RENDER_OPTIONS &options) const {
+    // The job outlives the task: its destructor cancels and waits for it, so the task can refer to it
+    auto job = make_shared<RenderJob>();
+    RenderJob *state = job.get();
+    job->result = std::async(std::launch::async, [renderer = *this, spheres, rt_camera_values, region, write, options,
+                                 state] {
+        BLUNDER_PROFILE_ZONE("Render");
+
+        // Packing a large scene takes a while, a render stopped before it is done does not start
+        if (state->cancelled)
+            return RenderStatus::Cancelled;
+        if (std::chrono::steady_clock::now() >= options.deadline)
+            return RenderStatus::TimedOut;
+        const auto accelerator = spheres->get_accelerator();
+        return renderer.renderTiles(*accelerator, rt_camera_values, region, write, options, *state);
+    }).share();
+
+    return job;
+}
+
+RT_CROP Renderer::validateRender(const shared_ptr<SphereList> &spheres, const shared_ptr<Camera> &camera,
+                                 const int width, const int height, const std::string &caller) const {
     // Ensure spheres is not nullptr
     if (spheres == nullptr)
-        throw RendererException("Renderer::render(): spheres cannot be nullptr");
+        throw RendererException("Renderer::" + caller + "(): spheres cannot be nullptr");
+
+    return validateRegion(camera, width, height, caller);
+}
 
+RT_CROP Renderer::validateRegion(const shared_ptr<Camera> &camera, const int width, const int height,
+                                 const std::string &caller) const {
     // Ensure camera is not nullptr
     if (camera == nullptr)
-        throw RendererException("Renderer::render(): camera cannot be nullptr");
+        throw RendererException("Renderer::" + caller + "(): camera cannot be nullptr");
+
+    // Region traced, the whole image unless cropped
+    RT_CROP region = crop;
+    if (region.width == 0 && region.height == 0) {
+        region.width = width;
+        region.height = height;
+    }
+
+    // Ensure the region fits inside the image
+    if (region.x + region.width > width || region.y + region.height > height)
+        throw RendererException("Renderer::" + caller + "(): crop window does not fit inside the image");
 
+    return region;
+}
+
+void Renderer::validateRenderTarget(const shared_ptr<RenderTarget> &render_target, const std::string &caller) {
     // Ensure render_target is not nullptr
     if (render_target == nullptr)
-        throw RendererException("Renderer::render(): render_target cannot be nullptr");
+        throw RendererException("Renderer::" + caller + "(): render_target cannot be nullptr");
+}
+
+void Renderer::validateFramebuffer(const RT_FRAMEBUFFER &framebuffer, const std::string &caller) {
+    // Ensure data is not nullptr
+    if (framebuffer.data == nullptr)
+        throw RendererException("Renderer::" + caller + "(): framebuffer data cannot be nullptr");
+
+    // Ensure the size is positive
+    if (framebuffer.width <= 0 || framebuffer.height <= 0)
+        throw RendererException("Renderer::" + caller + "(): framebuffer size must be positive");
+
+    // Ensure rows do not overlap
+    const size_t pixel_size = framebuffer.format == PixelFormat::RGBA32F ? 4 * sizeof(float) : 4;
+    if (framebuffer.stride != 0 && framebuffer.stride < pixel_size * framebuffer.width)
+        throw RendererException("Renderer::" + caller + "(): framebuffer stride is smaller than a row");
+
+    // Ensure float rows are aligned for float stores
+    const auto address = reinterpret_cast<uintptr_t>(framebuffer.data);
+    if (framebuffer.format == PixelFormat::RGBA32F &&
+        (address % alignof(float) != 0 || framebuffer.stride % alignof(float) != 0))
+        throw RendererException("Renderer::" + caller + "(): float framebuffer data and stride must be float-aligned");
+}
+
+void Renderer::validateCostMap(const shared_ptr<CostMap> &cost_map, const int width, const int height,
+                               const std::string &caller) {
+    // Ensure the cost map, if any, covers the image exactly
+    if (cost_map != nullptr && (cost_map->get_width() != width || cost_map->get_height() != height))
+        throw RendererException("Renderer::" + caller + "(): cost map must be the size of the image");
+}
+
+void Renderer::validateHistory(const shared_ptr<TemporalHistory> &history, const int width, const int height,
+                               const std::string &caller) {
+    // Ensure the history, if any, covers the image exactly
+    if (history != nullptr && (history->get_width() != width || history->get_height() != height))
+        throw RendererException("Renderer::" + caller + "(): temporal history must be the size of the image");
+}
+
+Renderer::RowWriter Renderer::renderTargetWriter(const shared_ptr<RenderTarget> &render_target) {
+    return [render_target](const int x, const int y, const int count, const float *rgb) {
+        render_target->writeRow(x, y, count, rgb);
+    };
+}
+
+Renderer::RowWriter Renderer::framebufferWriter(const RT_FRAMEBUFFER &framebuffer) {
+    const size_t pixel_size = framebuffer.format == PixelFormat::RGBA32F ? 4 * sizeof(float) : 4;
+    const size_t stride = framebuffer.stride != 0 ? framebuffer.stride : pixel_size * framebuffer.width;
+    auto *const data = static_cast<unsigned char *>(framebuffer.data);
+
+    if (framebuffer.format == PixelFormat::RGBA32F) {
+        return [data, stride](const int x, const int y, const int count, const float *rgb) {
+            auto *out = reinterpret_cast<float *>(data + stride * y) + 4 * static_cast<size_t>(x);
+            for (int i = 0; i < count; i++) {
+                out[4 * i] = rgb[3 * i];
+                out[4 * i + 1] = rgb[3 * i + 1];
+                out[4 * i + 2] = rgb[3 * i + 2];
+                out[4 * i + 3] = 1.0f;
+            }
+        };
+    }
+
+    return [data, stride, post_process = framebuffer.post_process](const int x, const int y, const int count,
+                                                                   const float *rgb) {
+        // Quantized through the post process like writeToFile(), then spread out to RGBA
+        thread_local std::vector<unsigned char> encoded;
+        encoded.resize(3 * static_cast<size_t>(count));
+        post_process.applyRow(rgb, encoded.size(), encoded.data());
+
+        unsigned char *out = data + stride * y + 4 * static_cast<size_t>(x);
+        for (int i = 0; i < count; i++) {
+            out[4 * i] = encoded[3 * i];
+            out[4 * i + 1] = encoded[3 * i + 1];
+            out[4 * i + 2] = encoded[3 * i + 2];
+            out[4 * i + 3] = 255;
+        }
+    };
+}
+
+template<class Scene>
+RenderStatus Renderer::renderTiles(const Scene &scene, const RT_CAMERA_VALUES &rt_camera_values,
+                                   const RT_CROP &region, const RowWriter &write, const RT_RENDER_OPTIONS &options,
+                                   RenderJob &job) const {
+    // Tiles of the region, moved to its position
+    auto tiles = Tiling::makeTiles(region.width, region.height, tiling);
+    for (auto &tile: tiles) {
+        tile.x += region.x;
+        tile.y += region.y;
+    }
+    job.tiles_total = tiles.size();
+
+    // Stops are checked before every tile row, so threads are freed within one row's worth of tracing. Tiles are
+    // traced into buffers and only written once complete, so a stopped render leaves unfinished tiles untouched.
+    std::atomic<bool> timed_out{false};
+    const std::function<bool()> stopped = [&] {
+        if (job.cancelled.load(std::memory_order_relaxed) || timed_out.load(std::memory_order_relaxed))
+            return true;
+        if (options.deadline != std::chrono::steady_clock::time_point::max() &&
+            std::chrono::steady_clock::now() >= options.deadline) {
+            timed_out = true;
+            return true;
+        }
+        return false;
+    };
+    if (stopped())
+        return job.cancelled ? RenderStatus::Cancelled : RenderStatus::TimedOut;
+
+    // Read-only from here on, shared by every render thread. Both pre-passes trace sphere groups only.
+    constexpr bool grouped = std::is_same_v<Scene, SphereGroup>;
+    shared_ptr<IrradianceCache> cache;
+    // Training samples are as unbiased as the image's, so they are averaged in rather than thrown away
+    std::vector<vec3> training;
+    shared_ptr<PathGuide> guide;
+    if constexpr (grouped) {
+        if (irradiance_cache.enabled)
+            cache = buildIrradianceCache(scene, rt_camera_values, region, stopped);
+        if (path_guiding.enabled)
+            guide = trainPathGuide(scene, rt_camera_values, region, stopped, &training);
+    }
+    const Guiding guiding{guide.get(), path_guiding.guided_fraction, false};
+    const int training_samples = guide != nullptr ? (1 << path_guiding.training_passes) - 1 : 0;
+    if (options.history != nullptr)
+        options.history->beginFrame(rt_camera_values);
+
+    // Every frame of an animation draws new numbers, so the history averages them
+    const uint64_t frame_seed = mix_seed(seed, options.history != nullptr ? options.history->get_frames() : 0);
+    const uint64_t jitter_seed = StreamSeed(frame_seed, RandomUse::Jitter);
+    const uint64_t path_seed = StreamSeed(frame_seed, RandomUse::Path);
+
+    // Tiles are claimed in order, so the tiles in flight stay close together along the tile order's curve
+    std::atomic<size_t> next_tile{0};
+    std::mutex progress_mutex;
+
+    const auto threads = static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency()));
+    const int workers = static_cast<int>(std::min(tiles.size(), threads));
+    parallel_for(workers, [&](int, int) {
+        // Camera rays of the current tile, its traced pixels and their costs, reused between tiles
+        RT_RAY_BATCH batch{};
+        std::vector<float> pixels;
+        std::vector<RT_PIXEL_COST> costs;
+
+        for (size_t t = next_tile++; t < tiles.size() && !stopped(); t = next_tile++) {
+            const RT_TILE &tile = tiles[t];
+            BLUNDER_PROFILE_ZONE_ARG("Render tile", static_cast<int64_t>(t));
+            const auto tile_start = std::chrono::steady_clock::now();
+            getRaysInTile(tile.x, tile.y, tile.width, tile.height, get_samples(), rt_camera_values, batch,
+                          jitter_seed);
+            // Camera rays find their spheres through the hierarchy, a tile seeing none of a group's spheres is sky
+            bool sky_only = scene.size() == 0;
+            if constexpr (grouped)
+                sky_only = !tileSeesSpheres(tile, rt_camera_values, scene);
+            size_t k = 0;
+
+            pixels.resize(3 * static_cast<size_t>(tile.width) * tile.height);
+            costs.assign(options.cost_map != nullptr ? static_cast<size_t>(tile.width) * tile.height : 0, {});
+            for (int j = tile.y; j < tile.y + tile.height; j++) {
+                if (stopped())
+                    return;
+
+                for (int i = 0; i < tile.width; i++) {
+                    const size_t p = static_cast<size_t>(j - tile.y) * tile.width + i;
+                    seedRandom(PixelSeed(path_seed, tile.x + i, j));
+                    vec3 color{0};
+                    RT_PIXEL_COST *const counted = options.cost_map != nullptr ? &costs[p] : nullptr;
+
+                    // Tiles that see no sphere need no intersection tests
+                    for (int s = 0; s < get_samples(); s++, k++) {
+                        const vec3 origin(batch.origin_x[k], batch.origin_y[k], batch.origin_z[k]);
+                        const vec3 direction(batch.direction_x[k], batch.direction_y[k], batch.direction_z[k]);
+                        color += sky_only ? SkyRadiance(direction)
+                                          : TraceRay(origin, direction, get_max_depth(), scene, counted, cache.get(),
+                                                     guide != nullptr ? &guiding : nullptr);
+                    }
+
+                    if (!training.empty())
+                        color += training[static_cast<size_t>(j - region.y) * region.width + (tile.x + i - region.x)];
+
+                    color /= static_cast<float>(get_samples() + training_samples);
+                    pixels[3 * p] = color.x;
+                    pixels[3 * p + 1] = color.y;
+                    pixels[3 * p + 2] = color.z;
+                }
+            }
+
+            // The tile is complete, its pixels are blended with the history and written out
+            for (int j = tile.y; j < tile.y + tile.height; j++) {
+                const size_t first = static_cast<size_t>(j - tile.y) * tile.width;
+                float *const row = pixels.data() + 3 * first;
+                for (int i = 0; i < tile.width; i++) {
+                    if (options.cost_map != nullptr)
+                        options.cost_map->set_cost(tile.x + i, j, costs[first + i]);
+
+                    // The surface seen through the pixel center finds the pixels that saw it in the previous frame
+                    if (options.history != nullptr) {
+                        HitRecord first{};
+                        const Ray center(rt_camera_values.position,
+                                         rt_camera_values.pixel_upper_left - rt_camera_values.position +
+                                         static_cast<float>(tile.x + i) * rt_camera_values.pixel_delta_u +
+                                         static_cast<float>(j) * rt_camera_values.pixel_delta_v);
+                        const vec3 color(row[3 * i], row[3 * i + 1], row[3 * i + 2]);
+                        vec3 blended = color;
+                        if (!sky_only && scene.Hit(center, 0.001, 1000000, first))
+                            blended = options.history->accumulate(tile.x + i, j, first.get_point(),
+                                                                  first.get_normal(), color,
+                                                                  get_samples() + training_samples);
+                        else
+                            options.history->clear(tile.x + i, j);
+                        row[3 * i] = blended.x;
+                        row[3 * i + 1] = blended.y;
+                        row[3 * i + 2] = blended.z;
+                    }
+                }
+
+                write(tile.x, j, tile.width, row);
+            }
+
+            if (options.cost_map != nullptr)
+                options.cost_map->set_tile_time(tile, std::chrono::duration<double, std::nano>(
+                                                    std::chrono::steady_clock::now() - tile_start).count());
+
+            std::lock_guard lock(progress_mutex);
+            const size_t done = ++job.tiles_done;
+            if (options.on_progress)
+                options.on_progress({done, tiles.size(), tile});
+        }
+    });
+
+    if (job.tiles_done == tiles.size())
+        return RenderStatus::Completed;
+    return job.cancelled ? RenderStatus::Cancelled : RenderStatus::TimedOut;
+}
+
+shared_ptr<IrradianceCache> Renderer::buildIrradianceCache(const shared_ptr<SphereList> &spheres,
+                                                           const shared_ptr<Camera> &camera, const int width,
+                                                           const int height) const {
+    const RT_CROP region = validateRender(spheres, camera, width, height, "buildIrradianceCache");
+    return buildIrradianceCache(*spheres->get_accelerator(), initializeRTCamera(camera, width, height), region,
+                                [] { return false; });
+}
+
+shared_ptr<IrradianceCache> Renderer::buildIrradianceCache(const SphereGroup &scene,
+                                                           const RT_CAMERA_VALUES &rt_camera_values,
+                                                           const RT_CROP &region,
+                                                           const std::function<bool()> &stopped) const {
+    BLUNDER_PROFILE_ZONE("Irradiance cache");
+
+    // Spacing not given is scaled to the mean distance camera rays travel before hitting a sphere
+    float min_spacing = irradiance_cache.min_spacing;
+    float max_spacing = irradiance_cache.max_spacing;
+    if (min_spacing == 0 || max_spacing == 0) {
+        float total = 0;
+        int hits = 0;
+        HitRecord record{};
+        for (int j = 0; j < SPACING_RAYS; j++) {
+            for (int i = 0; i < SPACING_RAYS; i++) {
+                const Ray ray = getRayAtPixel(region.x + (2 * i + 1) * region.width / (2 * SPACING_RAYS),
+                                              region.y + (2 * j + 1) * region.height / (2 * SPACING_RAYS),
+                                              rt_camera_values);
+                if (scene.Hit(ray, 0.001, 1000000, record)) {
+                    total += record.get_t() * length(ray.get_direction());
+                    hits++;
+                }
+            }
+        }
+
+        // A camera seeing only sky needs no records, any spacing will do
+        const float mean = hits > 0 ? total / static_cast<float>(hits) : 1.0f;
+        if (max_spacing == 0)
+            max_spacing = std::max(min_spacing, AUTO_MAX_SPACING * mean);
+        if (min_spacing == 0)
+            min_spacing = std::min(max_spacing, AUTO_MIN_SPACING * mean);
+    }
+
+    auto cache = make_shared<IrradianceCache>(irradiance_cache.accuracy, min_spacing, max_spacing);
 
-    // Get RT_CAMERA_VALUES for ray query information
-    auto rt_camera_values = initializeRTCamera(camera, render_target);
+    // Records stand in for paths at their second hit, where max_depth - 2 hits are left
+    const int depth = get_max_depth() - 2;
+    if (depth <= 0)
+        return cache;
 
-    // Rendered rows
-    int rendered_rows = 0;
+    const int theta_strata = irradiance_cache.theta_strata;
+    const int phi_strata = static_cast<int>(std::lround(3.14159265f * static_cast<float>(theta_strata)));
 
-    for (int j = 0; j < render_target->get_height(); j++) {
-        for (int i = 0; i < render_target->get_width(); i++) {
-            vec3 color{0};
+    for (int stride = FIRST_RECORD_STRIDE; stride >= 2 && !stopped(); stride /= 2) {
+        // Second hits of one path per grid pixel, where no record covers them yet
+        const int columns = (region.width + stride - 1) / stride;
+        const int rows = (region.height + stride - 1) / stride;
+        std::vector<std::vector<RecordSite> > found(rows);
+        const uint64_t sites_seed = mix_seed(StreamSeed(seed, RandomUse::CacheSites), stride);
+        parallel_for(rows, [&](const int begin, const int end) {
+            HitRecord record{};
+            vec3 irradiance;
+            for (int row = begin; row < end; row++) {
+                for (int column = 0; column < columns; column++) {
+                    seedRandom(PixelSeed(sites_seed, column, row));
+                    Ray ray = getRayAtPixel(region.x + column * stride, region.y + row * stride, rt_camera_values);
+                    if (!scene.Hit(ray, 0.001, 1000000, record))
+                        continue;
 
-            for (int k = 0; k < get_samples(); k++) {
-                Ray ray = getRayAtPixel(i, j, rt_camera_values);
-                color += getRayColor(ray, spheres).get_color();
+                    scatter(record, ray);
+                    if (scene.Hit(ray, 0.001, 1000000, record) &&
+                        !cache->lookup(record.get_point(), record.get_normal(), irradiance))
+                        found[row].push_back({record.get_point(), record.get_normal()});
+                }
             }
+        });
+
+        std::vector<RecordSite> sites;
+        for (const auto &row: found)
+            sites.insert(sites.end(), row.begin(), row.end());
+
+        // Gathering is nearly all of the work, and every record is independent
+        std::vector<RT_IRRADIANCE_RECORD> records(sites.size());
+        std::vector<char> gathered(sites.size(), 0);
+        const uint64_t records_seed = mix_seed(StreamSeed(seed, RandomUse::CacheRecords), stride);
+        parallel_for(static_cast<int>(sites.size()), [&](const int begin, const int end) {
+            std::vector<vec3> radiance;
+            std::vector<float> distance;
+            for (int n = begin; n < end && !stopped(); n++) {
+                seedRandom(mix_seed(records_seed, n));
+                records[n] = GatherRecord(*cache, sites[n], theta_strata, phi_strata, depth, scene, radiance,
+                                          distance);
+                gathered[n] = 1;
+            }
+        });
+
+        // Sites close together in one pass gather overlapping records, only the first is kept
+        vec3 irradiance;
+        for (size_t n = 0; n < records.size(); n++)
+            if (gathered[n] && !cache->lookup(records[n].position, records[n].normal, irradiance))
+                cache->add(records[n]);
+    }
+
+    return cache;
+}
+
+shared_ptr<PathGuide> Renderer::trainPathGuide(const shared_ptr<SphereList> &spheres, const shared_ptr<Camera> &camera,
+                                               const int width, const int height) const {
+    const RT_CROP region = validateRender(spheres, camera, width, height, "trainPathGuide");
+    return trainPathGuide(*spheres->get_accelerator(), initializeRTCamera(camera, width, height), region,
+                          [] { return false; }, nullptr);
+}
+
+shared_ptr<PathGuide> Renderer::trainPathGuide(const SphereGroup &scene, const RT_CAMERA_VALUES &rt_camera_values,
+                                               const RT_CROP &region, const std::function<bool()> &stopped,
+                                               std::vector<vec3> *radiance) const {
+    BLUNDER_PROFILE_ZONE("Path guide");
 
-            color /= get_samples();
-            render_target->set_pixel(i, j, Color(color));
+    // The guide covers where most of a grid of camera paths bounce. Paths wander far along large ground spheres, so
+    // the few outermost bounces on each axis are left out, the regions at the edge of the box taking them.
+    std::vector<float> bounces[3];
+    HitRecord record{};
+    seedRandom(StreamSeed(seed, RandomUse::GuideBounds));
+    for (int j = 0; j < GUIDE_BOUNDS_PATHS; j++) {
+        for (int i = 0; i < GUIDE_BOUNDS_PATHS; i++) {
+            Ray ray = getRayAtPixel(region.x + (2 * i + 1) * region.width / (2 * GUIDE_BOUNDS_PATHS),
+                                    region.y + (2 * j + 1) * region.height / (2 * GUIDE_BOUNDS_PATHS),
+                                    rt_camera_values);
+            for (int depth = get_max_depth(); depth > 0 && scene.Hit(ray, 0.001, 1000000, record); depth--) {
+                for (int axis = 0; axis < 3; axis++)
+                    bounces[axis].push_back(record.get_point()[axis]);
+                scatter(record, ray);
+            }
         }
+    }
+
+    // A camera seeing only sky needs no guide, any box will do
+    vec3 minimum = rt_camera_values.position, maximum = rt_camera_values.position;
+    for (int axis = 0; axis < 3 && !bounces[axis].empty(); axis++) {
+        auto &values = bounces[axis];
+        const size_t outer = static_cast<size_t>(GUIDE_BOUNDS_OUTLIERS * static_cast<float>(values.size()));
+        std::nth_element(values.begin(), values.begin() + outer, values.end());
+        minimum[axis] = values[outer];
+        std::nth_element(values.begin(), values.end() - 1 - outer, values.end());
+        maximum[axis] = values[values.size() - 1 - outer];
+    }
+
+    auto guide = make_shared<PathGuide>(minimum, maximum);
+    const Guiding learning{guide.get(), path_guiding.guided_fraction, true};
+    if (radiance != nullptr)
+        radiance->assign(static_cast<size_t>(region.width) * static_cast<size_t>(region.height), vec3(0));
+
+    for (int pass = 0; pass < path_guiding.training_passes && !stopped(); pass++) {
+        // Every thread records into the guide at once, which only adds to atomics
+        const int samples = 1 << pass;
+        const uint64_t pass_seed = mix_seed(StreamSeed(seed, RandomUse::GuideTraining), pass);
+        parallel_for(region.height, [&](const int begin, const int end) {
+            for (int j = begin; j < end && !stopped(); j++) {
+                for (int i = 0; i < region.width; i++) {
+                    seedRandom(PixelSeed(pass_seed, region.x + i, region.y + j));
+                    vec3 color{0};
+                    for (int s = 0; s < samples; s++) {
+                        const Ray ray = getRayAtPixel(region.x + i, region.y + j, rt_camera_values);
+                        color += TraceRay(ray.get_position(), ray.get_direction(), get_max_depth(), scene, nullptr,
+                                          nullptr, &learning);
+                    }
+                    if (radiance != nullptr)
+                        (*radiance)[static_cast<size_t>(j) * region.width + i] += color;
+                }
+            }
+        });
+
+        guide->refine(static_cast<size_t>(GUIDE_SPLIT_VISITS * std::sqrt(static_cast<float>(samples))));
+    }
+
+    return guide;
+}
+
+RenderJob::~RenderJob() {
+    cancel();
+    if (result.valid())
+        result.wait();
+}
 
-        rendered_rows += 1;
-        std::cout << "Rendering in progress: " << 100.0f * static_cast<float>(rendered_rows) / static_cast<float>(
-            render_target->get_height()) << "%\n";
+void RenderJob::cancel() {
+    cancelled = true;
+}
+
+bool RenderJob::wait_for(const int timeout_ms) const {
+    if (!result.valid())
+        return true;
+    if (timeout_ms < 0) {
+        result.wait();
+        return true;
+    }
+    return result.wait_for(std::chrono::milliseconds(timeout_ms)) == std::future_status::ready;
+}
+
+RenderStatus RenderJob::wait() const {
+    if (!result.valid())
+        return RenderStatus::Completed;
+    return result.get();
+}
+
+RenderStatus RenderJob::get_status() const {
+    if (!wait_for(0))
+        return RenderStatus::Running;
+
+    try {
+        return wait();
+    } catch (...) {
+        return RenderStatus::Failed;
     }
 }
 
+float RenderJob::get_progress() const {
+    const size_t total = tiles_total;
+    return total == 0 ? 0.0f : static_cast<float>(tiles_done) / static_cast<float>(total);
+}
+
 RT_CAMERA_VALUES Renderer::initializeRTCamera(const shared_ptr<Camera> &camera,
                                               const shared_ptr<RenderTarget> &render_target) {
     // Ensure camera is not nullptr
@@ -54,6 +986,18 @@ RT_CAMERA_VALUES Renderer::initializeRTCamera(const shared_ptr<Camera> &camera,
     if (render_target == nullptr)
         throw RendererException("Renderer::initializeRTCamera(): render_target cannot be nullptr");
 
+    return initializeRTCamera(camera, render_target->get_width(), render_target->get_height());
+}
+
+RT_CAMERA_VALUES Renderer::initializeRTCamera(const shared_ptr<Camera> &camera, const int width, const int height) {
+    // Ensure camera is not nullptr
+    if (camera == nullptr)
+        throw RendererException("Renderer::initializeRTCamera(): camera cannot be nullptr");
+
+    // Ensure the size is positive
+    if (width <= 0 || height <= 0)
+        throw RendererException("Renderer::initializeRTCamera(): width and height must be positive");
+
     // Continue, all values validated and guaranteed to not cause issues
     RT_CAMERA_VALUES rtc{};
 
@@ -65,9 +1009,7 @@ RT_CAMERA_VALUES Renderer::initializeRTCamera(const shared_ptr<Camera> &camera,
     rtc.theta = degrees_to_radians(camera->get_fov());
     rtc.h = std::tan(rtc.theta / 2.0f);
     rtc.viewport_height = 2.0f * rtc.h * rtc.focal_length;
-    rtc.viewport_width = rtc.viewport_height * (
-                             static_cast<float>(render_target->get_width()) / static_cast<float>(render_target->
-                                 get_height()));
+    rtc.viewport_width = rtc.viewport_height * (static_cast<float>(width) / static_cast<float>(height));
 
     rtc.w = normalize(rtc.position - rtc.direction);
     rtc.u = normalize(cross(rtc.up_direction, rtc.w));
@@ -76,8 +1018,8 @@ RT_CAMERA_VALUES Renderer::initializeRTCamera(const shared_ptr<Camera> &camera,
     rtc.viewport_u = rtc.viewport_width * rtc.u;
     rtc.viewport_v = rtc.viewport_height * -rtc.v;
 
-    rtc.pixel_delta_u = rtc.viewport_u / static_cast<float>(render_target->get_width());
-    rtc.pixel_delta_v = rtc.viewport_v / static_cast<float>(render_target->get_height());
+    rtc.pixel_delta_u = rtc.viewport_u / static_cast<float>(width);
+    rtc.pixel_delta_v = rtc.viewport_v / static_cast<float>(height);
 
     rtc.viewport_upper_left = camera->get_position() - (rtc.focal_length * rtc.w) - rtc.viewport_u / 2.0f - rtc
                               .viewport_v / 2.0f;
@@ -110,42 +1052,128 @@ Ray Renderer::getRayAtPixel(const int i, const int j, const RT_CAMERA_VALUES &rt
     return {ray_origin, ray_direction};
 }
 
-Color Renderer::getRayColor(Ray ray, const shared_ptr<SphereList> &spheres) const {
+void Renderer::getRaysInTile(const int x, const int y, const int width, const int height, const int samples,
+                             const RT_CAMERA_VALUES &rt_camera_values, RT_RAY_BATCH &batch, const uint64_t seed) {
+    // Ensure x and y are non-negative
+    if (x < 0 || y < 0)
+        throw RendererException("Renderer::getRaysInTile(): x and y must not be negative");
+
+    // Ensure the block has a size
+    if (width <= 0 || height <= 0)
+        throw RendererException("Renderer::getRaysInTile(): width and height must be positive");
+
+    // Ensure samples is positive
+    if (samples <= 0)
+        throw RendererException("Renderer::getRaysInTile(): samples must be positive");
+
+    batch.x = x;
+    batch.y = y;
+    batch.width = width;
+    batch.height = height;
+    batch.samples = samples;
+
+    const size_t count = static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(samples);
+    batch.origin_x.resize(count);
+    batch.origin_y.resize(count);
+    batch.origin_z.resize(count);
+    batch.direction_x.resize(count);
+    batch.direction_y.resize(count);
+    batch.direction_z.resize(count);
+
+    // Jittered pixel coordinates are staged in the direction buffers (x -> u, y -> v) before being replaced.
+    // The random number generator is scalar, so this is the only loop that has to be.
+    float *u = batch.direction_x.data();
+    float *v = batch.direction_y.data();
+    size_t k = 0;
+    for (int j = y; j < y + height; j++) {
+        for (int i = x; i < x + width; i++) {
+            seed_random(PixelSeed(seed, i, j));
+            for (int s = 0; s < samples; s++, k++) {
+                u[k] = static_cast<float>(i) + random_float() - 0.5f;
+                v[k] = static_cast<float>(j) + random_float() - 0.5f;
+            }
+        }
+    }
+
+    // Branch-free, dependency-free loops over contiguous arrays, which vectorize
+    const vec3 origin = rt_camera_values.position;
+    const vec3 base = rt_camera_values.pixel_upper_left - origin;
+    const vec3 du = rt_camera_values.pixel_delta_u;
+    const vec3 dv = rt_camera_values.pixel_delta_v;
+    float *ox = batch.origin_x.data();
+    float *oy = batch.origin_y.data();
+    float *oz = batch.origin_z.data();
+    float *dx = batch.direction_x.data();
+    float *dy = batch.direction_y.data();
+    float *dz = batch.direction_z.data();
+
+    for (size_t n = 0; n < count; n++) {
+        ox[n] = origin.x;
+        oy[n] = origin.y;
+        oz[n] = origin.z;
+    }
+
+    for (size_t n = 0; n < count; n++) {
+        const float pu = u[n];
+        const float pv = v[n];
+        dx[n] = base.x + pu * du.x + pv * dv.x;
+        dy[n] = base.y + pu * du.y + pv * dv.y;
+        dz[n] = base.z + pu * du.z + pv * dv.z;
+    }
+}
+
+Color Renderer::getRayColor(const Ray ray, const shared_ptr<SphereList> &spheres) const {
     // Ensure spheres is not nullptr
     if (spheres == nullptr)
         throw RendererException("Renderer::getRayColor(): spheres cannot be nullptr");
 
-    // Calculate ray color
-    int depth = this->get_max_depth();
+    return Color(TraceRay(ray.get_position(), ray.get_direction(), get_max_depth(), *spheres));
+}
 
-    HitRecord record{};
-    vec3 color{0};
-    vec3 attenuation{1.0f};
-
-    while (depth > 0) {
-        if (spheres->Hit(ray, 0.001, 1000000, record)) {
-            scatter(record, ray);
-            attenuation *= record.get_color().get_color();
-            depth--;
-        } else {
-            color += attenuation * getSkyColor(ray).get_color();
-            depth = 0;
+bool Renderer::tileSeesSpheres(const RT_TILE &tile, const RT_CAMERA_VALUES &rt_camera_values,
+                               const SphereGroup &spheres) {
+    const BoundingVolumeHierarchy &hierarchy = spheres.get_hierarchy();
+    if (hierarchy.size() == 0)
+        return false;
+
+    // Subtrees whose box lies outside the pyramid are skipped whole, only the spheres of leaves inside are tested
+    const TileFrustum frustum(tile, rt_camera_values);
+    uint32_t stack[BoundingVolumeHierarchy::MAX_DEPTH];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const RT_BVH_NODE &node = hierarchy.get_node(stack[--top]);
+        if (!frustum.overlaps(node.minimum, node.maximum))
+            continue;
+
+        if (node.count == 0) {
+            stack[top++] = node.first;
+            stack[top++] = node.first + 1;
+            continue;
+        }
+
+        for (uint32_t i = node.first; i < node.first + node.count; i++) {
+            const vec4 sphere = spheres.get_spheres().get_sphere(i);
+            if (frustum.contains(vec3(sphere.x, sphere.y, sphere.z), sphere.w))
+                return true;
         }
     }
 
-    return Color(color);
+    return false;
 }
 
 Color Renderer::getSkyColor(const Ray &ray) {
-    const vec3 unit_direction = normalize(ray.get_direction());
-    auto a = 0.5f * (unit_direction.z + 1);
-    const auto bottom_color = vec3(0);
-    const auto top_color = vec3(1);
-    return Color(((1.0f - a) * bottom_color) + (a * top_color));
+    return Color(SkyRadiance(ray.get_direction()));
+}
+
+void Renderer::seedRandom(const uint64_t seed) {
+    seed_random(seed);
+    direction_pool.reset();
 }
 
 bool Renderer::scatter(const HitRecord &hit_record, Ray &scattered_ray) {
-    vec3 direction = hit_record.get_normal() + random_unit_vector();
+    // Bounce directions are generated a block at a time, then handed out one per scatter
+    vec3 direction = hit_record.get_normal() + direction_pool.next();
 
     if (is_near_zero(direction))
         direction = hit_record.get_normal();
@@ -171,3 +1199,78 @@ void Renderer::set_max_depth(const int max_depth) {
     // Set max_depth
     this->max_depth = max_depth;
 }
+
+void Renderer::set_tiling(const RT_TILING &tiling) {
+    // Ensure the tile size is positive, or 0 x 0 for automatic
+    const bool automatic = tiling.tile_width == 0 && tiling.tile_height == 0;
+    if (!automatic && (tiling.tile_width <= 0 || tiling.tile_height <= 0))
+        throw RendererException("Renderer::set_tiling(): tile size must be positive, or 0 x 0 for automatic");
+
+    // Set tiling
+    this->tiling = tiling;
+}
+
+void Renderer::set_crop(const RT_CROP &crop) {
+    // Ensure the position is non-negative
+    if (crop.x < 0 || crop.y < 0)
+        throw RendererException("Renderer::set_crop(): position must be non-negative");
+
+    // Ensure the size is positive, or 0 x 0 for the whole image
+    const bool whole = crop.width == 0 && crop.height == 0;
+    if (!whole && (crop.width <= 0 || crop.height <= 0))
+        throw RendererException("Renderer::set_crop(): size must be positive, or 0 x 0 for the whole image");
+
+    // Set crop
+    this->crop = crop;
+}
+
+void Renderer::set_irradiance_cache(const RT_IRRADIANCE_CACHE &irradiance_cache) {
+    // Ensure accuracy is in (0, 1]
+    if (!(irradiance_cache.accuracy > 0 && irradiance_cache.accuracy <= 1))
+        throw RendererException("Renderer::set_irradiance_cache(): accuracy must be in (0, 1]");
+
+    // Ensure the hemisphere has strata
+    if (irradiance_cache.theta_strata <= 0)
+        throw RendererException("Renderer::set_irradiance_cache(): theta_strata must be positive");
+
+    // Ensure the spacing is finite and non-negative, and ordered when both are given
+    if (!(irradiance_cache.min_spacing >= 0) || !(irradiance_cache.max_spacing >= 0) ||
+        !is_finite(irradiance_cache.min_spacing) || !is_finite(irradiance_cache.max_spacing))
+        throw RendererException("Renderer::set_irradiance_cache(): spacing must be finite and non-negative");
+    if (irradiance_cache.min_spacing > 0 && irradiance_cache.max_spacing > 0 &&
+        irradiance_cache.min_spacing > irradiance_cache.max_spacing)
+        throw RendererException("Renderer::set_irradiance_cache(): min_spacing cannot exceed max_spacing");
+
+    // Set irradiance_cache
+    this->irradiance_cache = irradiance_cache;
+}
+
+void Renderer::set_path_guiding(const RT_PATH_GUIDING &path_guiding) {
+    // Ensure there is a training pass, and few enough that the last one's sample count fits
+    if (path_guiding.training_passes <= 0 || path_guiding.training_passes > MAX_TRAINING_PASSES)
+        throw RendererException("Renderer::set_path_guiding(): training_passes must be in [1, 16]");
+
+    // Ensure the cosine lobe keeps a share of the bounces, for the light the guide has not found
+    if (!(path_guiding.guided_fraction >= 0 && path_guiding.guided_fraction < 1))
+        throw RendererException("Renderer::set_path_guiding(): guided_fraction must be in [0, 1)");
+
+    // Set path_guiding
+    this->path_guiding = path_guiding;
+}
+
+void Renderer::set_seed(const uint64_t seed) {
+    this->seed = seed;
+}
+
+RT_CROP Renderer::parseCrop(const std::string &text) {
+    RT_CROP crop{};
+    char separator1 = 0, separator2 = 0, separator3 = 0;
+    std::istringstream stream(text);
+
+    // Ensure the text is four comma separated integers and nothing else
+    if (!(stream >> crop.x >> separator1 >> crop.y >> separator2 >> crop.width >> separator3 >> crop.height) ||
+        separator1 != ',' || separator2 != ',' || separator3 != ',' || stream.peek() != EOF)
+        throw RendererException("Renderer::parseCrop(): crop '" + text + "' should be <x>,<y>,<width>,<height>");
+
+    return crop;
+}
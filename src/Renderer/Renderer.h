@@ -2,8 +2,19 @@
 #define RENDERER_H
 #include <Utils/Headers.h>
 #include <Renderer/RenderTarget.h>
+#include <Renderer/Tiling.h>
+#include <Renderer/CostMap.h>
+#include <Renderer/IrradianceCache.h>
+#include <Renderer/PathGuide.h>
+#include <Renderer/TemporalHistory.h>
 #include <Camera/Camera.h>
 #include <Geometry/SphereList.h>
+#include <Geometry/PackedSphereList.h>
+#include <Geometry/SphereGroup.h>
+#include <Geometry/InstancedSphereList.h>
+#include <atomic>
+#include <chrono>
+#include <future>
 
 /**
  * Utility structure to hold necessary camera values and computations for ray tracing.
@@ -62,6 +73,223 @@ struct RT_CAMERA_VALUES {
     vec3 pixel_upper_left;
 };
 
+/**
+ * Structure-of-arrays buffer of rays generated for a block of pixels.
+ * Each component lives in its own contiguous array so kernels can process many rays at once.
+ * Ray k belongs to pixel (x + k / samples % width, y + k / samples / width) of the block, sample k % samples.
+ */
+struct RT_RAY_BATCH {
+    /// Left pixel column of the block.
+    int x;
+
+    /// Top pixel row of the block.
+    int y;
+
+    /// Width of the block, in pixels.
+    int width;
+
+    /// Height of the block, in pixels.
+    int height;
+
+    /// Number of rays generated per pixel.
+    int samples;
+
+    /// X components of the ray origins.
+    std::vector<float> origin_x;
+
+    /// Y components of the ray origins.
+    std::vector<float> origin_y;
+
+    /// Z components of the ray origins.
+    std::vector<float> origin_z;
+
+    /// X components of the ray directions.
+    std::vector<float> direction_x;
+
+    /// Y components of the ray directions.
+    std::vector<float> direction_y;
+
+    /// Z components of the ray directions.
+    std::vector<float> direction_z;
+
+    /// Gets the number of rays held in the batch.
+    [[nodiscard]] size_t size() const { return direction_x.size(); }
+
+    /// Gets ray k of the batch as a Ray.
+    [[nodiscard]] Ray get_ray(const size_t k) const {
+        return {vec3(origin_x[k], origin_y[k], origin_z[k]), vec3(direction_x[k], direction_y[k], direction_z[k])};
+    }
+};
+
+/**
+ * Region of interest of an image, in pixels. Only pixels inside it are traced.
+ * A 0 x 0 size means the whole image.
+ */
+struct RT_CROP {
+    /// Left pixel column of the window.
+    int x = 0;
+
+    /// Top pixel row of the window.
+    int y = 0;
+
+    /// Width of the window, in pixels, 0 for the whole image.
+    int width = 0;
+
+    /// Height of the window, in pixels, 0 for the whole image.
+    int height = 0;
+};
+
+/**
+ * Pixel layouts of caller-owned framebuffers.
+ */
+enum class PixelFormat {
+    /// Four floats per pixel (16 bytes): linear radiance, then alpha 1.
+    RGBA32F,
+
+    /// Four bytes per pixel: display values made by the framebuffer's post process (sRGB by default), then alpha 255.
+    RGBA8
+};
+
+/**
+ * Memory owned by the caller that a render writes pixels straight into, such as shared memory or a mapped file.
+ * Rows start stride bytes apart, pixels within a row are packed. For PixelFormat::RGBA32F, data and stride must be
+ * multiples of alignof(float).
+ */
+struct RT_FRAMEBUFFER {
+    /// First byte of the top row.
+    void *data = nullptr;
+
+    /// Width of the image, in pixels.
+    int width = 0;
+
+    /// Height of the image, in pixels.
+    int height = 0;
+
+    /// Bytes from the start of a row to the start of the next, 0 for packed rows.
+    size_t stride = 0;
+
+    /// Layout of a pixel.
+    PixelFormat format = PixelFormat::RGBA32F;
+
+    /// Exposure, tone mapping and transfer function used for PixelFormat::RGBA8.
+    PostProcess post_process{1, ToneMapping::Clamp, TransferFunction::SRGB};
+};
+
+/**
+ * State of a render started with Renderer::renderAsync().
+ */
+enum class RenderStatus {
+    /// Tiles are still being rendered.
+    Running,
+
+    /// Every tile was rendered.
+    Completed,
+
+    /// RenderJob::cancel() stopped the render, the render target holds the tiles finished so far.
+    Cancelled,
+
+    /// The deadline passed, the render target holds the tiles finished so far.
+    TimedOut,
+
+    /// Rendering threw, RenderJob::wait() rethrows the exception.
+    Failed
+};
+
+/**
+ * Progress reported after every finished tile.
+ */
+struct RT_RENDER_PROGRESS {
+    /// Tiles finished so far, including this one.
+    size_t tiles_done;
+
+    /// Tiles in the render.
+    size_t tiles_total;
+
+    /// Tile just finished. Its pixels in the render target are final, so they can be read as a partial result.
+    RT_TILE tile;
+};
+
+/**
+ * Options of a render that apply to one call rather than to the renderer.
+ */
+struct RT_RENDER_OPTIONS {
+    /**
+     * Called after every finished tile, from render threads but never from two at once. Keep it short, the other
+     * threads wait for it. Throwing from it fails the render.
+     */
+    std::function<void(const RT_RENDER_PROGRESS &)> on_progress{};
+
+    /// Time after which the render stops, unfinished tiles are left untouched.
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    /// Records the cost of every traced pixel and the time of every tile when set. It must be the image's size.
+    shared_ptr<CostMap> cost_map{};
+
+    /// Blends each pixel with the previous frames of an animation when set, the same history passed to the render
+    /// of every frame. It must be the image's size.
+    shared_ptr<TemporalHistory> history{};
+};
+
+/**
+ * Handle to a render running in the background, made by Renderer::renderAsync().
+ * Destroying the handle cancels the render and waits for its threads to finish.
+ */
+class RenderJob final {
+    friend class Renderer;
+
+    /// Set by cancel(), checked by render threads before every tile row.
+    std::atomic<bool> cancelled{false};
+
+    /// Tiles finished so far.
+    std::atomic<size_t> tiles_done{0};
+
+    /// Tiles in the render, known once the render has started.
+    std::atomic<size_t> tiles_total{0};
+
+    /// Final status of the render.
+    std::shared_future<RenderStatus> result{};
+
+public:
+    RenderJob() = default;
+
+    RenderJob(const RenderJob &) = delete;
+
+    RenderJob &operator=(const RenderJob &) = delete;
+
+    /// Cancels the render and waits for its threads.
+    ~RenderJob();
+
+    /**
+     * Asks the render to stop. Render threads notice before starting their next tile row, so they are free within
+     * the time it takes to trace one row of a tile.
+     */
+    void cancel();
+
+    /**
+     * Waits for the render to end.
+     * @param timeout_ms Longest wait, in milliseconds. 0 only checks, negative waits until the render ends.
+     * @return Whether the render has ended.
+     *
+     * @note Test Cases:\n
+     * job->wait_for(0) -> false while the render is running\n
+     * job->wait_for(-1) -> true\n
+     */
+    [[nodiscard]] bool wait_for(int timeout_ms) const;
+
+    /**
+     * Waits for the render to end.
+     * @return How the render ended: Completed, Cancelled or TimedOut.
+     * @note Rethrows the exception of a Failed render.
+     */
+    RenderStatus wait() const;
+
+    /// Gets the status of the render, without waiting.
+    [[nodiscard]] RenderStatus get_status() const;
+
+    /// Gets the fraction of tiles finished, in [0, 1].
+    [[nodiscard]] float get_progress() const;
+};
+
 class Renderer {
     /// Number of rays cast per pixel. Increases image quality.
     int samples = 10;
@@ -69,6 +297,21 @@ class Renderer {
     /// Maximum number of times a ray is allowed to bounce before being terminated.
     int max_depth = 10;
 
+    /// Tile size and order the image is rendered in.
+    RT_TILING tiling{};
+
+    /// Window of the image that is traced, the rest of the render target is left untouched.
+    RT_CROP crop{};
+
+    /// Irradiance cache built before each render, when enabled.
+    RT_IRRADIANCE_CACHE irradiance_cache{};
+
+    /// Path guide trained before each render, when enabled.
+    RT_PATH_GUIDING path_guiding{};
+
+    /// Seed of every random number a render draws.
+    uint64_t seed = 0;
+
 public:
     // Constructors
     /**
@@ -84,18 +327,159 @@ public:
     // Methods
     /**
      * Renders spheres through the perspective of a camera into a render target.
+     * The spheres are traced through their SphereGroup (see SphereList::get_accelerator()), which is built on the
+     * first render and shared by every later render of the unchanged list.
+     * The image is split into tiles, which render threads take one at a time in the configured tile order. Tiles that
+     * see no sphere are filled with the sky color directly.
+     * With a crop window set, only pixels inside it are traced and written. Camera rays are computed for the full
+     * render target and each pixel draws its random numbers by position (see set_seed()), so a cropped render matches
+     * the same region of a full render exactly, unless the irradiance cache or path guiding, built for the window
+     * only, are enabled.
+     * With the irradiance cache enabled, it is built first (see buildIrradianceCache()), and paths end at their second
+     * hit wherever a record covers it, reflecting the cached irradiance instead of bouncing further.
+     * With path guiding enabled, a guide is trained first (see trainPathGuide()), and bounces sample it mixed with
+     * the cosine lobe, weighted by the mixture's density so the image stays unbiased. The training samples are
+     * averaged into the image.
+     * With a temporal history, each pixel's samples are blended with what the previous frames saw of the surface
+     * hit through its center (see TemporalHistory), so a frame of an animation needs fewer samples.
      * @param spheres Pointer to a SphereList containing the spheres to be rendered.
      * @param camera Pointer to a camera viewing the spheres to be rendered.
      * @param render_target Pointer to the image the function will output the rendered image to.
+     * @param cost_map Optional map recording the cost of every traced pixel, the same size as render_target.
+     * @param history Optional history of the previous frames, the same size as render_target.
      *
      * @note Test Cases:\n
      * auto r1 = Renderer(10, 10)\n
      * ...\n
      * r1.Render(spheres, camera, render_target) -> should output an image to RenderTarget\n
+     * r1.Render(spheres, camera, render_target, cost_map) -> same image, cost_map filled\n
+     * r1.Render(spheres, camera, render_target, nullptr, history) per frame -> noise falls as frames accumulate\n
      * ERROR: will throw a RendererException (will be thrown if any of the above arguments are nullptr)\n
+     * ERROR: will throw a RendererException (crop window does not fit inside render_target)\n
+     * ERROR: will throw a RendererException (cost_map or history is not the size of render_target)\n
+     * ERROR: will throw a PackedSphereListException (a sphere in spheres is nullptr)\n
+     */
+    void render(const shared_ptr<SphereList> &spheres, const shared_ptr<Camera> &camera,
+                const shared_ptr<RenderTarget> &render_target, const shared_ptr<CostMap> &cost_map = nullptr,
+                const shared_ptr<TemporalHistory> &history = nullptr) const;
+
+    /**
+     * Starts rendering spheres into a render target in the background, like render() but without printing.
+     * The arguments are validated before returning, everything else happens on other threads. The spheres, camera and
+     * render target are kept alive until the render ends, and must not be changed while it runs.
+     * @param spheres Pointer to a SphereList containing the spheres to be rendered.
+     * @param camera Pointer to a camera viewing the spheres to be rendered.
+     * @param render_target Pointer to the image the function will output the rendered image to.
+     * @param options Progress callback, deadline, cost map and temporal history.
+     * @return Handle to cancel, poll and wait for the render.
+     *
+     * @note Test Cases:\n
+     * r1.renderAsync(spheres, camera, render_target)->wait() -> RenderStatus::Completed, same image as render()\n
+     * job->cancel(), job->wait() -> RenderStatus::Cancelled\n
+     * r1.renderAsync(spheres, camera, render_target, {nullptr, past deadline})->wait() -> RenderStatus::TimedOut\n
+     * ERROR: will throw a RendererException (any argument is nullptr, or the crop window does not fit)\n
+     */
+    [[nodiscard]] shared_ptr<RenderJob> renderAsync(const shared_ptr<SphereList> &spheres,
+                                                    const shared_ptr<Camera> &camera,
+                                                    const shared_ptr<RenderTarget> &render_target,
+                                                    const RT_RENDER_OPTIONS &options = RT_RENDER_OPTIONS()) const;
+
+    /**
+     * Renders spheres straight into a caller-owned framebuffer, without a RenderTarget or any copy of the image.
+     * Each tile is written as soon as all of it is traced. Pixels outside the crop window are left untouched.
+     * @param spheres Pointer to a SphereList containing the spheres to be rendered.
+     * @param camera Pointer to a camera viewing the spheres to be rendered.
+     * @param framebuffer Memory written to, its size and pixel format.
+     * @param cost_map Optional map recording the cost of every traced pixel, the same size as framebuffer.
+     * @param history Optional history of the previous frames, the same size as framebuffer.
+     *
+     * @note Test Cases:\n
+     * r1.render(spheres, camera, {data, 64, 48, 0, PixelFormat::RGBA32F}) -> same radiance as a RenderTarget render\n
+     * r1.render(spheres, camera, {nullptr, 64, 48}) -> ERROR: will throw a RendererException (data cannot be nullptr)\n
+     * r1.render(spheres, camera, {data, 64, 48, 32}) -> ERROR: will throw a RendererException (stride too small)\n
+     * r1.render(spheres, camera, {data, 64, 48, 1026}) -> ERROR: will throw a RendererException (stride not float-aligned)\n
      */
     void render(const shared_ptr<SphereList> &spheres, const shared_ptr<Camera> &camera,
-                const shared_ptr<RenderTarget> &render_target) const;
+                const RT_FRAMEBUFFER &framebuffer, const shared_ptr<CostMap> &cost_map = nullptr,
+                const shared_ptr<TemporalHistory> &history = nullptr) const;
+
+    /**
+     * Starts rendering spheres into a caller-owned framebuffer in the background.
+     * The framebuffer's memory must stay valid until the render ends, which destroying the handle waits for.
+     * @param spheres Pointer to a SphereList containing the spheres to be rendered.
+     * @param camera Pointer to a camera viewing the spheres to be rendered.
+     * @param framebuffer Memory written to, its size and pixel format.
+     * @param options Progress callback, deadline, cost map and temporal history.
+     * @return Handle to cancel, poll and wait for the render.
+     *
+     * @note Test Cases:\n
+     * Same as the RenderTarget version.\n
+     */
+    [[nodiscard]] shared_ptr<RenderJob> renderAsync(const shared_ptr<SphereList> &spheres,
+                                                    const shared_ptr<Camera> &camera,
+                                                    const RT_FRAMEBUFFER &framebuffer,
+                                                    const RT_RENDER_OPTIONS &options = RT_RENDER_OPTIONS()) const;
+
+    /**
+     * Renders the instances of a two-level scene through the perspective of a camera into a render target, like the
+     * SphereList version. Every ray goes through the scene's top-level hierarchy, so tiles are not culled.
+     * @param instances Pointer to a built InstancedSphereList holding the instances to be rendered.
+     * @param camera Pointer to a camera viewing the instances to be rendered.
+     * @param render_target Pointer to the image the function will output the rendered image to.
+     * @param cost_map Optional map recording the cost of every traced pixel, the same size as render_target.
+     * @param history Optional history of the previous frames, the same size as render_target.
+     *
+     * @note Test Cases:\n
+     * r1.render(instances, camera, render_target) -> same image as a SphereList holding every copy\n
+     * r1.render(instances, camera, render_target) before instances->Build() ->
+     * ERROR: will throw a RendererException (instances must be built)\n
+     * r1.render(instances, camera, render_target) with the irradiance cache or path guiding enabled ->
+     * ERROR: will throw a RendererException (not supported for instances)\n
+     */
+    void render(const shared_ptr<InstancedSphereList> &instances, const shared_ptr<Camera> &camera,
+                const shared_ptr<RenderTarget> &render_target, const shared_ptr<CostMap> &cost_map = nullptr,
+                const shared_ptr<TemporalHistory> &history = nullptr) const;
+
+    /**
+     * Builds the irradiance cache a render of spheres through camera would use, with the renderer's settings.
+     * Records are placed where paths through the image bounce a second time, in passes over ever finer grids of
+     * pixels (every 16th, 8th, 4th then 2nd pixel). Each pass finds the second hits no record covers yet, gathers a
+     * record at each of them in parallel, then adds them in order, skipping those an earlier one already covers. A
+     * record traces one path through every cell of its hemisphere, with the hits a path has left at its second hit.
+     * @param spheres Pointer to a SphereList containing the spheres to be rendered.
+     * @param camera Pointer to a camera viewing the spheres to be rendered.
+     * @param width Width of the image, in pixels.
+     * @param height Height of the image, in pixels.
+     * @return Filled cache, even when the cache is not enabled. Empty when max_depth is below 3, as the second hit
+     * then has no light left to gather.
+     *
+     * @note Test Cases:\n
+     * r1.buildIrradianceCache(spheres, camera, 64, 48) -> records on the spheres, each covering its own position\n
+     * r1.buildIrradianceCache(nullptr, camera, 64, 48) -> ERROR: will throw a RendererException (spheres cannot be nullptr)\n
+     */
+    [[nodiscard]] shared_ptr<IrradianceCache> buildIrradianceCache(const shared_ptr<SphereList> &spheres,
+                                                                   const shared_ptr<Camera> &camera, int width,
+                                                                   int height) const;
+
+    /**
+     * Trains the path guide a render of spheres through camera would use, with the renderer's settings.
+     * Each training pass path traces every pixel with twice the samples of the one before, starting at one, sampling
+     * bounces from the guide as trained so far and recording the light every bounce received into it. The guide is
+     * refined after each pass, splitting regions where more paths bounced. Renders average the passes' samples into
+     * the image, as they are unbiased too.
+     * @param spheres Pointer to a SphereList containing the spheres to be rendered.
+     * @param camera Pointer to a camera viewing the spheres to be rendered.
+     * @param width Width of the image, in pixels.
+     * @param height Height of the image, in pixels.
+     * @return Trained guide, even when path guiding is not enabled.
+     *
+     * @note Test Cases:\n
+     * r1.trainPathGuide(spheres, camera, 64, 48) -> regions around the spheres, trained where paths bounced\n
+     * r1.trainPathGuide(nullptr, camera, 64, 48) -> ERROR: will throw a RendererException (spheres cannot be nullptr)\n
+     */
+    [[nodiscard]] shared_ptr<PathGuide> trainPathGuide(const shared_ptr<SphereList> &spheres,
+                                                       const shared_ptr<Camera> &camera, int width,
+                                                       int height) const;
 
     // Helpers
     /**
@@ -113,6 +497,19 @@ public:
     static RT_CAMERA_VALUES initializeRTCamera(const shared_ptr<Camera> &camera,
                                                const shared_ptr<RenderTarget> &render_target);
 
+    /**
+     * Initializes the camera values required for ray tracing an image of a given size.
+     * @param camera Camera viewing the world.
+     * @param width Width of the image, in pixels.
+     * @param height Height of the image, in pixels.
+     * @return Struct containing all information necessary for ray tracing.
+     *
+     * @note Test Cases:\n
+     * Renderer::initializeRTCamera(camera, 64, 48) -> same as for a 64 x 48 render target\n
+     * Renderer::initializeRTCamera(camera, 0, 48) -> ERROR: will throw a RendererException (size must be positive)\n
+     */
+    static RT_CAMERA_VALUES initializeRTCamera(const shared_ptr<Camera> &camera, int width, int height);
+
     /**
      * Gets the ray from the camera origin through a specified pixel index.
      * @param i Pixel along the width of the camera.
@@ -128,6 +525,49 @@ public:
      */
     static Ray getRayAtPixel(int i, int j, const RT_CAMERA_VALUES &rt_camera_values);
 
+    /**
+     * Generates every camera ray for a block of pixels in one pass, samples rays per pixel.
+     * The antialiasing offsets are drawn first, each pixel's from its own stream keyed by seed and the pixel's
+     * position, then the origins and directions are computed in flat loops over contiguous arrays so the compiler can
+     * vectorize them.
+     * @param x Left pixel column of the block.
+     * @param y Top pixel row of the block.
+     * @param width Width of the block, in pixels.
+     * @param height Height of the block, in pixels.
+     * @param samples Number of rays per pixel.
+     * @param rt_camera_values Initialized RT_CAMERA_VALUES struct.
+     * @param batch Batch the rays are written to. Its buffers are reused when they are large enough.
+     * @param seed Seed of the offsets. Reseeds the calling thread's random stream.
+     *
+     * @note Test Cases:\n
+     * RT_RAY_BATCH batch{}\n
+     * Renderer::getRaysInTile(1, 0, 1, 1, 3, rtcv, batch) -> same rays as pixel (1, 0) of getRaysInTile(0, 0, 4, 2, 3, rtcv, batch)\n
+     * Renderer::getRaysInTile(0, 0, 4, 2, 3, rtcv, batch) -> batch.size() should be 24, each ray passes through its pixel\n
+     * Renderer::getRaysInTile(-1, 0, 4, 2, 3, rtcv, batch) -> ERROR: will throw a RendererException (x, y negative)\n
+     * Renderer::getRaysInTile(0, 0, 0, 2, 3, rtcv, batch) -> ERROR: will throw a RendererException (width, height, samples must be positive)\n
+     */
+    static void getRaysInTile(int x, int y, int width, int height, int samples,
+                              const RT_CAMERA_VALUES &rt_camera_values, RT_RAY_BATCH &batch, uint64_t seed = 0);
+
+    /**
+     * Determines whether primary rays of a tile can hit any sphere of a group. The tile, widened by half a pixel for
+     * the antialiasing jitter plus half a pixel of margin, is a pyramid with its apex at the camera. The group's
+     * hierarchy is walked from the root and subtrees whose box lies outside the pyramid are skipped, so a tile costs
+     * about the log of the sphere count rather than a test per sphere. Tiles seeing no sphere are filled with the
+     * sky, the camera rays of every other tile traverse the whole hierarchy.
+     * @param tile Tile of the image, in pixels.
+     * @param rt_camera_values Initialized RT_CAMERA_VALUES struct.
+     * @param spheres Group of the spheres in the scene.
+     * @return Whether any sphere may be visible through the tile.
+     *
+     * @note Test Cases:\n
+     * Renderer::tileSeesSpheres(center tile, rtcv, *spheres->get_accelerator()) -> true with a sphere in front of the camera\n
+     * Renderer::tileSeesSpheres(corner tile, rtcv, *spheres->get_accelerator()) -> false when no sphere reaches the corner\n
+     * Renderer::tileSeesSpheres(tile, rtcv, *spheres->get_accelerator()) -> true whenever a camera ray of the tile hits a sphere\n
+     */
+    static bool tileSeesSpheres(const RT_TILE &tile, const RT_CAMERA_VALUES &rt_camera_values,
+                                const SphereGroup &spheres);
+
     /**
      * Calculates the color of light passing through the scene over a particular ray.
      * @param ray Ray passing through the scene from the camera.
@@ -167,6 +607,16 @@ public:
      */
     static bool scatter(const HitRecord &hit_record, Ray &scattered_ray);
 
+    /**
+     * Restarts the calling thread's random numbers (see seed_random()), including the bounce directions scatter()
+     * draws ahead of use, so what the thread traces next depends on seed alone.
+     * @param seed Seed of the thread's random stream.
+     *
+     * @note Test Cases:\n
+     * Renderer::seedRandom(7), r1.getRayColor(ray, spheres) -> same color after Renderer::seedRandom(7) again\n
+     */
+    static void seedRandom(uint64_t seed);
+
     // Getters
     /// Gets the number of rays drawn and averaged per pixel.
     [[nodiscard]] int get_samples() const {
@@ -178,6 +628,31 @@ public:
         return max_depth;
     }
 
+    /// Gets the tile size and order the image is rendered in.
+    [[nodiscard]] const RT_TILING &get_tiling() const {
+        return tiling;
+    }
+
+    /// Gets the window of the image that is traced.
+    [[nodiscard]] const RT_CROP &get_crop() const {
+        return crop;
+    }
+
+    /// Gets the settings of the irradiance cache.
+    [[nodiscard]] const RT_IRRADIANCE_CACHE &get_irradiance_cache() const {
+        return irradiance_cache;
+    }
+
+    /// Gets the settings of path guiding.
+    [[nodiscard]] const RT_PATH_GUIDING &get_path_guiding() const {
+        return path_guiding;
+    }
+
+    /// Gets the seed of every random number a render draws.
+    [[nodiscard]] uint64_t get_seed() const {
+        return seed;
+    }
+
     // Setters
     /**
      * Sets the number of rays drawn and averaged per pixel.
@@ -204,6 +679,153 @@ public:
      * r1.set_max_depth(-1) -> ERROR: will throw a RendererException (see above)\n
      */
     void set_max_depth(int max_depth);
+
+    /**
+     * Sets the tile size and order the image is rendered in.
+     * @param tiling Tile size (0 x 0 for automatic) and order.
+     *
+     * @note Test Cases:\n
+     * auto r1 = Renderer(10, 10)\n
+     * r1.set_tiling({32, 16, TileOrder::Morton}) -> tiling should be 32 x 16, Morton\n
+     * r1.set_tiling({0, 0, TileOrder::Hilbert}) -> tiling should be automatic, Hilbert\n
+     * r1.set_tiling({0, 16, TileOrder::Hilbert}) -> ERROR: will throw a RendererException (invalid tile size)\n
+     * r1.set_tiling({-8, -8, TileOrder::Hilbert}) -> ERROR: will throw a RendererException (see above)\n
+     */
+    void set_tiling(const RT_TILING &tiling);
+
+    /**
+     * Sets the window of the image that is traced. Whether it fits the render target is checked when rendering.
+     * @param crop Window, 0 x 0 for the whole image.
+     *
+     * @note Test Cases:\n
+     * auto r1 = Renderer(10, 10)\n
+     * r1.set_crop({16, 8, 32, 32}) -> crop should be 32 x 32 at (16, 8)\n
+     * r1.set_crop({}) -> crop should be the whole image\n
+     * r1.set_crop({-1, 0, 32, 32}) -> ERROR: will throw a RendererException (position must be non-negative)\n
+     * r1.set_crop({0, 0, 32, 0}) -> ERROR: will throw a RendererException (size must be positive, or 0 x 0)\n
+     */
+    void set_crop(const RT_CROP &crop);
+
+    /**
+     * Sets whether renders build and use an irradiance cache, and how.
+     * @param irradiance_cache Settings, see RT_IRRADIANCE_CACHE.
+     *
+     * @note Test Cases:\n
+     * auto r1 = Renderer(10, 10)\n
+     * r1.set_irradiance_cache({true}) -> cache enabled with default settings\n
+     * r1.set_irradiance_cache({true, 0}) -> ERROR: will throw a RendererException (accuracy must be in (0, 1])\n
+     * r1.set_irradiance_cache({true, 0.3, 0}) -> ERROR: will throw a RendererException (theta_strata must be positive)\n
+     * r1.set_irradiance_cache({true, 0.3, 8, 2, 1}) -> ERROR: will throw a RendererException (min_spacing above max_spacing)\n
+     */
+    void set_irradiance_cache(const RT_IRRADIANCE_CACHE &irradiance_cache);
+
+    /**
+     * Sets whether renders train and use a path guide, and how.
+     * @param path_guiding Settings, see RT_PATH_GUIDING.
+     *
+     * @note Test Cases:\n
+     * auto r1 = Renderer(10, 10)\n
+     * r1.set_path_guiding({true}) -> guiding enabled with default settings\n
+     * r1.set_path_guiding({true, 0}) -> ERROR: will throw a RendererException (training_passes must be in [1, 16])\n
+     * r1.set_path_guiding({true, 5, 1}) -> ERROR: will throw a RendererException (guided_fraction must be in [0, 1))\n
+     */
+    void set_path_guiding(const RT_PATH_GUIDING &path_guiding);
+
+    /**
+     * Sets the seed of every random number a render draws. Each pixel draws from a stream keyed by the seed, its
+     * position and the temporal history's frame, so renders with the same seed match whatever the thread count or
+     * the order threads finish tiles in. Path guiding is the exception: its training threads learn from each other.
+     * @param seed Seed, 0 by default.
+     *
+     * @note Test Cases:\n
+     * r1.set_seed(7) -> seed should be 7, two renders of the same scene match pixel for pixel\n
+     */
+    void set_seed(uint64_t seed);
+
+    /**
+     * Parses a crop window written as "<x>,<y>,<width>,<height>".
+     * @param text Crop window.
+     * @return Parsed window. Its values are validated by set_crop().
+     *
+     * @note Test Cases:\n
+     * Renderer::parseCrop("16,8,32,32") -> {16, 8, 32, 32}\n
+     * Renderer::parseCrop("16,8,32") -> ERROR: will throw a RendererException (expected four integers)\n
+     */
+    static RT_CROP parseCrop(const std::string &text);
+
+private:
+    /// Stores count traced pixels starting at (x, y), given as interleaved linear RGB.
+    using RowWriter = std::function<void(int x, int y, int count, const float *rgb)>;
+
+    /**
+     * Validates the arguments of a render into an image of a given size and gets the region it traces.
+     * @return Crop window, or the whole image.
+     */
+    [[nodiscard]] RT_CROP validateRender(const shared_ptr<SphereList> &spheres, const shared_ptr<Camera> &camera,
+                                         int width, int height, const std::string &caller) const;
+
+    /**
+     * Validates the camera of a render into an image of a given size and gets the region it traces.
+     * @return Crop window, or the whole image.
+     */
+    [[nodiscard]] RT_CROP validateRegion(const shared_ptr<Camera> &camera, int width, int height,
+                                         const std::string &caller) const;
+
+    /// Ensures a render target is not nullptr, naming the calling method in the error.
+    static void validateRenderTarget(const shared_ptr<RenderTarget> &render_target, const std::string &caller);
+
+    /// Ensures a framebuffer can be written to, naming the calling method in the error.
+    static void validateFramebuffer(const RT_FRAMEBUFFER &framebuffer, const std::string &caller);
+
+    /// Ensures a cost map, if any, is the size of the image, naming the calling method in the error.
+    static void validateCostMap(const shared_ptr<CostMap> &cost_map, int width, int height, const std::string &caller);
+
+    /// Ensures a temporal history, if any, is the size of the image, naming the calling method in the error.
+    static void validateHistory(const shared_ptr<TemporalHistory> &history, int width, int height,
+                                const std::string &caller);
+
+    /// Makes the writer storing rows into a render target.
+    static RowWriter renderTargetWriter(const shared_ptr<RenderTarget> &render_target);
+
+    /// Makes the writer storing rows into a framebuffer.
+    static RowWriter framebufferWriter(const RT_FRAMEBUFFER &framebuffer);
+
+    /**
+     * Renders the tiles of a validated region, stopping early on cancellation or at the deadline.
+     * Scene is a SphereGroup, which may use the irradiance cache and path guiding, or an InstancedSphereList.
+     * @param write Stores each row of a tile once the whole tile is traced.
+     * @param job Job whose cancel flag is checked and progress counters are updated.
+     * @return Completed, Cancelled or TimedOut.
+     */
+    template<class Scene>
+    RenderStatus renderTiles(const Scene &scene, const RT_CAMERA_VALUES &rt_camera_values,
+                             const RT_CROP &region, const RowWriter &write, const RT_RENDER_OPTIONS &options,
+                             RenderJob &job) const;
+
+    /**
+     * Builds the irradiance cache for a sphere group, over the pixels of a region.
+     * @param stopped Checked between records, a stopped build returns the records added so far.
+     */
+    [[nodiscard]] shared_ptr<IrradianceCache> buildIrradianceCache(const SphereGroup &scene,
+                                                                   const RT_CAMERA_VALUES &rt_camera_values,
+                                                                   const RT_CROP &region,
+                                                                   const std::function<bool()> &stopped) const;
+
+    /**
+     * Trains the path guide for a sphere group, over the pixels of a region.
+     * @param stopped Checked between rows, a stopped training returns the guide refined so far.
+     * @param radiance Set to the sum of every training sample of each pixel of the region, row by row, when not
+     * nullptr.
+     */
+    [[nodiscard]] shared_ptr<PathGuide> trainPathGuide(const SphereGroup &scene,
+                                                       const RT_CAMERA_VALUES &rt_camera_values,
+                                                       const RT_CROP &region, const std::function<bool()> &stopped,
+                                                       std::vector<vec3> *radiance) const;
+
+    /// Starts renderTiles() on a background task.
+    [[nodiscard]] shared_ptr<RenderJob> startRender(const shared_ptr<SphereList> &spheres,
+                                                    const RT_CAMERA_VALUES &rt_camera_values, const RT_CROP &region,
+                                                    const RowWriter &write, const RT_RENDER_OPTIONS &options) const;
 };
 
 #endif //RENDERER_H
@@ -0,0 +1,131 @@
+#include "TemporalHistory.h"
+#include <Renderer/Renderer.h>
+
+TemporalHistory::TemporalHistory(const int width, const int height, const RT_TEMPORAL &settings)
+    : width(width), height(height), settings(settings) {
+    // Ensure the size is positive
+    if (width <= 0 || height <= 0)
+        throw TemporalHistoryException("TemporalHistory::TemporalHistory(): size must be positive");
+
+    // Ensure the new samples always count
+    if (settings.max_history <= 0)
+        throw TemporalHistoryException("TemporalHistory::TemporalHistory(): max_history must be positive");
+
+    // Ensure the depth test can pass
+    if (!(settings.depth_tolerance > 0))
+        throw TemporalHistoryException("TemporalHistory::TemporalHistory(): depth_tolerance must be positive");
+
+    // Ensure the normal test can pass
+    if (!(settings.normal_tolerance >= -1 && settings.normal_tolerance <= 1))
+        throw TemporalHistoryException("TemporalHistory::TemporalHistory(): normal_tolerance must be in [-1, 1]");
+
+    const size_t size = static_cast<size_t>(width) * static_cast<size_t>(height);
+    previous.assign(size, Pixel{vec3(0), 0, 0, vec3(0)});
+    current.assign(size, Pixel{vec3(0), 0, 0, vec3(0)});
+}
+
+void TemporalHistory::beginFrame(const RT_CAMERA_VALUES &camera) {
+    // The frame rendered last is reprojected from, its buffer is reused for the new frame
+    std::swap(previous, current);
+    std::fill(current.begin(), current.end(), Pixel{vec3(0), 0, 0, vec3(0)});
+    previous_view = current_view;
+    current_view = {
+        camera.position, camera.w, camera.focal_length, camera.pixel_upper_left, camera.pixel_delta_u,
+        camera.pixel_delta_v
+    };
+    frames++;
+}
+
+bool TemporalHistory::reproject(const vec3 &position, const vec3 &normal, vec3 &radiance, float &samples) const {
+    if (frames < 2)
+        return false;
+
+    // Depth along the previous camera's view, the camera looking down -w
+    const View &view = previous_view;
+    const float depth = dot(view.position - position, view.w);
+    if (!(depth > 0))
+        return false;
+
+    // Pixel coordinates of the point on the previous viewport, pixel centers at whole numbers
+    const vec3 on_viewport = view.position + (position - view.position) * (view.focal_length / depth) -
+                             view.pixel_upper_left;
+    const float px = dot(on_viewport, view.pixel_delta_u) / dot(view.pixel_delta_u, view.pixel_delta_u);
+    const float py = dot(on_viewport, view.pixel_delta_v) / dot(view.pixel_delta_v, view.pixel_delta_v);
+    if (!(px > -1 && py > -1 && px < static_cast<float>(width) && py < static_cast<float>(height)))
+        return false;
+
+    // Bilinear weights of the four pixels around the point, leaving out those that saw another surface
+    const int x0 = static_cast<int>(std::floor(px));
+    const int y0 = static_cast<int>(std::floor(py));
+    const float fx = px - static_cast<float>(x0);
+    const float fy = py - static_cast<float>(y0);
+    vec3 sum(0);
+    float sum_samples = 0, sum_weights = 0;
+    for (int tap = 0; tap < 4; tap++) {
+        const int x = x0 + tap % 2;
+        const int y = y0 + tap / 2;
+        if (x < 0 || y < 0 || x >= width || y >= height)
+            continue;
+
+        const Pixel &pixel = previous[static_cast<size_t>(y) * width + x];
+        if (pixel.samples <= 0 || std::fabs(pixel.depth - depth) > settings.depth_tolerance * depth ||
+            dot(pixel.normal, normal) < settings.normal_tolerance)
+            continue;
+
+        const float weight = (tap % 2 ? fx : 1 - fx) * (tap / 2 ? fy : 1 - fy);
+        sum += weight * pixel.radiance;
+        sum_samples += weight * pixel.samples;
+        sum_weights += weight;
+    }
+
+    // Points right at the edge of a matching pixel's reach are too uncertain to reuse
+    if (sum_weights < 1e-3f)
+        return false;
+
+    radiance = sum / sum_weights;
+    samples = sum_samples / sum_weights;
+    return true;
+}
+
+vec3 TemporalHistory::accumulate(const int x, const int y, const vec3 &position, const vec3 &normal,
+                                 const vec3 &radiance, const int samples) {
+    // Ensure x and y are within bounds
+    if (x < 0 || y < 0 || x >= width || y >= height)
+        throw TemporalHistoryException("TemporalHistory::accumulate(): pixel index out of bounds");
+
+    // Ensure there are new samples
+    if (samples <= 0)
+        throw TemporalHistoryException("TemporalHistory::accumulate(): samples must be positive");
+
+    // Old samples are capped, so a pixel keeps following what it sees now
+    vec3 reused;
+    float reused_samples;
+    vec3 blended = radiance;
+    auto fresh = static_cast<float>(samples);
+    if (reproject(position, normal, reused, reused_samples)) {
+        reused_samples = std::min(reused_samples, static_cast<float>(settings.max_history) * fresh);
+        blended = (reused * reused_samples + radiance * fresh) / (reused_samples + fresh);
+        fresh += reused_samples;
+    }
+
+    current[static_cast<size_t>(y) * width + x] = {
+        blended, fresh, dot(current_view.position - position, current_view.w), normal
+    };
+    return blended;
+}
+
+void TemporalHistory::clear(const int x, const int y) {
+    // Ensure x and y are within bounds
+    if (x < 0 || y < 0 || x >= width || y >= height)
+        throw TemporalHistoryException("TemporalHistory::clear(): pixel index out of bounds");
+
+    current[static_cast<size_t>(y) * width + x] = {vec3(0), 0, 0, vec3(0)};
+}
+
+float TemporalHistory::get_samples(const int x, const int y) const {
+    // Ensure x and y are within bounds
+    if (x < 0 || y < 0 || x >= width || y >= height)
+        throw TemporalHistoryException("TemporalHistory::get_samples(): pixel index out of bounds");
+
+    return current[static_cast<size_t>(y) * width + x].samples;
+}
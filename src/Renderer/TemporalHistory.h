@@ -0,0 +1,171 @@
+#ifndef TEMPORALHISTORY_H
+#define TEMPORALHISTORY_H
+#include <Utils/Headers.h>
+#include <vector>
+
+struct RT_CAMERA_VALUES;
+
+/**
+ * Settings of a TemporalHistory.
+ */
+struct RT_TEMPORAL {
+    /// Most frames of history a pixel keeps, counted in the current frame's samples. Higher values average away more
+    /// noise but follow changes of the scene's lighting more slowly.
+    int max_history = 8;
+
+    /// Largest difference of view depth, relative to the depth, between a surface and a previous pixel it reuses.
+    float depth_tolerance = 0.05f;
+
+    /// Smallest cosine between a surface's normal and the normal of a previous pixel it reuses.
+    float normal_tolerance = 0.9f;
+};
+
+/**
+ * Radiance accumulated over the frames of a camera animation, reused by each new frame (temporal accumulation).
+ * Every pixel keeps what its surface was found to reflect so far, with the number of samples behind it, and the view
+ * depth and normal of its first hit through the pixel center. A new frame projects its own first hits into the
+ * previous frame's camera and blends with the four pixels around them, skipping those whose depth or normal differs:
+ * surfaces that were hidden or off screen the frame before start over. Only the camera is assumed to move, lighting
+ * and spheres that change between frames leave a trail until max_history frames have passed.
+ * Pass the same history to the render of every frame, see RT_RENDER_OPTIONS::history.
+ */
+class TemporalHistory final {
+    /// What a pixel accumulated.
+    struct Pixel {
+        /// Mean radiance of every sample behind the pixel.
+        vec3 radiance;
+
+        /// Samples averaged into radiance, 0 when there is nothing to reuse.
+        float samples;
+
+        /// View depth of the first hit through the pixel center.
+        float depth;
+
+        /// Surface normal of that hit.
+        vec3 normal;
+    };
+
+    /// Camera values needed to project a point into a frame.
+    struct View {
+        vec3 position;
+        vec3 w;
+        float focal_length;
+        vec3 pixel_upper_left;
+        vec3 pixel_delta_u;
+        vec3 pixel_delta_v;
+    };
+
+    /// Width in pixels of the frames.
+    int width;
+
+    /// Height in pixels of the frames.
+    int height;
+
+    /// Settings given at construction.
+    RT_TEMPORAL settings;
+
+    /// Pixels of the previous frame, read while rendering.
+    std::vector<Pixel> previous;
+
+    /// Pixels of the frame being rendered.
+    std::vector<Pixel> current;
+
+    /// Camera of the previous frame.
+    View previous_view{};
+
+    /// Camera of the frame being rendered.
+    View current_view{};
+
+    /// Frames begun so far.
+    int frames = 0;
+
+public:
+    // Constructors
+    /**
+     * Makes an empty history, the first frame reuses nothing.
+     * @param width Width, in pixels, the same as the rendered frames.
+     * @param height Height, in pixels, the same as the rendered frames.
+     * @param settings How much history is kept, and how closely a surface has to match a previous pixel.
+     *
+     * @note Test Cases:\n
+     * TemporalHistory(64, 48) -> no frames\n
+     * TemporalHistory(0, 48) -> ERROR: will throw a TemporalHistoryException (size must be positive)\n
+     * TemporalHistory(64, 48, {0}) -> ERROR: will throw a TemporalHistoryException (max_history must be positive)\n
+     */
+    TemporalHistory(int width, int height, const RT_TEMPORAL &settings = RT_TEMPORAL());
+
+    // Methods
+    /**
+     * Starts a frame: the frame rendered last becomes the one reprojected from, and every pixel of the new frame
+     * starts empty. Pixels a frame does not render, outside the crop window or of tiles left unfinished, have no
+     * history in the next one. Not thread-safe, call it before rendering.
+     * @param camera Camera of the new frame.
+     *
+     * @note Test Cases:\n
+     * history.beginFrame(camera) -> get_frames() grows by one\n
+     */
+    void beginFrame(const RT_CAMERA_VALUES &camera);
+
+    /**
+     * Finds what the previous frame accumulated for a surface point, interpolated between the four pixels around it
+     * that saw the same surface.
+     * @param position Point on a surface.
+     * @param normal Surface normal at position, normalized.
+     * @param radiance Reused radiance, set when a pixel matched.
+     * @param samples Samples behind radiance, set when a pixel matched.
+     * @return Whether any previous pixel saw the point.
+     *
+     * @note Test Cases:\n
+     * history.reproject(point seen by the previous frame, its normal, r, s) -> true, r is what was stored there\n
+     * history.reproject(point behind the previous camera, n, r, s) -> false\n
+     * history.reproject(point seen with another normal, n, r, s) -> false\n
+     */
+    bool reproject(const vec3 &position, const vec3 &normal, vec3 &radiance, float &samples) const;
+
+    /**
+     * Blends a pixel's new samples with the history of its first hit, and keeps the result for the next frame.
+     * The history weighs as many samples as it holds, at most max_history times the new ones. Safe to call from any
+     * number of threads at once for different pixels.
+     * @param x x pixel coordinate.
+     * @param y y pixel coordinate.
+     * @param position First hit through the pixel center.
+     * @param normal Surface normal at position, normalized.
+     * @param radiance Mean radiance of the new samples.
+     * @param samples Number of new samples.
+     * @return Blended radiance of the pixel.
+     *
+     * @note Test Cases:\n
+     * history.accumulate(x, y, p, n, r, 4) in the first frame -> r\n
+     * history.accumulate(x, y, p, n, r2, 4) in the next frame, same camera -> (r + r2) / 2\n
+     * history.accumulate(-1, 0, p, n, r, 4) -> ERROR: will throw a TemporalHistoryException (pixel out of bounds)\n
+     */
+    vec3 accumulate(int x, int y, const vec3 &position, const vec3 &normal, const vec3 &radiance, int samples);
+
+    /**
+     * Keeps a pixel whose center ray hit nothing, such as sky, without history: nothing is reprojected into it.
+     * @param x x pixel coordinate.
+     * @param y y pixel coordinate.
+     *
+     * @note Test Cases:\n
+     * history.clear(x, y) -> get_samples(x, y) == 0\n
+     */
+    void clear(int x, int y);
+
+    // Getters
+    /// Gets the width in pixels of the frames.
+    [[nodiscard]] int get_width() const { return width; }
+
+    /// Gets the height in pixels of the frames.
+    [[nodiscard]] int get_height() const { return height; }
+
+    /// Gets the settings of the history.
+    [[nodiscard]] const RT_TEMPORAL &get_settings() const { return settings; }
+
+    /// Gets the number of frames begun so far.
+    [[nodiscard]] int get_frames() const { return frames; }
+
+    /// Gets the samples accumulated in a pixel of the frame being rendered.
+    [[nodiscard]] float get_samples(int x, int y) const;
+};
+
+#endif //TEMPORALHISTORY_H
@@ -0,0 +1,155 @@
+#include "Tiling.h"
+#include <algorithm>
+#include <thread>
+
+std::vector<RT_TILE> Tiling::makeTiles(const int image_width, const int image_height, const RT_TILING &tiling) {
+    // Ensure the image size is positive
+    if (image_width <= 0 || image_height <= 0)
+        throw TilingException("Tiling::makeTiles(): image size must be positive");
+
+    // Ensure the tile size is positive, or 0 x 0 for automatic
+    const bool automatic = tiling.tile_width == 0 && tiling.tile_height == 0;
+    if (!automatic && (tiling.tile_width <= 0 || tiling.tile_height <= 0))
+        throw TilingException("Tiling::makeTiles(): tile size must be positive, or 0 x 0 for automatic");
+
+    int tile_width = tiling.tile_width;
+    int tile_height = tiling.tile_height;
+    if (automatic) {
+        const int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        tile_width = tile_height = autoTileSize(image_width, image_height, threads);
+    }
+
+    const int tiles_x = (image_width + tile_width - 1) / tile_width;
+    const int tiles_y = (image_height + tile_height - 1) / tile_height;
+
+    // Smallest power of two grid holding every tile, for the Hilbert curve
+    uint32_t side = 1;
+    while (side < static_cast<uint32_t>(std::max(tiles_x, tiles_y)))
+        side *= 2;
+
+    // Tiles with their curve positions
+    std::vector<std::pair<uint64_t, RT_TILE> > keyed;
+    keyed.reserve(static_cast<size_t>(tiles_x) * tiles_y);
+    for (int ty = 0; ty < tiles_y; ty++) {
+        for (int tx = 0; tx < tiles_x; tx++) {
+            const RT_TILE tile{
+                tx * tile_width, ty * tile_height, std::min(tile_width, image_width - tx * tile_width),
+                std::min(tile_height, image_height - ty * tile_height)
+            };
+
+            uint64_t key;
+            switch (tiling.order) {
+                case TileOrder::Morton:
+                    key = mortonIndex(tx, ty);
+                    break;
+                case TileOrder::Hilbert:
+                    key = hilbertIndex(side, tx, ty);
+                    break;
+                default:
+                    key = static_cast<uint64_t>(ty) * tiles_x + tx;
+                    break;
+            }
+            keyed.emplace_back(key, tile);
+        }
+    }
+
+    std::sort(keyed.begin(), keyed.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    std::vector<RT_TILE> tiles;
+    tiles.reserve(keyed.size());
+    for (const auto &[key, tile]: keyed)
+        tiles.push_back(tile);
+
+    return tiles;
+}
+
+int Tiling::autoTileSize(const int image_width, const int image_height, const int threads) {
+    // Ensure arguments are positive
+    if (image_width <= 0 || image_height <= 0 || threads <= 0)
+        throw TilingException("Tiling::autoTileSize(): image size and threads must be positive");
+
+    const int64_t wanted = 8 * static_cast<int64_t>(threads);
+    int side = 64;
+    while (side > 8) {
+        const int64_t tiles = static_cast<int64_t>((image_width + side - 1) / side) * ((image_height + side - 1) / side);
+        if (tiles >= wanted)
+            break;
+        side /= 2;
+    }
+
+    return side;
+}
+
+uint32_t Tiling::mortonIndex(const uint32_t x, const uint32_t y) {
+    // Spreads the low 16 bits of v to the even bits
+    const auto spread = [](uint32_t v) {
+        v &= 0xffffu;
+        v = (v | (v << 8)) & 0x00ff00ffu;
+        v = (v | (v << 4)) & 0x0f0f0f0fu;
+        v = (v | (v << 2)) & 0x33333333u;
+        v = (v | (v << 1)) & 0x55555555u;
+        return v;
+    };
+
+    return spread(x) | (spread(y) << 1);
+}
+
+uint32_t Tiling::hilbertIndex(const uint32_t side, uint32_t x, uint32_t y) {
+    uint32_t index = 0;
+    for (uint32_t s = side / 2; s > 0; s /= 2) {
+        const uint32_t rx = (x & s) > 0;
+        const uint32_t ry = (y & s) > 0;
+        index += s * s * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant so the sub-curve connects to its neighbours
+        if (ry == 0) {
+            if (rx == 1) {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+
+    return index;
+}
+
+TileOrder Tiling::parseTileOrder(const std::string &name) {
+    if (name == "rowmajor")
+        return TileOrder::RowMajor;
+    if (name == "morton")
+        return TileOrder::Morton;
+    if (name == "hilbert")
+        return TileOrder::Hilbert;
+
+    throw TilingException("Tiling::parseTileOrder(): unknown tile order '" + name + "'");
+}
+
+void Tiling::parseTileSize(const std::string &text, RT_TILING &tiling) {
+    if (text == "auto") {
+        tiling.tile_width = 0;
+        tiling.tile_height = 0;
+        return;
+    }
+
+    // Ensure the text is <width>x<height> with positive integers
+    const auto separator = text.find('x');
+    int width = 0, height = 0;
+    try {
+        size_t used_width = 0, used_height = 0;
+        if (separator != std::string::npos) {
+            width = std::stoi(text.substr(0, separator), &used_width);
+            height = std::stoi(text.substr(separator + 1), &used_height);
+        }
+        if (used_width != separator || used_height != text.size() - separator - 1)
+            width = height = 0;
+    } catch (std::exception &) {
+        width = height = 0;
+    }
+
+    if (width <= 0 || height <= 0)
+        throw TilingException("Tiling::parseTileSize(): tile size '" + text + "' should be auto or <width>x<height>");
+
+    tiling.tile_width = width;
+    tiling.tile_height = height;
+}
@@ -0,0 +1,141 @@
+#ifndef TILING_H
+#define TILING_H
+#include <Utils/Headers.h>
+
+/**
+ * Orders in which the tiles of an image are handed out to render threads.
+ */
+enum class TileOrder {
+    /// Left to right, top to bottom. Consecutive rows of tiles are a full image width apart.
+    RowMajor,
+
+    /// Z-order curve. Tiles close in the order are close in the image, with occasional long jumps.
+    Morton,
+
+    /// Hilbert curve. Consecutive tiles are always neighbours, so tiles in flight cover a compact region.
+    Hilbert
+};
+
+/**
+ * Rectangle of pixels rendered as one unit of work.
+ */
+struct RT_TILE {
+    /// Left pixel column of the tile.
+    int x;
+
+    /// Top pixel row of the tile.
+    int y;
+
+    /// Width of the tile, in pixels. Tiles on the right edge may be narrower than the requested size.
+    int width;
+
+    /// Height of the tile, in pixels. Tiles on the bottom edge may be shorter than the requested size.
+    int height;
+};
+
+/**
+ * How an image is split into tiles and in which order they are rendered.
+ * A tile size of 0 x 0 picks one automatically from the image size and thread count.
+ */
+struct RT_TILING {
+    /// Width of a tile, in pixels, 0 for automatic.
+    int tile_width = 0;
+
+    /// Height of a tile, in pixels, 0 for automatic.
+    int tile_height = 0;
+
+    /// Order tiles are rendered in.
+    TileOrder order = TileOrder::Hilbert;
+};
+
+/**
+ * Splits images into tiles and orders them along space-filling curves.
+ * Threads take tiles in order, so with a curve order the tiles being rendered at any time are neighbours in the image
+ * and their rays touch the same parts of the scene, which keeps the working set in cache.
+ */
+class Tiling {
+public:
+    /**
+     * Splits an image into tiles, in render order.
+     * @param image_width Width of the image, in pixels.
+     * @param image_height Height of the image, in pixels.
+     * @param tiling Tile size and order. A 0 x 0 size uses autoTileSize() with the hardware thread count.
+     * @return Tiles covering every pixel exactly once.
+     *
+     * @note Test Cases:\n
+     * Tiling::makeTiles(100, 50, {32, 32, TileOrder::RowMajor}) -> 8 tiles, first (0, 0, 32, 32), last (96, 32, 4, 18)\n
+     * Tiling::makeTiles(64, 64, {16, 16, TileOrder::Hilbert}) -> 16 tiles, consecutive tiles share an edge\n
+     * Tiling::makeTiles(0, 50, tiling) -> ERROR: will throw a TilingException (image size must be positive)\n
+     * Tiling::makeTiles(100, 50, {-1, 8, order}) -> ERROR: will throw a TilingException (invalid tile size)\n
+     */
+    static std::vector<RT_TILE> makeTiles(int image_width, int image_height, const RT_TILING &tiling);
+
+    /**
+     * Picks a square tile size: the largest power of two from 64 down to 8 that still gives every thread at least
+     * 8 tiles, so threads stay busy until the end of the image.
+     * @param image_width Width of the image, in pixels.
+     * @param image_height Height of the image, in pixels.
+     * @param threads Number of render threads.
+     * @return Tile side, in pixels.
+     *
+     * @note Test Cases:\n
+     * Tiling::autoTileSize(3840, 2160, 16) -> 64\n
+     * Tiling::autoTileSize(256, 256, 16) -> 16\n
+     * Tiling::autoTileSize(64, 48, 16) -> 8\n
+     * Tiling::autoTileSize(0, 48, 16) -> ERROR: will throw a TilingException (arguments must be positive)\n
+     */
+    static int autoTileSize(int image_width, int image_height, int threads);
+
+    /**
+     * Interleaves the bits of x and y (x in the even bits) into a Morton code.
+     * @param x Column, 16 bits.
+     * @param y Row, 16 bits.
+     * @return Position of (x, y) along the Z-order curve.
+     *
+     * @note Test Cases:\n
+     * Tiling::mortonIndex(1, 0) -> 1\n
+     * Tiling::mortonIndex(0, 1) -> 2\n
+     * Tiling::mortonIndex(3, 3) -> 15\n
+     */
+    static uint32_t mortonIndex(uint32_t x, uint32_t y);
+
+    /**
+     * Gets the position of a cell along the Hilbert curve filling a side x side grid.
+     * @param side Side of the grid, a power of two.
+     * @param x Column, less than side.
+     * @param y Row, less than side.
+     * @return Position of (x, y) along the curve, in [0, side * side).
+     *
+     * @note Test Cases:\n
+     * Tiling::hilbertIndex(2, 0, 0) -> 0\n
+     * Tiling::hilbertIndex(2, 0, 1) -> 1\n
+     * Tiling::hilbertIndex(2, 1, 1) -> 2\n
+     * Tiling::hilbertIndex(2, 1, 0) -> 3\n
+     */
+    static uint32_t hilbertIndex(uint32_t side, uint32_t x, uint32_t y);
+
+    /**
+     * Parses a tile order name.
+     * @param name One of "rowmajor", "morton", "hilbert".
+     * @return Matching tile order.
+     *
+     * @note Test Cases:\n
+     * Tiling::parseTileOrder("morton") -> TileOrder::Morton\n
+     * Tiling::parseTileOrder("zorder") -> ERROR: will throw a TilingException (unknown tile order)\n
+     */
+    static TileOrder parseTileOrder(const std::string &name);
+
+    /**
+     * Parses a tile size, "auto" or "<width>x<height>".
+     * @param text Tile size.
+     * @param tiling Tiling whose tile_width, tile_height are set.
+     *
+     * @note Test Cases:\n
+     * Tiling::parseTileSize("32x16", tiling) -> tile_width 32, tile_height 16\n
+     * Tiling::parseTileSize("auto", tiling) -> tile_width 0, tile_height 0\n
+     * Tiling::parseTileSize("32", tiling) -> ERROR: will throw a TilingException (invalid tile size)\n
+     */
+    static void parseTileSize(const std::string &text, RT_TILING &tiling);
+};
+
+#endif //TILING_H
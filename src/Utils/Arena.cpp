@@ -0,0 +1,106 @@
+#include "Arena.h"
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace {
+    /// Rounds size up to a multiple of Arena::HUGE_PAGE_SIZE.
+    size_t RoundToHugePages(const size_t size) {
+        return (size + Arena::HUGE_PAGE_SIZE - 1) / Arena::HUGE_PAGE_SIZE * Arena::HUGE_PAGE_SIZE;
+    }
+}
+
+Arena::Arena(const size_t block_size, const HugePages huge_pages) : huge_pages(huge_pages) {
+    // Ensure block_size is positive
+    if (block_size == 0)
+        throw ArenaException("Arena::Arena(): block size must be positive");
+
+    next_block_size = RoundToHugePages(block_size);
+}
+
+Arena::~Arena() {
+    for (const auto &block: blocks) {
+#ifdef __linux__
+        munmap(block.data, block.size);
+#else
+        ::operator delete(block.data, std::align_val_t(HUGE_PAGE_SIZE));
+#endif
+    }
+}
+
+Arena::Block Arena::mapBlock(const size_t size) const {
+#ifdef __linux__
+    void *data = MAP_FAILED;
+    bool huge = false;
+
+    // Explicit huge pages only exist when reserved, fall back to transparent ones
+    if (huge_pages == HugePages::Explicit) {
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        huge = data != MAP_FAILED;
+    }
+
+    if (data == MAP_FAILED) {
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED)
+            throw ArenaException("Arena::allocate(): cannot map " + std::to_string(size) + " bytes");
+
+        // Only advice, the kernel may ignore it
+        if (huge_pages != HugePages::Off)
+            madvise(data, size, MADV_HUGEPAGE);
+    }
+
+    return {static_cast<unsigned char *>(data), size, 0, huge};
+#else
+    void *data = ::operator new(size, std::align_val_t(HUGE_PAGE_SIZE));
+    return {static_cast<unsigned char *>(data), size, 0, false};
+#endif
+}
+
+void *Arena::allocate(const size_t bytes, const size_t alignment) {
+    // Ensure alignment is a power of two
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        throw ArenaException("Arena::allocate(): alignment must be a power of two");
+
+    // Fits in the current block
+    if (!blocks.empty()) {
+        Block &block = blocks.back();
+        const auto address = reinterpret_cast<uintptr_t>(block.data + block.used);
+        const size_t padding = (alignment - address % alignment) % alignment;
+        if (padding + bytes <= block.size - block.used) {
+            block.used += padding + bytes;
+            return block.data + block.used - bytes;
+        }
+    }
+
+    // New block, blocks start huge page aligned so any alignment up to that needs no padding
+    const size_t size = RoundToHugePages(std::max({next_block_size, bytes, size_t{1}}));
+    blocks.push_back(mapBlock(size));
+    next_block_size = std::min(next_block_size * 2, MAX_BLOCK_SIZE);
+
+    Block &block = blocks.back();
+    block.used = bytes;
+    return block.data;
+}
+
+size_t Arena::get_used() const {
+    size_t used = 0;
+    for (const auto &block: blocks)
+        used += block.used;
+    return used;
+}
+
+size_t Arena::get_reserved() const {
+    size_t reserved = 0;
+    for (const auto &block: blocks)
+        reserved += block.size;
+    return reserved;
+}
+
+bool Arena::has_huge_pages() const {
+    for (const auto &block: blocks)
+        if (block.huge)
+            return true;
+    return false;
+}
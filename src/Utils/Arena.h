@@ -0,0 +1,162 @@
+#ifndef ARENA_H
+#define ARENA_H
+#include <Utils/Headers.h>
+
+/**
+ * Huge page backing of arena blocks.
+ */
+enum class HugePages {
+    /// Regular pages.
+    Off,
+
+    /// Regular mappings advised for transparent huge pages (madvise MADV_HUGEPAGE), used when the kernel allows it.
+    Transparent,
+
+    /// Explicit huge pages (MAP_HUGETLB) from the reserved pool, falling back to Transparent when none are free.
+    Explicit
+};
+
+/**
+ * Monotonic allocator for data that lives as long as a scene.
+ * Allocations are carved out of large blocks one after the other and are never freed on their own; the blocks are
+ * released together when the arena is destroyed. Objects placed in it sit next to each other in memory, and with huge
+ * pages far fewer TLB entries cover them. Not thread-safe, use one arena per thread.
+ */
+class Arena final {
+    /// A mapped block and how much of it is used.
+    struct Block {
+        unsigned char *data;
+        size_t size;
+        size_t used;
+        bool huge;
+    };
+
+    /// Blocks, the last one is being allocated from.
+    std::vector<Block> blocks{};
+
+    /// Size of the next block, doubled for every block up to MAX_BLOCK_SIZE.
+    size_t next_block_size;
+
+    /// Huge page backing of new blocks.
+    HugePages huge_pages;
+
+    /// Maps a block of at least size bytes.
+    Block mapBlock(size_t size) const;
+
+public:
+    /// Size of a huge page, and the default size of the first block.
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /// Largest block made by growth, larger allocations get a block of their own.
+    static constexpr size_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+    // Constructors
+    /**
+     * Creates an arena. No memory is mapped until the first allocation.
+     * @param block_size Size of the first block, rounded up to a multiple of HUGE_PAGE_SIZE.
+     * @param huge_pages Huge page backing of the blocks.
+     *
+     * @note Test Cases:\n
+     * Arena(0) -> ERROR: will throw an ArenaException (block size must be positive)\n
+     */
+    explicit Arena(size_t block_size = HUGE_PAGE_SIZE, HugePages huge_pages = HugePages::Transparent);
+
+    /// Releases every block.
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+
+    // Methods
+    /**
+     * Allocates memory that stays valid until the arena is destroyed.
+     * @param bytes Size of the allocation.
+     * @param alignment Alignment of the allocation, a power of two.
+     * @return Pointer to uninitialized memory.
+     *
+     * @note Test Cases:\n
+     * arena.allocate(24, 8) -> 8-byte aligned, right after the previous allocation (up to alignment)\n
+     * arena.allocate(3 * Arena::MAX_BLOCK_SIZE, 64) -> a block of its own\n
+     * arena.allocate(24, 3) -> ERROR: will throw an ArenaException (alignment must be a power of two)\n
+     */
+    void *allocate(size_t bytes, size_t alignment);
+
+    // Getters
+    /// Gets the number of bytes handed out, including alignment padding.
+    [[nodiscard]] size_t get_used() const;
+
+    /// Gets the number of bytes mapped.
+    [[nodiscard]] size_t get_reserved() const;
+
+    /// Gets the number of blocks mapped.
+    [[nodiscard]] size_t get_block_count() const { return blocks.size(); }
+
+    /// Gets whether any block is backed by explicit huge pages.
+    [[nodiscard]] bool has_huge_pages() const;
+};
+
+/**
+ * Standard allocator handing out arena memory, for std::allocate_shared and containers.
+ * It holds a reference to the arena, so containers and objects made with std::allocate_shared keep their arena alive
+ * on their own. Deallocation does nothing, the memory is returned when the arena is destroyed. Without an arena it
+ * uses the heap like std::allocator, so one container type serves both.
+ * Copies of a container are made on the heap: the arena is not thread-safe and never reuses memory.
+ */
+template<class T>
+class ArenaAllocator {
+    template<class U>
+    friend class ArenaAllocator;
+
+    /// Arena the memory comes from, the heap when nullptr.
+    shared_ptr<Arena> arena;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    /// Allocates from the heap.
+    ArenaAllocator() = default;
+
+    /// Allocates from arena, or from the heap when it is nullptr.
+    explicit ArenaAllocator(shared_ptr<Arena> arena) : arena(std::move(arena)) {
+    }
+
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {
+    }
+
+    T *allocate(const size_t count) {
+        if (arena == nullptr)
+            return std::allocator<T>().allocate(count);
+        return static_cast<T *>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *pointer, const size_t count) {
+        if (arena == nullptr)
+            std::allocator<T>().deallocate(pointer, count);
+    }
+
+    [[nodiscard]] ArenaAllocator select_on_container_copy_construction() const {
+        return ArenaAllocator();
+    }
+
+    /// Gets the arena the memory comes from, nullptr for the heap.
+    [[nodiscard]] const shared_ptr<Arena> &get_arena() const {
+        return arena;
+    }
+
+    template<class U>
+    bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+
+    template<class U>
+    bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+};
+
+/// Vector whose elements live in an arena, or on the heap when default constructed.
+template<class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+#endif //ARENA_H
@@ -58,6 +58,33 @@ public:
     };
 };
 
+/**
+ * ImageMetrics-specific exceptions useful for debugging and unit testing.
+ */
+class ImageMetricsException final : public BaseException {
+public:
+    explicit ImageMetricsException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
+/**
+ * PostProcess-specific exceptions useful for debugging and unit testing.
+ */
+class PostProcessException final : public BaseException {
+public:
+    explicit PostProcessException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
+/**
+ * Profiler-specific exceptions useful for debugging and unit testing.
+ */
+class ProfilerException final : public BaseException {
+public:
+    explicit ProfilerException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
 /**
  * Renderer-specific exceptions useful for debugging and unit testing.
  */
@@ -67,6 +94,15 @@ public:
     };
 };
 
+/**
+ * Tiling-specific exceptions useful for debugging and unit testing.
+ */
+class TilingException final : public BaseException {
+public:
+    explicit TilingException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
 /**
  * Sphere-specific exceptions useful for debugging and unit testing.
  */
@@ -85,6 +121,15 @@ public:
     };
 };
 
+/**
+ * PackedSphereList-specific exceptions useful for debugging and unit testing.
+ */
+class PackedSphereListException final : public BaseException {
+public:
+    explicit PackedSphereListException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
 /**
  * HitRecord-specific exceptions useful for debugging and unit testing.
  */
@@ -112,5 +157,86 @@ public:
     };
 };
 
+/**
+ * FileWatcher-specific exceptions useful for debugging and unit testing.
+ */
+class FileWatcherException final : public BaseException {
+public:
+    explicit FileWatcherException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
+/**
+ * Arena-specific exceptions useful for debugging and unit testing.
+ */
+class ArenaException final : public BaseException {
+public:
+    explicit ArenaException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
+/**
+ * CostMap-specific exceptions useful for debugging and unit testing.
+ */
+class CostMapException final : public BaseException {
+public:
+    explicit CostMapException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
+/**
+ * IrradianceCache-specific exceptions useful for debugging and unit testing.
+ */
+class IrradianceCacheException final : public BaseException {
+public:
+    explicit IrradianceCacheException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
+/**
+ * PathGuide-specific exceptions useful for debugging and unit testing.
+ */
+class PathGuideException final : public BaseException {
+public:
+    explicit PathGuideException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
+/**
+ * TemporalHistory-specific exceptions useful for debugging and unit testing.
+ */
+class TemporalHistoryException final : public BaseException {
+public:
+    explicit TemporalHistoryException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
+/**
+ * BoundingVolumeHierarchy-specific exceptions useful for debugging and unit testing.
+ */
+class BoundingVolumeHierarchyException final : public BaseException {
+public:
+    explicit BoundingVolumeHierarchyException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
+/**
+ * SphereGroup-specific exceptions useful for debugging and unit testing.
+ */
+class SphereGroupException final : public BaseException {
+public:
+    explicit SphereGroupException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
+/**
+ * InstancedSphereList-specific exceptions useful for debugging and unit testing.
+ */
+class InstancedSphereListException final : public BaseException {
+public:
+    explicit InstancedSphereListException(std::string message) : BaseException(std::move(message)) {
+    };
+};
+
 
 #endif //EXCEPTIONS_H
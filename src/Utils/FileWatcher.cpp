@@ -0,0 +1,116 @@
+#include "FileWatcher.h"
+#include <chrono>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    /// Time events keep arriving for after the first one of a single save, merged into one change.
+    constexpr int SETTLE_MS = 5;
+
+    /// Polling interval where inotify is not available.
+    constexpr int POLL_MS = 20;
+
+    /// Gets a file's modification time, or the default value if it cannot be read (mid-save, deleted).
+    std::filesystem::file_time_type write_time(const std::filesystem::path &path) {
+        std::error_code error;
+        const auto time = std::filesystem::last_write_time(path, error);
+        return error ? std::filesystem::file_time_type{} : time;
+    }
+}
+
+FileWatcher::FileWatcher(const std::string &path) {
+    // Ensure path is non-empty
+    if (path.empty())
+        throw FileWatcherException("FileWatcher::FileWatcher(): path cannot be empty");
+
+    this->path = std::filesystem::absolute(path);
+    const auto directory = this->path.parent_path();
+
+    // Ensure the directory exists
+    if (!std::filesystem::is_directory(directory))
+        throw FileWatcherException("FileWatcher::FileWatcher(): cannot watch directory " + directory.string());
+
+    last_write = write_time(this->path);
+
+#ifdef __linux__
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd >= 0 && inotify_add_watch(inotify_fd, directory.c_str(),
+                                             IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY) < 0) {
+        close(inotify_fd);
+        inotify_fd = -1;
+    }
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (inotify_fd >= 0)
+        close(inotify_fd);
+#endif
+}
+
+bool FileWatcher::wait(const int timeout_ms) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    const auto remaining_ms = [&] {
+        if (timeout_ms < 0)
+            return -1;
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        return static_cast<int>(std::max<int64_t>(left, 0));
+    };
+
+#ifdef __linux__
+    if (inotify_fd >= 0) {
+        // Reads pending events, returns whether any names the watched file
+        const auto drain = [&] {
+            bool changed = false;
+            alignas(inotify_event) char buffer[4096];
+            ssize_t length;
+            while ((length = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+                for (ssize_t offset = 0; offset < length;) {
+                    const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                    if (event->len > 0 && path.filename() == event->name)
+                        changed = true;
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                }
+            }
+            return changed;
+        };
+
+        pollfd descriptor{inotify_fd, POLLIN, 0};
+        while (true) {
+            if (poll(&descriptor, 1, remaining_ms()) <= 0)
+                return false;
+
+            if (drain()) {
+                // Let the rest of the save land, then swallow its events
+                while (poll(&descriptor, 1, SETTLE_MS) > 0)
+                    drain();
+                return true;
+            }
+
+            if (timeout_ms >= 0 && remaining_ms() == 0)
+                return false;
+        }
+    }
+#endif
+
+    // Polling fallback
+    while (true) {
+        const auto time = write_time(path);
+        if (time != last_write) {
+            last_write = time;
+            return true;
+        }
+
+        const int left = remaining_ms();
+        if (left == 0)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(left < 0 ? POLL_MS : std::min(left, POLL_MS)));
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+#include <Utils/Headers.h>
+#include <filesystem>
+
+/**
+ * Reports changes to a single file.
+ * On Linux it listens to inotify events on the file's directory, which also catches editors that save by writing a new
+ * file and renaming it over the old one. Elsewhere it polls the file's modification time.
+ */
+class FileWatcher {
+    /// Watched file.
+    std::filesystem::path path;
+
+    /// inotify descriptor, -1 when polling.
+    int inotify_fd = -1;
+
+    /// Last modification time seen, used when polling.
+    std::filesystem::file_time_type last_write{};
+
+public:
+    // Constructors
+    /**
+     * Starts watching a file.
+     * @param path File to watch. Its directory must exist.
+     *
+     * @note Test Cases:\n
+     * FileWatcher("scene.blunder") -> watches scene.blunder\n
+     * FileWatcher("") -> ERROR: will throw a FileWatcherException (path cannot be empty)\n
+     * FileWatcher("missing_dir/scene.blunder") -> ERROR: will throw a FileWatcherException (cannot watch directory)\n
+     */
+    explicit FileWatcher(const std::string &path);
+
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher &) = delete;
+
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    // Methods
+    /**
+     * Waits until the file changes or the timeout passes. Changes that happened since the last call count as well.
+     * Bursts of events (an editor's write, truncate, rename) are merged into one change.
+     * @param timeout_ms Longest time to wait, in milliseconds. 0 only checks, negative waits indefinitely.
+     * @return True if the file changed.
+     *
+     * @note Test Cases:\n
+     * auto watcher = FileWatcher("scene.blunder")\n
+     * watcher.wait(0) -> false\n
+     * (write scene.blunder) watcher.wait(1000) -> true\n
+     * watcher.wait(0) -> false\n
+     */
+    bool wait(int timeout_ms);
+};
+
+#endif //FILEWATCHER_H
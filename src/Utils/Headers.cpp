@@ -1,4 +1,7 @@
 #include "Headers.h"
+#include <algorithm>
+#include <cstdint>
+#include <thread>
 
 bool is_finite(float val) {
     return std::isfinite(val);
@@ -79,9 +82,61 @@ float degrees_to_radians(float degrees) {
     return degrees * 3.14159265f / 180.0f;
 }
 
+namespace {
+    /**
+     * Per-thread PCG32 stream. Each thread seeds its stream from std::rand() on first use, unless seed_random()
+     * seeds it first, so render threads never share state or a lock.
+     */
+    struct RandomStream {
+        uint64_t state;
+
+        RandomStream() {
+            seed(static_cast<uint64_t>(std::rand()) << 32 ^ static_cast<uint64_t>(std::rand()));
+        }
+
+        /// Same initialization as pcg32_srandom_r() with the default increment.
+        void seed(const uint64_t value) {
+            state = 0;
+            next();
+            state += value;
+            next();
+        }
+
+        uint32_t next() {
+            const uint64_t old = state;
+            state = old * 6364136223846793005ull + 1442695040888963407ull;
+            const auto shifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+            const auto rotation = static_cast<uint32_t>(old >> 59u);
+            return (shifted >> rotation) | (shifted << ((32u - rotation) & 31u));
+        }
+    };
+
+    /// Gets the calling thread's stream.
+    inline RandomStream &thread_stream() {
+        thread_local RandomStream stream;
+        return stream;
+    }
+
+    /// Gets 32 random bits from the calling thread's stream.
+    inline uint32_t random_bits() {
+        return thread_stream().next();
+    }
+}
+
+void seed_random(const uint64_t seed) {
+    thread_stream().seed(seed);
+}
+
+uint64_t mix_seed(const uint64_t seed, const uint64_t value) {
+    uint64_t z = seed + 0x9e3779b97f4a7c15ull * (value + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
 float random_float() {
-    // Calculate result
-    return static_cast<float>(std::rand()) / (RAND_MAX + 1.0f);
+    // Top 24 bits, exactly representable, in [0, 1)
+    return static_cast<float>(random_bits() >> 8) * (1.0f / 16777216.0f);
 }
 
 float random_float(float min, float max) {
@@ -127,3 +182,170 @@ vec3 random_unit_vector() {
 vec3 sampleSquare() {
     return {random_float() - 0.5, random_float() - 0.5, 0};
 }
+
+namespace {
+    /// Directions generated per inner block, sized so the temporaries stay in L1.
+    constexpr int DIRECTION_BLOCK = 256;
+
+    /// Stateless 32-bit integer hash (lowbias32), every output bit depends on every input bit.
+    inline uint32_t hash_u32(uint32_t v) {
+        v ^= v >> 16;
+        v *= 0x7feb352du;
+        v ^= v >> 15;
+        v *= 0x846ca68bu;
+        v ^= v >> 16;
+        return v;
+    }
+
+    /**
+     * Generates count directions from the random stream seed, in closed form.
+     * The azimuth is split into a quadrant, taken from the top two bits of a hash, and an angle in [0, pi/2) whose sine
+     * and cosine are evaluated with polynomials. The quadrant rotation is done with selects, so there is no branch and
+     * no libm call in the loop, and it vectorizes.
+     */
+    void unit_vectors_block(const uint32_t seed, const int count, float *x, float *y, float *z) {
+        constexpr float to_unit = 1.0f / 16777216.0f;
+        constexpr float half_pi = 1.57079632679f;
+
+        for (int i = 0; i < count; i++) {
+            const uint32_t counter = seed + 2u * static_cast<uint32_t>(i);
+            const uint32_t a = hash_u32(counter);
+            const uint32_t b = hash_u32(counter + 1u);
+
+            // Height uniform in (-1, 1], radius of the circle at that height
+            const float height = 1.0f - 2.0f * (static_cast<float>(a >> 8) + 0.5f) * to_unit;
+            const float radius = std::sqrt(std::max(0.0f, 1.0f - height * height));
+
+            // Angle in [0, pi/2), Taylor polynomials within about 3.7e-6 (sine) and 6e-7 (cosine) there
+            const float angle = static_cast<float>(b & 0xffffffu) * to_unit * half_pi;
+            const float angle2 = angle * angle;
+            const float sine = angle * (1.0f + angle2 * (-1.0f / 6 + angle2 * (1.0f / 120 + angle2 * (
+                                                             -1.0f / 5040 + angle2 * (1.0f / 362880)))));
+            const float cosine = 1.0f + angle2 * (-0.5f + angle2 * (1.0f / 24 + angle2 * (
+                                                      -1.0f / 720 + angle2 * (1.0f / 40320 - angle2 / 3628800))));
+
+            // Rotate by the quadrant: 0 -> (c, s), 1 -> (-s, c), 2 -> (-c, -s), 3 -> (s, -c)
+            const uint32_t quadrant = b >> 30;
+            const bool odd = (quadrant & 1u) != 0;
+            const float u = odd ? sine : cosine;
+            const float v = odd ? cosine : sine;
+            const float sign_u = (quadrant == 1u || quadrant == 2u) ? -1.0f : 1.0f;
+            const float sign_v = quadrant >= 2u ? -1.0f : 1.0f;
+
+            x[i] = radius * sign_u * u;
+            y[i] = radius * sign_v * v;
+            z[i] = height;
+        }
+    }
+
+    /// Draws a fresh seed for a block from the calling thread's random stream.
+    inline uint32_t block_seed() {
+        return random_bits();
+    }
+}
+
+void random_unit_vectors(const int count, float *x, float *y, float *z) {
+    // Ensure count is non-negative
+    if (count < 0)
+        throw HeaderException("Headers -> random_unit_vectors(): count is negative");
+
+    // Nothing to do
+    if (count == 0)
+        return;
+
+    // Ensure output arrays exist
+    if (x == nullptr || y == nullptr || z == nullptr)
+        throw HeaderException("Headers -> random_unit_vectors(): output array is null");
+
+    for (int begin = 0; begin < count; begin += DIRECTION_BLOCK) {
+        const int block = std::min(DIRECTION_BLOCK, count - begin);
+        unit_vectors_block(block_seed(), block, x + begin, y + begin, z + begin);
+    }
+}
+
+void random_hemisphere_vectors(const int count, const float *normal_x, const float *normal_y, const float *normal_z,
+                               float *x, float *y, float *z) {
+    // Ensure count is non-negative
+    if (count < 0)
+        throw HeaderException("Headers -> random_hemisphere_vectors(): count is negative");
+
+    // Nothing to do
+    if (count == 0)
+        return;
+
+    // Ensure normal arrays exist
+    if (normal_x == nullptr || normal_y == nullptr || normal_z == nullptr)
+        throw HeaderException("Headers -> random_hemisphere_vectors(): normal array is null");
+
+    // Ensure output arrays exist
+    if (x == nullptr || y == nullptr || z == nullptr)
+        throw HeaderException("Headers -> random_hemisphere_vectors(): output array is null");
+
+    float block_x[DIRECTION_BLOCK], block_y[DIRECTION_BLOCK], block_z[DIRECTION_BLOCK];
+    for (int begin = 0; begin < count; begin += DIRECTION_BLOCK) {
+        const int block = std::min(DIRECTION_BLOCK, count - begin);
+        unit_vectors_block(block_seed(), block, block_x, block_y, block_z);
+
+        // Flip directions below their normal, in the local block so the loop has no aliasing to check
+        for (int i = 0; i < block; i++) {
+            const float side = block_x[i] * normal_x[begin + i] + block_y[i] * normal_y[begin + i]
+                               + block_z[i] * normal_z[begin + i];
+            const float sign = std::copysign(1.0f, side);
+            block_x[i] *= sign;
+            block_y[i] *= sign;
+            block_z[i] *= sign;
+        }
+
+        std::copy_n(block_x, block, x + begin);
+        std::copy_n(block_y, block, y + begin);
+        std::copy_n(block_z, block, z + begin);
+    }
+}
+
+void parallel_for(const int count, const std::function<void(int begin, int end)> &body, const int min_per_thread) {
+    // Ensure count is non-negative
+    if (count < 0)
+        throw HeaderException("Headers -> parallel_for(): count is negative");
+
+    // Nothing to do
+    if (count == 0)
+        return;
+
+    // Pick a thread count, never more threads than useful ranges
+    const int hardware_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int useful_threads = std::max(1, count / std::max(1, min_per_thread));
+    const int thread_count = std::min(hardware_threads, useful_threads);
+
+    // Run on the calling thread if there is no parallelism to be had
+    if (thread_count == 1) {
+        body(0, count);
+        return;
+    }
+
+    // Split into contiguous ranges, the calling thread takes the first one
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(thread_count);
+    threads.reserve(thread_count - 1);
+
+    const auto run = [&](const int index) {
+        const int begin = static_cast<int>(static_cast<long long>(count) * index / thread_count);
+        const int end = static_cast<int>(static_cast<long long>(count) * (index + 1) / thread_count);
+        try {
+            body(begin, end);
+        } catch (...) {
+            errors[index] = std::current_exception();
+        }
+    };
+
+    for (int index = 1; index < thread_count; index++)
+        threads.emplace_back(run, index);
+    run(0);
+
+    for (auto &thread: threads)
+        thread.join();
+
+    // Report the first failure
+    for (const auto &error: errors)
+        if (error)
+            std::rethrow_exception(error);
+}
@@ -2,11 +2,14 @@
 #define HEADERS_H
 #define GLM_ENABLE_EXPERIMENTAL
 #include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <random>
 #include <string>
+#include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
 
@@ -147,8 +150,31 @@ float linear_to_gamma(float linear_component);
  */
 float degrees_to_radians(float degrees);
 
+/**
+ * Restarts the calling thread's random stream, so everything it draws next depends on seed alone.
+ * Streams not seeded start from std::rand() on their first use.
+ * @param seed Seed of the stream.
+ *
+ * @note Test Cases:\n
+ * seed_random(7), random_float() twice -> the same two floats after seed_random(7) again\n
+ */
+void seed_random(uint64_t seed);
+
+/**
+ * Combines a seed with a value into a new seed, every bit of which depends on both, for streams keyed by what they
+ * are used for (splitmix64's finalizer).
+ * @param seed Seed to combine.
+ * @param value Value to combine it with.
+ * @return Combined seed.
+ *
+ * @note Test Cases:\n
+ * mix_seed(1, 2) -> same every call, different from mix_seed(1, 3) and mix_seed(2, 2)\n
+ */
+uint64_t mix_seed(uint64_t seed, uint64_t value);
+
 /**
  * Gets a random float in [0, 1).
+ * Safe to call from several threads, each thread draws from its own stream.
  * @return Random float in [0, 1).
  *
  * @note Test Cases:\n
@@ -209,6 +235,59 @@ vec3 random_unit_vector();
  */
 vec3 sampleSquare();
 
+/**
+ * Fills arrays with random unit vectors, uniformly distributed on the sphere.
+ * Unlike random_unit_vector(), this is closed-form and branch-free: every direction costs two random numbers and a
+ * fixed amount of arithmetic, so the loops vectorize and a whole batch of bounces can be generated at once.
+ * Directions are unit length to within 1e-5.
+ * @param count Number of directions to generate.
+ * @param x Output x components, count floats.
+ * @param y Output y components, count floats.
+ * @param z Output z components, count floats.
+ *
+ * @note Test Cases:\n
+ * random_unit_vectors(1000, x, y, z) -> every (x[i], y[i], z[i]) should have a length of nearly 1, mean nearly 0\n
+ * random_unit_vectors(0, x, y, z) -> should not touch the arrays\n
+ * random_unit_vectors(-1, x, y, z) -> ERROR: will return a HeaderException(count is negative)\n
+ * random_unit_vectors(10, nullptr, y, z) -> ERROR: will return a HeaderException(output array is null)\n
+ */
+void random_unit_vectors(int count, float *x, float *y, float *z);
+
+/**
+ * Fills arrays with random unit vectors, uniformly distributed on the hemisphere around each given normal.
+ * Each direction is a random_unit_vectors() direction, flipped without branching when it points below its normal.
+ * @param count Number of directions to generate.
+ * @param normal_x Normals' x components, count floats.
+ * @param normal_y Normals' y components, count floats.
+ * @param normal_z Normals' z components, count floats.
+ * @param x Output x components, count floats.
+ * @param y Output y components, count floats.
+ * @param z Output z components, count floats.
+ *
+ * @note Test Cases:\n
+ * random_hemisphere_vectors(1000, normals, x, y, z) -> every direction should have a length of nearly 1 and a
+ * non-negative dot product with its normal\n
+ * random_hemisphere_vectors(-1, normals, x, y, z) -> ERROR: will return a HeaderException(count is negative)\n
+ * random_hemisphere_vectors(10, nullptr, ..., x, y, z) -> ERROR: will return a HeaderException(array is null)\n
+ */
+void random_hemisphere_vectors(int count, const float *normal_x, const float *normal_y, const float *normal_z,
+                               float *x, float *y, float *z);
+
+/**
+ * Runs body over [0, count) split into contiguous ranges, one per hardware thread.
+ * Small workloads (fewer than min_per_thread items per thread) use fewer threads, down to running on the caller.
+ * If any range throws, the first exception is rethrown on the calling thread once every range has finished.
+ * @param count Number of items to process.
+ * @param body Function called as body(begin, end) for each range.
+ * @param min_per_thread Minimum number of items worth handing to a thread.
+ *
+ * @note Test Cases:\n
+ * parallel_for(1000, body) -> body should see every index in [0, 1000) exactly once\n
+ * parallel_for(0, body) -> body should not be called\n
+ * parallel_for(-1, body) -> ERROR: will throw a HeaderException (count is negative)\n
+ */
+void parallel_for(int count, const std::function<void(int begin, int end)> &body, int min_per_thread = 1);
+
 // Common custom headers
 #include <Utils/Ray.h>
 #include <Utils/Color.h>
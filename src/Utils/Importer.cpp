@@ -3,24 +3,138 @@
 #include <sstream>
 #include <Renderer/Renderer.h>
 #include <Renderer/RenderTarget.h>
+#include <Utils/Arena.h>
+#include <Utils/FileWatcher.h>
+#include <Utils/Profiler.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+
+namespace {
+    /// Makes the render target for a scene, starting from the composite image when one is given.
+    shared_ptr<RenderTarget> MakeRenderTarget(const Scene &scene, const std::string &compositeFileName,
+                                              const PixelStorage storage) {
+        if (compositeFileName.empty())
+            return make_shared<RenderTarget>(scene.screen_width, scene.screen_height, storage);
+
+        shared_ptr<RenderTarget> renderTarget;
+        if (compositeFileName.size() >= 4 && compositeFileName.substr(compositeFileName.size() - 4) == ".pfm")
+            renderTarget = RenderTarget::readFromPFM(compositeFileName);
+        else
+            renderTarget = RenderTarget::readFromPPM(compositeFileName);
+
+        if (renderTarget->get_width() != scene.screen_width || renderTarget->get_height() != scene.screen_height)
+            throw ImporterException("Importer::RenderFile: composite image size differs from the scene's screen size");
+
+        renderTarget->set_storage(storage);
+        return renderTarget;
+    }
 
-void Importer::RenderFile(const std::string &fileNameIn, const std::string &fileNameOut) {
-    // Ensure fileNameIn is non-empty
-    if (fileNameIn.empty())
-        throw ImporterException("Importer::RenderFile: empty scene file name");
+    /// Size of the #SPHERES section, in bytes, worth parsing on its own thread.
+    constexpr size_t SPHERE_CHUNK_BYTES = 256 * 1024;
+
+    /// Longest a save goes unnoticed while a watched scene refines in the background, in milliseconds.
+    constexpr int REFINEMENT_POLL_MS = 50;
 
-    // Ensure fileNameOut is non-empty
-    if (fileNameOut.empty())
-        throw ImporterException("Importer::RenderFile: empty output file name");
+    /// Characters separating the values of a sphere definition.
+    constexpr std::string_view BLANKS = " \t\r\v\f";
+
+    /// Reads a float filling the whole token.
+    bool ParseFloat(const std::string_view token, float &value) {
+        if (token.empty())
+            return false;
+
+        // The section is a std::string, so strtof stops at the blank after the token at the latest
+        char *end = nullptr;
+        value = std::strtof(token.data(), &end);
+        return end == token.data() + token.size();
+    }
+
+    /**
+     * Parses the sphere definitions in [begin, end) of the #SPHERES section, which start and end on line boundaries.
+     * Errors name their line in the file, sectionLine being the line the section starts on.
+     */
+    void ParseSphereChunk(const std::string_view section, const size_t begin, const size_t end, const int sectionLine,
+                          const std::unordered_map<std::string, Color> &colorMap,
+                          std::vector<shared_ptr<Sphere> > &spheres) {
+        const auto error = [&](const size_t lineStart, const std::string &message) {
+            const auto line = sectionLine + std::count(section.begin(), section.begin() + lineStart, '\n');
+            return ImporterException("Importer::LoadScene: " + message + " on line " + std::to_string(line));
+        };
+
+        // Rough size of a definition, "x y z color radius", for the first allocation
+        spheres.reserve((end - begin) / 24);
+
+        // The chunk's spheres sit next to each other in an arena of their own, kept alive by the spheres themselves.
+        // Regular pages, so the unused end of the last block is never touched
+        const ArenaAllocator<Sphere> allocator(make_shared<Arena>(Arena::HUGE_PAGE_SIZE, HugePages::Off));
+
+        size_t lineStart = begin;
+        while (lineStart < end) {
+            size_t lineEnd = section.find('\n', lineStart);
+            if (lineEnd == std::string_view::npos || lineEnd > end)
+                lineEnd = end;
+            const std::string_view line = section.substr(lineStart, lineEnd - lineStart);
+
+            // Split into the leading tokens, anything after the radius is ignored
+            std::string_view tokens[5];
+            int count = 0;
+            for (size_t pos = line.find_first_not_of(BLANKS); pos != std::string_view::npos && count < 5;
+                 pos = line.find_first_not_of(BLANKS, pos)) {
+                const size_t tokenEnd = std::min(line.find_first_of(BLANKS, pos), line.size());
+                tokens[count++] = line.substr(pos, tokenEnd - pos);
+                pos = tokenEnd;
+            }
+
+            // Ignore empty lines
+            if (count > 0) {
+                float x, y, z, radius;
+                if (count < 5 || !ParseFloat(tokens[0], x) || !ParseFloat(tokens[1], y) ||
+                    !ParseFloat(tokens[2], z) || !ParseFloat(tokens[4], radius))
+                    throw error(lineStart, "invalid sphere definition");
+
+                const auto color = colorMap.find(std::string(tokens[3]));
+                if (color == colorMap.end())
+                    throw error(lineStart, "undefined color used in sphere");
+
+                try {
+                    spheres.push_back(std::allocate_shared<Sphere>(allocator, vec3(x, y, z), radius, color->second));
+                } catch (SphereException &e) {
+                    throw error(lineStart, std::string("invalid sphere (") + e.what() + ")");
+                }
+            }
+
+            lineStart = lineEnd + 1;
+        }
+    }
+
+    /// Ensures the scene names and output names given to RenderFile() and WatchFile() are usable.
+    void ValidateFileNames(const std::string &fileNameIn, const std::string &fileNameOut) {
+        // Ensure fileNameIn is non-empty
+        if (fileNameIn.empty())
+            throw ImporterException("Importer::RenderFile: empty scene file name");
+
+        // Ensure fileNameOut is non-empty
+        if (fileNameOut.empty())
+            throw ImporterException("Importer::RenderFile: empty output file name");
+
+        // Ensure no weird name equals weirdness
+        if (fileNameIn == fileNameOut)
+            throw ImporterException("Importer::RenderFile: scene file name cannot be the same as output file name");
+    }
+}
 
-    // Ensure no weird name equals weirdness
-    if (fileNameIn == fileNameOut)
-        throw ImporterException("Importer::RenderFile: scene file name cannot be the same as output file name");
+Scene Importer::LoadScene(const std::string &fileNameIn) {
+    // Ensure fileNameIn is non-empty
+    if (fileNameIn.empty())
+        throw ImporterException("Importer::LoadScene: empty scene file name");
 
     // Try to open the file
     std::ifstream file(fileNameIn);
     if (!file.is_open())
-        throw ImporterException("Importer::RenderFile: cannot open file (does the file exist?)");
+        throw ImporterException("Importer::LoadScene: cannot open file (does the file exist?)");
 
     // Line currently being used throughout
     std::string line;
@@ -31,7 +145,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
             continue;
 
         if (line != "#BLUNDER")
-            throw ImporterException("Importer::RenderFile: no #BLUNDER header");
+            throw ImporterException("Importer::LoadScene: no #BLUNDER header");
 
         break;
     }
@@ -45,7 +159,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
             continue;
 
         if (line != "#SETTINGS")
-            throw ImporterException("Importer::RenderFile: no #SETTINGS header");
+            throw ImporterException("Importer::LoadScene: no #SETTINGS header");
 
         break;
     }
@@ -57,7 +171,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
 
         std::istringstream(line) >> line >> screenWidth;
         if (line != "screen_width")
-            throw ImporterException("Importer::RenderFile: expected screen_width");
+            throw ImporterException("Importer::LoadScene: expected screen_width");
 
         break;
     }
@@ -69,7 +183,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
 
         std::istringstream(line) >> line >> screenHeight;
         if (line != "screen_height")
-            throw ImporterException("Importer::RenderFile: expected screen_height");
+            throw ImporterException("Importer::LoadScene: expected screen_height");
 
         break;
     }
@@ -81,7 +195,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
 
         std::istringstream(line) >> line >> samples;
         if (line != "samples")
-            throw ImporterException("Importer::RenderFile: expected samples");
+            throw ImporterException("Importer::LoadScene: expected samples");
 
         break;
     }
@@ -93,7 +207,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
 
         std::istringstream(line) >> line >> bounces;
         if (line != "bounces")
-            throw ImporterException("Importer::RenderFile: expected bounces");
+            throw ImporterException("Importer::LoadScene: expected bounces");
 
         break;
     }
@@ -102,13 +216,28 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
     vec3 camera_position, look_at, up_direction;
     float fov;
 
-    // Require camera header
+    // Optional crop window, then require camera header
+    RT_CROP crop{};
     while (std::getline(file, line)) {
         if (line.empty())
             continue;
 
+        if (line.rfind("crop", 0) == 0) {
+            std::istringstream ss(line);
+            std::string key;
+            if (!(ss >> key >> crop.x >> crop.y >> crop.width >> crop.height) || key != "crop")
+                throw ImporterException("Importer::LoadScene: expected crop <x> <y> <width> <height>");
+
+            // Ensure the window lies inside the image
+            if (crop.x < 0 || crop.y < 0 || crop.width <= 0 || crop.height <= 0 ||
+                crop.x + crop.width > screenWidth || crop.y + crop.height > screenHeight)
+                throw ImporterException("Importer::LoadScene: crop window must lie inside the screen");
+
+            continue;
+        }
+
         if (line != "#CAMERA")
-            throw ImporterException("Importer::RenderFile: no #CAMERA header");
+            throw ImporterException("Importer::LoadScene: no #CAMERA header");
 
         break;
     }
@@ -120,7 +249,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
 
         std::istringstream(line) >> line >> camera_position.x >> camera_position.y >> camera_position.z;
         if (line != "position")
-            throw ImporterException("Importer::RenderFile: expected camera position");
+            throw ImporterException("Importer::LoadScene: expected camera position");
 
         break;
     }
@@ -132,7 +261,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
 
         std::istringstream(line) >> line >> look_at.x >> look_at.y >> look_at.z;
         if (line != "look_at")
-            throw ImporterException("Importer::RenderFile: expected camera look_at");
+            throw ImporterException("Importer::LoadScene: expected camera look_at");
 
         break;
     }
@@ -144,7 +273,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
 
         std::istringstream(line) >> line >> fov;
         if (line != "fov")
-            throw ImporterException("Importer::RenderFile: expected camera fov");
+            throw ImporterException("Importer::LoadScene: expected camera fov");
 
         break;
     }
@@ -156,7 +285,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
 
         std::istringstream(line) >> line >> up_direction.x >> up_direction.y >> up_direction.z;
         if (line != "up_direction")
-            throw ImporterException("Importer::RenderFile: expected camera up_direction");
+            throw ImporterException("Importer::LoadScene: expected camera up_direction");
 
         break;
     }// Ignore empty lines
@@ -170,7 +299,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
             continue;
 
         if (line != "#COLORS")
-            throw ImporterException("Importer::RenderFile: no #COLORS header");
+            throw ImporterException("Importer::LoadScene: no #COLORS header");
 
         break;
     }
@@ -185,7 +314,7 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
         float r, g, b;
 
         if (!(ss >> name >> r >> g >> b))
-            throw ImporterException("Importer::RenderFile: invalid color definition");
+            throw ImporterException("Importer::LoadScene: invalid color definition");
 
         colorMap[name] = Color(vec3(r, g, b));
     }
@@ -193,34 +322,275 @@ void Importer::RenderFile(const std::string &fileNameIn, const std::string &file
     // SPHERES
     auto spheres = make_shared<SphereList>();
 
-    // Get sphere definitions
-    while (std::getline(file, line)) {
-        if (line.empty())
-            continue;
-        
-        std::istringstream ss(line);
-        float x, y, z, radius;
-        std::string colorName;
-        
-        if (!(ss >> x >> y >> z >> colorName >> radius))
-            throw ImporterException("Importer::RenderFile: invalid sphere definition");
+    // Get sphere definitions: the rest of the file is read at once and parsed in chunks by several threads
+    if (file) {
+        // A '#SPHERES' line without a trailing newline leaves eof set, which would make tellg() fail
+        file.clear();
+        const std::streamoff sectionStart = file.tellg();
+        file.seekg(0, std::ios::end);
+        const std::streamoff fileSize = file.tellg();
+
+        // Ensure the section bounds are valid before sizing the buffer
+        if (sectionStart < 0 || fileSize < sectionStart)
+            throw ImporterException("Importer::LoadScene: cannot read sphere definitions");
+
+        std::string content(static_cast<size_t>(fileSize), '\0');
+        file.seekg(0);
+        if (!file.read(content.data(), fileSize))
+            throw ImporterException("Importer::LoadScene: cannot read sphere definitions");
+
+        const std::string_view section = std::string_view(content).substr(sectionStart);
+        const int sectionLine = 1 + static_cast<int>(std::count(content.begin(), content.begin() + sectionStart, '\n'));
+
+        // Chunk boundaries, moved forward to the start of the next line
+        const auto hardwareThreads = static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency()));
+        const size_t chunkCount = std::clamp(section.size() / SPHERE_CHUNK_BYTES, size_t{1}, 4 * hardwareThreads);
+        std::vector<size_t> bounds{0};
+        for (size_t k = 1; k < chunkCount; k++) {
+            const size_t newline = section.find('\n', std::max(section.size() * k / chunkCount, bounds.back()));
+            bounds.push_back(newline == std::string_view::npos ? section.size() : newline + 1);
+        }
+        bounds.push_back(section.size());
+
+        // Parse chunks into their own buffers, then splice them in file order
+        std::vector<std::vector<shared_ptr<Sphere> > > chunks(chunkCount);
+        parallel_for(static_cast<int>(chunkCount), [&](const int begin, const int end) {
+            for (int k = begin; k < end; k++)
+                ParseSphereChunk(section, bounds[k], bounds[k + 1], sectionLine, colorMap, chunks[k]);
+        });
+
+        size_t total = 0;
+        for (const auto &chunk: chunks)
+            total += chunk.size();
+        spheres->Reserve(total);
+        for (const auto &chunk: chunks)
+            for (const auto &sphere: chunk)
+                spheres->Add(sphere);
+    }
+
+    // CAMERA OBJECT
+    auto camera = make_shared<Camera>(camera_position, look_at);
+    camera->set_fov(fov);
+    camera->set_up_direction(up_direction);
 
-        if (!colorMap.count(colorName))
-            throw ImporterException("Importer::RenderFile: undefined color used in sphere");
+    return {screenWidth, screenHeight, samples, bounces, camera, spheres, crop};
+}
 
-        auto position = vec3(x, y, z);
-        Color color(colorMap[colorName]);
-        spheres->Add(make_shared<Sphere>(position, radius, color));
+void Importer::RenderFile(const std::string &fileNameIn, const std::string &fileNameOut,
+                          const PostProcess &postProcess, const RT_TILING &tiling, const RT_CROP &crop,
+                          const std::string &compositeFileName, const std::string &costMapName,
+                          const PixelStorage storage, const RT_IRRADIANCE_CACHE &irradianceCache,
+                          const RT_PATH_GUIDING &pathGuiding) {
+    ValidateFileNames(fileNameIn, fileNameOut);
+
+    // PARSE
+    Scene scene;
+    {
+        BLUNDER_PROFILE_ZONE("Parse scene");
+        scene = LoadScene(fileNameIn);
+    }
+
+    // SETUP
+    shared_ptr<RenderTarget> renderTarget;
+    shared_ptr<Renderer> renderer;
+    {
+        BLUNDER_PROFILE_ZONE("Scene setup");
+        // Pixels outside the crop window come from the composite image, if any
+        renderTarget = MakeRenderTarget(scene, compositeFileName, storage);
+
+        renderer = make_shared<Renderer>(scene.samples, scene.bounces);
+        renderer->set_tiling(tiling);
+        renderer->set_crop(crop.width > 0 ? crop : scene.crop);
+        renderer->set_irradiance_cache(irradianceCache);
+        renderer->set_path_guiding(pathGuiding);
     }
 
     // ATTEMPT TO RENDER
-    auto renderTarget = make_shared<RenderTarget>(screenWidth, screenHeight);
+    const auto costMap = costMapName.empty()
+                             ? nullptr
+                             : make_shared<CostMap>(renderTarget->get_width(), renderTarget->get_height());
+    renderer->render(scene.spheres, scene.camera, renderTarget, costMap);
+    renderTarget->writeToFile(fileNameOut, postProcess);
+
+    // COST MAP
+    if (costMap != nullptr) {
+        costMap->writeFalseColor(costMapName + "_tests.ppm", CostChannel::IntersectionTests);
+        costMap->writeFalseColor(costMapName + "_steps.ppm", CostChannel::TraversalSteps);
+        costMap->writeFalseColor(costMapName + "_bounces.ppm", CostChannel::Bounces);
+        costMap->writeFalseColor(costMapName + "_time.ppm", CostChannel::TileTime);
+        costMap->writeRaw(costMapName + ".raw");
+    }
+}
 
-    auto camera = make_shared<Camera>(camera_position, look_at);
-    camera->set_fov(fov);
-    camera->set_up_direction(up_direction);
+SceneChanges Importer::UpdateScene(Scene &current, const Scene &updated) {
+    // Ensure both scenes are complete
+    if (current.camera == nullptr || current.spheres == nullptr || updated.camera == nullptr ||
+        updated.spheres == nullptr)
+        throw ImporterException("Importer::UpdateScene: scenes must have a camera and a sphere list");
+
+    SceneChanges changes;
+
+    // Settings
+    const auto &a = current.crop;
+    const auto &b = updated.crop;
+    changes.settings = current.screen_width != updated.screen_width || current.screen_height != updated.screen_height
+                       || current.samples != updated.samples || current.bounces != updated.bounces
+                       || a.x != b.x || a.y != b.y || a.width != b.width || a.height != b.height;
+    if (changes.settings) {
+        current.screen_width = updated.screen_width;
+        current.screen_height = updated.screen_height;
+        current.samples = updated.samples;
+        current.bounces = updated.bounces;
+        current.crop = updated.crop;
+    }
+
+    // Camera, updated in place
+    Camera &camera = *current.camera;
+    const Camera &newCamera = *updated.camera;
+    changes.camera = camera.get_position() != newCamera.get_position() ||
+                     camera.get_look_at() != newCamera.get_look_at() ||
+                     camera.get_up_direction() != newCamera.get_up_direction() ||
+                     camera.get_fov() != newCamera.get_fov();
+    if (changes.camera)
+        camera = newCamera;
+
+    // Spheres: same count refits in place, anything else replaces the list
+    const auto &spheres = current.spheres->get_spheres();
+    const auto &newSpheres = updated.spheres->get_spheres();
+    if (spheres.size() != newSpheres.size()) {
+        current.spheres = updated.spheres;
+        changes.spheres_rebuilt = true;
+        return changes;
+    }
+
+    for (size_t i = 0; i < spheres.size(); i++) {
+        Sphere &sphere = *spheres[i];
+        const Sphere &newSphere = *newSpheres[i];
+        if (sphere.get_position() == newSphere.get_position() && sphere.get_radius() == newSphere.get_radius() &&
+            sphere.get_color().get_color() == newSphere.get_color().get_color())
+            continue;
 
-    auto renderer = Renderer(samples, bounces);
-    renderer.render(spheres, camera, renderTarget);
-    renderTarget->writeToFile(fileNameOut);
+        sphere = newSphere;
+        changes.spheres_updated++;
+    }
+
+    if (changes.spheres_updated > 0)
+        current.spheres->Refit();
+
+    return changes;
+}
+
+void Importer::WatchFile(const std::string &fileNameIn, const std::string &fileNameOut,
+                         const PostProcess &postProcess, const RT_TILING &tiling, const RT_CROP &crop,
+                         const std::string &compositeFileName, const PixelStorage storage,
+                         const RT_IRRADIANCE_CACHE &irradianceCache, const RT_PATH_GUIDING &pathGuiding) {
+    ValidateFileNames(fileNameIn, fileNameOut);
+
+    using Clock = std::chrono::steady_clock;
+    const auto milliseconds = [](const Clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+    };
+
+    FileWatcher watcher(fileNameIn);
+    Scene scene = LoadScene(fileNameIn);
+    auto renderTarget = MakeRenderTarget(scene, compositeFileName, storage);
+
+    // Renderer for the current scene at a sample count, the pre-passes take longer than a preview sample to build
+    const auto makeRenderer = [&](const int samples) {
+        Renderer renderer(samples, scene.bounces);
+        renderer.set_tiling(tiling);
+        renderer.set_crop(crop.width > 0 ? crop : scene.crop);
+        if (samples >= scene.samples) {
+            renderer.set_irradiance_cache(irradianceCache);
+            renderer.set_path_guiding(pathGuiding);
+        }
+        return renderer;
+    };
+
+    const auto initial = Clock::now();
+    makeRenderer(scene.samples).render(scene.spheres, scene.camera, renderTarget);
+    renderTarget->writeToFile(fileNameOut, postProcess);
+    std::cout << "Watching " << fileNameIn << ", rendered in " << milliseconds(initial) << " ms" << std::endl;
+
+    // Full render of the current scene, running in the background while the file is watched
+    shared_ptr<RenderJob> refinement;
+    Clock::time_point refinementStart;
+    const auto startRefinement = [&]() {
+        refinementStart = Clock::now();
+        refinement = makeRenderer(scene.samples).renderAsync(scene.spheres, scene.camera, renderTarget);
+    };
+
+    // Waits for the refinement and writes it if it completed, returns whether it did
+    const auto finishRefinement = [&]() {
+        const bool completed = refinement->wait() == RenderStatus::Completed;
+        refinement.reset();
+        if (!completed)
+            return false;
+
+        renderTarget->writeToFile(fileNameOut, postProcess);
+        std::cout << "Full render (" << scene.samples << " spp) written in " << milliseconds(refinementStart)
+                  << " ms" << std::endl;
+        return true;
+    };
+
+    while (true) {
+        // Poll for saves while the refinement runs, block once it is done
+        if (refinement != nullptr) {
+            if (!watcher.wait(REFINEMENT_POLL_MS)) {
+                if (refinement->wait_for(0))
+                    finishRefinement();
+                continue;
+            }
+        } else if (!watcher.wait(-1)) {
+            continue;
+        }
+        const auto edit = Clock::now();
+
+        // The scene is edited in place, so the refinement stops first and is restarted if the save changed nothing
+        bool interrupted = false;
+        if (refinement != nullptr) {
+            refinement->cancel();
+            interrupted = !finishRefinement();
+        }
+
+        // Parse and apply the new version, keep the current scene if it does not parse
+        SceneChanges changes;
+        try {
+            const Scene updated = LoadScene(fileNameIn);
+            changes = UpdateScene(scene, updated);
+        } catch (BaseException &e) {
+            std::cerr << e.what() << " (keeping the previous scene)" << std::endl;
+            if (interrupted)
+                startRefinement();
+            continue;
+        }
+
+        if (!changes.any()) {
+            if (interrupted)
+                startRefinement();
+            continue;
+        }
+
+        if (renderTarget->get_width() != scene.screen_width || renderTarget->get_height() != scene.screen_height)
+            renderTarget = make_shared<RenderTarget>(scene.screen_width, scene.screen_height, storage);
+
+        // Describe what the update cost
+        std::string summary = changes.spheres_rebuilt
+                                  ? "spheres rebuilt"
+                                  : std::to_string(changes.spheres_updated) + " spheres updated in place";
+        if (changes.camera)
+            summary += ", camera moved";
+        if (changes.settings)
+            summary += ", settings changed";
+        if (interrupted)
+            summary += ", refinement cancelled";
+        std::cout << "Reloaded in " << milliseconds(edit) << " ms (" << summary << ")" << std::endl;
+
+        // Quick preview first, then refine in the background until the file changes again
+        makeRenderer(1).render(scene.spheres, scene.camera, renderTarget);
+        renderTarget->writeToFile(fileNameOut, postProcess);
+        std::cout << "Preview written " << milliseconds(edit) << " ms after the save" << std::endl;
+        if (scene.samples > 1)
+            startRefinement();
+    }
 }
@@ -1,21 +1,149 @@
 #ifndef IMPORTER_H
 #define IMPORTER_H
 #include <Utils/Headers.h>
+#include <Renderer/PostProcess.h>
+#include <Renderer/Renderer.h>
+#include <Camera/Camera.h>
+#include <Geometry/SphereList.h>
+
+/**
+ * Everything a Blunder scene file describes: render settings, the camera and the spheres.
+ */
+struct Scene {
+    /// Width of the output image, in pixels.
+    int screen_width;
+
+    /// Height of the output image, in pixels.
+    int screen_height;
+
+    /// Number of rays traced per pixel.
+    int samples;
+
+    /// Maximum number of bounces per ray.
+    int bounces;
+
+    /// Camera viewing the scene.
+    shared_ptr<Camera> camera;
+
+    /// Spheres in the scene.
+    shared_ptr<SphereList> spheres;
+
+    /// Window of the image to trace, from the optional crop setting. 0 x 0 for the whole image.
+    RT_CROP crop{};
+};
+
+/**
+ * What changed between two versions of a scene, as applied by Importer::UpdateScene().
+ */
+struct SceneChanges {
+    /// Screen size, samples, bounces or crop window changed.
+    bool settings = false;
+
+    /// Camera position, look_at, fov or up direction changed.
+    bool camera = false;
+
+    /// Number of spheres moved, resized or recolored in place.
+    size_t spheres_updated = 0;
+
+    /// Spheres were added or removed, so the sphere list was replaced.
+    bool spheres_rebuilt = false;
+
+    /// Gets whether anything changed.
+    [[nodiscard]] bool any() const {
+        return settings || camera || spheres_updated > 0 || spheres_rebuilt;
+    }
+};
 
 class Importer {
 public:
+    /**
+     * Parses a Blunder scene file.
+     * Sphere definitions are parsed in chunks on several threads and kept in file order.
+     * @param fileNameIn Blunder scene file to be parsed.
+     * @return Scene described by the file.
+     *
+     * @note Test Cases:\n
+     * Importer::LoadScene("good.blunder") -> returns the scene's settings, camera and spheres\n
+     * Importer::LoadScene("bad.blunder") -> ERROR: will throw an ImporterException (Blunder scene file is not exactly to format specifications)\n
+     * Importer::LoadScene("") -> ERROR: will throw an ImporterException (Blunder scene file name cannot be empty)\n
+     * Importer::LoadScene("bad_sphere.blunder") -> ERROR: will throw an ImporterException naming the sphere's line\n
+     */
+    static Scene LoadScene(const std::string& fileNameIn);
+
     /**
      * Renders a Blunder scene file to the specified fileNameOut file.
      * @param fileNameIn Blunder scene file to be rendered.
      * @param fileNameOut Name of the file the image will be written to, in ppm format.
+     * @param postProcess Exposure, tone mapping and transfer function used when writing the image.
+     * @param tiling Tile size and order used when rendering.
+     * @param crop Window of the image to trace, overriding the scene's crop setting unless it is 0 x 0.
+     * @param compositeFileName Image (.ppm or .pfm) of the same size filling the pixels outside the crop window.
+     * Empty to leave them black.
+     * @param costMapName Base name of the cost map files written next to the image: false-color images
+     * <name>_tests.ppm, <name>_steps.ppm, <name>_bounces.ppm and <name>_time.ppm, and the raw floats <name>.raw (see
+     * CostMap::writeRaw()). Empty to write none.
+     * @param storage How the render target stores pixels, Half or RGB9E5 to fit very large images in memory.
+     * @param irradianceCache Irradiance cache settings of the renderer, off by default.
+     * @param pathGuiding Path guiding settings of the renderer, off by default.
      *
      * @note Test Cases:\n
      * Importer::RenderFile("good.blunder", "out.ppm") -> renders good.blunder to out.ppm\n
+     * Importer::RenderFile("good.blunder", "out.ppm", pp, tiling, crop, "", "cost") -> also writes the cost map files\n
      * Importer::RenderFile("bad.blunder", "out.ppm") -> ERROR: will throw an ImporterException (Blunder scene file is not exactly to format specifications)\n
      * Importer::RenderFile("", "out.ppm") -> ERROR: will throw an ImporterException (Blunder scene file name cannot be empty)\n
      * Importer::RenderFile("bad.blunder", "") -> ERROR: will throw an ImporterException (Output file name cannot be empty)\n
+     * Importer::RenderFile("good.blunder", "out.ppm", pp, tiling, crop, "other_size.ppm") -> ERROR: will throw an ImporterException (composite image size differs)\n
+     */
+    static void RenderFile(const std::string& fileNameIn, const std::string& fileNameOut,
+                           const PostProcess& postProcess = PostProcess(), const RT_TILING& tiling = RT_TILING(),
+                           const RT_CROP& crop = RT_CROP(), const std::string& compositeFileName = "",
+                           const std::string& costMapName = "", PixelStorage storage = PixelStorage::Float,
+                           const RT_IRRADIANCE_CACHE& irradianceCache = RT_IRRADIANCE_CACHE(),
+                           const RT_PATH_GUIDING& pathGuiding = RT_PATH_GUIDING());
+
+    /**
+     * Brings a loaded scene up to date with a newly parsed version of it, doing as little work as possible.
+     * Settings and camera values are copied over. When the number of spheres is unchanged, spheres that moved,
+     * resized or changed color are updated in place, the sphere list is kept and its accelerator is refit rather than
+     * rebuilt (see SphereList::Refit()). Only added or removed spheres replace the list.
+     * @param current Loaded scene, updated in place.
+     * @param updated Newly parsed version of the scene.
+     * @return What changed.
+     *
+     * @note Test Cases:\n
+     * Importer::UpdateScene(scene, same scene) -> nothing changed\n
+     * Importer::UpdateScene(scene, scene with a moved camera) -> camera changed, spheres kept\n
+     * Importer::UpdateScene(scene, scene with one recolored sphere) -> 1 sphere updated, same sphere list\n
+     * Importer::UpdateScene(scene, scene with an extra sphere) -> spheres rebuilt\n
+     * Importer::UpdateScene(scene, scene without a camera) -> ERROR: will throw an ImporterException (incomplete scene)\n
+     */
+    static SceneChanges UpdateScene(Scene& current, const Scene& updated);
+
+    /**
+     * Renders a Blunder scene file, then keeps watching it and re-renders after every save until the process is
+     * interrupted. Each save is parsed and applied with UpdateScene(), then a 1 sample per pixel preview is written
+     * straight away, without the irradiance cache or path guide pre-passes. The render at the scene's sample count
+     * then runs in the background and is cancelled as soon as the file changes again.
+     * Files that fail to parse are reported and skipped, the previous scene stays loaded.
+     * @param fileNameIn Blunder scene file to be watched.
+     * @param fileNameOut Name of the file the image will be written to, in ppm format.
+     * @param postProcess Exposure, tone mapping and transfer function used when writing the image.
+     * @param tiling Tile size and order used when rendering.
+     * @param crop Window of the image to trace, overriding the scene's crop setting unless it is 0 x 0.
+     * @param compositeFileName Image (.ppm or .pfm) of the same size filling the pixels outside the crop window.
+     * @param storage How the render target stores pixels.
+     * @param irradianceCache Irradiance cache settings of the renderer, off by default.
+     * @param pathGuiding Path guiding settings of the renderer, off by default.
+     *
+     * @note Test Cases:\n
+     * Same argument validation as RenderFile(). Runs until interrupted, so it is exercised by hand.\n
      */
-    static void RenderFile(const std::string& fileNameIn, const std::string& fileNameOut);
+    static void WatchFile(const std::string& fileNameIn, const std::string& fileNameOut,
+                          const PostProcess& postProcess = PostProcess(), const RT_TILING& tiling = RT_TILING(),
+                          const RT_CROP& crop = RT_CROP(), const std::string& compositeFileName = "",
+                          PixelStorage storage = PixelStorage::Float,
+                          const RT_IRRADIANCE_CACHE& irradianceCache = RT_IRRADIANCE_CACHE(),
+                          const RT_PATH_GUIDING& pathGuiding = RT_PATH_GUIDING());
 };
 
 #endif //IMPORTER_H
@@ -0,0 +1,155 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+namespace {
+    /// Events recorded by one thread.
+    struct ThreadBuffer {
+        /// Sequential id used as the trace's tid.
+        int thread_id;
+
+        /// Whether a live thread owns the buffer, guarded by thread_buffers_mutex().
+        bool in_use;
+
+        /// Recorded events, only ever appended to by the owning thread.
+        std::vector<Profiler::Event> events;
+    };
+
+    /// Every thread buffer. Buffers outlive their threads so short-lived workers are not lost, then pass to the next
+    /// new thread, so threads started per render do not add a buffer each.
+    std::vector<std::unique_ptr<ThreadBuffer> > &thread_buffers() {
+        static std::vector<std::unique_ptr<ThreadBuffer> > buffers;
+        return buffers;
+    }
+
+    /// Guards thread_buffers(), only taken when a thread records its first event or exits, and when exporting.
+    std::mutex &thread_buffers_mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    /// A thread's hold on its buffer, released when the thread exits.
+    struct BufferLease {
+        ThreadBuffer *buffer = nullptr;
+
+        ~BufferLease() {
+            if (buffer != nullptr) {
+                std::lock_guard lock(thread_buffers_mutex());
+                buffer->in_use = false;
+            }
+        }
+    };
+
+    /// Gets the calling thread's buffer, taking a released one or registering a new one on first use.
+    ThreadBuffer &local_buffer() {
+        thread_local BufferLease lease;
+        if (lease.buffer == nullptr) {
+            std::lock_guard lock(thread_buffers_mutex());
+            auto &buffers = thread_buffers();
+            const auto released = std::find_if(buffers.begin(), buffers.end(), [](const auto &buffer) {
+                return !buffer->in_use;
+            });
+            if (released != buffers.end()) {
+                lease.buffer = released->get();
+            } else {
+                static int next_thread_id = 1;
+                buffers.push_back(std::make_unique<ThreadBuffer>());
+                lease.buffer = buffers.back().get();
+                lease.buffer->thread_id = next_thread_id++;
+                lease.buffer->events.reserve(1024);
+            }
+            lease.buffer->in_use = true;
+        }
+        return *lease.buffer;
+    }
+
+    /// Writes a string as a JSON string literal.
+    void write_json_string(std::ostream &out, const char *text) {
+        out << '"';
+        for (const char *c = text; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\')
+                out << '\\';
+            out << *c;
+        }
+        out << '"';
+    }
+}
+
+std::atomic<bool> Profiler::enabled{false};
+const std::chrono::steady_clock::time_point Profiler::epoch = std::chrono::steady_clock::now();
+
+void Profiler::enable() {
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::disable() {
+    enabled.store(false, std::memory_order_relaxed);
+}
+
+void Profiler::clear() {
+    // Buffers of exited threads are freed, live threads keep theirs
+    std::lock_guard lock(thread_buffers_mutex());
+    auto &buffers = thread_buffers();
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](const auto &buffer) {
+        return !buffer->in_use;
+    }), buffers.end());
+    for (const auto &buffer: buffers)
+        buffer->events.clear();
+}
+
+void Profiler::record(const char *name, const int64_t argument, const int64_t start, const int64_t end) {
+    local_buffer().events.push_back({name, argument, start, end - start});
+}
+
+size_t Profiler::get_buffer_count() {
+    std::lock_guard lock(thread_buffers_mutex());
+    return thread_buffers().size();
+}
+
+size_t Profiler::get_event_count() {
+    std::lock_guard lock(thread_buffers_mutex());
+    size_t count = 0;
+    for (const auto &buffer: thread_buffers())
+        count += buffer->events.size();
+    return count;
+}
+
+void Profiler::writeChromeTrace(const std::string &filename) {
+    // Ensure the filename is not empty
+    if (filename.empty())
+        throw ProfilerException("Profiler::writeChromeTrace(): empty filename");
+
+    std::ofstream file(filename);
+    if (!file.is_open())
+        throw ProfilerException("Profiler::writeChromeTrace(): cannot open " + filename);
+
+    // Chrome trace-event format, complete ("X") events with microsecond timestamps
+    std::lock_guard lock(thread_buffers_mutex());
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+
+    for (const auto &buffer: thread_buffers()) {
+        for (const auto &event: buffer->events) {
+            if (!first)
+                file << ",\n";
+            first = false;
+
+            file << "{\"name\": ";
+            write_json_string(file, event.name);
+            file << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->thread_id
+                    << ", \"ts\": " << static_cast<double>(event.start) / 1000.0
+                    << ", \"dur\": " << static_cast<double>(event.duration) / 1000.0;
+            if (event.argument >= 0)
+                file << ", \"args\": {\"index\": " << event.argument << "}";
+            file << "}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    if (!file.good())
+        throw ProfilerException("Profiler::writeChromeTrace(): system error writing " + filename);
+}
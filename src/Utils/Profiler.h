@@ -0,0 +1,155 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <Utils/Headers.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Lightweight wall-clock profiler that records scoped timing zones and exports them as Chrome trace-event JSON.
+ * Every thread appends to its own buffer, so recording never takes a lock. The trace can be opened in Perfetto
+ * (ui.perfetto.dev) or about:tracing.
+ *
+ * Zones are declared with BLUNDER_PROFILE_ZONE(name). When BLUNDER_PROFILING is not defined the macros expand to
+ * nothing. When it is defined, a zone costs one relaxed atomic load until Profiler::enable() is called.
+ */
+class Profiler {
+public:
+    /// A completed timing zone.
+    struct Event {
+        /// Name of the zone, must have static storage duration (a string literal).
+        const char *name;
+
+        /// Optional integer argument shown with the zone (row, tile index, ...), -1 if unused.
+        int64_t argument;
+
+        /// Start time, in nanoseconds since the profiler epoch.
+        int64_t start;
+
+        /// Duration, in nanoseconds.
+        int64_t duration;
+    };
+
+    /**
+     * Starts recording zones.
+     *
+     * @note Test Cases:\n
+     * Profiler::enable() -> Profiler::is_enabled() should be true\n
+     */
+    static void enable();
+
+    /**
+     * Stops recording zones. Already recorded events are kept.
+     *
+     * @note Test Cases:\n
+     * Profiler::disable() -> Profiler::is_enabled() should be false\n
+     */
+    static void disable();
+
+    /// Gets whether zones are currently being recorded.
+    static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * Discards every recorded event and frees the buffers of threads that have exited.
+     *
+     * @note Test Cases:\n
+     * Profiler::clear() -> Profiler::get_event_count() should be 0\n
+     */
+    static void clear();
+
+    /**
+     * Records a completed zone on the calling thread's buffer.
+     * @param name Name of the zone, must be a string literal.
+     * @param argument Optional integer argument, -1 if unused.
+     * @param start Start time from now().
+     * @param end End time from now().
+     */
+    static void record(const char *name, int64_t argument, int64_t start, int64_t end);
+
+    /// Gets the current time, in nanoseconds since the profiler epoch.
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    /**
+     * Gets the number of per-thread buffers. A thread that exits hands its buffer, events included, to the next thread
+     * that records, so the count is bounded by the threads alive at once rather than growing per render.
+     *
+     * @note Test Cases:\n
+     * recording on many short-lived threads one after another -> Profiler::get_buffer_count() grows by at most 1\n
+     */
+    static size_t get_buffer_count();
+
+    /// Gets the number of events recorded over all threads.
+    static size_t get_event_count();
+
+    /**
+     * Writes every recorded event as Chrome trace-event JSON.
+     * Should be called once worker threads have finished.
+     * @param filename Name of the JSON file to write.
+     *
+     * @note Test Cases:\n
+     * Profiler::writeChromeTrace("trace.json") -> writes {"traceEvents": [...]} with one complete ("X") event per zone\n
+     * Profiler::writeChromeTrace("") -> ERROR: will throw a ProfilerException (filename must be provided)\n
+     */
+    static void writeChromeTrace(const std::string &filename);
+
+private:
+    /// Whether zones are being recorded.
+    static std::atomic<bool> enabled;
+
+    /// Time all events are measured from.
+    static const std::chrono::steady_clock::time_point epoch;
+};
+
+/**
+ * Scoped timing zone, records the time between construction and destruction.
+ * Use through BLUNDER_PROFILE_ZONE rather than directly so it compiles out.
+ */
+class ProfileZone {
+    /// Name of the zone.
+    const char *name;
+
+    /// Optional integer argument, -1 if unused.
+    int64_t argument;
+
+    /// Start time, negative when the profiler was disabled on entry.
+    int64_t start;
+
+public:
+    /**
+     * Opens a zone.
+     * @param name Name of the zone, must be a string literal.
+     * @param argument Optional integer argument, -1 if unused.
+     */
+    explicit ProfileZone(const char *name, const int64_t argument = -1)
+        : name(name), argument(argument), start(Profiler::is_enabled() ? Profiler::now() : -1) {
+    }
+
+    /// Closes the zone and records it.
+    ~ProfileZone() {
+        if (start >= 0)
+            Profiler::record(name, argument, start, Profiler::now());
+    }
+
+    ProfileZone(const ProfileZone &) = delete;
+
+    ProfileZone &operator=(const ProfileZone &) = delete;
+};
+
+#define BLUNDER_PROFILE_CONCAT_INNER(a, b) a##b
+#define BLUNDER_PROFILE_CONCAT(a, b) BLUNDER_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef BLUNDER_PROFILING
+/// Times the rest of the enclosing scope under name.
+#define BLUNDER_PROFILE_ZONE(name) const ProfileZone BLUNDER_PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+/// Times the rest of the enclosing scope under name, tagged with an integer argument.
+#define BLUNDER_PROFILE_ZONE_ARG(name, argument) \
+    const ProfileZone BLUNDER_PROFILE_CONCAT(profile_zone_, __LINE__)(name, argument)
+#else
+#define BLUNDER_PROFILE_ZONE(name)
+#define BLUNDER_PROFILE_ZONE_ARG(name, argument)
+#endif
+
+#endif //PROFILER_H
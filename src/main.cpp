@@ -1,17 +1,92 @@
 // Includes
 #include "Utils/Importer.h"
+#include "Utils/Profiler.h"
 
 // Main method
 int main(const int argc, char *argv[]) {
-    if (argc != 3)
-        throw ImporterException("Must pass an input file and specify an output file!");
+    try {
+        std::vector<std::string> files;
+        PostProcess postProcess;
+        RT_TILING tiling;
+        RT_CROP crop;
+        std::string compositeFile;
+        bool watch = false;
+        std::string profileFile;
+        std::string costMapName;
+        PixelStorage storage = PixelStorage::Float;
+        RT_IRRADIANCE_CACHE irradianceCache;
+        RT_PATH_GUIDING pathGuiding;
 
-    const std::string inputFile = argv[1];
-    const std::string outputFile = argv[2];
+        // Parse options, everything else is a positional file name
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
 
-    try {
-        Importer::RenderFile(inputFile, outputFile);
-    } catch (ImporterException &e) {
+            if (arg == "--exposure" && hasValue)
+                postProcess.set_exposure(PostProcess::parseExposure(argv[++i]));
+            else if (arg == "--tone-mapping" && hasValue)
+                postProcess.set_tone_mapping(PostProcess::parseToneMapping(argv[++i]));
+            else if (arg == "--transfer" && hasValue)
+                postProcess.set_transfer_function(PostProcess::parseTransferFunction(argv[++i]));
+            else if (arg == "--tile-size" && hasValue)
+                Tiling::parseTileSize(argv[++i], tiling);
+            else if (arg == "--tile-order" && hasValue)
+                tiling.order = Tiling::parseTileOrder(argv[++i]);
+            else if (arg == "--crop" && hasValue)
+                crop = Renderer::parseCrop(argv[++i]);
+            else if (arg == "--composite" && hasValue)
+                compositeFile = argv[++i];
+            else if (arg == "--watch")
+                watch = true;
+            else if (arg == "--profile" && hasValue)
+                profileFile = argv[++i];
+            else if (arg == "--cost-map" && hasValue)
+                costMapName = argv[++i];
+            else if (arg == "--storage" && hasValue)
+                storage = RenderTarget::parsePixelStorage(argv[++i]);
+            else if (arg == "--irradiance-cache")
+                irradianceCache.enabled = true;
+            else if (arg == "--path-guiding")
+                pathGuiding.enabled = true;
+            else if (arg.rfind("--", 0) == 0)
+                throw ImporterException("Unknown or incomplete option " + arg);
+            else
+                files.push_back(arg);
+        }
+
+        if (files.size() != 2)
+            throw ImporterException(
+                "Must pass an input file and specify an output file!\n"
+                "Usage: Blunder <scene.blunder> <image.ppm> [--exposure <value>] "
+                "[--tone-mapping clamp|reinhard|aces] [--transfer gamma2|srgb]\n"
+                "       [--tile-size auto|<width>x<height>] [--tile-order hilbert|morton|rowmajor]\n"
+                "       [--crop <x>,<y>,<width>,<height>] [--composite <image.ppm|image.pfm>]\n"
+                "       [--watch] [--profile <trace.json>] [--cost-map <name>]\n"
+                "       [--storage float|half|rgb9e5] [--irradiance-cache] [--path-guiding]");
+
+#ifdef BLUNDER_PROFILING
+        if (!profileFile.empty())
+            Profiler::enable();
+#else
+        if (!profileFile.empty())
+            std::cerr << "WARNING: profiling was compiled out (BLUNDER_PROFILING), no trace will be written" << std::endl;
+#endif
+
+        if (watch && !costMapName.empty())
+            std::cerr << "WARNING: --cost-map is not used with --watch, no cost map will be written" << std::endl;
+
+        if (watch)
+            Importer::WatchFile(files[0], files[1], postProcess, tiling, crop, compositeFile, storage, irradianceCache,
+                                pathGuiding);
+        else
+            Importer::RenderFile(files[0], files[1], postProcess, tiling, crop, compositeFile, costMapName, storage,
+                                 irradianceCache, pathGuiding);
+
+#ifdef BLUNDER_PROFILING
+        if (!profileFile.empty())
+            Profiler::writeChromeTrace(profileFile);
+#endif
+    } catch (BaseException &e) {
         std::cerr << e.what() << std::endl;
     } catch (...) {
         std::cerr << "ERROR: Unexpected exception. Stop." << std::endl;
@@ -0,0 +1,144 @@
+#include <Utils/Headers.h>
+#include <Utils/Arena.h>
+#include <Geometry/Sphere.h>
+#include <Geometry/SphereGroup.h>
+#include <cstring>
+
+namespace BlunderTest {
+    static void TestArenaAllocate() {
+        std::cout << "\t[Arena] Testing allocate..." << std::endl;
+        auto arena = Arena(Arena::HUGE_PAGE_SIZE, HugePages::Off);
+        assert(arena.get_block_count() == 0);
+        assert(arena.get_used() == 0);
+
+        // Allocations are aligned and follow each other
+        auto *a = static_cast<unsigned char *>(arena.allocate(3, 1));
+        auto *b = static_cast<unsigned char *>(arena.allocate(16, 16));
+        auto *c = static_cast<unsigned char *>(arena.allocate(8, 8));
+        assert(reinterpret_cast<uintptr_t>(b) % 16 == 0);
+        assert(reinterpret_cast<uintptr_t>(c) % 8 == 0);
+        assert(b - a == 16);
+        assert(c == b + 16);
+        assert(arena.get_block_count() == 1);
+        assert(arena.get_used() == 40);
+        assert(arena.get_reserved() == Arena::HUGE_PAGE_SIZE);
+
+        // Memory is usable
+        std::memset(a, 1, Arena::HUGE_PAGE_SIZE - 40);
+        assert(a[100] == 1);
+
+        // A full block starts the next one, twice as large
+        arena.allocate(Arena::HUGE_PAGE_SIZE - 40, 1);
+        assert(arena.get_block_count() == 1);
+        arena.allocate(1, 1);
+        assert(arena.get_block_count() == 2);
+        assert(arena.get_reserved() == 3 * Arena::HUGE_PAGE_SIZE);
+
+        // Allocations larger than a block get one of their own
+        auto *large = static_cast<unsigned char *>(arena.allocate(Arena::MAX_BLOCK_SIZE + 1, 64));
+        assert(reinterpret_cast<uintptr_t>(large) % 64 == 0);
+        large[Arena::MAX_BLOCK_SIZE] = 1;
+        assert(arena.get_block_count() == 3);
+        assert(arena.get_reserved() >= 3 * Arena::HUGE_PAGE_SIZE + Arena::MAX_BLOCK_SIZE + 1);
+        assert(!arena.has_huge_pages());
+
+        try {
+            arena.allocate(8, 3);
+            assert(false);
+        } catch (ArenaException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            arena.allocate(8, 0);
+            assert(false);
+        } catch (ArenaException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestArenaConstructor() {
+        std::cout << "\t[Arena] Testing constructor..." << std::endl;
+
+        // Block sizes are rounded to huge pages, explicit huge pages fall back when none are reserved
+        auto arena = Arena(1, HugePages::Explicit);
+        arena.allocate(1, 1);
+        assert(arena.get_reserved() == Arena::HUGE_PAGE_SIZE);
+
+        try {
+            auto empty = Arena(0);
+            assert(false);
+        } catch (ArenaException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestArenaAllocator() {
+        std::cout << "\t[Arena] Testing ArenaAllocator..." << std::endl;
+        auto arena = make_shared<Arena>();
+        const auto allocator = ArenaAllocator<Sphere>(arena);
+
+        // Spheres keep their arena alive after the last other reference is gone
+        auto sphere = std::allocate_shared<Sphere>(allocator, vec3(1, 2, 3), 4.0f, Color(1, 0, 0));
+        assert(arena.use_count() > 1);
+        assert(arena->get_used() > sizeof(Sphere));
+        arena.reset();
+        assert(sphere->get_radius() == 4.0f);
+        assert(sphere->get_position() == vec3(1, 2, 3));
+
+        // Containers work on top of it
+        auto vectorArena = make_shared<Arena>();
+        std::vector<int, ArenaAllocator<int> > values{ArenaAllocator<int>(vectorArena)};
+        for (int i = 0; i < 1000; i++)
+            values.push_back(i);
+        assert(values[999] == 999);
+        assert(values.get_allocator() == ArenaAllocator<Sphere>(vectorArena));
+
+        // Copies go to the heap, moves keep the arena
+        const size_t used = vectorArena->get_used();
+        const auto copy = values;
+        assert(copy[999] == 999 && copy.get_allocator().get_arena() == nullptr);
+        assert(vectorArena->get_used() == used);
+        const auto moved = std::move(values);
+        assert(moved.get_allocator().get_arena() == vectorArena);
+
+        // Without an arena it is the heap
+        ArenaVector<int> heap;
+        for (int i = 0; i < 1000; i++)
+            heap.push_back(i);
+        assert(heap[999] == 999 && heap.get_allocator() == ArenaAllocator<int>(nullptr));
+    }
+
+    static void TestArenaSphereGroup() {
+        std::cout << "\t[Arena] Testing SphereGroup in an arena..." << std::endl;
+        SphereList list;
+        for (int i = 0; i < 1000; i++)
+            list.Add(make_shared<Sphere>(vec3(static_cast<float>(i), 0, -10), 0.5f, Color(1, 0, 0)));
+
+        // The packed spheres and nodes fit the size the group asks for, and trace like a heap group
+        const auto arena = make_shared<Arena>(SphereGroup::ArenaSize(list.size()));
+        const SphereGroup group(list, arena);
+        const SphereGroup heap(list);
+        assert(arena->get_used() > 0 && arena->get_used() <= SphereGroup::ArenaSize(list.size()));
+        assert(arena->get_block_count() == 1);
+
+        HitRecord record, heapRecord;
+        const Ray ray(vec3(420, 0, 0), vec3(0, 0, -1));
+        assert(group.Hit(ray, 0.001f, 1000, record) && heap.Hit(ray, 0.001f, 1000, heapRecord));
+        assert(record.get_t() == heapRecord.get_t() && record.get_point() == heapRecord.get_point());
+    }
+
+    static void TestArenaAll() {
+        std::cout << "[Unit Test] Testing Arena..." << std::endl;
+        TestArenaConstructor();
+        TestArenaAllocate();
+        TestArenaAllocator();
+        TestArenaSphereGroup();
+    }
+}
@@ -0,0 +1,146 @@
+#include <Utils/Headers.h>
+#include <Renderer/CostMap.h>
+#include <Renderer/RenderTarget.h>
+#include <filesystem>
+#include <fstream>
+
+namespace BlunderTest {
+    static void TestCostMapConstructor() {
+        std::cout << "\t[CostMap] Testing constructor..." << std::endl;
+        auto map = CostMap(6, 4);
+        assert(map.get_width() == 6);
+        assert(map.get_height() == 4);
+        for (int channel = 0; channel < CostMap::CHANNELS; channel++)
+            assert(map.get_max(static_cast<CostChannel>(channel)) == 0);
+
+        try {
+            auto empty = CostMap(0, 4);
+            assert(false);
+        } catch (CostMapException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto negative = CostMap(6, -1);
+            assert(false);
+        } catch (CostMapException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestCostMapSetCost() {
+        std::cout << "\t[CostMap] Testing set_cost and set_tile_time..." << std::endl;
+        auto map = CostMap(6, 4);
+        map.set_cost(1, 2, {50, 10, 3});
+        assert(map.get_value(1, 2, CostChannel::IntersectionTests) == 50);
+        assert(map.get_value(1, 2, CostChannel::TraversalSteps) == 10);
+        assert(map.get_value(1, 2, CostChannel::Bounces) == 3);
+        assert(map.get_value(1, 2, CostChannel::TileTime) == 0);
+        assert(map.get_value(2, 1, CostChannel::IntersectionTests) == 0);
+        assert(map.get_max(CostChannel::IntersectionTests) == 50);
+
+        map.set_tile_time({2, 0, 4, 2}, 1500);
+        assert(map.get_value(2, 0, CostChannel::TileTime) == 1500);
+        assert(map.get_value(5, 1, CostChannel::TileTime) == 1500);
+        assert(map.get_value(1, 0, CostChannel::TileTime) == 0);
+        assert(map.get_value(2, 2, CostChannel::TileTime) == 0);
+        assert(map.get_value(1, 2, CostChannel::IntersectionTests) == 50);
+
+        try {
+            map.set_cost(6, 0, {});
+            assert(false);
+        } catch (CostMapException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            map.set_tile_time({4, 0, 4, 2}, 1500);
+            assert(false);
+        } catch (CostMapException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            static_cast<void>(map.get_value(0, -1, CostChannel::Bounces));
+            assert(false);
+        } catch (CostMapException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestCostMapFalseColor() {
+        std::cout << "\t[CostMap] Testing falseColor..." << std::endl;
+        assert(CostMap::falseColor(0).get_color() == vec3(0));
+        assert(CostMap::falseColor(1).get_color() == vec3(1));
+        assert(CostMap::falseColor(-1).get_color() == vec3(0));
+        assert(CostMap::falseColor(2).get_color() == vec3(1));
+
+        // Brighter with cost
+        float previous = -1;
+        for (int i = 0; i <= 20; i++) {
+            const vec3 color = CostMap::falseColor(static_cast<float>(i) / 20).get_color();
+            const float luminance = dot(color, vec3(0.2126f, 0.7152f, 0.0722f));
+            assert(luminance > previous);
+            previous = luminance;
+        }
+    }
+
+    static void TestCostMapWrite() {
+        std::cout << "\t[CostMap] Testing writeFalseColor and writeRaw..." << std::endl;
+        auto map = CostMap(6, 4);
+        map.set_cost(5, 3, {8, 2, 1});
+        map.set_tile_time({0, 0, 6, 4}, 250);
+
+        map.writeRaw("cost.raw");
+        assert(std::filesystem::file_size("cost.raw") == 6 * 4 * CostMap::CHANNELS * sizeof(float));
+        std::vector<float> raw(6 * 4 * CostMap::CHANNELS);
+        std::ifstream("cost.raw", std::ios::binary).read(reinterpret_cast<char *>(raw.data()),
+                                                         static_cast<std::streamsize>(raw.size() * sizeof(float)));
+        assert(std::equal(raw.begin(), raw.end(), map.get_data()));
+        assert(raw[(3 * 6 + 5) * CostMap::CHANNELS] == 8);
+        assert(raw[CostMap::CHANNELS - 1] == 250);
+
+        // The most expensive pixel is white, pixels without cost black
+        map.writeFalseColor("cost_tests.ppm", CostChannel::IntersectionTests);
+        auto image = RenderTarget::readFromPPM("cost_tests.ppm");
+        assert(image->get_width() == 6 && image->get_height() == 4);
+        assert(length(image->get_pixel(5, 3).get_color() - vec3(1)) < 0.01f);
+        assert(length(image->get_pixel(0, 0).get_color()) < 0.01f);
+
+        try {
+            map.writeFalseColor("", CostChannel::Bounces);
+            assert(false);
+        } catch (CostMapException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            map.writeRaw("");
+            assert(false);
+        } catch (CostMapException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestCostMapAll() {
+        std::cout << "[Unit Test] Testing CostMap..." << std::endl;
+        TestCostMapConstructor();
+        TestCostMapSetCost();
+        TestCostMapFalseColor();
+        TestCostMapWrite();
+    }
+}
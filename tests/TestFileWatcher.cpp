@@ -0,0 +1,61 @@
+#include <Utils/Headers.h>
+#include <Utils/FileWatcher.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace BlunderTest {
+    static void TestFileWatcherWait() {
+        std::cout << "\t[FileWatcher] Testing wait..." << std::endl;
+        std::ofstream("watched.blunder") << "#BLUNDER\n";
+
+        auto watcher = FileWatcher("watched.blunder");
+        bool changed = watcher.wait(0);
+        assert(!changed);
+
+        // Modification times can be coarse, make sure the write lands on a later tick
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::ofstream("watched.blunder") << "#BLUNDER\n#SETTINGS\n";
+        changed = watcher.wait(2000);
+        assert(changed);
+        changed = watcher.wait(0);
+        assert(!changed);
+
+        // Other files in the same directory are ignored
+        std::ofstream("unwatched.blunder") << "#BLUNDER\n";
+        changed = watcher.wait(50);
+        assert(!changed);
+
+        std::remove("watched.blunder");
+        std::remove("unwatched.blunder");
+    }
+
+    static void TestFileWatcherConstructor() {
+        std::cout << "\t[FileWatcher] Testing constructor..." << std::endl;
+
+        try {
+            auto watcher = FileWatcher("");
+            assert(false);
+        } catch (FileWatcherException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto watcher = FileWatcher("missing_dir/scene.blunder");
+            assert(false);
+        } catch (FileWatcherException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestFileWatcherAll() {
+        std::cout << "[Unit Test] Testing FileWatcher..." << std::endl;
+        TestFileWatcherConstructor();
+        TestFileWatcherWait();
+    }
+}
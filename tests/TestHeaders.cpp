@@ -111,6 +111,19 @@ namespace BlunderTest {
         assert(0 <= rand_float && rand_float <= 1);
     }
 
+    static void TestHeadersSeedRandom() {
+        std::cout << "\t[Headers] Testing seed_random() and mix_seed()..." << std::endl;
+        seed_random(7);
+        const float first = random_float(), second = random_float();
+        seed_random(8);
+        assert(random_float() != first);
+        seed_random(7);
+        assert(random_float() == first && random_float() == second);
+
+        assert(mix_seed(1, 2) == mix_seed(1, 2));
+        assert(mix_seed(1, 2) != mix_seed(1, 3) && mix_seed(1, 2) != mix_seed(2, 2));
+    }
+
     static void TestHeadersRandomFloatFloat() {
         std::cout << "\t[Headers] Testing random_float(float)..." << std::endl;
         auto rand_float = random_float(0, 1);
@@ -175,6 +188,86 @@ namespace BlunderTest {
         assert(is_near_zero(length(random_unit) - 1.0f));
     }
 
+    static void TestHeadersRandomUnitVectors() {
+        std::cout << "\t[Headers] Testing random_unit_vectors()..." << std::endl;
+        constexpr int count = 1000;
+        std::vector<float> x(count), y(count), z(count);
+        random_unit_vectors(count, x.data(), y.data(), z.data());
+
+        vec3 mean(0);
+        for (int i = 0; i < count; i++) {
+            assert(std::fabs(length(vec3(x[i], y[i], z[i])) - 1.0f) <= 1e-5f);
+            mean += vec3(x[i], y[i], z[i]) / static_cast<float>(count);
+        }
+        assert(length(mean) < 0.15f);
+
+        // Every octant should be reached
+        bool octants[8] = {};
+        for (int i = 0; i < count; i++)
+            octants[(x[i] < 0) + 2 * (y[i] < 0) + 4 * (z[i] < 0)] = true;
+        for (const bool octant: octants)
+            assert(octant);
+
+        random_unit_vectors(0, nullptr, nullptr, nullptr);
+
+        try {
+            random_unit_vectors(-1, x.data(), y.data(), z.data());
+            assert(false);
+        } catch (HeaderException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            random_unit_vectors(10, nullptr, y.data(), z.data());
+            assert(false);
+        } catch (HeaderException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestHeadersRandomHemisphereVectors() {
+        std::cout << "\t[Headers] Testing random_hemisphere_vectors()..." << std::endl;
+        constexpr int count = 1000;
+        std::vector<float> normal_x(count), normal_y(count), normal_z(count), x(count), y(count), z(count);
+        for (int i = 0; i < count; i++) {
+            const vec3 normal = random_unit_vector();
+            normal_x[i] = normal.x;
+            normal_y[i] = normal.y;
+            normal_z[i] = normal.z;
+        }
+        random_hemisphere_vectors(count, normal_x.data(), normal_y.data(), normal_z.data(), x.data(), y.data(),
+                                  z.data());
+
+        for (int i = 0; i < count; i++) {
+            const vec3 direction(x[i], y[i], z[i]);
+            assert(std::fabs(length(direction) - 1.0f) <= 1e-5f);
+            assert(dot(direction, vec3(normal_x[i], normal_y[i], normal_z[i])) >= 0);
+        }
+
+        try {
+            random_hemisphere_vectors(-1, normal_x.data(), normal_y.data(), normal_z.data(), x.data(), y.data(),
+                                      z.data());
+            assert(false);
+        } catch (HeaderException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            random_hemisphere_vectors(10, nullptr, normal_y.data(), normal_z.data(), x.data(), y.data(), z.data());
+            assert(false);
+        } catch (HeaderException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
     static void TestHeadersSampleSquare() {
         std::cout << "\t[Headers] Testing sample_square()..." << std::endl;
         auto sample = sampleSquare();
@@ -183,6 +276,39 @@ namespace BlunderTest {
         assert(sample.z == 0);
     }
 
+    static void TestHeadersParallelFor() {
+        std::cout << "\t[Headers] Testing parallel_for()..." << std::endl;
+        std::vector<int> visits(1000, 0);
+        parallel_for(1000, [&](const int begin, const int end) {
+            for (int i = begin; i < end; i++)
+                visits[i]++;
+        });
+        for (const auto visit: visits)
+            assert(visit == 1);
+
+        bool called = false;
+        parallel_for(0, [&](int, int) { called = true; });
+        assert(!called);
+
+        try {
+            parallel_for(-1, [](int, int) {});
+            assert(false);
+        } catch (HeaderException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            parallel_for(100, [](int, int) { throw HeaderException("range failed"); });
+            assert(false);
+        } catch (HeaderException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
     static void TestHeadersAll() {
         std::cout << "[Unit Testing] Testing Headers..." << std::endl;
         TestHeadersIsFiniteFloat();
@@ -195,10 +321,14 @@ namespace BlunderTest {
         TestHeadersLinearToGamma();
         TestHeadersDegreesToRadians();
         TestHeadersRandomFloatNoArgs();
+        TestHeadersSeedRandom();
         TestHeadersRandomFloatFloat();
         TestHeadersRandomVec3NoArgs();
         TestHeadersRandomVec3Float();
         TestHeadersRandomUnitVector();
+        TestHeadersRandomUnitVectors();
+        TestHeadersRandomHemisphereVectors();
         TestHeadersSampleSquare();
+        TestHeadersParallelFor();
     }
 }
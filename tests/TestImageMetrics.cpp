@@ -0,0 +1,85 @@
+#include <Utils/Headers.h>
+#include <Renderer/ImageMetrics.h>
+
+namespace BlunderTest {
+    static void TestImageMetricsRmse() {
+        std::cout << "\t[ImageMetrics] Testing rmse..." << std::endl;
+        auto black = RenderTarget(16, 16);
+        auto white = RenderTarget(16, 16);
+        for (int y = 0; y < 16; y++)
+            for (int x = 0; x < 16; x++)
+                white.set_pixel(x, y, Color(1, 1, 1));
+
+        assert(ImageMetrics::rmse(black, black) == 0);
+        assert(is_near_zero(ImageMetrics::rmse(black, white) - 1.0f));
+
+        try {
+            auto small = RenderTarget(8, 8);
+            auto error = ImageMetrics::rmse(black, small);
+            assert(false);
+        } catch (ImageMetricsException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestImageMetricsPsnr() {
+        std::cout << "\t[ImageMetrics] Testing psnr..." << std::endl;
+        auto black = RenderTarget(16, 16);
+        auto gray = RenderTarget(16, 16);
+        for (int y = 0; y < 16; y++)
+            for (int x = 0; x < 16; x++)
+                gray.set_pixel(x, y, Color(0.1, 0.1, 0.1));
+
+        assert(ImageMetrics::psnr(black, black) == 100);
+        assert(std::fabs(ImageMetrics::psnr(black, gray) - 20.0f) < 1e-3f);
+
+        try {
+            auto small = RenderTarget(8, 8);
+            auto error = ImageMetrics::psnr(black, small);
+            assert(false);
+        } catch (ImageMetricsException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestImageMetricsFlip() {
+        std::cout << "\t[ImageMetrics] Testing flip..." << std::endl;
+        auto black = RenderTarget(16, 16);
+        auto white = RenderTarget(16, 16);
+        auto speckled = RenderTarget(16, 16);
+        for (int y = 0; y < 16; y++) {
+            for (int x = 0; x < 16; x++) {
+                white.set_pixel(x, y, Color(1, 1, 1));
+                if ((x + y) % 7 == 0)
+                    speckled.set_pixel(x, y, Color(0.5, 0.5, 0.5));
+            }
+        }
+
+        assert(ImageMetrics::flip(black, black) == 0);
+        const auto large = ImageMetrics::flip(black, white);
+        const auto small = ImageMetrics::flip(black, speckled);
+        assert(large > 0.9f && large <= 1.0f);
+        assert(small > 0 && small < large);
+
+        try {
+            auto tiny = RenderTarget(8, 8);
+            auto error = ImageMetrics::flip(black, tiny);
+            assert(false);
+        } catch (ImageMetricsException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestImageMetricsAll() {
+        std::cout << "[Unit Test] Testing ImageMetrics..." << std::endl;
+        TestImageMetricsRmse();
+        TestImageMetricsPsnr();
+        TestImageMetricsFlip();
+    }
+}
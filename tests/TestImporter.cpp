@@ -1,5 +1,7 @@
 #include <Utils/Headers.h>
 #include <Utils/Importer.h>
+#include <cstdio>
+#include <fstream>
 
 namespace BlunderTest {
     static void TestImporterRenderFile() {
@@ -28,8 +30,181 @@ namespace BlunderTest {
         }
     }
 
+    /// Writes a small scene file, with settings_extra appended to its #SETTINGS section.
+    static void WriteCropScene(const std::string &fileName, const std::string &settings_extra) {
+        std::ofstream file(fileName);
+        file << "#BLUNDER\n\n#SETTINGS\nscreen_width 8\nscreen_height 6\nsamples 2\nbounces 2\n" << settings_extra
+                << "\n#CAMERA\nposition 0 -10 5\nlook_at 0 0 0\nfov 25\nup_direction 0 0 1\n"
+                << "\n#COLORS\nred 1 0 0\n\n#SPHERES\n0 0 0 red 1\n";
+    }
+
+    static void TestImporterCrop() {
+        std::cout << "\t[Importer] Testing crop setting and composite..." << std::endl;
+        WriteCropScene("crop_scene.blunder", "crop 2 1 3 2\n");
+
+        const Scene scene = Importer::LoadScene("crop_scene.blunder");
+        assert(scene.crop.x == 2 && scene.crop.y == 1 && scene.crop.width == 3 && scene.crop.height == 2);
+
+        // A full-frame crop overrides the scene's window, then the cropped render is composited over it
+        Importer::RenderFile("crop_scene.blunder", "crop_full.ppm", PostProcess(), RT_TILING(), {0, 0, 8, 6});
+        Importer::RenderFile("crop_scene.blunder", "crop_part.ppm", PostProcess(), RT_TILING(), RT_CROP(),
+                             "crop_full.ppm");
+
+        const auto full = RenderTarget::readFromPPM("crop_full.ppm");
+        const auto part = RenderTarget::readFromPPM("crop_part.ppm");
+        for (int y = 0; y < 6; y++)
+            for (int x = 0; x < 8; x++)
+                if (x < 2 || x >= 5 || y < 1 || y >= 3)
+                    assert(part->get_radiance(x, y) == full->get_radiance(x, y));
+
+        try {
+            WriteCropScene("crop_bad.blunder", "crop 6 0 4 4\n");
+            Importer::LoadScene("crop_bad.blunder");
+            assert(false);
+        } catch (ImporterException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            WriteCropScene("crop_bad.blunder", "crop 1 2\n");
+            Importer::LoadScene("crop_bad.blunder");
+            assert(false);
+        } catch (ImporterException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            RenderTarget(3, 3).writeToFile("crop_small.ppm");
+            Importer::RenderFile("crop_scene.blunder", "crop_part.ppm", PostProcess(), RT_TILING(), RT_CROP(),
+                                 "crop_small.ppm");
+            assert(false);
+        } catch (ImporterException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestImporterLoadSceneSpheres() {
+        std::cout << "\t[Importer] Testing parallel sphere parsing..." << std::endl;
+        // Enough spheres to be split into several chunks, header lines 1-15 and spheres from line 16
+        const std::string header = "#BLUNDER\n#SETTINGS\nscreen_width 8\nscreen_height 6\nsamples 2\nbounces 2\n"
+                "#CAMERA\nposition 0 -10 5\nlook_at 0 0 0\nfov 25\nup_direction 0 0 1\n#COLORS\nred 1 0 0\n"
+                "blue 0 0 1\n#SPHERES\n";
+        const auto write = [&](const int count, const int badIndex, const std::string &bad) {
+            std::ofstream file("parse_scene.blunder");
+            file << header;
+            for (int i = 0; i < count; i++) {
+                if (i == badIndex)
+                    file << bad << "\n";
+                else
+                    file << i << " 0.5 -2.25 " << (i % 2 ? "red" : "blue") << " 0.75\n";
+                if (i % 1000 == 999)
+                    file << "\n";
+            }
+        };
+
+        write(40000, -1, "");
+        const Scene scene = Importer::LoadScene("parse_scene.blunder");
+        assert(scene.spheres->size() == 40000);
+        for (int i = 0; i < 40000; i++) {
+            const auto &sphere = scene.spheres->get_spheres()[i];
+            assert(sphere->get_position() == vec3(static_cast<float>(i), 0.5f, -2.25f));
+            assert(sphere->get_radius() == 0.75f);
+            assert(sphere->get_color().get_color() == (i % 2 ? vec3(1, 0, 0) : vec3(0, 0, 1)));
+        }
+
+        // Errors name the line in the file, counting the blank line after every thousand spheres
+        for (const auto &[bad, message]: {
+                 std::pair{"1 2 three red 1", "invalid sphere definition on line 35051"},
+                 std::pair{"1 2 3 green 1", "undefined color used in sphere on line 35051"},
+                 std::pair{"1 2 3 red -1", "on line 35051"}
+             }) {
+            try {
+                write(40000, 35000, bad);
+                Importer::LoadScene("parse_scene.blunder");
+                assert(false);
+            } catch (ImporterException &e) {
+                assert(std::string(e.what()).find(message) != std::string::npos);
+            } catch (...) {
+                assert(false);
+            }
+        }
+
+        // A '#SPHERES' line without a trailing newline is an empty section
+        {
+            std::ofstream file("parse_scene.blunder");
+            file << header.substr(0, header.size() - 1);
+        }
+        assert(Importer::LoadScene("parse_scene.blunder").spheres->size() == 0);
+
+        std::remove("parse_scene.blunder");
+    }
+
+    static void TestImporterUpdateScene() {
+        std::cout << "\t[Importer] Testing UpdateScene..." << std::endl;
+        const auto load = [](const std::string &spheres, const std::string &camera) {
+            std::ofstream("update_scene.blunder") << "#BLUNDER\n#SETTINGS\nscreen_width 8\nscreen_height 6\nsamples 2\n"
+                    << "bounces 2\n#CAMERA\nposition " << camera << "\nlook_at 0 0 0\nfov 25\nup_direction 0 0 1\n"
+                    << "#COLORS\nred 1 0 0\nblue 0 0 1\n#SPHERES\n" << spheres;
+            return Importer::LoadScene("update_scene.blunder");
+        };
+
+        Scene scene = load("0 0 0 red 1\n3 0 0 red 1\n", "0 -10 5");
+        const auto camera = scene.camera;
+        const auto spheres = scene.spheres;
+        const auto first = spheres->get_spheres()[0];
+        const auto accelerator = spheres->get_accelerator();
+
+        auto changes = Importer::UpdateScene(scene, load("0 0 0 red 1\n3 0 0 red 1\n", "0 -10 5"));
+        assert(!changes.any());
+
+        // Camera only, same camera object
+        changes = Importer::UpdateScene(scene, load("0 0 0 red 1\n3 0 0 red 1\n", "0 -12 5"));
+        assert(changes.camera && !changes.settings && changes.spheres_updated == 0 && !changes.spheres_rebuilt);
+        assert(scene.camera == camera && scene.camera->get_position() == vec3(0, -12, 5));
+
+        // Moved and recolored spheres are refit in place
+        changes = Importer::UpdateScene(scene, load("0 0 1 blue 1\n3 0 0 red 1\n", "0 -12 5"));
+        assert(!changes.camera && changes.spheres_updated == 1 && !changes.spheres_rebuilt);
+        assert(scene.spheres == spheres && spheres->get_spheres()[0] == first);
+        assert(first->get_position() == vec3(0, 0, 1) && first->get_color().get_color() == vec3(0, 0, 1));
+
+        // and the accelerator is refit to them, the group traced before the update is left alone
+        HitRecord record{};
+        const auto refit = spheres->get_accelerator();
+        assert(refit != accelerator && refit->get_hierarchy().size() == accelerator->get_hierarchy().size());
+        assert(refit->Hit(Ray(vec3(0, -5, 1), vec3(0, 1, 0)), 0.001, 1000, record));
+        assert(std::fabs(record.get_t() - 4) < 1e-4f && record.get_color().get_color() == vec3(0, 0, 1));
+        assert(accelerator->Hit(Ray(vec3(0, -5, 0), vec3(0, 1, 0)), 0.001, 1000, record));
+        assert(record.get_color().get_color() == vec3(1, 0, 0));
+
+        // Added spheres replace the list
+        changes = Importer::UpdateScene(scene, load("0 0 1 blue 1\n3 0 0 red 1\n6 0 0 red 1\n", "0 -12 5"));
+        assert(changes.spheres_rebuilt && scene.spheres != spheres && scene.spheres->size() == 3);
+
+        try {
+            Scene empty{};
+            Importer::UpdateScene(scene, empty);
+            assert(false);
+        } catch (ImporterException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        std::remove("update_scene.blunder");
+    }
+
     static void TestImporterAll() {
         std::cout << "[Unit Test] Testing Importer..." << std::endl;
         TestImporterRenderFile();
+        TestImporterCrop();
+        TestImporterLoadSceneSpheres();
+        TestImporterUpdateScene();
     }
 }
@@ -0,0 +1,173 @@
+#include <Utils/Headers.h>
+#include <Geometry/InstancedSphereList.h>
+
+namespace BlunderTest {
+    /// Rotation by angle radians around a unit axis, scaled evenly by scale.
+    static mat3 TestInstanceTransform(const vec3 &axis, const float angle, const float scale) {
+        const float c = std::cos(angle), s = std::sin(angle), t = 1 - c;
+        const mat3 rotation(vec3(t * axis.x * axis.x + c, t * axis.x * axis.y + s * axis.z,
+                                 t * axis.x * axis.z - s * axis.y),
+                            vec3(t * axis.x * axis.y - s * axis.z, t * axis.y * axis.y + c,
+                                 t * axis.y * axis.z + s * axis.x),
+                            vec3(t * axis.x * axis.z + s * axis.y, t * axis.y * axis.z - s * axis.x,
+                                 t * axis.z * axis.z + c));
+        return mat3(scale) * rotation;
+    }
+
+    static void TestInstancedSphereListBuild() {
+        std::cout << "\t[InstancedSphereList] Testing groups, instances and Build..." << std::endl;
+        SphereList list;
+        list.Add(make_shared<Sphere>(vec3(0), 1, Color(1, 0, 0)));
+        const auto group = make_shared<const SphereGroup>(list);
+
+        InstancedSphereList instances;
+        const uint32_t first = instances.AddGroup(group);
+        const uint32_t second = instances.AddGroup(group);
+        assert(first == 0 && second == 1);
+        assert(instances.is_built());
+        instances.AddInstance(0, mat3(1), vec3(5, 0, 0));
+        instances.AddInstance(1, mat3(2), vec3(-5, 0, 0));
+        assert(!instances.is_built());
+        assert(instances.size() == 2 && instances.get_group_count() == 2 && instances.get_sphere_count() == 2);
+
+        try {
+            HitRecord record{};
+            instances.Hit(Ray(vec3(0), vec3(1, 0, 0)), 0.001, 1000, record);
+            assert(false);
+        } catch (InstancedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        // Both copies are hit where their transforms place them, the second one twice as large
+        instances.Build();
+        HitRecord record{};
+        assert(instances.Hit(Ray(vec3(0), vec3(1, 0, 0)), 0.001, 1000, record));
+        assert(std::fabs(record.get_t() - 4) < 1e-4f && length(record.get_normal() - vec3(-1, 0, 0)) < 1e-4f);
+        assert(instances.Hit(Ray(vec3(0), vec3(-1, 0, 0)), 0.001, 1000, record));
+        assert(std::fabs(record.get_t() - 3) < 1e-4f && length(record.get_normal() - vec3(1, 0, 0)) < 1e-4f);
+        assert(record.get_color().get_color() == vec3(1, 0, 0));
+        const bool rawHit = instances.Hit(vec3(0), vec3(1, 0, 0), 0.001, 1000, record);
+        assert(rawHit && std::fabs(record.get_t() - 4) < 1e-4f && length(record.get_point() - vec3(4, 0, 0)) < 1e-4f);
+        assert(!instances.Occluded(Ray(vec3(0), vec3(0, 1, 0)), 0.001, 1000));
+        assert(instances.Occluded(Ray(vec3(0), vec3(1, 0, 0)), 0.001, 1000));
+        assert(!instances.Occluded(Ray(vec3(0), vec3(1, 0, 0)), 0.001, 3.5));
+
+        try {
+            instances.AddGroup(nullptr);
+            assert(false);
+        } catch (InstancedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            instances.AddGroup(make_shared<const SphereGroup>(SphereList()));
+            assert(false);
+        } catch (InstancedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            instances.AddInstance(2, mat3(1), vec3(0));
+            assert(false);
+        } catch (InstancedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            instances.AddInstance(0, mat3(vec3(1, 0, 0), vec3(2, 0, 0), vec3(0, 0, 1)), vec3(0));
+            assert(false);
+        } catch (InstancedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto isOccluded = instances.Occluded(Ray(vec3(0), vec3(1, 0, 0)), 10, 1);
+            assert(false);
+        } catch (InstancedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestInstancedSphereListHit() {
+        std::cout << "\t[InstancedSphereList] Testing Hit and Occluded against every copy in a SphereList..." <<
+                std::endl;
+        SphereList prototype;
+        for (int i = 0; i < 20; i++)
+            prototype.Add(make_shared<Sphere>(vec3(random_float(-2, 2), random_float(-2, 2), random_float(-2, 2)),
+                                              random_float(0.2, 0.6), Color(i % 2 == 0, 0.5, i % 2 == 1)));
+        const auto group = make_shared<const SphereGroup>(prototype);
+
+        // Rotated, evenly scaled and moved copies, each also written out sphere by sphere
+        InstancedSphereList instances;
+        instances.AddGroup(group);
+        SphereList expanded;
+        for (int n = 0; n < 50; n++) {
+            const mat3 linear = TestInstanceTransform(random_unit_vector(), random_float(0, 6.28f),
+                                                      random_float(0.5, 2));
+            const float scale = length(linear[0]);
+            const vec3 translation(random_float(-30, 30), random_float(-30, 30), random_float(-30, 30));
+            instances.AddInstance(0, linear, translation);
+            for (const auto &sphere: prototype.get_spheres())
+                expanded.Add(make_shared<Sphere>(linear * sphere->get_position() + translation,
+                                                 scale * sphere->get_radius(), sphere->get_color()));
+        }
+        instances.Build();
+        assert(instances.get_sphere_count() == expanded.size());
+
+        // Rays grazing a sphere may round either way, everything else must agree
+        int disagreements = 0;
+        for (int k = 0; k < 2000; k++) {
+            const Ray ray(vec3(random_float(-40, 40), random_float(-40, 40), -60),
+                          normalize(vec3(random_float(-0.5, 0.5), random_float(-0.5, 0.5), 1)));
+            HitRecord expected{}, actual{};
+            const bool hit = expanded.Hit(ray, 0.001, 1000000, expected);
+            if (instances.Hit(ray, 0.001, 1000000, actual) != hit ||
+                instances.Occluded(ray, 0.001, 1000000) != hit ||
+                (hit && (std::fabs(actual.get_t() - expected.get_t()) > 1e-3f * expected.get_t() ||
+                         length(actual.get_normal() - expected.get_normal()) > 1e-2f))) {
+                disagreements++;
+                continue;
+            }
+            if (hit)
+                assert(length(actual.get_normal()) > 0.999f && length(actual.get_normal()) < 1.001f);
+        }
+        assert(disagreements < 10);
+    }
+
+    static void TestInstancedSphereListMemory() {
+        std::cout << "\t[InstancedSphereList] Testing memory grows with instances, not spheres..." << std::endl;
+        SphereList prototype;
+        for (int i = 0; i < 1000; i++)
+            prototype.Add(make_shared<Sphere>(vec3(random_float(-10, 10), random_float(-10, 10),
+                                                   random_float(-10, 10)), 0.1, Color(0.5, 0.5, 0.5)));
+        InstancedSphereList instances;
+        instances.AddGroup(make_shared<const SphereGroup>(prototype));
+        for (int n = 0; n < 10000; n++)
+            instances.AddInstance(0, mat3(1), vec3(static_cast<float>(n % 100) * 25, 0,
+                                                   static_cast<float>(n / 100) * 25));
+        instances.Build();
+
+        // Ten million spheres, held in well under a hundred bytes per instance plus one copy of the group
+        assert(instances.get_sphere_count() == 10000000);
+        assert(instances.get_memory_bytes() < 10000 * 100 + 1000 * 100);
+    }
+
+    static void TestInstancedSphereListAll() {
+        std::cout << "[Unit Test] Testing InstancedSphereList..." << std::endl;
+        TestInstancedSphereListBuild();
+        TestInstancedSphereListHit();
+        TestInstancedSphereListMemory();
+    }
+}
@@ -0,0 +1,159 @@
+#include <Utils/Headers.h>
+#include <Renderer/IrradianceCache.h>
+
+namespace BlunderTest {
+    static void TestIrradianceCacheConstructor() {
+        std::cout << "\t[IrradianceCache] Testing constructor..." << std::endl;
+        auto cache = IrradianceCache(0.3f, 0.1f, 2.0f);
+        assert(cache.size() == 0);
+        assert(cache.get_accuracy() == 0.3f);
+        assert(cache.get_min_spacing() == 0.1f);
+        assert(cache.get_max_spacing() == 2.0f);
+
+        try {
+            auto zero = IrradianceCache(0, 0.1f, 2.0f);
+            assert(false);
+        } catch (IrradianceCacheException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto reversed = IrradianceCache(0.3f, 2.0f, 0.1f);
+            assert(false);
+        } catch (IrradianceCacheException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto unbounded = IrradianceCache(0.3f, 0.1f, infinity);
+            assert(false);
+        } catch (IrradianceCacheException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestIrradianceCacheGetSampleDirection() {
+        std::cout << "\t[IrradianceCache] Testing getSampleDirection..." << std::endl;
+        const vec3 normals[] = {vec3(0, 0, 1), vec3(0, 0, -1), normalize(vec3(1, -2, 0.5f))};
+        for (const auto &normal: normals) {
+            assert(length(IrradianceCache::getSampleDirection(normal, 8, 25, 0, 0, 0, 0) - normal) < 1e-6f);
+
+            // Cosine weighted: the mean cosine of a stratified hemisphere is 2/3
+            float cosines = 0;
+            for (int j = 0; j < 8; j++) {
+                for (int k = 0; k < 25; k++) {
+                    const vec3 direction = IrradianceCache::getSampleDirection(normal, 8, 25, j, k, 0.5f, 0.5f);
+                    assert(std::fabs(length(direction) - 1) < 1e-4f);
+                    assert(dot(direction, normal) >= 0);
+                    cosines += dot(direction, normal);
+                }
+            }
+            assert(std::fabs(cosines / 200 - 2.0f / 3.0f) < 0.01f);
+        }
+
+        try {
+            static_cast<void>(IrradianceCache::getSampleDirection(vec3(0, 0, 1), 8, 25, 8, 0, 0, 0));
+            assert(false);
+        } catch (IrradianceCacheException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestIrradianceCacheMakeRecord() {
+        std::cout << "\t[IrradianceCache] Testing makeRecord..." << std::endl;
+        auto cache = IrradianceCache(0.3f, 0.1f, 2.0f);
+        const vec3 normal(0, 0, 1);
+
+        // Uniform light from surfaces 1 unit away: that light, no gradient, radius 1
+        auto record = cache.makeRecord(vec3(1, 2, 3), normal, 8, 25, std::vector<vec3>(200, vec3(0.5f, 0.25f, 1)),
+                                       std::vector<float>(200, 1.0f));
+        assert(length(record.irradiance - vec3(0.5f, 0.25f, 1)) < 1e-5f);
+        assert(std::fabs(record.radius - 1) < 1e-4f);
+        for (int c = 0; c < 3; c++) {
+            assert(length(record.rotational_gradient[c]) < 1e-4f);
+            assert(length(record.translational_gradient[c]) < 1e-4f);
+        }
+
+        // Only sky: as large as allowed. Brighter towards +x: tilting the normal that way gains light.
+        std::vector<vec3> radiance(200);
+        for (int j = 0; j < 8; j++)
+            for (int k = 0; k < 25; k++)
+                radiance[j * 25 + k] = vec3(1 + IrradianceCache::getSampleDirection(normal, 8, 25, j, k, 0.5f, 0.5f).x);
+        record = cache.makeRecord(vec3(0), normal, 8, 25, radiance, std::vector<float>(200, infinity));
+        assert(record.radius == 2.0f);
+        assert(length(record.translational_gradient[0]) < 1e-4f);
+        const vec3 tilt = cross(normal, normalize(vec3(0.1f, 0, 1)));
+        assert(dot(tilt, record.rotational_gradient[0]) > 0);
+
+        // Close surfaces: as small as allowed
+        record = cache.makeRecord(vec3(0), normal, 8, 25, radiance, std::vector<float>(200, 0.01f));
+        assert(record.radius == 0.1f);
+
+        try {
+            static_cast<void>(cache.makeRecord(vec3(0), normal, 8, 25, std::vector<vec3>(199),
+                                               std::vector<float>(199)));
+            assert(false);
+        } catch (IrradianceCacheException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestIrradianceCacheLookup() {
+        std::cout << "\t[IrradianceCache] Testing add and lookup..." << std::endl;
+        auto cache = IrradianceCache(0.5f, 0.1f, 2.0f);
+        const vec3 normal(0, 0, 1);
+        vec3 irradiance(-1);
+        assert(!cache.lookup(vec3(0), normal, irradiance));
+        assert(irradiance == vec3(-1));
+
+        const auto first = cache.makeRecord(vec3(0), normal, 4, 13, std::vector<vec3>(52, vec3(0.2f)),
+                                            std::vector<float>(52, 1.0f));
+        const auto second = cache.makeRecord(vec3(0.3f, 0, 0), normal, 4, 13, std::vector<vec3>(52, vec3(0.6f)),
+                                             std::vector<float>(52, 1.0f));
+        cache.add(first);
+        assert(cache.size() == 1);
+        assert(cache.lookup(vec3(0), normal, irradiance));
+        assert(length(irradiance - vec3(0.2f)) < 1e-5f);
+
+        // Beyond the record's reach, facing away, or behind its surface
+        assert(!cache.lookup(vec3(0.6f, 0, 0), normal, irradiance));
+        assert(!cache.lookup(vec3(0), -normal, irradiance));
+        assert(!cache.lookup(vec3(0, 0, -0.15f), normal, irradiance));
+
+        // Between two records, a weighted mean of both
+        cache.add(second);
+        assert(cache.size() == 2);
+        assert(cache.get_record(1).position == vec3(0.3f, 0, 0));
+        assert(cache.lookup(vec3(0.15f, 0, 0), normal, irradiance));
+        assert(std::fabs(irradiance.x - 0.4f) < 1e-4f);
+        assert(cache.lookup(vec3(0.2f, 0, 0), normal, irradiance));
+        assert(irradiance.x > 0.4f && irradiance.x < 0.6f);
+
+        // Records are found across grid cells, far from the origin too
+        for (const auto &position: {vec3(-0.01f, -0.01f, 0), vec3(1000.5f, -2000.25f, 3.5f)}) {
+            auto record = first;
+            record.position = position;
+            cache.add(record);
+            assert(cache.lookup(position + vec3(0.2f, 0.2f, 0), normal, irradiance));
+            assert(cache.lookup(position - vec3(0.2f, 0.2f, 0), normal, irradiance));
+        }
+    }
+
+    static void TestIrradianceCacheAll() {
+        std::cout << "[Unit Test] Testing IrradianceCache..." << std::endl;
+        TestIrradianceCacheConstructor();
+        TestIrradianceCacheGetSampleDirection();
+        TestIrradianceCacheMakeRecord();
+        TestIrradianceCacheLookup();
+    }
+}
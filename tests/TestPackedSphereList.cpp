@@ -0,0 +1,111 @@
+#include <Utils/Headers.h>
+#include <Geometry/PackedSphereList.h>
+
+namespace BlunderTest {
+    static void TestPackedSphereListPack() {
+        std::cout << "\t[PackedSphereList] Testing packing and palette..." << std::endl;
+        SphereList list;
+        list.Add(make_shared<Sphere>(vec3(0, 5, 0), 1, Color(1, 0, 0)));
+        list.Add(make_shared<Sphere>(vec3(0, 2, 0), 0.5, Color(0, 1, 0)));
+        list.Add(make_shared<Sphere>(vec3(0, 8, 0), 2, Color(1, 0, 0)));
+
+        const PackedSphereList packed(list);
+        assert(packed.size() == 3);
+        assert(packed.get_palette().size() == 2);
+        assert(packed.get_sphere(1).y == 2 && packed.get_sphere(1).w == 0.5f);
+        assert(packed.get_color(2).get_color() == vec3(1, 0, 0));
+
+        // Selected lists keep the palette
+        const auto selected = packed.Select({2, 1});
+        assert(selected.size() == 2);
+        assert(selected.get_sphere(0).y == 8 && selected.get_color(1).get_color() == vec3(0, 1, 0));
+        assert(&selected.get_palette() == &packed.get_palette());
+
+        try {
+            auto bad = packed.Select({3});
+            assert(false);
+        } catch (PackedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        // Updates reuse palette colors, new ones go to a copy of the palette
+        auto updated = selected;
+        updated.Update(0, Sphere(vec3(1, 2, 3), 4, Color(0, 1, 0)));
+        assert(updated.get_sphere(0) == vec4(1, 2, 3, 4) && updated.get_color(0).get_color() == vec3(0, 1, 0));
+        assert(&updated.get_palette() == &packed.get_palette());
+        updated.Update(1, Sphere(vec3(0), 1, Color(0, 0, 1)));
+        assert(updated.get_color(1).get_color() == vec3(0, 0, 1) && updated.get_palette().size() == 3);
+        assert(packed.get_palette().size() == 2 && selected.get_color(1).get_color() == vec3(0, 1, 0));
+
+        try {
+            updated.Update(2, Sphere(vec3(0), 1, Color(0, 0, 1)));
+            assert(false);
+        } catch (PackedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            list.Add(nullptr);
+            auto bad = PackedSphereList(list);
+            assert(false);
+        } catch (PackedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestPackedSphereListHit() {
+        std::cout << "\t[PackedSphereList] Testing Hit and Occluded against SphereList..." << std::endl;
+        SphereList list;
+        for (int i = 0; i < 64; i++)
+            list.Add(make_shared<Sphere>(vec3(random_float(-4, 4), random_float(-4, 4), random_float(-4, 4)),
+                                         random_float(0.1, 1), Color(i % 3 == 0, i % 3 == 1, i % 3 == 2)));
+        const PackedSphereList packed(list);
+        assert(packed.get_palette().size() == 3);
+
+        // Every ray must give exactly the same hit as the unpacked list
+        for (int k = 0; k < 1000; k++) {
+            const Ray ray(vec3(random_float(-6, 6), -10, random_float(-6, 6)), random_unit_vector());
+            HitRecord expected{}, actual{};
+            const bool hit = list.Hit(ray, 0.001, 1000000, expected);
+            assert(packed.Hit(ray, 0.001, 1000000, actual) == hit);
+            assert(packed.Occluded(ray, 0.001, 1000000) == list.Occluded(ray, 0.001, 1000000));
+            if (hit) {
+                assert(actual.get_t() == expected.get_t());
+                assert(actual.get_point() == expected.get_point());
+                assert(actual.get_normal() == expected.get_normal());
+                assert(actual.get_color().get_color() == expected.get_color().get_color());
+            }
+        }
+
+        try {
+            HitRecord record{};
+            packed.Hit(Ray(vec3(0), vec3(0, 1, 0)), -infinity, infinity, record);
+            assert(false);
+        } catch (PackedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto isOccluded = packed.Occluded(Ray(vec3(0), vec3(0, 1, 0)), 10, 1);
+            assert(false);
+        } catch (PackedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestPackedSphereListAll() {
+        std::cout << "[Unit Test] Testing PackedSphereList..." << std::endl;
+        TestPackedSphereListPack();
+        TestPackedSphereListHit();
+    }
+}
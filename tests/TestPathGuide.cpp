@@ -0,0 +1,135 @@
+#include <Utils/Headers.h>
+#include <Renderer/PathGuide.h>
+
+namespace BlunderTest {
+    static void TestPathGuideConstructor() {
+        std::cout << "\t[PathGuide] Testing constructor..." << std::endl;
+        auto guide = PathGuide(vec3(-1), vec3(1));
+        assert(guide.get_region_count() == PathGuide::NORMAL_BINS);
+        for (uint32_t region = 0; region < guide.get_region_count(); region++)
+            assert(!guide.is_trained(region));
+
+        // A flat box still makes a cube
+        auto flat = PathGuide(vec3(-1, -1, 0), vec3(1, 1, 0));
+        assert(flat.get_region_count() == PathGuide::NORMAL_BINS);
+
+        try {
+            auto reversed = PathGuide(vec3(1), vec3(-1));
+            assert(false);
+        } catch (PathGuideException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto unbounded = PathGuide(vec3(-1), vec3(infinity));
+            assert(false);
+        } catch (PathGuideException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestPathGuideFindRegion() {
+        std::cout << "\t[PathGuide] Testing findRegion..." << std::endl;
+        auto guide = PathGuide(vec3(-1), vec3(1));
+        const vec3 normals[] = {vec3(1, 0, 0), vec3(0, 1, 0), vec3(0, 0, 1), normalize(vec3(0.2f, -1, 0.5f))};
+        for (const auto &normal: normals) {
+            const uint32_t region = guide.findRegion(vec3(0.5f), normal);
+            assert(region < guide.get_region_count());
+            assert(guide.findRegion(vec3(0.5f), -normal) != region);
+
+            // Points outside the box use the nearest region
+            assert(guide.findRegion(vec3(100), normal) == region);
+        }
+    }
+
+    static void TestPathGuideSample() {
+        std::cout << "\t[PathGuide] Testing sample and pdf..." << std::endl;
+        constexpr float PI = 3.14159265f;
+        auto guide = PathGuide(vec3(-1), vec3(1));
+        const uint32_t region = guide.findRegion(vec3(0), vec3(0, 0, 1));
+
+        // Untrained, every direction is equally likely
+        float density;
+        for (int i = 0; i < 100; i++) {
+            const vec3 direction = guide.sample(region, random_float(), random_float(), density);
+            assert(std::fabs(length(direction) - 1) < 1e-4f);
+            assert(std::fabs(density - 1 / (4 * PI)) < 1e-6f);
+            assert(std::fabs(guide.pdf(region, direction) - 1 / (4 * PI)) < 1e-6f);
+        }
+
+        // Light from straight above, plus a little from everywhere. Each pass refines the quadtree one level deeper.
+        for (int pass = 0; pass < 8; pass++) {
+            for (int i = 0; i < 5000; i++) {
+                guide.record(region, normalize(vec3(random_float(-0.1f, 0.1f), random_float(-0.1f, 0.1f), 1)), 1);
+                guide.record(region, random_unit_vector(), 0.01f);
+            }
+            guide.refine(1000000);
+        }
+        assert(guide.get_region_count() == PathGuide::NORMAL_BINS);
+        assert(guide.is_trained(region));
+        assert(guide.get_node(guide.get_root(region)).child[3] != 0);
+
+        // The density integrates to 1 over the sphere, area of the square times 4 pi
+        constexpr int STEPS = 512;
+        double integral = 0;
+        for (int i = 0; i < STEPS; i++) {
+            for (int j = 0; j < STEPS; j++) {
+                const float cos_theta = 2 * (static_cast<float>(i) + 0.5f) / STEPS - 1;
+                const float phi = 2 * PI * ((static_cast<float>(j) + 0.5f) / STEPS - 0.5f);
+                const float sin_theta = std::sqrt(1 - cos_theta * cos_theta);
+                const vec3 direction(sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta);
+                integral += guide.pdf(region, direction) * 4 * PI / (STEPS * STEPS);
+            }
+        }
+        assert(std::fabs(integral - 1) < 0.01);
+
+        // Samples head up, with the density pdf() gives them. Rounding may put one on the other side of an edge.
+        int up = 0, mismatched = 0;
+        for (int i = 0; i < 1000; i++) {
+            const vec3 direction = guide.sample(region, random_float(), random_float(), density);
+            assert(density > 0);
+            if (direction.z > 0.95f)
+                up++;
+            if (std::fabs(density - guide.pdf(region, direction)) > 1e-3f * density)
+                mismatched++;
+        }
+        assert(up > 800);
+        assert(mismatched < 5);
+    }
+
+    static void TestPathGuideRefine() {
+        std::cout << "\t[PathGuide] Testing refine..." << std::endl;
+        auto guide = PathGuide(vec3(-1), vec3(1));
+        const uint32_t region = guide.findRegion(vec3(0.5f), vec3(0, 0, 1));
+
+        // 4000 bounces split the only cell twice, every half learns what the cell recorded
+        for (int i = 0; i < 4000; i++)
+            guide.record(region, vec3(0, 0, 1), 1);
+        guide.refine(1000);
+        assert(guide.get_region_count() == 4 * PathGuide::NORMAL_BINS);
+        const vec3 corners[] = {vec3(-0.5f), vec3(0.5f), vec3(0.5f, -0.5f, 0), vec3(-0.5f, 0.5f, 0)};
+        for (const auto &corner: corners) {
+            const uint32_t trained = guide.findRegion(corner, vec3(0, 0, 1));
+            assert(guide.is_trained(trained));
+            assert(!guide.is_trained(guide.findRegion(corner, vec3(0, 0, -1))));
+            assert(guide.pdf(trained, vec3(0, 0, 1)) > guide.pdf(trained, vec3(0, 0, -1)));
+        }
+
+        // A pass without light keeps what was learned
+        guide.refine(1000);
+        assert(guide.get_region_count() == 4 * PathGuide::NORMAL_BINS);
+        assert(guide.is_trained(guide.findRegion(vec3(0.5f), vec3(0, 0, 1))));
+    }
+
+    static void TestPathGuideAll() {
+        std::cout << "[Unit Test] Testing PathGuide..." << std::endl;
+        TestPathGuideConstructor();
+        TestPathGuideFindRegion();
+        TestPathGuideSample();
+        TestPathGuideRefine();
+    }
+}
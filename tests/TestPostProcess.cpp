@@ -0,0 +1,165 @@
+#include <Utils/Headers.h>
+#include <Renderer/PostProcess.h>
+#include <cfloat>
+
+namespace BlunderTest {
+    static void TestPostProcessApply() {
+        std::cout << "\t[PostProcess] Testing apply..." << std::endl;
+        auto pp = PostProcess();
+        float linear[6] = {0.25f, 1, 4, 0, 0.5f, 0.01f};
+        unsigned char out[6];
+        pp.apply(linear, 2, 1, out);
+        assert(out[0] == 127 && out[1] == 255 && out[2] == 255);
+
+        // Default output must match the original gamma 2 writer exactly
+        for (int i = 0; i < 6; i++) {
+            const float clamped = std::min(linear[i], 1.0f);
+            assert(out[i] == static_cast<int>(255.999 * linear_to_gamma(clamped)));
+        }
+
+        try {
+            pp.apply(nullptr, 1, 1, out);
+            assert(false);
+        } catch (PostProcessException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            pp.apply(linear, 0, 1, out);
+            assert(false);
+        } catch (PostProcessException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestPostProcessToneMapping() {
+        std::cout << "\t[PostProcess] Testing tone mapping..." << std::endl;
+        float linear[3] = {0, 1, 1000};
+        unsigned char out[3];
+
+        auto reinhard = PostProcess(1, ToneMapping::Reinhard, TransferFunction::Gamma2);
+        reinhard.apply(linear, 1, 1, out);
+        assert(out[0] == 0);
+        assert(out[1] == static_cast<int>(255.999 * std::sqrt(0.5f)));
+        assert(out[2] == 255);
+
+        auto aces = PostProcess(1, ToneMapping::ACES, TransferFunction::Gamma2);
+        aces.apply(linear, 1, 1, out);
+        assert(out[0] == 0);
+        assert(out[1] > 200 && out[1] < 255);
+        assert(out[2] == 255);
+
+        // Exposure scales before tone mapping
+        auto bright = PostProcess(4, ToneMapping::Clamp, TransferFunction::Gamma2);
+        float quarter[3] = {0.25f, 0.25f, 0.25f};
+        bright.apply(quarter, 1, 1, out);
+        assert(out[0] == 255);
+
+        // Exposure overflowing to infinity makes the operators divide infinities, the result is still white
+        float largest[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+        for (const auto tone_mapping: {ToneMapping::Reinhard, ToneMapping::ACES}) {
+            for (const auto transfer_function: {TransferFunction::Gamma2, TransferFunction::SRGB}) {
+                PostProcess(2, tone_mapping, transfer_function).apply(largest, 1, 1, out);
+                assert(out[0] == 255 && out[1] == 255 && out[2] == 255);
+            }
+        }
+    }
+
+    static void TestPostProcessTransferFunction() {
+        std::cout << "\t[PostProcess] Testing transfer functions..." << std::endl;
+        auto srgb = PostProcess(1, ToneMapping::Clamp, TransferFunction::SRGB);
+
+        // Compare against the exact sRGB curve, quantized like the gamma 2 writer
+        std::vector<float> linear(3 * 1024);
+        for (size_t i = 0; i < linear.size(); i++)
+            linear[i] = static_cast<float>(i) / static_cast<float>(linear.size() - 1);
+        std::vector<unsigned char> out(linear.size());
+        srgb.apply(linear.data(), 1024, 1, out.data());
+
+        for (size_t i = 0; i < linear.size(); i++) {
+            const double v = linear[i];
+            const double encoded = v <= 0.0031308 ? 12.92 * v : 1.055 * std::pow(v, 1.0 / 2.4) - 0.055;
+            const int expected = std::min(static_cast<int>(255.999 * encoded), 255);
+            assert(out[i] == expected);
+        }
+        assert(out.front() == 0);
+        assert(out.back() == 255);
+    }
+
+    static void TestPostProcessParse() {
+        std::cout << "\t[PostProcess] Testing parse..." << std::endl;
+        assert(PostProcess::parseToneMapping("clamp") == ToneMapping::Clamp);
+        assert(PostProcess::parseToneMapping("reinhard") == ToneMapping::Reinhard);
+        assert(PostProcess::parseToneMapping("aces") == ToneMapping::ACES);
+        assert(PostProcess::parseTransferFunction("gamma2") == TransferFunction::Gamma2);
+        assert(PostProcess::parseTransferFunction("srgb") == TransferFunction::SRGB);
+        assert(PostProcess::parseExposure("1.5") == 1.5f);
+
+        for (const auto &text: {"bright", "2x", "", "1e99"}) {
+            try {
+                PostProcess::parseExposure(text);
+                assert(false);
+            } catch (PostProcessException &e) {
+                assert(std::string(e.what()).find("invalid exposure") != std::string::npos);
+            } catch (...) {
+                assert(false);
+            }
+        }
+
+        try {
+            PostProcess::parseToneMapping("filmic");
+            assert(false);
+        } catch (PostProcessException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            PostProcess::parseTransferFunction("gamma");
+            assert(false);
+        } catch (PostProcessException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestPostProcessSetExposure() {
+        std::cout << "\t[PostProcess] Testing set_exposure..." << std::endl;
+        auto pp = PostProcess();
+        pp.set_exposure(2);
+        assert(pp.get_exposure() == 2);
+
+        try {
+            pp.set_exposure(0);
+            assert(false);
+        } catch (PostProcessException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            pp.set_exposure(infinity);
+            assert(false);
+        } catch (PostProcessException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestPostProcessAll() {
+        std::cout << "[Unit Test] Testing PostProcess..." << std::endl;
+        TestPostProcessApply();
+        TestPostProcessToneMapping();
+        TestPostProcessTransferFunction();
+        TestPostProcessParse();
+        TestPostProcessSetExposure();
+    }
+}
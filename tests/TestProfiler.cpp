@@ -0,0 +1,83 @@
+#include <Utils/Headers.h>
+#include <Utils/Profiler.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace BlunderTest {
+    static void TestProfilerZones() {
+        std::cout << "\t[Profiler] Testing zones..." << std::endl;
+        Profiler::clear();
+
+        // Disabled zones record nothing
+        Profiler::disable();
+        {
+            ProfileZone zone("Disabled zone");
+        }
+        assert(Profiler::get_event_count() == 0);
+
+        // Enabled zones record on every thread
+        Profiler::enable();
+        assert(Profiler::is_enabled());
+        {
+            ProfileZone zone("Enabled zone", 7);
+        }
+        parallel_for(4, [](const int begin, const int end) {
+            for (int i = begin; i < end; i++)
+                ProfileZone zone("Worker zone", i);
+        });
+        Profiler::disable();
+        assert(Profiler::get_event_count() == 5);
+
+        Profiler::clear();
+        assert(Profiler::get_event_count() == 0);
+
+        // Threads started one after another, like one render task per frame, share a buffer
+        Profiler::enable();
+        const size_t buffers = Profiler::get_buffer_count();
+        for (int i = 0; i < 8; i++)
+            std::thread([i] { ProfileZone zone("Frame zone", i); }).join();
+        Profiler::disable();
+        assert(Profiler::get_buffer_count() <= buffers + 1);
+        assert(Profiler::get_event_count() == 8);
+
+        Profiler::clear();
+        assert(Profiler::get_event_count() == 0);
+    }
+
+    static void TestProfilerWriteChromeTrace() {
+        std::cout << "\t[Profiler] Testing writeChromeTrace..." << std::endl;
+        Profiler::clear();
+        Profiler::enable();
+        {
+            ProfileZone zone("Traced \"zone\"", 3);
+        }
+        Profiler::disable();
+        Profiler::writeChromeTrace("test_trace.json");
+
+        std::ifstream file("test_trace.json");
+        std::stringstream contents;
+        contents << file.rdbuf();
+        const auto json = contents.str();
+        assert(json.find("\"traceEvents\"") != std::string::npos);
+        assert(json.find("\"name\": \"Traced \\\"zone\\\"\"") != std::string::npos);
+        assert(json.find("\"ph\": \"X\"") != std::string::npos);
+        assert(json.find("\"args\": {\"index\": 3}") != std::string::npos);
+        Profiler::clear();
+
+        try {
+            Profiler::writeChromeTrace("");
+            assert(false);
+        } catch (ProfilerException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestProfilerAll() {
+        std::cout << "[Unit Test] Testing Profiler..." << std::endl;
+        TestProfilerZones();
+        TestProfilerWriteChromeTrace();
+    }
+}
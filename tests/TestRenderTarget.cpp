@@ -1,5 +1,8 @@
 #include <Utils/Headers.h>
 #include <Renderer/RenderTarget.h>
+#include <fstream>
+#include <limits>
+#include <sstream>
 
 namespace BlunderTest {
     static void TestRenderTargetInitialize() {
@@ -64,6 +67,43 @@ namespace BlunderTest {
         }
     }
 
+    static void TestRenderTargetRadiance() {
+        std::cout << "\t[RenderTarget] Testing set_radiance / get_radiance..." << std::endl;
+        auto rt1 = RenderTarget(101, 101);
+        rt1.set_radiance(0, 0, vec3(4));
+        assert(rt1.get_radiance(0, 0) == vec3(4));
+        assert(rt1.get_pixel(0, 0).get_color() == vec3(1));
+        rt1.set_pixel(100, 100, Color(0.5, 0.5, 0.5));
+        assert(rt1.get_radiance(100, 100) == vec3(0.5));
+
+        try {
+            rt1.set_radiance(0, 0, vec3(-1));
+            assert(false);
+        } catch (RenderTargetException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            rt1.set_radiance(0, 0, vec3(infinity));
+            assert(false);
+        } catch (RenderTargetException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto radiance = rt1.get_radiance(101, 101);
+            assert(false);
+        } catch (RenderTargetException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
     static void TestRenderTargetWriteToFile() {
         std::cout << "\t[RenderTarget] Testing writeToFile..." << std::endl;
         auto rt1 = RenderTarget(100, 200);
@@ -84,6 +124,235 @@ namespace BlunderTest {
         } catch (...) {
             assert(false);
         }
+
+        try {
+            rt1.writeToFile("missing_dir/test.ppm");
+            assert(false);
+        } catch (RenderTargetException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        // Same bytes as formatting every component with a stream, over more rows than one write batch holds
+        auto rt2 = RenderTarget(3, 150);
+        std::ostringstream expected;
+        expected << "P3\n3 150\n255\n";
+        for (int y = 0; y < 150; y++) {
+            for (int x = 0; x < 3; x++) {
+                const Color color(static_cast<float>((x + y) % 7) / 6, static_cast<float>(y % 11) / 10,
+                                  static_cast<float>(x % 2));
+                rt2.set_pixel(x, y, color);
+                unsigned char encoded[3];
+                const float linear[3] = {color.get_color().r, color.get_color().g, color.get_color().b};
+                PostProcess().applyRow(linear, 3, encoded);
+                expected << static_cast<int>(encoded[0]) << " " << static_cast<int>(encoded[1]) << " "
+                        << static_cast<int>(encoded[2]) << "\n";
+            }
+        }
+        rt2.writeToFile("test_format.ppm");
+        std::ifstream written("test_format.ppm", std::ios::binary);
+        const std::string contents((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+        assert(contents == expected.str());
+    }
+
+    static void TestRenderTargetPFM() {
+        std::cout << "\t[RenderTarget] Testing writeToPFM / readFromPFM..." << std::endl;
+        auto rt1 = RenderTarget(7, 5);
+        rt1.set_radiance(0, 0, vec3(4, 0.5, 0));
+        rt1.set_radiance(6, 4, vec3(0.25, 2, 8));
+        rt1.writeToPFM("test.pfm");
+
+        auto rt2 = RenderTarget::readFromPFM("test.pfm");
+        assert(rt2->get_width() == 7);
+        assert(rt2->get_height() == 5);
+        for (int y = 0; y < 5; y++)
+            for (int x = 0; x < 7; x++)
+                assert(rt2->get_radiance(x, y) == rt1.get_radiance(x, y));
+
+        try {
+            rt1.writeToPFM("");
+            assert(false);
+        } catch (RenderTargetException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto missing = RenderTarget::readFromPFM("missing.pfm");
+            assert(false);
+        } catch (RenderTargetException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestRenderTargetPPM() {
+        std::cout << "\t[RenderTarget] Testing readFromPPM..." << std::endl;
+
+        // Every 8-bit value must survive a read and write with the default post process
+        auto rt1 = RenderTarget(256, 1);
+        for (int x = 0; x < 256; x++) {
+            const float v = static_cast<float>(x) / 255.0f;
+            rt1.set_radiance(x, 0, vec3(v * v, v, 1.0f - v));
+        }
+        rt1.writeToFile("test.ppm");
+
+        auto rt2 = RenderTarget::readFromPPM("test.ppm");
+        assert(rt2->get_width() == 256);
+        assert(rt2->get_height() == 1);
+        rt2->writeToFile("test_copy.ppm");
+
+        std::ifstream original("test.ppm"), copy("test_copy.ppm");
+        const std::string original_text((std::istreambuf_iterator<char>(original)), std::istreambuf_iterator<char>());
+        const std::string copy_text((std::istreambuf_iterator<char>(copy)), std::istreambuf_iterator<char>());
+        assert(original_text == copy_text);
+
+        try {
+            RenderTarget(2, 2).writeToPFM("test.pfm");
+            auto wrong = RenderTarget::readFromPPM("test.pfm");
+            assert(false);
+        } catch (RenderTargetException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto missing = RenderTarget::readFromPPM("missing.ppm");
+            assert(false);
+        } catch (RenderTargetException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestRenderTargetPixelStorage() {
+        std::cout << "\t[RenderTarget] Testing half float and RGB9E5 storage..." << std::endl;
+        assert(pixel_storage_size(PixelStorage::Float) == 12);
+        assert(pixel_storage_size(PixelStorage::Half) == 6);
+        assert(pixel_storage_size(PixelStorage::RGB9E5) == 4);
+
+        // Every non-negative finite half survives a round trip
+        std::vector<uint16_t> halves(0x7c00);
+        for (size_t h = 0; h < halves.size(); h++)
+            halves[h] = static_cast<uint16_t>(h);
+        std::vector<float> floats(halves.size());
+        std::vector<uint16_t> encoded(halves.size());
+        decode_half(halves.data(), halves.size(), floats.data());
+        encode_half(floats.data(), floats.size(), encoded.data());
+        assert(encoded == halves);
+        assert(floats[0x3c00] == 1.0f && floats[0x7bff] == HALF_MAX && floats[1] == std::ldexp(1.0f, -24));
+
+        // Rounding to nearest even, saturation, and negative or NaN values to zero
+        const float special[] = {
+            1.0f + std::ldexp(1.0f, -11), 1.0f + 3 * std::ldexp(1.0f, -11), 1e9f, -1.0f,
+            std::numeric_limits<float>::quiet_NaN(), 0.1f, 0.1f, 0.1f, 0.1f
+        };
+        uint16_t rounded[9];
+        encode_half(special, 9, rounded);
+        assert(rounded[0] == 0x3c00 && rounded[1] == 0x3c02 && rounded[2] == 0x7bff);
+        assert(rounded[3] == 0 && rounded[4] == 0 && rounded[5] == 0x2e66 && rounded[8] == 0x2e66);
+
+        // Relative error below 2^-11 over the normal range, for the hardware and the portable paths alike
+        std::vector<float> values, decoded(4096);
+        for (int i = 0; i < 4096; i++)
+            values.push_back(std::ldexp(1.0f + static_cast<float>(i) / 4096, i % 30 - 14));
+        encode_half(values.data(), values.size(), encoded.data());
+        decode_half(encoded.data(), values.size(), decoded.data());
+        for (size_t i = 0; i < values.size(); i++)
+            assert(std::abs(decoded[i] - values[i]) <= values[i] * std::ldexp(1.0f, -11));
+
+        // RGB9E5: exact for short mantissas, the brightest channel within 2^-9, the others relative to it
+        float exact[3] = {1.0f, 0.5f, 0.0f};
+        uint32_t packed;
+        encode_rgb9e5(exact, 1, &packed);
+        decode_rgb9e5(&packed, 1, exact);
+        assert(exact[0] == 1.0f && exact[1] == 0.5f && exact[2] == 0.0f);
+
+        std::vector<float> colors, restored(3 * 1000);
+        std::vector<uint32_t> pixels(1000);
+        for (int i = 0; i < 1000; i++)
+            for (int c = 0; c < 3; c++)
+                colors.push_back(std::ldexp(random_float(), i % 24 - 12));
+        encode_rgb9e5(colors.data(), 1000, pixels.data());
+        decode_rgb9e5(pixels.data(), 1000, restored.data());
+        for (int i = 0; i < 1000; i++) {
+            const float brightest = std::max({colors[3 * i], colors[3 * i + 1], colors[3 * i + 2]});
+            for (int c = 0; c < 3; c++)
+                assert(std::abs(restored[3 * i + c] - colors[3 * i + c]) <= brightest * std::ldexp(1.0f, -9));
+        }
+
+        const float huge[3] = {1e9f, -1.0f, 2.0f};
+        encode_rgb9e5(huge, 1, &packed);
+        decode_rgb9e5(&packed, 1, restored.data());
+        assert(restored[0] == RGB9E5_MAX && restored[1] == 0 && restored[2] == 0);
+
+        // Render targets in each storage
+        for (const auto storage: {PixelStorage::Half, PixelStorage::RGB9E5}) {
+            auto rt1 = RenderTarget(7, 5, storage);
+            assert(rt1.get_storage() == storage);
+            assert(rt1.get_data() == nullptr);
+            assert(rt1.get_radiance(6, 4) == vec3(0));
+
+            rt1.set_radiance(1, 2, vec3(4, 0.5, 0.25));
+            assert(rt1.get_radiance(1, 2) == vec3(4, 0.5, 0.25));
+            assert(rt1.get_pixel(1, 2).get_color() == vec3(1, 0.5, 0.25));
+
+            const float row[6] = {0.1f, 0.2f, 0.3f, 3.0f, 2.0f, 1.0f};
+            rt1.writeRow(5, 4, 2, row);
+            float read[6];
+            rt1.readRow(5, 4, 2, read);
+            for (int c = 0; c < 6; c++)
+                assert(std::abs(read[c] - row[c]) <= 3.0f * std::ldexp(1.0f, -9));
+
+            // Converting to floats keeps the stored values exactly, and back again changes nothing
+            const vec3 stored = rt1.get_radiance(5, 4);
+            rt1.set_storage(PixelStorage::Float);
+            assert(rt1.get_data() != nullptr);
+            assert(rt1.get_radiance(5, 4) == stored);
+            rt1.set_storage(storage);
+            assert(rt1.get_radiance(5, 4) == stored);
+
+            // Files are written from the decoded values
+            rt1.writeToFile("storage.ppm");
+            rt1.writeToPFM("storage.pfm");
+            assert(RenderTarget::readFromPFM("storage.pfm")->get_radiance(1, 2) == vec3(4, 0.5, 0.25));
+
+            try {
+                const float negative[3] = {-1, 0, 0};
+                rt1.writeRow(0, 0, 1, negative);
+                assert(false);
+            } catch (RenderTargetException &e) {
+                assert(true);
+            } catch (...) {
+                assert(false);
+            }
+
+            try {
+                rt1.readRow(6, 0, 2, read);
+                assert(false);
+            } catch (RenderTargetException &e) {
+                assert(true);
+            } catch (...) {
+                assert(false);
+            }
+        }
+
+        assert(RenderTarget::parsePixelStorage("float") == PixelStorage::Float);
+        assert(RenderTarget::parsePixelStorage("half") == PixelStorage::Half);
+        assert(RenderTarget::parsePixelStorage("rgb9e5") == PixelStorage::RGB9E5);
+        try {
+            static_cast<void>(RenderTarget::parsePixelStorage("fp8"));
+            assert(false);
+        } catch (RenderTargetException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
     }
 
     static void TestRenderTargetSetWidth() {
@@ -145,7 +414,11 @@ namespace BlunderTest {
         TestRenderTargetInitialize();
         TestRenderTargetGetPixel();
         TestRenderTargetSetPixel();
+        TestRenderTargetRadiance();
         TestRenderTargetWriteToFile();
+        TestRenderTargetPFM();
+        TestRenderTargetPPM();
+        TestRenderTargetPixelStorage();
         TestRenderTargetSetWidth();
         TestRenderTargetSetHeight();
     }
@@ -1,5 +1,8 @@
 #include <Utils/Headers.h>
 #include <Renderer/Renderer.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 namespace BlunderTest {
     static void TestRendererConstructor() {
@@ -73,6 +76,500 @@ namespace BlunderTest {
         }
     }
 
+    static void TestRendererRenderAsync() {
+        std::cout << "\t[Renderer] Testing renderAsync, cancellation and deadline..." << std::endl;
+        auto sl = make_shared<SphereList>();
+        sl->Add(make_shared<Sphere>(vec3(0), 0.5, Color(0, 0, 1)));
+        auto c1 = make_shared<Camera>(vec3(0, -10, 5), vec3(0));
+
+        // Completed, with one callback per tile in increasing order
+        auto r1 = Renderer(2, 2);
+        r1.set_tiling({8, 8, TileOrder::Hilbert});
+        auto rtt1 = make_shared<RenderTarget>(32, 24);
+        std::vector<RT_RENDER_PROGRESS> reports;
+        RT_RENDER_OPTIONS options;
+        options.on_progress = [&](const RT_RENDER_PROGRESS &progress) { reports.push_back(progress); };
+        auto job = r1.renderAsync(sl, c1, rtt1, options);
+        const RenderStatus completed = job->wait();
+        assert(completed == RenderStatus::Completed);
+        assert(job->get_status() == RenderStatus::Completed && job->get_progress() == 1.0f);
+        assert(reports.size() == 12);
+        for (size_t k = 0; k < reports.size(); k++)
+            assert(reports[k].tiles_done == k + 1 && reports[k].tiles_total == 12);
+        for (int y = 0; y < 24; y++)
+            for (int x = 0; x < 32; x++)
+                assert(rtt1->get_radiance(x, y) != vec3(0));
+
+        // Cancelled soon after starting, the threads are released long before the render could finish
+        auto r2 = Renderer(512, 50);
+        r2.set_tiling({16, 16, TileOrder::Hilbert});
+        auto rtt2 = make_shared<RenderTarget>(256, 256);
+        auto slow = r2.renderAsync(sl, c1, rtt2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const auto cancelled_at = std::chrono::steady_clock::now();
+        slow->cancel();
+        const RenderStatus cancelled = slow->wait();
+        assert(cancelled == RenderStatus::Cancelled);
+        assert(std::chrono::steady_clock::now() - cancelled_at < std::chrono::seconds(1));
+        assert(slow->get_progress() < 1.0f);
+
+        // Tiles are written whole, so each one is either finished or untouched
+        for (int ty = 0; ty < 256; ty += 16) {
+            for (int tx = 0; tx < 256; tx += 16) {
+                const bool written = rtt2->get_radiance(tx, ty) != vec3(0);
+                for (int y = ty; y < ty + 16; y++)
+                    for (int x = tx; x < tx + 16; x++)
+                        assert((rtt2->get_radiance(x, y) != vec3(0)) == written);
+            }
+        }
+
+        // Deadline already passed, nothing is traced
+        auto rtt3 = make_shared<RenderTarget>(32, 24);
+        RT_RENDER_OPTIONS late;
+        late.deadline = std::chrono::steady_clock::now();
+        const RenderStatus timed_out = r1.renderAsync(sl, c1, rtt3, late)->wait();
+        assert(timed_out == RenderStatus::TimedOut);
+        assert(rtt3->get_radiance(0, 0) == vec3(0));
+
+        // Errors on the render threads are rethrown by wait()
+        auto bad = make_shared<SphereList>();
+        bad->Add(nullptr);
+        auto failed = r1.renderAsync(bad, c1, rtt3);
+        try {
+            failed->wait();
+            assert(false);
+        } catch (PackedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+        assert(failed->get_status() == RenderStatus::Failed);
+
+        try {
+            auto none = r1.renderAsync(sl, nullptr, rtt3);
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestRendererRenderFramebuffer() {
+        std::cout << "\t[Renderer] Testing render into caller-owned framebuffers..." << std::endl;
+        // Only the sky, which changes little within a pixel, so renders agree up to the antialiasing jitter
+        auto sl = make_shared<SphereList>();
+        auto c1 = make_shared<Camera>(vec3(0, -10, 5), vec3(0));
+        auto r1 = Renderer(64, 2);
+        auto rtt1 = make_shared<RenderTarget>(16, 12);
+        r1.render(sl, c1, rtt1);
+
+        // Float RGBA with padded rows, the padding is never written
+        const size_t stride = 16 * 4 * sizeof(float) + 24;
+        std::vector<unsigned char> floats(stride * 12, 0xab);
+        r1.render(sl, c1, RT_FRAMEBUFFER{floats.data(), 16, 12, stride, PixelFormat::RGBA32F});
+        for (int y = 0; y < 12; y++) {
+            const auto *pixels = reinterpret_cast<const float *>(floats.data() + stride * y);
+            for (int x = 0; x < 16; x++) {
+                const vec3 radiance(pixels[4 * x], pixels[4 * x + 1], pixels[4 * x + 2]);
+                assert(length(radiance - rtt1->get_radiance(x, y)) < 0.02f);
+                assert(pixels[4 * x + 3] == 1.0f);
+            }
+            for (size_t b = 16 * 4 * sizeof(float); b < stride; b++)
+                assert(floats[stride * y + b] == 0xab);
+        }
+
+        // 8-bit sRGB, packed rows, through the framebuffer's post process
+        std::vector<unsigned char> bytes(16 * 12 * 4, 0);
+        RT_FRAMEBUFFER framebuffer{bytes.data(), 16, 12, 0, PixelFormat::RGBA8};
+        r1.render(sl, c1, framebuffer);
+        for (int y = 0; y < 12; y++) {
+            for (int x = 0; x < 16; x++) {
+                const vec3 radiance = rtt1->get_radiance(x, y);
+                const float linear[3] = {radiance.x, radiance.y, radiance.z};
+                unsigned char expected[3];
+                framebuffer.post_process.applyRow(linear, 3, expected);
+                for (int c = 0; c < 3; c++)
+                    assert(std::abs(bytes[4 * (16 * y + x) + c] - expected[c]) <= 4);
+                assert(bytes[4 * (16 * y + x) + 3] == 255);
+            }
+        }
+
+        // Asynchronous, with a crop window leaving the rest of the buffer alone
+        std::vector<unsigned char> cropped(16 * 12 * 4, 0);
+        r1.set_crop({4, 2, 8, 6});
+        const RT_FRAMEBUFFER window{cropped.data(), 16, 12, 0, PixelFormat::RGBA8};
+        const RenderStatus status = r1.renderAsync(sl, c1, window)->wait();
+        assert(status == RenderStatus::Completed);
+        for (int y = 0; y < 12; y++)
+            for (int x = 0; x < 16; x++)
+                assert((cropped[4 * (16 * y + x) + 3] == 255) == (x >= 4 && x < 12 && y >= 2 && y < 8));
+
+        try {
+            r1.render(sl, c1, RT_FRAMEBUFFER{nullptr, 16, 12});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            r1.render(sl, c1, RT_FRAMEBUFFER{bytes.data(), 16, 12, 32, PixelFormat::RGBA8});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            r1.render(sl, c1, RT_FRAMEBUFFER{floats.data(), 16, 12, stride + 2, PixelFormat::RGBA32F});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            r1.render(sl, c1, RT_FRAMEBUFFER{bytes.data(), 0, 12});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestRendererCostMap() {
+        std::cout << "\t[Renderer] Testing cost maps..." << std::endl;
+        // One sphere filling the center of the view, sky in the corners
+        auto sl = make_shared<SphereList>();
+        sl->Add(make_shared<Sphere>(vec3(0), 3, Color(0.5, 0.5, 0.5)));
+        auto c1 = make_shared<Camera>(vec3(0, -10, 0), vec3(0));
+        auto r1 = Renderer(4, 3);
+        r1.set_tiling({4, 4, TileOrder::RowMajor});
+        auto rtt1 = make_shared<RenderTarget>(16, 12);
+        auto costs = make_shared<CostMap>(16, 12);
+        r1.render(sl, c1, rtt1, costs);
+
+        // Every sample of the center pixel hits the sphere, then bounces at most 3 times
+        assert(costs->get_value(8, 6, CostChannel::Bounces) >= 4);
+        assert(costs->get_value(8, 6, CostChannel::Bounces) <= 12);
+        assert(costs->get_value(8, 6, CostChannel::TraversalSteps) >= 4);
+        assert(costs->get_value(8, 6, CostChannel::IntersectionTests) >=
+            costs->get_value(8, 6, CostChannel::TraversalSteps));
+
+        // A hierarchy over many spheres only tests the few along each ray
+        auto row = make_shared<SphereList>();
+        for (int i = 0; i < 64; i++)
+            row->Add(make_shared<Sphere>(vec3(static_cast<float>(i - 32) * 4, 0, 0), 1, Color(0.5, 0.5, 0.5)));
+        auto rowCosts = make_shared<CostMap>(16, 12);
+        r1.render(row, c1, rtt1, rowCosts);
+        assert(rowCosts->get_value(8, 6, CostChannel::IntersectionTests) > 0);
+        assert(rowCosts->get_value(8, 6, CostChannel::IntersectionTests) < 4 * 3 * 64);
+
+        // Corner rays miss, so they cost less
+        assert(costs->get_value(0, 0, CostChannel::Bounces) == 0);
+        assert(costs->get_value(0, 0, CostChannel::IntersectionTests) <
+            costs->get_value(8, 6, CostChannel::IntersectionTests));
+        for (int y = 0; y < 12; y++)
+            for (int x = 0; x < 16; x++)
+                assert(costs->get_value(x, y, CostChannel::TileTime) > 0);
+
+        // Only the crop window is recorded
+        auto cropped = make_shared<CostMap>(16, 12);
+        r1.set_crop({8, 4, 4, 4});
+        r1.render(sl, c1, rtt1, cropped);
+        assert(cropped->get_value(8, 6, CostChannel::TraversalSteps) >= 4);
+        assert(cropped->get_value(0, 0, CostChannel::TileTime) == 0);
+
+        // Also through the render options
+        auto async = make_shared<CostMap>(16, 12);
+        RT_RENDER_OPTIONS options;
+        options.cost_map = async;
+        const RenderStatus status = r1.renderAsync(sl, c1, rtt1, options)->wait();
+        assert(status == RenderStatus::Completed);
+        assert(async->get_value(8, 6, CostChannel::TileTime) > 0);
+
+        try {
+            r1.render(sl, c1, rtt1, make_shared<CostMap>(8, 12));
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            options.cost_map = make_shared<CostMap>(16, 6);
+            auto job = r1.renderAsync(sl, c1, rtt1, options);
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestRendererIrradianceCache() {
+        std::cout << "\t[Renderer] Testing the irradiance cache..." << std::endl;
+        // A sphere resting on the ground, light bouncing between them
+        auto sl = make_shared<SphereList>();
+        sl->Add(make_shared<Sphere>(vec3(0, 0, -1000), 1000, Color(0.5, 0.5, 0.5)));
+        sl->Add(make_shared<Sphere>(vec3(0, 0, 1), 1, Color(0.8, 0.3, 0.3)));
+        auto c1 = make_shared<Camera>(vec3(0, -6, 2), vec3(0, 0, 0.5));
+        auto r1 = Renderer(64, 8);
+
+        auto r2 = r1;
+        r2.set_irradiance_cache({true});
+        assert(r2.get_irradiance_cache().enabled);
+        const auto cache = r2.buildIrradianceCache(sl, c1, 24, 18);
+        assert(cache->size() > 0);
+        vec3 irradiance;
+        for (size_t i = 0; i < cache->size(); i++) {
+            const auto &record = cache->get_record(i);
+            assert(record.radius >= cache->get_min_spacing() && record.radius <= cache->get_max_spacing());
+            assert(cache->lookup(record.position, record.normal, irradiance));
+        }
+
+        // Converges to the same image as path tracing
+        auto traced = make_shared<RenderTarget>(24, 18);
+        auto cached = make_shared<RenderTarget>(24, 18);
+        r1.render(sl, c1, traced);
+        r2.render(sl, c1, cached);
+        vec3 traced_sum{0}, cached_sum{0};
+        for (int y = 0; y < 18; y++) {
+            for (int x = 0; x < 24; x++) {
+                traced_sum += traced->get_pixel(x, y).get_color();
+                cached_sum += cached->get_pixel(x, y).get_color();
+            }
+        }
+        for (int c = 0; c < 3; c++)
+            assert(std::fabs(cached_sum[c] - traced_sum[c]) < 0.03f * traced_sum[c]);
+
+        // Too few bounces to reach a second hit's light
+        auto r3 = Renderer(4, 2);
+        r3.set_irradiance_cache({true});
+        assert(r3.buildIrradianceCache(sl, c1, 24, 18)->size() == 0);
+
+        try {
+            r2.set_irradiance_cache({true, 0});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            r2.set_irradiance_cache({true, 0.3f, 0});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            r2.set_irradiance_cache({true, 0.3f, 8, 2, 1});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            static_cast<void>(r2.buildIrradianceCache(nullptr, c1, 24, 18));
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestRendererPathGuiding() {
+        std::cout << "\t[Renderer] Testing path guiding..." << std::endl;
+        // A sphere resting on the ground, light bouncing between them
+        auto sl = make_shared<SphereList>();
+        sl->Add(make_shared<Sphere>(vec3(0, 0, -1000), 1000, Color(0.5, 0.5, 0.5)));
+        sl->Add(make_shared<Sphere>(vec3(0, 0, 1), 1, Color(0.8, 0.3, 0.3)));
+        auto c1 = make_shared<Camera>(vec3(0, -6, 2), vec3(0, 0, 0.5));
+        auto r1 = Renderer(64, 8);
+
+        auto r2 = Renderer(33, 8);
+        r2.set_path_guiding({true, 5});
+        assert(r2.get_path_guiding().enabled);
+        assert(r2.get_path_guiding().training_passes == 5);
+        const auto guide = r2.trainPathGuide(sl, c1, 24, 18);
+        assert(guide->get_region_count() >= PathGuide::NORMAL_BINS);
+        bool trained = false;
+        for (uint32_t region = 0; region < guide->get_region_count(); region++)
+            trained = trained || guide->is_trained(region);
+        assert(trained);
+
+        // Converges to the same image as path tracing, the 31 training samples making up the rest
+        auto traced = make_shared<RenderTarget>(24, 18);
+        auto guided = make_shared<RenderTarget>(24, 18);
+        r1.render(sl, c1, traced);
+        r2.render(sl, c1, guided);
+        vec3 traced_sum{0}, guided_sum{0};
+        for (int y = 0; y < 18; y++) {
+            for (int x = 0; x < 24; x++) {
+                traced_sum += traced->get_pixel(x, y).get_color();
+                guided_sum += guided->get_pixel(x, y).get_color();
+            }
+        }
+        for (int c = 0; c < 3; c++)
+            assert(std::fabs(guided_sum[c] - traced_sum[c]) < 0.03f * traced_sum[c]);
+
+        try {
+            r2.set_path_guiding({true, 0});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            r2.set_path_guiding({true, 5, 1});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            static_cast<void>(r2.trainPathGuide(nullptr, c1, 24, 18));
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestRendererTemporalHistory() {
+        std::cout << "\t[Renderer] Testing the temporal history..." << std::endl;
+        auto sl = make_shared<SphereList>();
+        sl->Add(make_shared<Sphere>(vec3(0, 0, -1000), 1000, Color(0.5, 0.5, 0.5)));
+        sl->Add(make_shared<Sphere>(vec3(0, 0, 1), 1, Color(0.8, 0.3, 0.3)));
+        auto c1 = make_shared<Camera>(vec3(0, -6, 2), vec3(0, 0, 0.5));
+        auto c2 = make_shared<Camera>(vec3(0.2f, -6, 2), vec3(0, 0, 0.5));
+        auto r1 = Renderer(4, 8);
+
+        // Frames of a still camera keep adding up, the sky above the ground keeps nothing
+        auto history = make_shared<TemporalHistory>(24, 18);
+        auto frame = make_shared<RenderTarget>(24, 18);
+        for (int i = 0; i < 3; i++)
+            r1.render(sl, c1, frame, nullptr, history);
+        assert(history->get_frames() == 3);
+        assert(history->get_samples(12, 12) == 12);
+        assert(history->get_samples(12, 0) == 0);
+
+        // A moving camera still reuses most of the last frame, and ends close to a plain render with many samples
+        r1.render(sl, c2, frame, nullptr, history);
+        assert(history->get_samples(12, 12) > 4);
+        auto traced = make_shared<RenderTarget>(24, 18);
+        Renderer(64, 8).render(sl, c2, traced);
+        vec3 traced_sum{0}, frame_sum{0};
+        for (int y = 0; y < 18; y++) {
+            for (int x = 0; x < 24; x++) {
+                traced_sum += traced->get_pixel(x, y).get_color();
+                frame_sum += frame->get_pixel(x, y).get_color();
+            }
+        }
+        for (int c = 0; c < 3; c++)
+            assert(std::fabs(frame_sum[c] - traced_sum[c]) < 0.05f * traced_sum[c]);
+
+        try {
+            r1.render(sl, c1, frame, nullptr, make_shared<TemporalHistory>(24, 17));
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestRendererInstances() {
+        std::cout << "\t[Renderer] Testing rendering instances..." << std::endl;
+        SphereList pair;
+        pair.Add(make_shared<Sphere>(vec3(-0.6f, 0, 0), 0.5, Color(0.8, 0.3, 0.3)));
+        pair.Add(make_shared<Sphere>(vec3(0.6f, 0, 0), 0.5, Color(0.3, 0.3, 0.8)));
+        const auto group = make_shared<const SphereGroup>(pair);
+
+        // Three copies of the pair, and the same six spheres written out
+        auto instances = make_shared<InstancedSphereList>();
+        instances->AddGroup(group);
+        auto sl = make_shared<SphereList>();
+        sl->Add(make_shared<Sphere>(vec3(0, 0, -1000), 1000, Color(0.5, 0.5, 0.5)));
+        const vec3 offsets[3] = {vec3(-2, 0, 1), vec3(0, 2, 1), vec3(2, 0, 1.5f)};
+        const float scales[3] = {1, 1, 1.5f};
+        for (int n = 0; n < 3; n++) {
+            instances->AddInstance(0, mat3(scales[n]), offsets[n]);
+            for (const auto &sphere: pair.get_spheres())
+                sl->Add(make_shared<Sphere>(scales[n] * sphere->get_position() + offsets[n],
+                                            scales[n] * sphere->get_radius(), sphere->get_color()));
+        }
+        auto ground = make_shared<SphereList>();
+        ground->Add(sl->get_spheres()[0]);
+        instances->AddGroup(make_shared<const SphereGroup>(*ground));
+        instances->AddInstance(1, mat3(1), vec3(0));
+        auto camera = make_shared<Camera>(vec3(0, -8, 3), vec3(0, 0, 1));
+        auto r1 = Renderer(16, 8);
+
+        try {
+            r1.render(instances, camera, make_shared<RenderTarget>(24, 18));
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+        instances->Build();
+
+        // Both scenes are the same spheres, so their images agree up to noise
+        auto instanced = make_shared<RenderTarget>(24, 18);
+        auto expanded = make_shared<RenderTarget>(24, 18);
+        r1.render(instances, camera, instanced);
+        r1.render(sl, camera, expanded);
+        vec3 instanced_sum{0}, expanded_sum{0};
+        for (int y = 0; y < 18; y++) {
+            for (int x = 0; x < 24; x++) {
+                instanced_sum += instanced->get_pixel(x, y).get_color();
+                expanded_sum += expanded->get_pixel(x, y).get_color();
+            }
+        }
+        for (int c = 0; c < 3; c++)
+            assert(std::fabs(instanced_sum[c] - expanded_sum[c]) < 0.05f * expanded_sum[c]);
+
+        try {
+            r1.render(shared_ptr<InstancedSphereList>(), camera, instanced);
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto r2 = Renderer(4, 8);
+            r2.set_irradiance_cache({true});
+            r2.render(instances, camera, instanced);
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
     static void TestRendererInitializeRTCamera() {
         std::cout << "\t[Renderer] Testing initializeRTCamera..." << std::endl;
         auto r1 = Renderer(10, 20);
@@ -129,6 +626,126 @@ namespace BlunderTest {
         }
     }
 
+    static void TestRendererGetRaysInTile() {
+        std::cout << "\t[Renderer] Testing getRaysInTile..." << std::endl;
+        auto camera = make_shared<Camera>(vec3(0), vec3(1));
+        auto rtt = make_shared<RenderTarget>(100, 100);
+        auto rtcv = Renderer::initializeRTCamera(camera, rtt);
+        RT_RAY_BATCH batch{};
+
+        Renderer::getRaysInTile(10, 20, 4, 2, 3, rtcv, batch);
+        assert(batch.size() == 24);
+
+        // Every ray should start at the camera and pass through its own pixel
+        size_t k = 0;
+        for (int j = 20; j < 22; j++) {
+            for (int i = 10; i < 14; i++) {
+                for (int s = 0; s < 3; s++, k++) {
+                    auto ray = batch.get_ray(k);
+                    assert(ray.get_position() == rtcv.position);
+
+                    auto center = rtcv.pixel_upper_left + static_cast<float>(i) * rtcv.pixel_delta_u
+                                  + static_cast<float>(j) * rtcv.pixel_delta_v - rtcv.position;
+                    auto offset = ray.get_direction() - center;
+                    auto offset_u = dot(offset, rtcv.pixel_delta_u) / length2(rtcv.pixel_delta_u);
+                    auto offset_v = dot(offset, rtcv.pixel_delta_v) / length2(rtcv.pixel_delta_v);
+                    assert(offset_u >= -0.501f && offset_u <= 0.501f);
+                    assert(offset_v >= -0.501f && offset_v <= 0.501f);
+                }
+            }
+        }
+
+        // Each pixel's offsets depend on the seed and the pixel alone, not on the block it is generated in
+        RT_RAY_BATCH single{};
+        Renderer::getRaysInTile(11, 21, 1, 1, 3, rtcv, single);
+        for (size_t s = 0; s < 3; s++)
+            assert(single.get_ray(s).get_direction() == batch.get_ray(15 + s).get_direction());
+        Renderer::getRaysInTile(11, 21, 1, 1, 3, rtcv, single, 1);
+        assert(single.get_ray(0).get_direction() != batch.get_ray(15).get_direction());
+
+        try {
+            Renderer::getRaysInTile(-1, 0, 4, 2, 3, rtcv, batch);
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            Renderer::getRaysInTile(0, 0, 0, 2, 3, rtcv, batch);
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestRendererSeed() {
+        std::cout << "\t[Renderer] Testing seeded renders..." << std::endl;
+        auto sl = make_shared<SphereList>();
+        sl->Add(make_shared<Sphere>(vec3(0), 2, Color(0.8, 0.3, 0.3)));
+        sl->Add(make_shared<Sphere>(vec3(0, 0, -102), 100, Color(0.5, 0.5, 0.5)));
+        auto c1 = make_shared<Camera>(vec3(0, -10, 1), vec3(0));
+
+        // Whatever tiles a pixel falls in and whenever it is traced, the same seed gives it the same value
+        auto r1 = Renderer(4, 5);
+        r1.set_tiling({8, 8, TileOrder::Hilbert});
+        auto first = make_shared<RenderTarget>(32, 24);
+        r1.render(sl, c1, first);
+        r1.set_tiling({16, 4, TileOrder::RowMajor});
+        auto second = make_shared<RenderTarget>(32, 24);
+        r1.render(sl, c1, second);
+
+        r1.set_seed(7);
+        assert(r1.get_seed() == 7);
+        auto reseeded = make_shared<RenderTarget>(32, 24);
+        r1.render(sl, c1, reseeded);
+
+        bool differs = false;
+        for (int y = 0; y < 24; y++) {
+            for (int x = 0; x < 32; x++) {
+                assert(first->get_radiance(x, y) == second->get_radiance(x, y));
+                differs = differs || reseeded->get_radiance(x, y) != first->get_radiance(x, y);
+            }
+        }
+        assert(differs);
+    }
+
+    static void TestRendererTileSeesSpheres() {
+        std::cout << "\t[Renderer] Testing tileSeesSpheres..." << std::endl;
+        auto camera = make_shared<Camera>(vec3(0, -10, 0), vec3(0));
+        auto rtt = make_shared<RenderTarget>(64, 64);
+        auto rtcv = Renderer::initializeRTCamera(camera, rtt);
+
+        auto sl = make_shared<SphereList>();
+        sl->Add(make_shared<Sphere>(vec3(0), 0.5, Color(0, 0, 1)));
+        sl->Add(make_shared<Sphere>(vec3(0, 20, 0), 1, Color(1, 0, 0)));
+        sl->Add(make_shared<Sphere>(vec3(0, -20, 0), 1, Color(0, 1, 0)));
+
+        // The center tile sees the spheres in front of the camera, the corner sees none of them
+        assert(Renderer::tileSeesSpheres({24, 24, 16, 16}, rtcv, *sl->get_accelerator()));
+        assert(!Renderer::tileSeesSpheres({0, 0, 8, 8}, rtcv, *sl->get_accelerator()));
+        assert(!Renderer::tileSeesSpheres({24, 24, 16, 16}, rtcv, SphereGroup(SphereList())));
+
+        // A tile filled with the sky must not hide a sphere one of its camera rays hits
+        for (int k = 0; k < 32; k++)
+            sl->Add(make_shared<Sphere>(vec3(random_float(-4, 4), random_float(-4, 4), random_float(-4, 4)),
+                                        random_float(0.05, 0.5), Color(1, 1, 1)));
+        const auto group = sl->get_accelerator();
+        for (const auto &tile: Tiling::makeTiles(64, 64, {8, 8, TileOrder::RowMajor})) {
+            if (Renderer::tileSeesSpheres(tile, rtcv, *group))
+                continue;
+            RT_RAY_BATCH batch{};
+            Renderer::getRaysInTile(tile.x, tile.y, tile.width, tile.height, 2, rtcv, batch);
+            for (size_t r = 0; r < batch.size(); r++) {
+                HitRecord record{};
+                assert(!group->Hit(batch.get_ray(r), 0.001, 1000000, record));
+            }
+        }
+    }
+
     static void TestRendererGetRayColor() {
         std::cout << "\t[Renderer] Testing getRayColor..." << std::endl;
         auto r1 = Renderer(10, 20);
@@ -162,9 +779,21 @@ namespace BlunderTest {
     static void TestRendererScatter() {
         std::cout << "\t[Renderer] Testing scatter..." << std::endl;
         auto hit_record = HitRecord{};
+        hit_record.set_point(vec3(0));
+        hit_record.set_normal(vec3(0, 0, 1));
         auto ray = Ray(vec3(0), vec3(1));
         auto r1 = Renderer(10, 20);
         assert(r1.scatter(hit_record, ray) == true);
+
+        // Seeding restarts the bounce directions too, even with some of them drawn ahead
+        Renderer::seedRandom(7);
+        Ray first = ray, other = ray;
+        Renderer::scatter(hit_record, first);
+        Renderer::scatter(hit_record, other);
+        Renderer::seedRandom(7);
+        Ray again = ray;
+        Renderer::scatter(hit_record, again);
+        assert(again.get_direction() == first.get_direction());
     }
 
     static void TestRendererSetSamples() {
@@ -221,15 +850,133 @@ namespace BlunderTest {
         }
     }
 
+    static void TestRendererSetTiling() {
+        std::cout << "\t[Renderer] Testing set_tiling..." << std::endl;
+        auto r1 = Renderer(10, 10);
+        r1.set_tiling({32, 16, TileOrder::Morton});
+        assert(r1.get_tiling().tile_width == 32 && r1.get_tiling().tile_height == 16);
+        assert(r1.get_tiling().order == TileOrder::Morton);
+        r1.set_tiling({0, 0, TileOrder::Hilbert});
+        assert(r1.get_tiling().tile_width == 0 && r1.get_tiling().order == TileOrder::Hilbert);
+
+        try {
+            r1.set_tiling({0, 16, TileOrder::Hilbert});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            r1.set_tiling({-8, -8, TileOrder::Hilbert});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestRendererCrop() {
+        std::cout << "\t[Renderer] Testing set_crop, parseCrop and cropped render..." << std::endl;
+        auto r1 = Renderer(2, 2);
+        r1.set_crop({16, 8, 32, 32});
+        assert(r1.get_crop().x == 16 && r1.get_crop().y == 8);
+        assert(r1.get_crop().width == 32 && r1.get_crop().height == 32);
+
+        const auto parsed = Renderer::parseCrop("3,2,4,5");
+        assert(parsed.x == 3 && parsed.y == 2 && parsed.width == 4 && parsed.height == 5);
+
+        // Only pixels inside the window are written, the sky is never black so every traced pixel changes
+        auto sl = make_shared<SphereList>();
+        sl->Add(make_shared<Sphere>(vec3(0), 0.5, Color(0, 0, 1)));
+        auto c1 = make_shared<Camera>(vec3(0, -10, 5), vec3(0));
+        auto rtt1 = make_shared<RenderTarget>(12, 9);
+        r1.set_crop(parsed);
+        r1.render(sl, c1, rtt1);
+        for (int y = 0; y < 9; y++) {
+            for (int x = 0; x < 12; x++) {
+                const bool inside = x >= 3 && x < 7 && y >= 2 && y < 7;
+                assert((rtt1->get_radiance(x, y) != vec3(0)) == inside);
+            }
+        }
+
+        // Pixels draw their random numbers by position, so a crop matches the same region of a full render exactly
+        auto r2 = Renderer(4, 4);
+        r2.set_tiling({4, 4, TileOrder::Hilbert});
+        auto scene = make_shared<SphereList>();
+        scene->Add(make_shared<Sphere>(vec3(0), 2, Color(0.8, 0.3, 0.3)));
+        scene->Add(make_shared<Sphere>(vec3(0, 0, -102), 100, Color(0.5, 0.5, 0.5)));
+        auto full = make_shared<RenderTarget>(24, 18);
+        r2.render(scene, c1, full);
+        auto cropped = make_shared<RenderTarget>(24, 18);
+        r2.set_crop({5, 3, 11, 9});
+        r2.render(scene, c1, cropped);
+        for (int y = 3; y < 12; y++)
+            for (int x = 5; x < 16; x++)
+                assert(cropped->get_radiance(x, y) == full->get_radiance(x, y));
+
+        try {
+            r1.set_crop({10, 0, 4, 4});
+            r1.render(sl, c1, rtt1);
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            r1.set_crop({-1, 0, 32, 32});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            r1.set_crop({0, 0, 32, 0});
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto bad = Renderer::parseCrop("16,8,32");
+            assert(false);
+        } catch (RendererException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
     static void TestRendererAll() {
         std::cout << "[Unit Test] Testing Renderer..." << std::endl;
         TestRendererConstructor();
         TestRendererRender();
+        TestRendererRenderAsync();
+        TestRendererRenderFramebuffer();
+        TestRendererCostMap();
+        TestRendererIrradianceCache();
+        TestRendererPathGuiding();
+        TestRendererTemporalHistory();
+        TestRendererInstances();
         TestRendererInitializeRTCamera();
         TestRendererGetRayAtPixel();
+        TestRendererGetRaysInTile();
+        TestRendererSeed();
+        TestRendererTileSeesSpheres();
         TestRendererGetRayColor();
         TestRendererGetSkyColor();
+        TestRendererScatter();
         TestRendererSetSamples();
         TestRendererSetMaxDepth();
+        TestRendererSetTiling();
+        TestRendererCrop();
     }
 }
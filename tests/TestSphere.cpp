@@ -20,6 +20,43 @@ namespace BlunderTest {
         }
     }
 
+    static void TestSphereIntersect() {
+        std::cout << "\t[Sphere] Testing Sphere Intersect..." << std::endl;
+        auto s1 = Sphere(vec3(0, 0, 0), 1, Color(1, 1, 1));
+        auto ray = Ray(vec3(0, -2, 0), vec3(0, 1, 0));
+        float t = -1;
+        assert(s1.Intersect(ray, 0, 100000, t) == true);
+        assert(t == 1);
+
+        t = -1;
+        assert(s1.Intersect(ray, 0, 0.5, t) == false);
+        assert(t == -1);
+
+        ray.set_direction(vec3(0, -1, 0));
+        assert(s1.Intersect(ray, 0, 100000, t) == false);
+    }
+
+    static void TestSphereRecordHit() {
+        std::cout << "\t[Sphere] Testing Sphere RecordHit..." << std::endl;
+        auto s1 = Sphere(vec3(0, 0, 0), 1, Color(0.5, 0.5, 0.5));
+        auto ray = Ray(vec3(0, -2, 0), vec3(0, 1, 0));
+        auto hitRecord = HitRecord();
+        s1.RecordHit(ray, 1, hitRecord);
+        assert(hitRecord.get_t() == 1);
+        assert(is_near_equal(hitRecord.get_point(), vec3(0, -1, 0)));
+        assert(is_near_equal(hitRecord.get_normal(), vec3(0, -1, 0)));
+        assert(hitRecord.get_color().get_color() == vec3(0.5));
+
+        try {
+            s1.RecordHit(ray, -1, hitRecord);
+            assert(false);
+        } catch (HitRecordException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
     static void TestSphereSetPosition() {
         std::cout << "\t[Sphere] Testing SetPosition..." << std::endl;
         auto s1 = Sphere(vec3(0, 0, 0), 1, Color(1, 1, 1));
@@ -73,6 +110,8 @@ namespace BlunderTest {
     static void TestSphereAll() {
         std::cout << "[Unit Testing] Testing Sphere..." << std::endl;
         TestSphereHit();
+        TestSphereIntersect();
+        TestSphereRecordHit();
         TestSphereSetPosition();
         TestSphereSetRadius();
         TestSphereSetColor();
@@ -0,0 +1,197 @@
+#include <Utils/Headers.h>
+#include <Geometry/SphereGroup.h>
+
+namespace BlunderTest {
+    static void TestSphereGroupHierarchy() {
+        std::cout << "\t[SphereGroup] Testing the bounding volume hierarchy..." << std::endl;
+        std::vector<vec3> minimums, maximums;
+        for (int i = 0; i < 100; i++) {
+            const vec3 center(static_cast<float>(i), 0, 0);
+            minimums.push_back(center - vec3(0.25f));
+            maximums.push_back(center + vec3(0.25f));
+        }
+
+        std::vector<uint32_t> order;
+        const BoundingVolumeHierarchy bvh(minimums, maximums, order);
+        assert(order.size() == 100);
+        assert(bvh.size() == BoundingVolumeHierarchy::NodeCount(100));
+        assert(BoundingVolumeHierarchy::NodeCount(0) == 0 && BoundingVolumeHierarchy::NodeCount(4) == 1);
+        assert(bvh.get_node(0).minimum == vec3(-0.25f) && bvh.get_node(0).maximum == vec3(99.25f, 0.25f, 0.25f));
+
+        // Every item sits in exactly one leaf, inside its leaf's box
+        std::vector<int> seen(100, 0);
+        for (size_t n = 0; n < bvh.size(); n++) {
+            const RT_BVH_NODE &node = bvh.get_node(n);
+            assert(node.count <= BoundingVolumeHierarchy::LEAF_SIZE);
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                seen[order[i]]++;
+                assert(minimums[order[i]].x >= node.minimum.x && maximums[order[i]].x <= node.maximum.x);
+            }
+        }
+        for (const int count: seen)
+            assert(count == 1);
+
+        // A ray along y through item 42 only reaches the leaf holding it
+        int leaves = 0;
+        const bool hit = bvh.Traverse(vec3(42, -10, 0), 1.0f / vec3(0, 1, 0), 0, 100,
+                                      [&](const uint32_t first, const uint32_t count, float &) {
+                                          leaves++;
+                                          bool found = false;
+                                          for (uint32_t i = first; i < first + count; i++)
+                                              found = found || order[i] == 42;
+                                          return found;
+                                      });
+        assert(hit && leaves == 1);
+        assert(!bvh.Traverse(vec3(42, -10, 5), 1.0f / vec3(0, 1, 0), 0, 100,
+            [](uint32_t, uint32_t, float &) { return true; }));
+
+        // Refit boxes follow the items, the tree stays the same
+        BoundingVolumeHierarchy refit = bvh;
+        std::vector<vec3> moved_minimums(100), moved_maximums(100);
+        for (size_t i = 0; i < 100; i++) {
+            moved_minimums[i] = minimums[order[i]] + vec3(0, 0, 10);
+            moved_maximums[i] = maximums[order[i]] + vec3(0, 0, 10);
+        }
+        refit.Refit(moved_minimums, moved_maximums);
+        assert(refit.size() == bvh.size());
+        assert(refit.get_node(0).minimum == vec3(-0.25f, -0.25f, 9.75f));
+        assert(refit.get_node(0).maximum == vec3(99.25f, 0.25f, 10.25f));
+
+        try {
+            moved_minimums.pop_back();
+            moved_maximums.pop_back();
+            refit.Refit(moved_minimums, moved_maximums);
+            assert(false);
+        } catch (BoundingVolumeHierarchyException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            minimums.pop_back();
+            auto bad = BoundingVolumeHierarchy(minimums, maximums, order);
+            assert(false);
+        } catch (BoundingVolumeHierarchyException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestSphereGroupHit() {
+        std::cout << "\t[SphereGroup] Testing Hit and Occluded against SphereList..." << std::endl;
+        SphereList list;
+        for (int i = 0; i < 200; i++)
+            list.Add(make_shared<Sphere>(vec3(random_float(-8, 8), random_float(-8, 8), random_float(-8, 8)),
+                                         random_float(0.1, 0.8), Color(i % 3 == 0, i % 3 == 1, i % 3 == 2)));
+        const SphereGroup group(list);
+        assert(group.size() == 200);
+        assert(group.get_hierarchy().size() > 1);
+
+        // The hierarchy only skips spheres, so the closest hit stays the same
+        for (int k = 0; k < 1000; k++) {
+            const Ray ray(vec3(random_float(-10, 10), -12, random_float(-10, 10)), random_unit_vector());
+            HitRecord expected{}, actual{};
+            const bool hit = list.Hit(ray, 0.001, 1000000, expected);
+            assert(group.Hit(ray, 0.001, 1000000, actual) == hit);
+            assert(group.Occluded(ray, 0.001, 1000000) == list.Occluded(ray, 0.001, 1000000));
+            if (hit) {
+                assert(std::fabs(actual.get_t() - expected.get_t()) < 1e-3f);
+                assert(length(actual.get_normal() - expected.get_normal()) < 1e-3f);
+                assert(actual.get_color().get_color() == expected.get_color().get_color());
+            }
+
+            // The same ray given by its vectors finds the same hit
+            HitRecord raw{};
+            const bool rawHit = group.Hit(ray.get_position(), ray.get_direction(), 0.001, 1000000, raw);
+            assert(rawHit == hit);
+            assert(!hit || (raw.get_t() == actual.get_t() && raw.get_point() == actual.get_point()));
+        }
+
+        try {
+            HitRecord record{};
+            group.Hit(vec3(0), vec3(0, 1, 0), 10, 1, record);
+            assert(false);
+        } catch (SphereGroupException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            HitRecord record{};
+            group.Hit(Ray(vec3(0), vec3(0, 1, 0)), 10, 1, record);
+            assert(false);
+        } catch (SphereGroupException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        HitRecord record{};
+
+        // Only the spheres of the leaves a ray reaches are tested
+        SphereList row;
+        for (int i = 0; i < 100; i++)
+            row.Add(make_shared<Sphere>(vec3(static_cast<float>(i), 0, 0), 0.25f, Color(1, 0, 0)));
+        const SphereGroup rowGroup(row);
+        RT_BVH_COUNTS counts;
+        assert(rowGroup.Hit(Ray(vec3(42, -10, 0), vec3(0, 1, 0)), 0.001, 1000, record, &counts));
+        assert(counts.tests > 0 && counts.tests <= BoundingVolumeHierarchy::LEAF_SIZE);
+        assert(counts.nodes > 1 && counts.nodes < rowGroup.get_hierarchy().size());
+
+        // An empty group is an empty scene
+        const SphereGroup empty{SphereList()};
+        assert(empty.size() == 0 && !empty.Hit(Ray(vec3(0), vec3(0, 1, 0)), 0.001, 1000, record));
+        assert(!empty.Occluded(Ray(vec3(0), vec3(0, 1, 0)), 0.001, 1000));
+    }
+
+    static void TestSphereGroupRefit() {
+        std::cout << "\t[SphereGroup] Testing Refit against SphereList..." << std::endl;
+        SphereList list;
+        for (int i = 0; i < 200; i++)
+            list.Add(make_shared<Sphere>(vec3(random_float(-8, 8), random_float(-8, 8), random_float(-8, 8)),
+                                         random_float(0.1, 0.8), Color(1, 0, 0)));
+        SphereGroup group(list);
+        const size_t nodes = group.get_hierarchy().size();
+
+        // Every sphere moves and grows, some change color, and the tree keeps its shape
+        for (const auto &sphere: list.get_spheres()) {
+            sphere->set_position(sphere->get_position() + vec3(random_float(-3, 3), random_float(-3, 3), 0));
+            sphere->set_radius(sphere->get_radius() * 1.5f);
+            if (random_float() < 0.25f)
+                sphere->set_color(Color(0, 0, 1));
+        }
+        group.Refit(list);
+        assert(group.get_hierarchy().size() == nodes);
+
+        for (int k = 0; k < 1000; k++) {
+            const Ray ray(vec3(random_float(-10, 10), -12, random_float(-10, 10)), random_unit_vector());
+            HitRecord expected{}, actual{};
+            const bool hit = list.Hit(ray, 0.001, 1000000, expected);
+            assert(group.Hit(ray, 0.001, 1000000, actual) == hit);
+            if (hit) {
+                assert(std::fabs(actual.get_t() - expected.get_t()) < 1e-3f);
+                assert(actual.get_color().get_color() == expected.get_color().get_color());
+            }
+        }
+
+        try {
+            list.Add(make_shared<Sphere>(vec3(0), 1, Color(1, 0, 0)));
+            group.Refit(list);
+            assert(false);
+        } catch (SphereGroupException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestSphereGroupAll() {
+        std::cout << "[Unit Test] Testing SphereGroup..." << std::endl;
+        TestSphereGroupHierarchy();
+        TestSphereGroupHit();
+        TestSphereGroupRefit();
+    }
+}
@@ -1,6 +1,7 @@
 #include <Utils/Headers.h>
 #include <Geometry/SphereList.h>
 #include <Geometry/Sphere.h>
+#include <Geometry/SphereGroup.h>
 
 namespace BlunderTest {
     static void TestSphereList() {
@@ -23,8 +24,95 @@ namespace BlunderTest {
         }
     }
 
+    static void TestSphereListClosestHit() {
+        std::cout << "\t[SphereList] Testing SphereList closest hit..." << std::endl;
+        auto spheres = make_shared<SphereList>();
+        spheres->Add(make_shared<Sphere>(vec3(0, 5, 0), 1, Color(1, 0, 0)));
+        spheres->Add(make_shared<Sphere>(vec3(0, 2, 0), 1, Color(0, 1, 0)));
+        spheres->Add(make_shared<Sphere>(vec3(0, 8, 0), 1, Color(0, 0, 1)));
+        auto ray = Ray(vec3(0, -2, 0), vec3(0, 1, 0));
+        auto hitRecord = HitRecord();
+
+        assert(spheres->Hit(ray, 0, 10000, hitRecord) == true);
+        assert(hitRecord.get_t() == 3);
+        assert(is_near_equal(hitRecord.get_point(), vec3(0, 1, 0)));
+        assert(is_near_equal(hitRecord.get_normal(), vec3(0, -1, 0)));
+        assert(hitRecord.get_color().get_color() == vec3(0, 1, 0));
+
+        ray.set_direction(vec3(0, -1, 0));
+        assert(spheres->Hit(ray, 0, 10000, hitRecord) == false);
+    }
+
+    static void TestSphereListOccluded() {
+        std::cout << "\t[SphereList] Testing SphereList Occluded..." << std::endl;
+        auto spheres = make_shared<SphereList>();
+        spheres->Add(make_shared<Sphere>(vec3(0, 5, 0), 1, Color(1, 0, 0)));
+        spheres->Add(make_shared<Sphere>(vec3(0, 2, 0), 1, Color(0, 1, 0)));
+        auto ray = Ray(vec3(0, -2, 0), vec3(0, 1, 0));
+
+        assert(spheres->Occluded(ray, 0, 10000) == true);
+        assert(spheres->Occluded(ray, 0, 2.5) == false);
+        assert(spheres->Occluded(ray, 3.5, 10000) == true);
+
+        ray.set_direction(vec3(0, -1, 0));
+        assert(spheres->Occluded(ray, 0, 10000) == false);
+
+        try {
+            auto isOccluded = spheres->Occluded(ray, -infinity, infinity);
+            assert(false);
+        } catch (SphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            spheres->Add(nullptr);
+            auto isOccluded = spheres->Occluded(ray, 0, 10000);
+            assert(false);
+        } catch (SphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestSphereListAccelerator() {
+        std::cout << "\t[SphereList] Testing get_accelerator..." << std::endl;
+        SphereList list;
+        const auto sphere = make_shared<Sphere>(vec3(0), 1, Color(1, 0, 0));
+        list.Add(sphere);
+
+        // Built once, shared until the spheres change
+        const auto group = list.get_accelerator();
+        assert(group->size() == 1 && list.get_accelerator() == group);
+        list.Add(make_shared<Sphere>(vec3(5, 0, 0), 1, Color(0, 1, 0)));
+        assert(list.get_accelerator() != group && list.get_accelerator()->size() == 2);
+
+        // Spheres changed in place are traced where they moved to once refit
+        sphere->set_position(vec3(0, 0, 10));
+        list.Refit();
+        HitRecord record{};
+        assert(list.get_accelerator()->Hit(Ray(vec3(0, -5, 10), vec3(0, 1, 0)), 0.001, 1000, record));
+        assert(std::fabs(record.get_t() - 4) < 1e-4f);
+
+        try {
+            SphereList bad;
+            bad.Add(nullptr);
+            auto unused = bad.get_accelerator();
+            assert(false);
+        } catch (PackedSphereListException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
     static void TestSphereListAll() {
         std::cout << "[Unit Testing] Testing SphereList..." << std::endl;
         TestSphereList();
+        TestSphereListClosestHit();
+        TestSphereListOccluded();
+        TestSphereListAccelerator();
     }
 }
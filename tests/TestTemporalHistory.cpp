@@ -0,0 +1,127 @@
+#include <Utils/Headers.h>
+#include <Renderer/TemporalHistory.h>
+#include <Renderer/Renderer.h>
+
+namespace BlunderTest {
+    static void TestTemporalHistoryConstructor() {
+        std::cout << "\t[TemporalHistory] Testing constructor..." << std::endl;
+        auto history = TemporalHistory(64, 48);
+        assert(history.get_width() == 64);
+        assert(history.get_height() == 48);
+        assert(history.get_frames() == 0);
+        assert(history.get_settings().max_history == 8);
+        assert(history.get_samples(63, 47) == 0);
+
+        try {
+            auto empty = TemporalHistory(0, 48);
+            assert(false);
+        } catch (TemporalHistoryException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto forgetful = TemporalHistory(64, 48, {0});
+            assert(false);
+        } catch (TemporalHistoryException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            auto strict = TemporalHistory(64, 48, {8, 0});
+            assert(false);
+        } catch (TemporalHistoryException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            static_cast<void>(history.get_samples(64, 0));
+            assert(false);
+        } catch (TemporalHistoryException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestTemporalHistoryAccumulate() {
+        std::cout << "\t[TemporalHistory] Testing accumulate and reproject..." << std::endl;
+        const auto camera = Renderer::initializeRTCamera(make_shared<Camera>(vec3(0, -5, 0), vec3(0, 0, 0)), 16, 12);
+        auto history = TemporalHistory(16, 12);
+
+        // A wall 5 units ahead through the center of pixel (8, 6), facing the camera
+        const vec3 center = camera.pixel_upper_left + 8.0f * camera.pixel_delta_u + 6.0f * camera.pixel_delta_v;
+        const vec3 point = camera.position + 5.0f * (center - camera.position) / length(center - camera.position);
+        const vec3 normal(0, -1, 0);
+
+        // The first frame has nothing to reuse
+        vec3 radiance;
+        float samples;
+        history.beginFrame(camera);
+        assert(history.get_frames() == 1);
+        assert(!history.reproject(point, normal, radiance, samples));
+        vec3 blended = history.accumulate(8, 6, point, normal, vec3(0.2f), 4);
+        assert(length(blended - vec3(0.2f)) < 1e-6f);
+        assert(history.get_samples(8, 6) == 4);
+
+        // The next one blends with it, as many samples weighing as much
+        history.beginFrame(camera);
+        assert(history.get_samples(8, 6) == 0);
+        assert(history.reproject(point, normal, radiance, samples));
+        assert(length(radiance - vec3(0.2f)) < 1e-5f);
+        assert(std::fabs(samples - 4) < 1e-4f);
+        blended = history.accumulate(8, 6, point, normal, vec3(0.4f), 4);
+        assert(length(blended - vec3(0.3f)) < 1e-5f);
+        assert(history.get_samples(8, 6) == 8);
+
+        // Surfaces the pixel did not see are not reused
+        assert(!history.reproject(point, -normal, radiance, samples));
+        assert(!history.reproject(2.0f * point - camera.position, normal, radiance, samples));
+        assert(!history.reproject(vec3(0, -10, 0), normal, radiance, samples));
+
+        // After the camera moves, the point is still found where the last frame saw it
+        const auto moved = Renderer::initializeRTCamera(make_shared<Camera>(vec3(0.5f, -5, 0), vec3(0, 0, 0)), 16, 12);
+        history.beginFrame(moved);
+        assert(history.reproject(point, normal, radiance, samples));
+        assert(length(radiance - vec3(0.3f)) < 1e-5f);
+        history.clear(8, 6);
+        assert(history.get_samples(8, 6) == 0);
+
+        // The history is capped at max_history times the new samples
+        auto short_history = TemporalHistory(16, 12, {1});
+        for (int frame = 0; frame < 5; frame++) {
+            short_history.beginFrame(camera);
+            static_cast<void>(short_history.accumulate(8, 6, point, normal, vec3(0.5f), 4));
+        }
+        assert(short_history.get_samples(8, 6) == 8);
+
+        try {
+            static_cast<void>(history.accumulate(-1, 0, point, normal, vec3(0.5f), 4));
+            assert(false);
+        } catch (TemporalHistoryException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            static_cast<void>(history.accumulate(8, 6, point, normal, vec3(0.5f), 0));
+            assert(false);
+        } catch (TemporalHistoryException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestTemporalHistoryAll() {
+        std::cout << "[Unit Test] Testing TemporalHistory..." << std::endl;
+        TestTemporalHistoryConstructor();
+        TestTemporalHistoryAccumulate();
+    }
+}
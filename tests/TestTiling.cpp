@@ -0,0 +1,136 @@
+#include <Utils/Headers.h>
+#include <Renderer/Tiling.h>
+
+namespace BlunderTest {
+    /// Ensures tiles cover every pixel of a width x height image exactly once.
+    static void AssertTilesCoverImage(const std::vector<RT_TILE> &tiles, const int width, const int height) {
+        std::vector<int> covered(static_cast<size_t>(width) * height, 0);
+        for (const auto &tile: tiles)
+            for (int y = tile.y; y < tile.y + tile.height; y++)
+                for (int x = tile.x; x < tile.x + tile.width; x++)
+                    covered[static_cast<size_t>(y) * width + x]++;
+
+        for (const int count: covered)
+            assert(count == 1);
+    }
+
+    static void TestTilingMakeTiles() {
+        std::cout << "\t[Tiling] Testing makeTiles..." << std::endl;
+        const auto row_major = Tiling::makeTiles(100, 50, {32, 32, TileOrder::RowMajor});
+        assert(row_major.size() == 8);
+        assert(row_major.front().x == 0 && row_major.front().y == 0);
+        assert(row_major.front().width == 32 && row_major.front().height == 32);
+        assert(row_major.back().x == 96 && row_major.back().y == 32);
+        assert(row_major.back().width == 4 && row_major.back().height == 18);
+        AssertTilesCoverImage(row_major, 100, 50);
+
+        // Curve orders visit the same tiles, consecutive Hilbert tiles share an edge
+        for (const auto order: {TileOrder::Morton, TileOrder::Hilbert}) {
+            const auto tiles = Tiling::makeTiles(100, 50, {16, 8, order});
+            AssertTilesCoverImage(tiles, 100, 50);
+        }
+
+        const auto hilbert = Tiling::makeTiles(64, 64, {16, 16, TileOrder::Hilbert});
+        assert(hilbert.size() == 16);
+        for (size_t i = 1; i < hilbert.size(); i++)
+            assert(std::abs(hilbert[i].x - hilbert[i - 1].x) + std::abs(hilbert[i].y - hilbert[i - 1].y) == 16);
+
+        // Automatic size
+        AssertTilesCoverImage(Tiling::makeTiles(37, 23, {0, 0, TileOrder::Hilbert}), 37, 23);
+
+        try {
+            Tiling::makeTiles(0, 50, {});
+            assert(false);
+        } catch (TilingException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        try {
+            Tiling::makeTiles(100, 50, {-1, 8, TileOrder::RowMajor});
+            assert(false);
+        } catch (TilingException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestTilingAutoTileSize() {
+        std::cout << "\t[Tiling] Testing autoTileSize..." << std::endl;
+        assert(Tiling::autoTileSize(3840, 2160, 16) == 64);
+        assert(Tiling::autoTileSize(256, 256, 16) == 16);
+        assert(Tiling::autoTileSize(64, 48, 16) == 8);
+
+        try {
+            Tiling::autoTileSize(0, 48, 16);
+            assert(false);
+        } catch (TilingException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+    }
+
+    static void TestTilingCurveIndices() {
+        std::cout << "\t[Tiling] Testing mortonIndex, hilbertIndex..." << std::endl;
+        assert(Tiling::mortonIndex(1, 0) == 1);
+        assert(Tiling::mortonIndex(0, 1) == 2);
+        assert(Tiling::mortonIndex(3, 3) == 15);
+
+        assert(Tiling::hilbertIndex(2, 0, 0) == 0);
+        assert(Tiling::hilbertIndex(2, 0, 1) == 1);
+        assert(Tiling::hilbertIndex(2, 1, 1) == 2);
+        assert(Tiling::hilbertIndex(2, 1, 0) == 3);
+
+        // Every cell of a larger grid gets its own index
+        std::vector<bool> seen(64, false);
+        for (uint32_t y = 0; y < 8; y++)
+            for (uint32_t x = 0; x < 8; x++)
+                seen[Tiling::hilbertIndex(8, x, y)] = true;
+        for (const bool cell: seen)
+            assert(cell);
+    }
+
+    static void TestTilingParse() {
+        std::cout << "\t[Tiling] Testing parseTileOrder, parseTileSize..." << std::endl;
+        assert(Tiling::parseTileOrder("rowmajor") == TileOrder::RowMajor);
+        assert(Tiling::parseTileOrder("morton") == TileOrder::Morton);
+        assert(Tiling::parseTileOrder("hilbert") == TileOrder::Hilbert);
+
+        RT_TILING tiling{};
+        Tiling::parseTileSize("32x16", tiling);
+        assert(tiling.tile_width == 32 && tiling.tile_height == 16);
+        Tiling::parseTileSize("auto", tiling);
+        assert(tiling.tile_width == 0 && tiling.tile_height == 0);
+
+        try {
+            Tiling::parseTileOrder("zorder");
+            assert(false);
+        } catch (TilingException &e) {
+            assert(true);
+        } catch (...) {
+            assert(false);
+        }
+
+        for (const std::string text: {"32", "x16", "32x", "0x16", "32x16px"}) {
+            try {
+                Tiling::parseTileSize(text, tiling);
+                assert(false);
+            } catch (TilingException &e) {
+                assert(true);
+            } catch (...) {
+                assert(false);
+            }
+        }
+    }
+
+    static void TestTilingAll() {
+        std::cout << "[Unit Test] Testing Tiling..." << std::endl;
+        TestTilingMakeTiles();
+        TestTilingAutoTileSize();
+        TestTilingCurveIndices();
+        TestTilingParse();
+    }
+}
@@ -6,9 +6,22 @@
 #include "TestColor.cpp"
 #include "TestHeaders.cpp"
 #include "TestSphereList.cpp"
+#include "TestPackedSphereList.cpp"
 #include "TestRenderTarget.cpp"
 #include "TestHitRecord.cpp"
 #include "TestImporter.cpp"
+#include "TestPostProcess.cpp"
+#include "TestProfiler.cpp"
+#include "TestImageMetrics.cpp"
+#include "TestTiling.cpp"
+#include "TestFileWatcher.cpp"
+#include "TestArena.cpp"
+#include "TestCostMap.cpp"
+#include "TestIrradianceCache.cpp"
+#include "TestPathGuide.cpp"
+#include "TestTemporalHistory.cpp"
+#include "TestSphereGroup.cpp"
+#include "TestInstancedSphereList.cpp"
 
 // Main Function
 int main() {
@@ -20,8 +33,21 @@ int main() {
     BlunderTest::TestRendererAll();
     BlunderTest::TestColorAll();
     BlunderTest::TestSphereListAll();
+    BlunderTest::TestPackedSphereListAll();
     BlunderTest::TestRenderTargetAll();
     BlunderTest::TestHitRecordAll();
     BlunderTest::TestImporterAll();
+    BlunderTest::TestPostProcessAll();
+    BlunderTest::TestProfilerAll();
+    BlunderTest::TestImageMetricsAll();
+    BlunderTest::TestTilingAll();
+    BlunderTest::TestFileWatcherAll();
+    BlunderTest::TestArenaAll();
+    BlunderTest::TestCostMapAll();
+    BlunderTest::TestIrradianceCacheAll();
+    BlunderTest::TestPathGuideAll();
+    BlunderTest::TestTemporalHistoryAll();
+    BlunderTest::TestSphereGroupAll();
+    BlunderTest::TestInstancedSphereListAll();
     std::cout << "[Unit Test] All tests pass!" << std::endl;
 }
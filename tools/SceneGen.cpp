@@ -0,0 +1,414 @@
+// Synthetic scene generator.
+// Writes .blunder scenes with millions of spheres laid out by a chosen distribution, for scale benchmarks and stress
+// tests. Output only depends on the options and the seed, not on the number of threads used to generate it.
+
+#include <Utils/Headers.h>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <sstream>
+
+namespace {
+    /// Ways spheres can be laid out.
+    enum class Distribution {
+        /// Centers uniformly random in a cube.
+        Uniform,
+
+        /// Gaussian clusters around random centers, mostly empty space in between.
+        Clustered,
+
+        /// Regular cubic lattice, filled in x, y, z order.
+        Grid,
+
+        /// Concentric spherical shells around the origin.
+        Shells,
+
+        /// A few small regions packed with heavily overlapping spheres.
+        Clumps
+    };
+
+    /// Ways sphere radii are picked between the minimum and maximum radius.
+    enum class RadiusDistribution {
+        /// Every sphere gets the minimum radius.
+        Fixed,
+
+        /// Uniform between minimum and maximum.
+        Uniform,
+
+        /// Uniform in log space, so small spheres are much more common than large ones.
+        Log
+    };
+
+    /// Generator options.
+    struct Options {
+        std::string output;
+        Distribution distribution = Distribution::Uniform;
+        int64_t count = 1000;
+        RadiusDistribution radius_distribution = RadiusDistribution::Uniform;
+        float radius_min = 0.05f;
+        float radius_max = 0.2f;
+        int palette = 8;
+        uint64_t seed = 1;
+
+        /// Half size of the region spheres are placed in, 0 to scale it with the sphere count.
+        float extent = 0;
+
+        /// Number of clusters or clumps, shells for Distribution::Shells. 0 picks one from the sphere count.
+        int groups = 0;
+
+        int width = 640;
+        int height = 360;
+        int samples = 16;
+        int bounces = 5;
+    };
+
+    constexpr float pi = 3.14159265f;
+
+    /// Spheres generated per block. Every block has its own random stream, so blocks can be generated in any order.
+    constexpr int64_t BLOCK = 1 << 16;
+
+    /// Blocks generated in parallel before they are written out, bounding memory use.
+    constexpr int64_t BLOCKS_PER_BATCH = 64;
+
+    /// SplitMix64, small and good enough for placing spheres.
+    class Random {
+        uint64_t state;
+
+    public:
+        explicit Random(const uint64_t seed) : state(seed) {
+        }
+
+        uint64_t next() {
+            uint64_t z = state += 0x9e3779b97f4a7c15ull;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        /// Uniform in [0, 1).
+        float uniform() {
+            return static_cast<float>(next() >> 40) * 0x1.0p-24f;
+        }
+
+        /// Uniform in [min, max).
+        float uniform(const float min, const float max) {
+            return min + (max - min) * uniform();
+        }
+
+        /// Standard normal, Box-Muller.
+        float normal() {
+            const float u = 1.0f - uniform();
+            return std::sqrt(-2.0f * std::log(u)) * std::cos(2.0f * pi * uniform());
+        }
+
+        /// Uniform direction on the unit sphere.
+        vec3 direction() {
+            const float z = uniform(-1, 1);
+            const float phi = 2.0f * pi * uniform();
+            const float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            return {r * std::cos(phi), r * std::sin(phi), z};
+        }
+    };
+
+    /// Everything derived from the options that every block shares.
+    struct Layout {
+        float extent;
+        int groups;
+
+        /// Cluster or clump centers.
+        std::vector<vec3> centers;
+
+        /// Spheres per grid row.
+        int64_t grid_side;
+    };
+
+    /// Appends value with a fixed number of decimals, much faster than printf for millions of numbers.
+    void append_fixed(std::string &out, const float value, const int decimals) {
+        int64_t scale = 1;
+        for (int d = 0; d < decimals; d++)
+            scale *= 10;
+
+        const auto scaled = static_cast<int64_t>(std::llround(std::fabs(static_cast<double>(value)) * scale));
+        if (value < 0 && scaled != 0)
+            out += '-';
+
+        char digits[24];
+        int length = 0;
+        int64_t whole = scaled / scale;
+        do {
+            digits[length++] = static_cast<char>('0' + whole % 10);
+            whole /= 10;
+        } while (whole > 0);
+        while (length > 0)
+            out += digits[--length];
+
+        if (decimals > 0) {
+            out += '.';
+            int64_t fraction = scaled % scale;
+            for (int d = decimals - 1; d >= 0; d--) {
+                digits[d] = static_cast<char>('0' + fraction % 10);
+                fraction /= 10;
+            }
+            out.append(digits, decimals);
+        }
+    }
+
+    /// Name of palette color i.
+    std::string color_name(const int i) {
+        return "c" + std::to_string(i);
+    }
+
+    float pick_radius(const Options &options, Random &random) {
+        switch (options.radius_distribution) {
+            case RadiusDistribution::Fixed:
+                return options.radius_min;
+            case RadiusDistribution::Log:
+                return options.radius_min * std::pow(options.radius_max / options.radius_min, random.uniform());
+            default:
+                return random.uniform(options.radius_min, options.radius_max);
+        }
+    }
+
+    /// Position of sphere index, drawn from random except on the grid.
+    vec3 pick_position(const Options &options, const Layout &layout, const int64_t index, Random &random) {
+        const float extent = layout.extent;
+        switch (options.distribution) {
+            case Distribution::Clustered: {
+                const vec3 &center = layout.centers[random.next() % layout.centers.size()];
+                const float sigma = 0.05f * extent;
+                return center + sigma * vec3(random.normal(), random.normal(), random.normal());
+            }
+            case Distribution::Grid: {
+                const int64_t side = layout.grid_side;
+                const float spacing = 2.0f * extent / static_cast<float>(side);
+                const auto coordinate = [&](const int64_t i) {
+                    return -extent + spacing * (static_cast<float>(i) + 0.5f);
+                };
+                return {coordinate(index % side), coordinate(index / side % side), coordinate(index / (side * side))};
+            }
+            case Distribution::Shells: {
+                const auto shell = static_cast<float>(index % layout.groups + 1);
+                return extent * shell / static_cast<float>(layout.groups) * random.direction();
+            }
+            case Distribution::Clumps: {
+                const vec3 &center = layout.centers[random.next() % layout.centers.size()];
+                const float clump = 0.1f * extent;
+                return center + clump * std::cbrt(random.uniform()) * random.direction();
+            }
+            default:
+                return {
+                    random.uniform(-extent, extent), random.uniform(-extent, extent), random.uniform(-extent, extent)
+                };
+        }
+    }
+
+    /// Generates the sphere lines of one block into out.
+    void generate_block(const Options &options, const Layout &layout, const int64_t block, std::string &out) {
+        // Each block gets its own stream, seeded from the scene seed and the block number
+        Random random(Random(options.seed ^ (0x632be59bd9b4e019ull * static_cast<uint64_t>(block + 1))).next());
+
+        const int64_t begin = block * BLOCK;
+        const int64_t end = std::min(options.count, begin + BLOCK);
+        out.clear();
+        out.reserve(static_cast<size_t>(end - begin) * 48);
+
+        for (int64_t i = begin; i < end; i++) {
+            const vec3 position = pick_position(options, layout, i, random);
+            const float radius = pick_radius(options, random);
+            const auto color = static_cast<int>(random.next() % static_cast<uint64_t>(options.palette));
+
+            append_fixed(out, position.x, 4);
+            out += ' ';
+            append_fixed(out, position.y, 4);
+            out += ' ';
+            append_fixed(out, position.z, 4);
+            out += " c";
+            out += std::to_string(color);
+            out += ' ';
+            append_fixed(out, radius, 4);
+            out += '\n';
+        }
+    }
+
+    Layout make_layout(const Options &options) {
+        Layout layout{};
+
+        // Keep the density of spheres roughly constant as the count grows
+        layout.extent = options.extent > 0
+                            ? options.extent
+                            : 2.0f * options.radius_max * std::cbrt(static_cast<float>(options.count));
+
+        layout.groups = options.groups > 0
+                            ? options.groups
+                            : static_cast<int>(std::clamp<int64_t>(options.count / 10000, 4, 256));
+
+        Random random(options.seed);
+        for (int g = 0; g < layout.groups; g++)
+            layout.centers.push_back(vec3(random.uniform(-0.8f, 0.8f), random.uniform(-0.8f, 0.8f),
+                                          random.uniform(-0.8f, 0.8f)) * layout.extent);
+
+        layout.grid_side = 1;
+        while (layout.grid_side * layout.grid_side * layout.grid_side < options.count)
+            layout.grid_side++;
+
+        return layout;
+    }
+
+    void write_scene(const Options &options, std::FILE *file) {
+        const Layout layout = make_layout(options);
+
+        // Header, with the camera looking at the whole region from outside it
+        std::ostringstream header;
+        const float distance = 3.0f * layout.extent;
+        header << "#BLUNDER\n\n#SETTINGS\nscreen_width " << options.width << "\nscreen_height " << options.height
+                << "\nsamples " << options.samples << "\nbounces " << options.bounces << "\n\n#CAMERA\nposition 0 "
+                << -distance << " " << 0.5f * distance << "\nlook_at 0 0 0\nfov 40\nup_direction 0 0 1\n\n#COLORS\n";
+
+        Random random(options.seed + 1);
+        for (int c = 0; c < options.palette; c++) {
+            std::string line = color_name(c);
+            for (int k = 0; k < 3; k++) {
+                line += ' ';
+                append_fixed(line, random.uniform(0.05f, 0.95f), 3);
+            }
+            header << line << "\n";
+        }
+        header << "\n#SPHERES\n";
+
+        const std::string text = header.str();
+        std::fwrite(text.data(), 1, text.size(), file);
+
+        // Spheres, a batch of blocks at a time
+        const int64_t blocks = (options.count + BLOCK - 1) / BLOCK;
+        std::vector<std::string> buffers(BLOCKS_PER_BATCH);
+        for (int64_t first = 0; first < blocks; first += BLOCKS_PER_BATCH) {
+            const auto batch = static_cast<int>(std::min(BLOCKS_PER_BATCH, blocks - first));
+            parallel_for(batch, [&](const int begin, const int end) {
+                for (int b = begin; b < end; b++)
+                    generate_block(options, layout, first + b, buffers[b]);
+            });
+
+            for (int b = 0; b < batch; b++)
+                if (std::fwrite(buffers[b].data(), 1, buffers[b].size(), file) != buffers[b].size())
+                    throw std::runtime_error("cannot write " + options.output);
+        }
+    }
+
+    void print_usage() {
+        std::cerr << "Usage: blunder-scenegen <scene.blunder> [--distribution uniform|clustered|grid|shells|clumps]\n"
+                "                        [--count <n>] [--radius <min>[:<max>]]\n"
+                "                        [--radius-distribution fixed|uniform|log] [--palette <n>] [--seed <n>]\n"
+                "                        [--extent <half size>] [--groups <n>]\n"
+                "                        [--size <width>x<height>] [--samples <n>] [--bounces <n>]" << std::endl;
+    }
+
+    Distribution parse_distribution(const std::string &name) {
+        if (name == "uniform")
+            return Distribution::Uniform;
+        if (name == "clustered")
+            return Distribution::Clustered;
+        if (name == "grid")
+            return Distribution::Grid;
+        if (name == "shells")
+            return Distribution::Shells;
+        if (name == "clumps")
+            return Distribution::Clumps;
+
+        throw std::invalid_argument("unknown distribution " + name);
+    }
+
+    RadiusDistribution parse_radius_distribution(const std::string &name) {
+        if (name == "fixed")
+            return RadiusDistribution::Fixed;
+        if (name == "uniform")
+            return RadiusDistribution::Uniform;
+        if (name == "log")
+            return RadiusDistribution::Log;
+
+        throw std::invalid_argument("unknown radius distribution " + name);
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    Options options;
+
+    // Parse options
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (arg == "--distribution" && hasValue)
+                options.distribution = parse_distribution(argv[++i]);
+            else if (arg == "--count" && hasValue)
+                options.count = std::stoll(argv[++i]);
+            else if (arg == "--radius" && hasValue) {
+                const std::string radius = argv[++i];
+                const auto separator = radius.find(':');
+                options.radius_min = std::stof(radius.substr(0, separator));
+                options.radius_max = separator == std::string::npos
+                                         ? options.radius_min
+                                         : std::stof(radius.substr(separator + 1));
+            } else if (arg == "--radius-distribution" && hasValue)
+                options.radius_distribution = parse_radius_distribution(argv[++i]);
+            else if (arg == "--palette" && hasValue)
+                options.palette = std::stoi(argv[++i]);
+            else if (arg == "--seed" && hasValue)
+                options.seed = std::stoull(argv[++i]);
+            else if (arg == "--extent" && hasValue)
+                options.extent = std::stof(argv[++i]);
+            else if (arg == "--groups" && hasValue)
+                options.groups = std::stoi(argv[++i]);
+            else if (arg == "--size" && hasValue) {
+                const std::string size = argv[++i];
+                const auto separator = size.find('x');
+                if (separator == std::string::npos)
+                    throw std::invalid_argument("size must be <width>x<height>");
+                options.width = std::stoi(size.substr(0, separator));
+                options.height = std::stoi(size.substr(separator + 1));
+            } else if (arg == "--samples" && hasValue)
+                options.samples = std::stoi(argv[++i]);
+            else if (arg == "--bounces" && hasValue)
+                options.bounces = std::stoi(argv[++i]);
+            else if (arg.rfind("--", 0) != 0 && options.output.empty())
+                options.output = arg;
+            else
+                throw std::invalid_argument("unknown or incomplete option " + arg);
+        }
+
+        // Ensure the scene loads: positive sizes, radii that survive 4 decimals, a non-empty palette
+        if (options.output.empty())
+            throw std::invalid_argument("no output file");
+        if (options.count < 0 || options.palette <= 0 || options.extent < 0 || options.groups < 0)
+            throw std::invalid_argument("count, extent and groups cannot be negative, palette must be positive");
+        if (options.radius_min < 0.001f || options.radius_max < options.radius_min)
+            throw std::invalid_argument("radius needs 0.001 <= min <= max");
+        if (options.width <= 0 || options.height <= 0 || options.samples <= 0 || options.bounces <= 0)
+            throw std::invalid_argument("size, samples and bounces must be positive");
+    } catch (std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        print_usage();
+        return 2;
+    }
+
+    std::FILE *file = std::fopen(options.output.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "ERROR: cannot open " << options.output << std::endl;
+        return 2;
+    }
+
+    try {
+        write_scene(options, file);
+    } catch (std::exception &e) {
+        std::fclose(file);
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 2;
+    }
+
+    if (std::fclose(file) != 0) {
+        std::cerr << "ERROR: cannot write " << options.output << std::endl;
+        return 2;
+    }
+
+    return 0;
+}